@@ -0,0 +1,105 @@
+/**
+ * @file binlog.h
+ * @brief Header for binlog.c file.
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+#ifndef BINLOG_H_
+#define BINLOG_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Other includes */
+#include <fsm.h>
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+
+#define BINLOG_RING_WORDS 256 /*Size of the ring of records in 32-bit words. It must be a power of two*/
+#define BINLOG_MAX_ARGS 4 /*Maximum number of arguments of a record*/
+#define BINLOG_HEADER_WORDS 2 /*Words of a record before its arguments: format ID and number of arguments, and timestamp*/
+#define BINLOG_ID_BITS 24 /*Bits of the format ID in the first word of a record. The number of arguments is stored in the upper bits*/
+#define BINLOG_ID_DROPPED ((1UL << BINLOG_ID_BITS) - 1) /*Format ID of the record that reports records dropped because the ring was full. Its argument is the number of records*/
+#define BINLOG_FRAME_TYPE 'L' /*First byte of the payload of a binary frame of records. It is followed by the cycles per microsecond of the timestamps (uint16_t, little endian) and the records (words in little endian)*/
+#define BINLOG_FRAME_HEADER_LENGTH 3 /*Bytes of the payload of a binary frame before the records*/
+
+/**
+ * @brief Store a log record: the ID of the format string, a timestamp in cycles (port_system_get_cycles()) and up to BINLOG_MAX_ARGS integer arguments. The text is not formatted on the MCU: the format string is placed in the section binlog_fmt of the ELF, where the host tool (tools/binlog_decode.py) finds it.
+ *
+ * Only integer conversions of up to 32 bits are supported (%d, %u, %x, %c, %p...). Pointers must be cast to an integer and %s prints the address of the string. It can be used from interrupts.
+ *
+ * @param fmt String literal with the printf-like format
+ * @param ... Arguments of the format. Each one is stored as a uint32_t.
+ */
+#define BINLOG(fmt, ...) \
+    do \
+    { \
+        static const char _binlog_fmt[] __attribute__((section("binlog_fmt"), used)) = fmt; \
+        binlog_write(_binlog_fmt, _BINLOG_NARGS(__VA_ARGS__), (const uint32_t[]){0, ##__VA_ARGS__} + 1); \
+    } while (0)
+
+#define _BINLOG_NARGS(...) _BINLOG_NARGS_N(0, ##__VA_ARGS__, 4, 3, 2, 1, 0) /*Number of arguments of BINLOG(). Up to BINLOG_MAX_ARGS*/
+#define _BINLOG_NARGS_N(_0, _1, _2, _3, _4, n, ...) n
+
+/* Function prototypes and explanation -------------------------------------------------*/
+
+/**
+ * @brief Discard all the records and reset the count of dropped records.
+ */
+
+void binlog_init(void);
+
+/**
+ * @brief Append a record to the ring. It is called by BINLOG(). If the ring is full the record is dropped and counted.
+ *
+ * This function runs in constant time with the interrupts disabled, so it can be called from any context.
+ *
+ * @param p_fmt Pointer to the format string. It must be placed in the section binlog_fmt.
+ * @param nargs Number of arguments (0 to BINLOG_MAX_ARGS)
+ * @param p_args Pointer to the arguments
+ */
+
+void binlog_write(const char *p_fmt, uint32_t nargs, const uint32_t *p_args);
+
+/**
+ * @brief Get the format string of an ID, to decode the records on the MCU itself (e.g., in tests).
+ *
+ * @param id Format ID of a record
+ * @return const char* Pointer to the format string, or NULL if the ID is BINLOG_ID_DROPPED
+ */
+
+const char *binlog_get_format(uint32_t id);
+
+/**
+ * @brief Move the oldest records into the payload of a binary frame. Only whole records are moved. If records were dropped since the last call, a BINLOG_ID_DROPPED record is added first.
+ *
+ * @param p_out Pointer to the buffer where the payload is written
+ * @param size Size of the buffer in bytes
+ * @return uint32_t Length of the payload in bytes, or 0 if there were no records or they do not fit
+ */
+
+uint32_t binlog_read(uint8_t *p_out, uint32_t size);
+
+/**
+ * @brief Send the oldest records as a binary frame of a USART FSM (see fsm_usart_send_frame()). The records are released only if the frame has been queued.
+ *
+ * @param p_usart Pointer to the USART FSM. Its peer must decode the frames with tools/binlog_decode.py.
+ * @return true if a frame has been queued
+ * @return false if there were no records or the TX queue is full
+ */
+
+bool binlog_drain(fsm_t *p_usart);
+
+/**
+ * @brief Get the number of records dropped because the ring was full since binlog_init().
+ *
+ * @return uint32_t Number of records dropped
+ */
+
+uint32_t binlog_get_dropped(void);
+
+#endif /* BINLOG_H_ */
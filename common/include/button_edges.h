@@ -0,0 +1,72 @@
+/**
+ * @file button_edges.h
+ * @brief Header for button_edges.c file.
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+#ifndef BUTTON_EDGES_H_
+#define BUTTON_EDGES_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+
+#define BUTTON_EDGES_LENGTH 32 /*Edges that can be queued for one button, bounces included. It must be a power of two*/
+
+/* Typedefs --------------------------------------------------------------------*/
+
+typedef struct {
+    uint32_t millis; /*System tick when the edge happened*/
+    uint32_t cycles; /*Cycle counter (port_system_get_cycles()) when the edge happened*/
+    bool pressed; /*Level of the button after the edge*/
+} button_edge_t;
+
+typedef struct {
+    button_edge_t ring[BUTTON_EDGES_LENGTH]; /*Queued edges*/
+    volatile uint32_t head; /*Free-running index where the next edge is written. Only written by the producer (ISR)*/
+    volatile uint32_t tail; /*Free-running index of the oldest edge. Only written by the consumer*/
+    uint32_t dropped; /*Edges dropped because the queue was full*/
+} button_edges_t;
+
+/* Function prototypes and explanation -------------------------------------------------*/
+
+/**
+ * @brief Queue an edge of a button with its timestamps. If the queue is full, the edge is dropped and counted.
+ *
+ * It is lock-free and it is called by the producer only (the EXTI or timer ISR of the port).
+ *
+ * @param p_edges Pointer to the queue
+ * @param pressed Level of the button after the edge
+ * @param millis System tick when the edge happened
+ * @param cycles Cycle counter when the edge happened
+ * @return true if the edge has been queued
+ * @return false if it has been dropped
+ */
+
+bool button_edges_push(button_edges_t *p_edges, bool pressed, uint32_t millis, uint32_t cycles);
+
+/**
+ * @brief Take the oldest edge of the queue. It is called by the consumer only.
+ *
+ * @param p_edges Pointer to the queue
+ * @param p_edge Pointer where the edge is copied
+ * @return true if there was an edge
+ * @return false if the queue was empty
+ */
+
+bool button_edges_pop(button_edges_t *p_edges, button_edge_t *p_edge);
+
+/**
+ * @brief Discard all the queued edges. It is called by the consumer only.
+ *
+ * @param p_edges Pointer to the queue
+ */
+
+void button_edges_flush(button_edges_t *p_edges);
+
+#endif /* BUTTON_EDGES_H_ */
@@ -0,0 +1,62 @@
+/**
+ * @file button_scan.h
+ * @brief Header for button_scan.c file.
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+#ifndef BUTTON_SCAN_H_
+#define BUTTON_SCAN_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+
+#define BUTTON_SCAN_SAMPLES 4 /*Consecutive samples that must differ from the debounced state before a change is accepted (2-bit counters)*/
+
+/* Typedefs --------------------------------------------------------------------*/
+
+typedef struct {
+    uint32_t state; /*Debounced state: bit n is set while line n is active*/
+    uint32_t cnt0; /*Bit 0 of the counter of each line (bit-sliced)*/
+    uint32_t cnt1; /*Bit 1 of the counter of each line (bit-sliced)*/
+} button_scan_t;
+
+/* Function prototypes and explanation -------------------------------------------------*/
+
+/**
+ * @brief Debounce up to 32 lines at once with a vertical counter.
+ *
+ * Each line has a 2-bit counter stored across cnt0 and cnt1, so all the lines are updated with a handful of bitwise operations whatever their number. The counter of a line counts the consecutive samples that differ from its debounced state and is reset by any sample that agrees with it. A line changes its state on the BUTTON_SCAN_SAMPLES-th sample in a row, so the bounces never reach the state.
+ *
+ * @param p_scan Pointer to the debouncer
+ * @param sample Current level of the lines: bit n is set if line n is active
+ * @return uint32_t Lines whose debounced state has just changed
+ */
+
+uint32_t button_scan_update(button_scan_t *p_scan, uint32_t sample);
+
+/**
+ * @brief Get the lines that are being debounced: their last sample differs from their debounced state.
+ *
+ * @param p_scan Pointer to the debouncer
+ * @return uint32_t Lines with a counter running
+ */
+
+uint32_t button_scan_busy(const button_scan_t *p_scan);
+
+/**
+ * @brief Set the debounced state of some lines and stop their counters. The rest of the lines are not modified.
+ *
+ * @param p_scan Pointer to the debouncer
+ * @param lines Lines to set
+ * @param state Debounced state: bit n is set if line n is active
+ */
+
+void button_scan_set(button_scan_t *p_scan, uint32_t lines, uint32_t state);
+
+#endif /* BUTTON_SCAN_H_ */
@@ -0,0 +1,100 @@
+/**
+ * @file cobs_frame.h
+ * @brief Header for cobs_frame.c file.
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+#ifndef COBS_FRAME_H_
+#define COBS_FRAME_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+
+#define COBS_FRAME_DELIMITER 0x00 /*Byte that delimits the frames on the link*/
+#define COBS_FRAME_CRC_LENGTH 2 /*Length of the CRC appended to the payload*/
+#define COBS_FRAME_CRC_INIT 0xFFFF /*Initial value of the CRC-16/CCITT-FALSE*/
+#define COBS_FRAME_MAX_ENCODED_LENGTH(n) ((n) + COBS_FRAME_CRC_LENGTH + ((n) + COBS_FRAME_CRC_LENGTH) / 254 + 2) /*Worst-case length of an encoded frame of n payload bytes, including the delimiter*/
+
+/* Enums */
+
+typedef enum {
+    COBS_FRAME_NONE = 0, /*No frame has been completed*/
+    COBS_FRAME_OK, /*A frame has been completed and its CRC is right*/
+    COBS_FRAME_ERROR /*A frame has been completed but it is corrupted, too long or truncated*/
+} cobs_frame_status_t;
+
+/* Typedefs --------------------------------------------------------------------*/
+
+typedef struct {
+    uint32_t max_length; /*Maximum length of a decoded frame, CRC included*/
+    uint32_t length; /*Number of decoded bytes of the current frame, CRC included*/
+    uint16_t crc; /*Running CRC of the decoded bytes. It is 0 at the end of a right frame*/
+    uint8_t code; /*Code byte of the current COBS group. 0 at the start of a frame*/
+    uint8_t remaining; /*Number of data bytes left in the current COBS group*/
+    bool error; /*Flag to indicate that the current frame must be discarded*/
+} cobs_decoder_t;
+
+/* Function prototypes and explanation -------------------------------------------------*/
+
+/**
+ * @brief Update a CRC-16/CCITT-FALSE (polynomial 0x1021, no reflection, no final XOR) with a block of data.
+ *
+ * @param p_data Pointer to the data
+ * @param length Length of the data in bytes
+ * @param crc Current value of the CRC. Use COBS_FRAME_CRC_INIT for the first block.
+ * @return uint16_t Updated CRC
+ */
+
+uint16_t cobs_frame_crc16(const uint8_t *p_data, uint32_t length, uint16_t crc);
+
+/**
+ * @brief Build a frame: append the CRC to the payload, COBS-encode both and add the delimiter.
+ *
+ * @param p_payload Pointer to the payload. It can contain any byte value.
+ * @param length Length of the payload in bytes
+ * @param p_out Pointer to the buffer where the frame is written
+ * @param out_size Size of the output buffer. It must be at least COBS_FRAME_MAX_ENCODED_LENGTH(length).
+ * @return uint32_t Length of the frame, delimiter included, or 0 if the output buffer is too small
+ */
+
+uint32_t cobs_frame_encode(const uint8_t *p_payload, uint32_t length, uint8_t *p_out, uint32_t out_size);
+
+/**
+ * @brief Initialize an incremental frame decoder.
+ *
+ * @param p_dec Pointer to the decoder
+ * @param max_length Maximum length of a decoded frame, CRC included
+ */
+
+void cobs_decoder_init(cobs_decoder_t *p_dec, uint32_t max_length);
+
+/**
+ * @brief Feed one byte received from the link to the decoder.
+ *
+ * Each byte produces at most one decoded byte, that the caller must store right after the previous one (e.g., directly in its RX ring). The last COBS_FRAME_CRC_LENGTH decoded bytes of a frame are its CRC.
+ * This function runs in constant time and it does not access any buffer, so it can be called from an ISR.
+ *
+ * @param p_dec Pointer to the decoder
+ * @param byte Byte received from the link
+ * @param p_out Pointer where the decoded byte is returned
+ * @param p_out_valid Pointer to a flag that is set to true if a decoded byte has been returned
+ * @return cobs_frame_status_t COBS_FRAME_OK or COBS_FRAME_ERROR when the delimiter closes a frame, COBS_FRAME_NONE otherwise
+ */
+
+cobs_frame_status_t cobs_decoder_push(cobs_decoder_t *p_dec, uint8_t byte, uint8_t *p_out, bool *p_out_valid);
+
+/**
+ * @brief Discard the frame being decoded, e.g., because the caller has no room to store it. The decoder resynchronizes at the next delimiter.
+ *
+ * @param p_dec Pointer to the decoder
+ */
+
+void cobs_decoder_abort(cobs_decoder_t *p_dec);
+
+#endif /* COBS_FRAME_H_ */
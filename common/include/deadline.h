@@ -0,0 +1,82 @@
+/**
+ * @file deadline.h
+ * @brief Header for deadline.c file.
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+#ifndef DEADLINE_H_
+#define DEADLINE_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+
+#define DEADLINE_MAX_MS ((uint32_t)INT32_MAX) /*Longest time to a deadline (about 24.8 days): the comparisons are done on the signed difference of two system ticks*/
+#define DEADLINE_MAX_US ((uint32_t)INT32_MAX) /*Longest time to a deadline on the microsecond count (about 35.8 minutes)*/
+
+/* Typedefs --------------------------------------------------------------------*/
+
+typedef uint32_t deadline_t; /*System tick (port_system_get_millis()) at which a deadline expires. Compare it only with the functions of this module: the system tick wraps after about 49.7 days. The functions work the same on the microsecond count of port_system_get_micros(), which wraps after about 71.6 minutes, as long as both arguments come from the same count*/
+
+/* Function prototypes and explanation -------------------------------------------------*/
+
+/**
+ * @brief Deadline some time after a system tick.
+ *
+ * @param start_ms System tick to count from
+ * @param timeout_ms Time to the deadline, up to DEADLINE_MAX_MS
+ * @return deadline_t Deadline
+ */
+
+deadline_t deadline_after(uint32_t start_ms, uint32_t timeout_ms);
+
+/**
+ * @brief Check if a deadline has been reached (now >= deadline), also across the wrap of the system tick.
+ *
+ * @param deadline Deadline
+ * @param now_ms Current system tick
+ * @return true if the deadline has been reached
+ * @return false otherwise
+ */
+
+bool deadline_reached(deadline_t deadline, uint32_t now_ms);
+
+/**
+ * @brief Check if a deadline has passed (now > deadline), also across the wrap of the system tick.
+ *
+ * @param deadline Deadline
+ * @param now_ms Current system tick
+ * @return true if the deadline has passed
+ * @return false otherwise
+ */
+
+bool deadline_passed(deadline_t deadline, uint32_t now_ms);
+
+/**
+ * @brief Time left to a deadline.
+ *
+ * @param deadline Deadline
+ * @param now_ms Current system tick
+ * @return uint32_t Time left in ms, 0 if the deadline has been reached
+ */
+
+uint32_t deadline_remaining(deadline_t deadline, uint32_t now_ms);
+
+/**
+ * @brief Check if some time has elapsed since a system tick (now - start >= interval). The unsigned difference is right across the wrap of the system tick.
+ *
+ * @param start_ms System tick to count from
+ * @param interval_ms Time to check
+ * @param now_ms Current system tick
+ * @return true if the time has elapsed
+ * @return false otherwise
+ */
+
+bool deadline_elapsed(uint32_t start_ms, uint32_t interval_ms, uint32_t now_ms);
+
+#endif /* DEADLINE_H_ */
@@ -4,9 +4,16 @@
 /* Includes ------------------------------------------------------------------*/
 /* Standard C includes */
 #include <stdint.h>
+#include <stdbool.h>
 
 /* Other includes */
 #include <fsm.h>
+#include "fsm_timed.h"
+#include "led_pattern.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define FSM_BLINK_TIMEOUT_HALF_PERIOD 0 //!< Index of the half period among the timeouts of the FSM: the LED toggles by software each time the FSM has been in IDLE for it
 
 /* Typedefs --------------------------------------------------------------------*/
 /**
@@ -34,9 +41,16 @@ enum FSM_BLINK_STATES
  */
 typedef struct fsm_blink_t
 {
-    fsm_t fsm;          //!< inner FSM. It must be the first element so we can use composition.
+    union
+    {
+        fsm_t fsm;          //!< inner FSM. It must be the first element so we can use composition.
+        fsm_timed_t timed;  //!< The same FSM with the time of entry in its state, which the LED toggle restarts.
+    };
     uint32_t period_ms; //!< LED toggling period.
-    uint32_t last_time; //!< Auxiliary variable to know when was the last time the LED toggled.
+    bool hw_blink;      //!< true if the LED is blinked by the hardware (see port_led_blink_start()) or plays a pattern. The FSM only acts when the period or the pattern changes.
+    bool new_period;    //!< Flag to indicate that the period has been changed with fsm_blink_set_period().
+    const led_pattern_t *p_pattern; //!< Pattern played instead of the blink (see port_led_pattern_start()). NULL to blink.
+    bool new_pattern;   //!< Flag to indicate that the pattern has been changed with fsm_blink_set_pattern().
 } fsm_blink_t;
 
 /* Function prototypes and explanation -------------------------------------------------*/
@@ -55,6 +69,8 @@ fsm_t *fsm_blink_new(uint32_t period_ms);
 /**
  * @brief Initializes all the parameters for an FSM that blinks the LED of the board.
  *
+ * The LED is blinked by the hardware if the port allows it for this LED (see port_led_blink_start()), and toggled by the FSM otherwise.
+ *
  * > **TO-DO alumnos:**
  * >
  * > ✅ 1. Cast pointer to blink FSM (we already provide this) \n
@@ -67,4 +83,47 @@ fsm_t *fsm_blink_new(uint32_t period_ms);
  */
 void fsm_blink_init(fsm_t *p_fsm, uint32_t period_ms);
 
+/**
+ * @brief Changes the blinking period of the LED. It is applied on the next fire of the FSM.
+ *
+ * @param p_fsm pointer to the FSM.
+ * @param period_ms new blinking period of the LED.
+ */
+void fsm_blink_set_period(fsm_t *p_fsm, uint32_t period_ms);
+
+/**
+ * @brief Plays a pattern on the LED instead of blinking it. It is applied on the next fire of the FSM. The pattern is played by the hardware, with no CPU time; if the hardware cannot play it, the LED keeps blinking. A pattern that does not loop keeps the duty cycle of its last step until the pattern is changed.
+ *
+ * @param p_fsm pointer to the FSM.
+ * @param p_pattern pattern to play. It must stay in memory while it is played. NULL to stop the pattern and blink the LED again, at the last period set.
+ */
+void fsm_blink_set_pattern(fsm_t *p_fsm, const led_pattern_t *p_pattern);
+
+/**
+ * @brief Checks if the blink FSM needs to be fired to keep the LED blinking. It does not when the LED is blinked by the hardware, so the main loop can sleep.
+ *
+ * @param p_fsm pointer to the FSM.
+ *
+ * @return true if the FSM toggles the LED by software or a new period or pattern is pending, false otherwise
+ */
+bool fsm_blink_check_activity(fsm_t *p_fsm);
+
+/**
+ * @brief Fire the blink FSM with fsm_timed_fire().
+ *
+ * @param p_fsm pointer to the FSM.
+ *
+ * @return int 1 if a transition has fired, 0 otherwise
+ */
+int fsm_blink_fire(fsm_t *p_fsm);
+
+/**
+ * @brief Get the time the main loop can sleep before it fires the blink FSM again: the time to the next software toggle of the LED, so it is not polled every iteration.
+ *
+ * @param p_fsm pointer to the FSM.
+ *
+ * @return uint32_t Time in ms: 0 if a new period or pattern is pending or the LED must toggle now, or FSM_TIMED_NONE if the hardware blinks the LED
+ */
+uint32_t fsm_blink_get_next_ms(fsm_t *p_fsm);
+
 #endif // FSM_BLINK_H_
@@ -16,8 +16,18 @@
 
 /* Other includes */
 #include "fsm.h"
+#include "fsm_timed.h"
+#include "button_edges.h"
+#include "deadline.h"
 
 /* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define FSM_BUTTON_SUBSCRIBERS 4          /*!< Maximum number of subscribers to the events of a button FSM */
+#define FSM_BUTTON_DOUBLE_CLICK_MS 300    /*!< Default maximum time between a release and the next press of a double click */
+#define FSM_BUTTON_LONG_PRESS_MS 1000     /*!< Default time the button must be held for a long press */
+#define FSM_BUTTON_REPEAT_MS 250          /*!< Default period of the auto-repeat while the button is held after a long press */
+#define FSM_BUTTON_TIMEOUT_DEBOUNCE 0     /*!< Index of the debounce time among the timeouts of the FSM, for AFTER() */
+
 /* Enums */
 enum FSM_BUTTON
 {
@@ -28,15 +38,59 @@ enum FSM_BUTTON
 
 };
 
+enum FSM_BUTTON_EVENTS
+{
+    BUTTON_EVENT_CLICK = 0x01,        /*!< Short press not followed by another one within the double click time */
+    BUTTON_EVENT_DOUBLE_CLICK = 0x02, /*!< Two short presses, the second one within the double click time after the first release */
+    BUTTON_EVENT_LONG_PRESS = 0x04,   /*!< The button has been held for the long press time. It is emitted while the button is still held, and no click follows */
+    BUTTON_EVENT_REPEAT = 0x08,       /*!< Auto-repeat while the button is still held after a long press */
+};
+
 /* Typedefs --------------------------------------------------------------------*/
+
+/**
+ * @brief Callback called by the button FSM when it detects a gesture the subscriber is interested in.
+ *
+ * @param p_this Pointer to the button FSM that emits the event
+ * @param event Event detected: one of FSM_BUTTON_EVENTS
+ * @param p_arg User argument given when subscribing
+ */
+typedef void (*fsm_button_event_cb_t)(fsm_t *p_this, uint32_t event, void *p_arg);
+
 typedef struct
 {
-    fsm_t f;              /*!< Internal FSM from the library */
+    uint32_t events;          /*!< Mask of FSM_BUTTON_EVENTS the subscriber is interested in */
+    fsm_button_event_cb_t cb; /*!< Callback of the subscriber */
+    void *p_arg;              /*!< Argument of the callback */
+} fsm_button_subscriber_t;
+
+typedef struct
+{
+    union
+    {
+        fsm_t f;            /*!< Internal FSM from the library */
+        fsm_timed_t timed;  /*!< The same FSM with the time of entry in its state, for the AFTER() transitions of the debounce */
+    };
     uint32_t debounce_time; /*!< Button debounce time in ms */
-    uint32_t next_timeout;  /*!< Next timeout for the debounce in ms */
     uint32_t tick_pressed;  /*!< Number of system ticks when the button was pressed */
     uint32_t duration;      /*!< How much time the button has been pressed */
+    uint32_t duration_us;   /*!< How much time the button has been pressed, in microseconds */
+    button_edge_t last_edge; /*!< Last edge taken from the edge queue of the port: press or release */
+    button_edge_t next_edge; /*!< Oldest edge debounced by the port that the FSM has not taken yet */
+    bool next_edge_queued;   /*!< Flag to indicate that next_edge holds an edge */
     uint32_t button_id;
+    bool timer_debounce;    /*!< Flag to indicate that the button is debounced by the port (EXTI and one-shot timer) instead of the FSM */
+    bool scan_debounce;     /*!< Flag to indicate that the button is debounced by the port (periodic scan in the SysTick) instead of the FSM */
+    uint32_t double_click_ms; /*!< Maximum time in ms between a release and the next press of a double click. 0 to emit the clicks right after the release */
+    uint32_t long_press_ms; /*!< Time in ms the button must be held for a long press. 0 to disable the long press and the auto-repeat */
+    uint32_t repeat_ms;     /*!< Period in ms of the auto-repeat after a long press. 0 to disable it */
+    uint32_t tick_released; /*!< Number of system ticks when the button was released */
+    deadline_t next_repeat; /*!< Number of system ticks of the next auto-repeat */
+    bool long_sent;         /*!< Flag to indicate that the long press of the current press has been emitted */
+    bool click_pending;     /*!< Flag to indicate that a short press waits for the double click time to pass */
+    bool second_press;      /*!< Flag to indicate that the current press started within the double click time */
+    fsm_button_subscriber_t subscribers[FSM_BUTTON_SUBSCRIBERS]; /*!< Subscribers to the gesture events */
+    uint32_t subscribers_number; /*!< Number of elements of subscribers[] in use */
 } fsm_button_t;
 
 /* Function prototypes and documentation ---------------------------------------*/
@@ -71,6 +125,24 @@ void fsm_button_init(fsm_t *p_this, uint32_t debounce_time, uint32_t button_id);
  */
 uint32_t fsm_button_get_duration(fsm_t *p_this);
 
+/**
+ * @brief Returns the ID of the button measured by the FSM, so the FSMs that consume its presses can tell the buttons apart.
+ *
+ * @param p_this pointer to the button FSM.
+ * @return uint32_t button ID. It selects the element of the buttons_arr[] array of the port.
+ */
+uint32_t fsm_button_get_id(fsm_t *p_this);
+
+/**
+ * @brief Returns the latest duration measured by the button FSM with microsecond resolution.
+ *
+ * The duration is computed from the timestamps taken by the port when the edges happened (see port_button_get_edge()), so it does not depend on when the FSM is fired. If the port has not queued the edges, the time when the FSM saw them is used instead.
+ *
+ * @param p_this pointer to the button FSM.
+ * @return uint32_t amount of time (in us) that the button has been pressed.
+ */
+uint32_t fsm_button_get_duration_us(fsm_t *p_this);
+
 /**
  * @brief Sets the duration measured by the button FSM to 0.
  * 
@@ -79,7 +151,7 @@ uint32_t fsm_button_get_duration(fsm_t *p_this);
 void fsm_button_reset_duration(fsm_t *p_this);
 
 /**
- * @brief Check if the button FSM is active, or not. The button is inactive when it is in the status BUTTON_RELEASED.
+ * @brief Check if the button FSM is active, or not. The button is inactive when it is in the status BUTTON_RELEASED, or always in timer debounce mode: every transition is then triggered by an interrupt, which wakes up the core. In scan debounce mode it is active while the port is settling an edge, so the SysTick keeps sampling the button. In both modes it is active while the port has queued edges the FSM has not taken yet, e.g. a press and a release debounced between two fires. With subscribers, it is also active while a gesture depends on the time: a click waiting for the double click time, or a press held towards a long press or an auto-repeat.
  * 
  * @param p_this pointer to the button FSM.
  * 
@@ -88,4 +160,60 @@ void fsm_button_reset_duration(fsm_t *p_this);
  */
 bool fsm_button_check_activity (fsm_t *p_this);
 
+/**
+ * @brief Fire the button FSM with fsm_timed_fire(): in the debounce wait states, where all the transitions are AFTER() transitions, the input functions are not called before the debounce time has elapsed.
+ *
+ * @param p_this pointer to the button FSM.
+ * @return int 1 if a transition has fired, 0 otherwise
+ */
+int fsm_button_fire(fsm_t *p_this);
+
+/**
+ * @brief Get the time the main loop can sleep before it fires the button FSM again, if no interrupt wakes it up before. In the debounce wait states it is the time to the end of the debounce (see fsm_timed_get_next_ms()), instead of polling it.
+ *
+ * @param p_this pointer to the button FSM.
+ * @return uint32_t Time in ms: 0 if the FSM must be fired again now (see fsm_button_check_activity()), or FSM_TIMED_NONE if only an interrupt can fire a transition
+ */
+uint32_t fsm_button_get_next_ms(fsm_t *p_this);
+
+/**
+ * @brief Select who debounces the button: the FSM, polling the time in BUTTON_PRESSED_WAIT and BUTTON_RELEASED_WAIT (default), or the port, with the EXTI interrupt and a one-shot timer (see port_button_set_timer_debounce()). In timer debounce mode the FSM only goes between BUTTON_RELEASED and BUTTON_PRESSED on the events posted by the timer ISR, so it never polls the time. The FSM takes the events from the edge queue of the port, so none is lost if several are debounced between two fires. The FSM goes back to BUTTON_RELEASED.
+ *
+ * @param p_this pointer to the button FSM.
+ * @param enable true to debounce with the timer, false to debounce in the FSM
+ */
+void fsm_button_set_timer_debounce(fsm_t *p_this, bool enable);
+
+/**
+ * @brief Subscribe to the gesture events of a button FSM. The callback is called from fsm_fire() as soon as the FSM detects one of the events: a long press while the button is still held, not after its release.
+ *
+ * While there is no subscriber, the FSM only measures the durations. With subscribers, it also polls the time while a gesture is in progress (see fsm_button_check_activity()).
+ *
+ * @param p_this pointer to the button FSM.
+ * @param events mask of FSM_BUTTON_EVENTS to be notified of.
+ * @param cb callback.
+ * @param p_arg argument passed to the callback.
+ * @return true if the subscriber has been added
+ * @return false if there are already FSM_BUTTON_SUBSCRIBERS subscribers
+ */
+bool fsm_button_subscribe(fsm_t *p_this, uint32_t events, fsm_button_event_cb_t cb, void *p_arg);
+
+/**
+ * @brief Set the thresholds of the gestures of a button FSM. By default they are FSM_BUTTON_DOUBLE_CLICK_MS, FSM_BUTTON_LONG_PRESS_MS and FSM_BUTTON_REPEAT_MS.
+ *
+ * @param p_this pointer to the button FSM.
+ * @param double_click_ms maximum time in ms between a release and the next press of a double click. 0 to disable the double click: the clicks are then emitted right after the release.
+ * @param long_press_ms time in ms the button must be held for a long press. 0 to disable the long press and the auto-repeat.
+ * @param repeat_ms period in ms of the auto-repeat after a long press. 0 to disable it.
+ */
+void fsm_button_set_gestures(fsm_t *p_this, uint32_t double_click_ms, uint32_t long_press_ms, uint32_t repeat_ms);
+
+/**
+ * @brief Select who debounces the button: the FSM (default) or the port, sampling all the buttons periodically in the SysTick ISR (see port_button_set_scan_debounce()). It suits noisy switches, whose bounces would raise a storm of EXTI interrupts. As in timer debounce mode, the FSM only goes between BUTTON_RELEASED and BUTTON_PRESSED on the events posted by the port. The FSM goes back to BUTTON_RELEASED.
+ *
+ * @param p_this pointer to the button FSM.
+ * @param enable true to debounce with the scan, false to debounce in the FSM
+ */
+void fsm_button_set_scan_debounce(fsm_t *p_this, bool enable);
+
 #endif
@@ -0,0 +1,107 @@
+/**
+ * @file fsm_command.h
+ * @brief Header for fsm_command.c file.
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+#ifndef FSM_COMMAND_H_
+#define FSM_COMMAND_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Other includes */
+#include <fsm.h>
+#include "fsm_usart.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+
+#define COMMAND_HASH_SIZE 16 /*Number of slots of the keyword table. It must be a power of two*/
+#define COMMAND_HASH(len, first, last) ((3u * (len) + (uint8_t)(first) + 2u * (uint8_t)(last)) & (COMMAND_HASH_SIZE - 1)) /*Perfect hash of the command keywords. A collision is a compile error (overridden initializer)*/
+#define COMMAND_SEPARATOR ';' /*Separator of the commands of a frame. A new line is also accepted*/
+#define COMMAND_SPEED_MIN 10 /*Minimum speed of the player, in hundredths*/
+#define COMMAND_SPEED_MAX 1000 /*Maximum speed of the player, in hundredths*/
+
+/* Enums */
+
+enum FSM_COMMAND {
+  WAIT_COMMAND = 0
+};
+
+/* Typedefs --------------------------------------------------------------------*/
+
+typedef struct{
+    uint32_t frames; /*Number of frames interpreted*/
+    uint32_t commands; /*Number of commands executed successfully*/
+    uint32_t errors; /*Number of unknown or invalid commands*/
+    uint32_t replies_dropped; /*Number of reply messages that could not be queued in the USART*/
+} fsm_command_stats_t;
+
+typedef struct{
+    fsm_t f; /*Command interpreter FSM*/
+    fsm_t *p_fsm_usart; /*USART FSM that receives the commands and sends the replies. It can be NULL (replies are discarded)*/
+    fsm_t *p_fsm_buzzer; /*Buzzer melody player FSM controlled by the commands*/
+    char reply [USART_OUTPUT_BUFFER_LENGTH]; /*Replies of the frame being interpreted, batched into one message*/
+    uint32_t reply_length; /*Number of bytes in the reply buffer*/
+    fsm_command_stats_t stats; /*Interpreter statistics*/
+} fsm_command_t;
+
+/* Function prototypes and explanation -------------------------------------------------*/
+
+/**
+ * @brief Create a new command interpreter FSM.
+ *
+ * The FSM waits for frames received by the USART FSM. A frame can contain several commands separated by COMMAND_SEPARATOR or new lines, and all of them are executed in the same FSM step. Each command is a keyword, optionally followed by a space and an argument:
+ * - `play`, `pause`, `stop`: act on the player.
+ * - `speed <x>`: set the speed of the player (e.g., `speed 1.5`).
+ * - `melody <name|index>`: select the melody to play.
+ * - `status`: query the state of the player.
+ * - `metrics`: send a binary snapshot of the metrics registry (see metrics.h and tools/metrics_cli.py).
+ * - `latency <probe>`: send a binary snapshot of the histogram of a latency probe, by index or name (see latency_probe.h and tools/latency_cli.py).
+ *
+ * Every command produces one reply line. The replies of a frame are batched and sent as one message through the USART TX queue.
+ *
+ * @param p_fsm_usart Pointer to the USART FSM. It can be NULL to run the interpreter without a USART (e.g., benchmarks).
+ * @param p_fsm_buzzer Pointer to the buzzer melody player FSM
+ * @return fsm_t* A pointer to the command interpreter FSM
+ */
+
+fsm_t *fsm_command_new(fsm_t *p_fsm_usart, fsm_t *p_fsm_buzzer);
+
+/**
+ * @brief Initialize the default values of the FSM struct.
+ *
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_command_t struct
+ * @param p_fsm_usart Pointer to the USART FSM. It can be NULL.
+ * @param p_fsm_buzzer Pointer to the buzzer melody player FSM
+ */
+
+void fsm_command_init(fsm_t *p_this, fsm_t *p_fsm_usart, fsm_t *p_fsm_buzzer);
+
+/**
+ * @brief Execute all the commands of a frame and send their replies.
+ *
+ * This function is called by the FSM for each received frame, but it can also be called directly.
+ *
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_command_t struct
+ * @param p_frame Pointer to the frame
+ * @param length Length of the frame in bytes
+ * @return uint32_t Number of commands found in the frame, including the invalid ones
+ */
+
+uint32_t fsm_command_execute(fsm_t *p_this, const char *p_frame, uint32_t length);
+
+/**
+ * @brief Get the statistics of the command interpreter.
+ *
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_command_t struct
+ * @param p_stats Pointer to the struct where the statistics will be copied
+ */
+
+void fsm_command_get_stats(fsm_t *p_this, fsm_command_stats_t *p_stats);
+
+#endif /* FSM_COMMAND_H_ */
@@ -2,7 +2,9 @@
 #define FSM_LED_H_
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <fsm.h>
+#include "led_pattern.h"
 
 enum FSM_LED_STATES
 {
@@ -14,9 +16,12 @@ typedef struct
 fsm_t fsm ; /*! < Internal FSM from the library */
 fsm_t * p_button ; /*! < Pointer to button FSM */
 uint32_t min_duration ; /*! < Minimum button pulse for toggling the LED */
+const led_pattern_t * p_pattern ; /*! < Pattern started and stopped by the button instead of toggling the LED. NULL to toggle it */
+bool pattern_on ; /*! < Flag to indicate that the FSM has started the pattern */
 } fsm_led_t ;
 
 fsm_t * fsm_led_new ( fsm_t * p_button , uint32_t min_duration );
 void fsm_led_init ( fsm_t *p_fsm , fsm_t * p_button , uint32_t min_duration );
+void fsm_led_set_pattern ( fsm_t *p_fsm , const led_pattern_t * p_pattern ); /* Each button pulse starts the pattern, or stops it if it is running. A pattern that is running is stopped. NULL to toggle the LED again */
 
 # endif // FSM_LED_H_
\ No newline at end of file
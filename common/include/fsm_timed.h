@@ -0,0 +1,145 @@
+/**
+ * @file fsm_timed.h
+ * @brief Header for fsm_timed.c file.
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+#ifndef FSM_TIMED_H_
+#define FSM_TIMED_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Other includes */
+#include "fsm.h"
+#include "deadline.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+
+#define FSM_TIMED_TIMEOUTS 4 /*Timeouts of an FSM that its AFTER() transitions can use: indexes 0 to FSM_TIMED_TIMEOUTS - 1*/
+#define FSM_TIMED_NONE UINT32_MAX /*Returned by fsm_timed_get_next_ms() when the state has no AFTER() transition*/
+
+/**
+ * @brief Input function of a transition that fires when the FSM has been in the origin state of the transition for the timeout of the given index (fsm_timed_set_timeout()). The index must be a constant that expands to 0 to FSM_TIMED_TIMEOUTS - 1, e.g. `{BUTTON_PRESSED_WAIT, AFTER(FSM_BUTTON_TIMEOUT_DEBOUNCE), BUTTON_PRESSED, NULL}`.
+ */
+#define AFTER(index) FSM_TIMED_AFTER_(index)
+#define FSM_TIMED_AFTER_(index) fsm_timed_after_##index /*Second level, so that the index is expanded before it is pasted*/
+
+/* Typedefs --------------------------------------------------------------------*/
+
+typedef struct
+{
+    fsm_t f; /*Internal FSM from the library. It must be the first field, so an fsm_timed_t is an fsm_t*/
+    uint32_t timeouts_ms[FSM_TIMED_TIMEOUTS]; /*Timeout of each index of AFTER()*/
+    int state; /*State whose entry is recorded. If it is not the current state, the FSM has entered the current state with no record*/
+    uint32_t entered; /*System tick at which the FSM entered the state*/
+    bool entry_recorded; /*Flag to indicate that the entry has been recorded by the transition that fsm_timed_fire() fires*/
+    deadline_t deadline; /*System tick of the first AFTER() transition of the state*/
+    bool has_deadline; /*Flag to indicate that the state has AFTER() transitions*/
+    bool timed_only; /*Flag to indicate that all the transitions of the state are AFTER() transitions: nothing can fire before the deadline*/
+} fsm_timed_t;
+
+/* Function prototypes and explanation -------------------------------------------------*/
+
+/**
+ * @brief Initialize an FSM with timed transitions: the FSM of the library is initialized with the transitions table, all the timeouts are 0 and the FSM enters its first state now.
+ *
+ * @param p_this Pointer to the FSM
+ * @param p_tt Transitions table. Its input functions can be AFTER() of the timeouts of the FSM
+ */
+
+void fsm_timed_init(fsm_timed_t *p_this, fsm_trans_t *p_tt);
+
+/**
+ * @brief Change the transitions table of the FSM, keeping its state and the time at which it entered it.
+ *
+ * @param p_this Pointer to the FSM
+ * @param p_tt Transitions table
+ */
+
+void fsm_timed_set_transitions(fsm_timed_t *p_this, fsm_trans_t *p_tt);
+
+/**
+ * @brief Set the timeout of an index of AFTER(). If the FSM is in a state with a transition AFTER() that index, its deadline is computed again from the time at which it entered the state.
+ *
+ * @param p_this Pointer to the FSM
+ * @param index Index of the timeout, 0 to FSM_TIMED_TIMEOUTS - 1
+ * @param timeout_ms Timeout in ms, up to DEADLINE_MAX_MS
+ */
+
+void fsm_timed_set_timeout(fsm_timed_t *p_this, uint32_t index, uint32_t timeout_ms);
+
+/**
+ * @brief Record the time at which the FSM entered its current state, when it is not the current system tick. It is called from the output function of a transition, once the library has moved to its destination state, e.g. to count the debounce time from the timestamp of the edge that fired the transition.
+ *
+ * @param p_this Pointer to the FSM
+ * @param entered_ms System tick at which the FSM entered the state
+ */
+
+void fsm_timed_enter(fsm_timed_t *p_this, uint32_t entered_ms);
+
+/**
+ * @brief Check if the FSM has been in its current state for the timeout of an index. It is the check of AFTER(), for input functions that combine it with other conditions.
+ *
+ * The FSM enters a state when an AFTER() transition fires, when fsm_timed_fire() fires any transition, or at fsm_timed_enter(). If fsm_fire() fires another transition, the new state is seen, and entered, at the next check of AFTER(); a transition of that kind to the same state does not restart the time, unless its output function calls fsm_timed_enter(). In a combined condition, call it last: it takes the transition as fired when it returns true, and, if the input function is not AFTER(), as a transition to the same state.
+ *
+ * @param p_this Pointer to the FSM
+ * @param index Index of the timeout, 0 to FSM_TIMED_TIMEOUTS - 1
+ * @return true if the timeout has elapsed since the FSM entered its state. The FSM then enters the destination state of the transition that fires
+ * @return false otherwise
+ */
+
+bool fsm_timed_after(fsm_timed_t *p_this, uint32_t index);
+
+/**
+ * @brief Fire the FSM as fsm_fire() does, but without calling the input functions when all the transitions of the state are AFTER() transitions and none is due yet. The state entered by a transition is recorded at the current system tick, unless its output function calls fsm_timed_enter().
+ *
+ * @param p_this Pointer to the FSM
+ * @return int 1 if a transition has fired, 0 otherwise
+ */
+
+int fsm_timed_fire(fsm_timed_t *p_this);
+
+/**
+ * @brief Get the time to the first AFTER() transition of the current state, so that a sleep scheduler can sleep until then if the FSM does not wait for anything else.
+ *
+ * @param p_this Pointer to the FSM
+ * @return uint32_t Time to the deadline in ms, 0 if it has been reached, or FSM_TIMED_NONE if the state has no AFTER() transition
+ */
+
+uint32_t fsm_timed_get_next_ms(fsm_timed_t *p_this);
+
+/**
+ * @brief Get the time until the FSM has been in its current state for the timeout of an index. It is the deadline of an input function that combines fsm_timed_after() with other conditions, which fsm_timed_get_next_ms() does not see.
+ *
+ * @param p_this Pointer to the FSM
+ * @param index Index of the timeout, 0 to FSM_TIMED_TIMEOUTS - 1
+ * @return uint32_t Time to the timeout in ms, 0 if it has elapsed, or FSM_TIMED_NONE if the index is not valid
+ */
+
+uint32_t fsm_timed_get_remaining_ms(fsm_timed_t *p_this, uint32_t index);
+
+/**
+ * @brief Get the time to the first AFTER() transition of several FSMs.
+ *
+ * @param pp_fsms Array of pointers to the FSMs
+ * @param n Number of FSMs
+ * @return uint32_t Time to the first deadline in ms, 0 if one has been reached, or FSM_TIMED_NONE if no FSM is in a state with AFTER() transitions
+ */
+
+uint32_t fsm_timed_get_next_ms_all(fsm_timed_t *const *pp_fsms, uint32_t n);
+
+/**
+ * @brief Input functions of AFTER(): fsm_timed_after() of each index. The input function of an fsm_trans_t receives the fsm_t, which is the first field of the fsm_timed_t.
+ */
+
+bool fsm_timed_after_0(fsm_t *p_fsm);
+bool fsm_timed_after_1(fsm_t *p_fsm);
+bool fsm_timed_after_2(fsm_t *p_fsm);
+bool fsm_timed_after_3(fsm_t *p_fsm);
+
+#endif /* FSM_TIMED_H_ */
@@ -17,10 +17,16 @@
 /* Other includes */
 #include <fsm.h>
 #include "port_usart.h"
+#include "cobs_frame.h"
 
 /* HW dependent includes */
 
 /* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+
+#define USART_TX_QUEUE_LENGTH 4 /*Number of messages that can be pending for transmission*/
+#define USART_FRAME_MAX_PAYLOAD_LENGTH (USART_OUTPUT_BUFFER_LENGTH - COBS_FRAME_CRC_LENGTH - 2) /*Maximum payload of a frame sent with fsm_usart_send_frame(): one COBS code byte and the delimiter are added*/
+
 /* Enums */
 
 enum FSM_USART {
@@ -30,11 +36,41 @@ enum FSM_USART {
 
 /* Typedefs --------------------------------------------------------------------*/
 
+/**
+ * @brief Callback called by the USART FSM once a message has been completely written to the USART.
+ *
+ * @param p_this Pointer to the USART FSM that sent the message
+ * @param p_arg User argument given when the message was queued
+ */
+typedef void (*fsm_usart_tx_cb_t)(fsm_t *p_this, void *p_arg);
+
+typedef struct{
+    const char *p_data; /*Pointer to the payload. It points either to buffer or to a caller-owned buffer*/
+    uint32_t length; /*Length of the payload in bytes*/
+    fsm_usart_tx_cb_t cb; /*Completion callback. NULL if not used*/
+    void *p_arg; /*Argument of the completion callback*/
+    char buffer [USART_OUTPUT_BUFFER_LENGTH]; /*Storage for payloads copied into the queue*/
+} fsm_usart_tx_msg_t;
+
+typedef struct{
+    uint32_t messages_queued; /*Number of messages accepted in the TX queue*/
+    uint32_t messages_sent; /*Number of messages completely sent*/
+    uint32_t messages_dropped; /*Number of messages rejected because the queue was full or they were too long*/
+    uint32_t bytes_copied; /*Total number of payload bytes copied into the TX queue*/
+    uint32_t last_bytes_copied; /*Number of payload bytes copied for the last queued message*/
+    uint8_t depth; /*Current number of messages in the TX queue*/
+    uint8_t max_depth; /*Maximum number of messages that have been in the TX queue at the same time*/
+} fsm_usart_tx_stats_t;
+
 typedef struct{
     fsm_t f; /*USART FSM*/
     bool data_received; /*Flag to indicate that a data has been received*/
     char in_data [USART_INPUT_BUFFER_LENGTH]; /*Input data*/
-    char out_data [USART_OUTPUT_BUFFER_LENGTH]; /*Output data*/
+    uint32_t in_length; /*Length of the input data in bytes*/
+    fsm_usart_tx_msg_t tx_queue [USART_TX_QUEUE_LENGTH]; /*Queue of messages to send*/
+    uint8_t tx_head; /*Index of the message being sent (or the next one to send)*/
+    uint8_t tx_count; /*Number of messages in the TX queue*/
+    fsm_usart_tx_stats_t tx_stats; /*TX queue statistics*/
     uint8_t usart_id; /*USART ID. Must be unique.*/
 } fsm_usart_t;
 
@@ -47,7 +83,7 @@ typedef struct{
  * At start and reset, the in_data array must be empty. An empty array means that there has not been new data.
  *
  * @param usart_id Unique USART identifier number
- * @return fsm_t* A pointer to the USART FSM
+ * @return fsm_t* A pointer to the USART FSM, or NULL if the port refuses the USART (the console, see port_usart_init())
  */
 
 fsm_t *fsm_usart_new(uint32_t usart_id);
@@ -57,9 +93,10 @@ fsm_t *fsm_usart_new(uint32_t usart_id);
  *
  * @param p_this Pointer to an fsm_t struct than contains an fsm_usart_t struct
  * @param usart_id
+ * @return true if the HW has been initialized, false if the port refuses the USART (the console, see port_usart_init())
  */
 
-void fsm_usart_init(fsm_t *p_this, uint32_t usart_id);
+bool fsm_usart_init(fsm_t *p_this, uint32_t usart_id);
 
 /**
  * @brief Checks if data has been received. If so, it returns true and the user can read the data using the function fsm_usart_get_in_data().
@@ -81,13 +118,88 @@ bool fsm_usart_check_data_received(fsm_t *p_this);
 void fsm_usart_get_in_data(fsm_t *p_this, char *p_data);
 
 /**
- * @brief Set the data to send.
+ * @brief Returns the length of the data received by the USART. Binary frames can contain empty chars, so this is the only way to know their length.
+ *
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_usart_t struct
+ * @return uint32_t Length of the received data in bytes. 0 if there is no data.
+ */
+
+uint32_t fsm_usart_get_in_length(fsm_t *p_this);
+
+/**
+ * @brief Select the framing of the received data: text lines terminated by END_CHAR_CONSTANT or COBS-encoded, CRC-checked binary frames. Pending received frames are discarded.
+ *
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_usart_t struct
+ * @param framing USART_FRAMING_TEXT or USART_FRAMING_COBS
+ */
+
+void fsm_usart_set_framing(fsm_t *p_this, uint8_t framing);
+
+/**
+ * @brief Get the number of received frames that have been discarded because they were corrupted, too long or did not fit in the RX ring.
+ *
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_usart_t struct
+ * @return uint32_t Number of discarded frames
+ */
+
+uint32_t fsm_usart_get_rx_frame_errors(fsm_t *p_this);
+
+/**
+ * @brief Queue a message to send. The payload is copied once into a free slot of the TX queue, so the caller can reuse its buffer right after the call.
+ * @note Only the given number of bytes is sent. No terminator or empty character is added or searched for.
+ *
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_usart_t struct
+ * @param p_data Pointer to the payload to send
+ * @param length Length of the payload in bytes (1 to USART_OUTPUT_BUFFER_LENGTH)
+ * @return true if the message has been queued
+ * @return false if the queue is full or the length is not valid
+ */
+
+bool fsm_usart_set_out_data(fsm_t *p_this, const char *p_data, uint32_t length);
+
+/**
+ * @brief Queue a caller-owned message to send without copying it.
+ * @warning The buffer must not be modified until the completion callback is called.
+ *
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_usart_t struct
+ * @param p_data Pointer to the payload to send
+ * @param length Length of the payload in bytes (at least 1)
+ * @param cb Completion callback, called from the FSM once the message has been sent. It can be NULL.
+ * @param p_arg Argument passed to the completion callback
+ * @return true if the message has been queued
+ * @return false if the queue is full or the length is not valid
+ */
+
+bool fsm_usart_set_out_data_ref(fsm_t *p_this, const char *p_data, uint32_t length, fsm_usart_tx_cb_t cb, void *p_arg);
+
+/**
+ * @brief Queue a binary payload to send as a COBS-encoded frame with CRC. The frame is encoded straight into a free slot of the TX queue, so the caller can reuse its buffer right after the call.
+ *
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_usart_t struct
+ * @param p_payload Pointer to the payload to send. It can contain any byte value.
+ * @param length Length of the payload in bytes (1 to USART_FRAME_MAX_PAYLOAD_LENGTH)
+ * @return true if the frame has been queued
+ * @return false if the queue is full or the length is not valid
+ */
+
+bool fsm_usart_send_frame(fsm_t *p_this, const uint8_t *p_payload, uint32_t length);
+
+/**
+ * @brief Get the statistics of the TX queue.
+ *
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_usart_t struct
+ * @param p_stats Pointer to the struct where the statistics will be copied
+ */
+
+void fsm_usart_get_tx_stats(fsm_t *p_this, fsm_usart_tx_stats_t *p_stats);
+
+/**
+ * @brief Reset the statistics of the TX queue. The current depth is kept.
  *
  * @param p_this Pointer to an fsm_t struct than contains an fsm_usart_t struct
- * @param p_data Pointer to an array from where the data will be copied to the out_data array
  */
 
-void fsm_usart_set_out_data(fsm_t *p_this, char *p_data);
+void fsm_usart_reset_tx_stats(fsm_t *p_this);
 
 /**
  * @brief Reset the input data buffer.
@@ -99,7 +211,7 @@ void fsm_usart_reset_input_data(fsm_t *p_this);
 
 /**
  * @brief Checks if the USART FSM is active, or not.
- * @note The USART is active either when it is in the state SEND_DATA or there is data to be read (indicated as true in the field data_received).
+ * @note The USART is active either when it is in the state SEND_DATA, there are messages waiting in the TX queue, there is data to be read (indicated as true in the field data_received) or there are complete frames waiting in the RX ring of the port.
  *
  * @param p_this Pointer to an fsm_t struct than contains an fsm_usart_t struct
  * @return true
@@ -0,0 +1,26 @@
+/**
+ * @file gpio_bsrr.h
+ * @brief Values of the GPIO bit set/reset register (BSRR) to change several pins of a port with a single store.
+ *
+ * A store to BSRR only changes the pins whose bits are set in it, so it cannot undo a change done meanwhile by an ISR on another pin of the same port, unlike a read-modify-write of ODR. The lower half of the word sets pins and the upper half resets them; if a pin is in both halves, it is set.
+ *
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+#ifndef GPIO_BSRR_H_
+#define GPIO_BSRR_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+
+#define GPIO_BSRR_RESET_POS 16 /*Position of the reset half of BSRR*/
+
+#define GPIO_BSRR_WRITE(set, reset) ((uint32_t)(uint16_t)(set) | ((uint32_t)(uint16_t)(reset) << GPIO_BSRR_RESET_POS)) /*BSRR value that sets the pins of the mask set and resets the pins of the mask reset*/
+#define GPIO_BSRR_TOGGLE(odr, pins) GPIO_BSRR_WRITE(~(odr) & (pins), (odr) & (pins)) /*BSRR value that toggles the pins of the mask pins, given the current ODR. odr is evaluated twice: pass a copy of the register, not the register itself*/
+
+#endif /* GPIO_BSRR_H_ */
@@ -0,0 +1,115 @@
+/**
+ * @file latency_probe.h
+ * @brief Header for latency_probe.c file.
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+#ifndef LATENCY_PROBE_H_
+#define LATENCY_PROBE_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Other includes */
+#include "port_system.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+
+/**
+ * @brief Probes: each one measures the time from a button edge to an action caused by it.
+ *
+ * The order of the table is the index of the probe in the command `latency`. tools/latency_cli.py parses this table, so keep one entry per line.
+ */
+#define LATENCY_PROBES(X) \
+    X(LED) /*From the release of the button to the toggle of the LED (do_toggle() of fsm_led.c)*/ \
+    X(BUZZER) /*From the release of the button to the start or stop of the player (fsm_buzzer.c)*/
+
+#define LATENCY_PROBE_BUCKETS 16 /*Buckets of a histogram. Bucket 0 counts the latencies lower than 2^LATENCY_PROBE_MIN_LOG2 us, bucket i the latencies in [2^(i+MIN_LOG2-1), 2^(i+MIN_LOG2)) us and the last one all the greater ones*/
+#define LATENCY_PROBE_MIN_LOG2 3 /*Upper bound (log2) of the first bucket, in us*/
+#define LATENCY_PROBE_WINDOW_MS 1000 /*An action later than this after the edge is not taken as caused by it, and is not recorded*/
+#define LATENCY_PROBE_FRAME_TYPE 'H' /*First byte of the payload of a snapshot (histogram), other than BINLOG_FRAME_TYPE and METRICS_FRAME_TYPE. It is followed by the index of the probe (1 byte), the number of latencies, the minimum and the maximum in us and the buckets (uint32_t, little endian)*/
+
+/* Enums */
+
+#define _LATENCY_PROBE_ENUM(name) LATENCY_PROBE_##name,
+
+enum LATENCY_PROBE {
+    LATENCY_PROBES(_LATENCY_PROBE_ENUM)
+    LATENCY_PROBES_NUMBER
+};
+
+#define LATENCY_PROBE_SNAPSHOT_LENGTH (2 + 4 * (3 + LATENCY_PROBE_BUCKETS)) /*Length of the payload of a snapshot in bytes*/
+
+/**
+ * @brief Instrumentation of the edges and the actions. If USE_LATENCY_PROBE is not defined, they expand to nothing and their arguments are not evaluated.
+ *
+ * The edges and the actions must be reported from the main loop: the timestamp of the edge is the one taken by the EXTI ISR of the button (see button_edges.h).
+ */
+#ifdef USE_LATENCY_PROBE
+#define LATENCY_PROBE_EDGE(millis, cycles) latency_probe_edge((millis), (cycles))
+#define LATENCY_PROBE_ACTION(name) latency_probe_action(LATENCY_PROBE_##name)
+#else
+#define LATENCY_PROBE_EDGE(millis, cycles) ((void)0)
+#define LATENCY_PROBE_ACTION(name) ((void)0)
+#endif
+
+/* Function prototypes and explanation -------------------------------------------------*/
+
+/**
+ * @brief Reset all the probes.
+ */
+
+void latency_probe_init(void);
+
+/**
+ * @brief Arm all the probes with the timestamp of an edge. It is called by LATENCY_PROBE_EDGE().
+ *
+ * @param millis System tick of the edge
+ * @param cycles Cycle counter at the edge
+ */
+
+void latency_probe_edge(uint32_t millis, uint32_t cycles);
+
+/**
+ * @brief Record the latency of an action since the edge that armed the probe, and disarm it. Nothing is recorded if the probe is not armed or the edge is older than LATENCY_PROBE_WINDOW_MS. It is called by LATENCY_PROBE_ACTION().
+ *
+ * @param probe Probe (LATENCY_PROBE_<name>)
+ */
+
+void latency_probe_action(uint32_t probe);
+
+/**
+ * @brief Add a latency to the histogram of a probe.
+ *
+ * @param probe Probe (LATENCY_PROBE_<name>)
+ * @param us Latency in us
+ */
+
+void latency_probe_observe(uint32_t probe, uint32_t us);
+
+/**
+ * @brief Look up a probe by its index or its name (case insensitive).
+ *
+ * @param p_name Pointer to the index or the name (not NUL-terminated)
+ * @param length Length of the index or the name
+ * @return int32_t Probe, or -1 if there is no such probe
+ */
+
+int32_t latency_probe_lookup(const char *p_name, uint32_t length);
+
+/**
+ * @brief Write a snapshot of the histogram of a probe.
+ *
+ * @param probe Probe (LATENCY_PROBE_<name>)
+ * @param p_out Pointer to the buffer where the payload is written
+ * @param size Size of the buffer in bytes
+ * @return uint32_t Length of the payload (LATENCY_PROBE_SNAPSHOT_LENGTH), or 0 if the probe does not exist or the buffer is too small
+ */
+
+uint32_t latency_probe_snapshot(uint32_t probe, uint8_t *p_out, uint32_t size);
+
+#endif /* LATENCY_PROBE_H_ */
@@ -0,0 +1,126 @@
+/**
+ * @file led_pattern.h
+ * @brief Header for led_pattern.c file.
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+#ifndef LED_PATTERN_H_
+#define LED_PATTERN_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+
+#define LED_PATTERN_DUTY_MAX 1000 /*Duty cycle of a fully lit LED. Duty cycles are in per mille, which is also the resolution of the PWM*/
+#define LED_PATTERN_PWM_HZ 1000 /*Frequency of the PWM of the LED, high enough not to flicker*/
+#define LED_PATTERN_MAX_STEP_MS 256 /*Maximum duration of a step: one step lasts a whole number of PWM periods, counted by the 8-bit repetition counter of the timer*/
+#define LED_PATTERN_HEARTBEAT_MIN_LENGTH 16 /*Minimum length of a heartbeat table, to fit both beats*/
+#define LED_PATTERN_CSV_HEADER "t_ms,duty\n" /*First line of a CSV rendering*/
+
+/* Typedefs --------------------------------------------------------------------*/
+
+/**
+ * @brief Pattern of the LED: a table of duty cycles played at a fixed step. On the STM32F4 the table is copied to the compare register of the PWM timer by DMA at each step, so it must stay in memory while the pattern runs. The entries of a looping pattern can be changed in place: the new values are played at their next step.
+ */
+typedef struct {
+    const uint16_t *p_duty; /*Duty cycle of each step, from 0 to LED_PATTERN_DUTY_MAX*/
+    uint32_t length; /*Number of steps*/
+    uint32_t step_ms; /*Duration of each step in ms, from 1 to LED_PATTERN_MAX_STEP_MS*/
+    bool loop; /*true to play the table forever; false to play it once and keep the duty cycle of the last step*/
+} led_pattern_t;
+
+/* Function prototypes and explanation -------------------------------------------------*/
+
+/**
+ * @brief Duty cycle that gives a perceived brightness, with a gamma of 2 (the eye is more sensitive to changes at low brightness).
+ *
+ * @param brightness Perceived brightness, from 0 to LED_PATTERN_DUTY_MAX (greater values are saturated)
+ * @return uint16_t Duty cycle
+ */
+
+uint16_t led_pattern_gamma(uint32_t brightness);
+
+/**
+ * @brief Fill a table with one breath: the brightness rises linearly from off to full at the middle of the table and falls back.
+ *
+ * @param p_duty Table to fill
+ * @param length Length of the table, at least 2
+ * @return uint32_t Steps filled: length, or 0 if the table is too short
+ */
+
+uint32_t led_pattern_breathe(uint16_t *p_duty, uint32_t length);
+
+/**
+ * @brief Fill a table with one heartbeat: a strong beat, a weaker one and a rest until the end of the table.
+ *
+ * @param p_duty Table to fill
+ * @param length Length of the table, at least LED_PATTERN_HEARTBEAT_MIN_LENGTH
+ * @return uint32_t Steps filled: length, or 0 if the table is too short
+ */
+
+uint32_t led_pattern_heartbeat(uint16_t *p_duty, uint32_t length);
+
+/**
+ * @brief Fill a table with n blinks at full brightness. The table ends with the LED off.
+ *
+ * @param p_duty Table to fill
+ * @param length Length of the table
+ * @param n Number of blinks
+ * @param on_steps Steps that the LED is on in each blink
+ * @param off_steps Steps that the LED is off after each blink
+ * @return uint32_t Steps filled: n * (on_steps + off_steps), or 0 if they do not fit in the table
+ */
+
+uint32_t led_pattern_blinks(uint16_t *p_duty, uint32_t length, uint32_t n, uint32_t on_steps, uint32_t off_steps);
+
+/**
+ * @brief Fill a table with a constant brightness proportional to a level, as a VU meter. To follow the level, loop a table of one step and call this function again on it at each new level: it costs a single store.
+ *
+ * @param p_duty Table to fill
+ * @param length Length of the table
+ * @param level Level to show (greater values than level_max are saturated)
+ * @param level_max Level shown at full brightness. It must not be 0
+ * @return uint32_t Steps filled: length
+ */
+
+uint32_t led_pattern_level(uint16_t *p_duty, uint32_t length, uint32_t level, uint32_t level_max);
+
+/**
+ * @brief Check that a pattern can be played: it has a table of at least one step and its step is in range.
+ *
+ * @param p_pattern Pattern to check
+ * @return true if the pattern can be played
+ * @return false otherwise
+ */
+
+bool led_pattern_is_valid(const led_pattern_t *p_pattern);
+
+/**
+ * @brief Duty cycle of the LED at a time from the start of a pattern, as the timer plays it.
+ *
+ * @param p_pattern Pattern
+ * @param t_ms Time since the start of the pattern in ms
+ * @return uint16_t Duty cycle
+ */
+
+uint16_t led_pattern_sample(const led_pattern_t *p_pattern, uint32_t t_ms);
+
+/**
+ * @brief Render a pattern to a CSV of duty cycle versus time: a header LED_PATTERN_CSV_HEADER and a line "t_ms,duty" for each sample. It can be plotted or compared on the host.
+ *
+ * @param p_pattern Pattern to render
+ * @param duration_ms Time rendered in ms
+ * @param resolution_ms Time between two samples in ms. It must not be 0
+ * @param p_buf Buffer for the CSV, ended by a null character
+ * @param size Size of the buffer
+ * @return uint32_t Length of the CSV, or 0 if it does not fit in the buffer
+ */
+
+uint32_t led_pattern_render_csv(const led_pattern_t *p_pattern, uint32_t duration_ms, uint32_t resolution_ms, char *p_buf, uint32_t size);
+
+#endif /* LED_PATTERN_H_ */
@@ -0,0 +1,161 @@
+/**
+ * @file metrics.h
+ * @brief Header for metrics.c file.
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+#ifndef METRICS_H_
+#define METRICS_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Other includes */
+#include <fsm.h>
+#include "port_system.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+
+/**
+ * @brief Counters of the registry. They only grow (and wrap around at 2^32): the host computes rates from the deltas of two snapshots.
+ *
+ * The order of the tables is the order of the values in a snapshot. tools/metrics_cli.py parses these tables, so keep one entry per line.
+ */
+#define METRICS_COUNTERS(X) \
+    X(FSM_FIRES) /*Calls to fsm_fire() done with METRICS_FSM_FIRE(), or to the fire function of METRICS_FSM_FIRE_WITH()*/ \
+    X(TRANSITIONS_BUTTON) /*State changes of the button FSM*/ \
+    X(TRANSITIONS_USART) /*State changes of the USART FSM*/ \
+    X(TRANSITIONS_BUZZER) /*State changes of the buzzer FSM*/ \
+    X(TRANSITIONS_COMMAND) /*State changes of the command interpreter FSM*/ \
+    X(USART_RX_BYTES) /*Bytes received by all the USARTs. Updated from all their ISRs with METRICS_INC_SHARED()*/ \
+    X(USART_TX_BYTES) /*Bytes of the messages sent by the USART FSMs*/ \
+    X(USART_RX_ERRORS) /*Frames discarded because they were corrupted, too long or the RX ring was full. Updated from all the USART ISRs with METRICS_INC_SHARED()*/ \
+    X(USART_OVERRUNS) /*Bytes lost because the RX register was not read in time (ORE flag). Updated from all the USART ISRs with METRICS_INC_SHARED()*/ \
+    X(NOTES_PLAYED) /*Notes started by the buzzer FSM*/ \
+    X(BUTTON_PRESSES) /*Presses detected by the button FSM*/
+
+/**
+ * @brief Gauges of the registry: values that go up and down.
+ */
+#define METRICS_GAUGES(X) \
+    X(IDLE_PERMILLE) /*Time spent in METRICS_SLEEP() since the previous snapshot, in per mille*/
+
+/**
+ * @brief Histograms of the registry, with METRICS_HISTOGRAM_BUCKETS power-of-two buckets.
+ */
+#define METRICS_HISTOGRAMS(X) \
+    X(BUTTON_PRESS_MS) /*Duration of the button presses in ms*/
+
+#define METRICS_HISTOGRAM_BUCKETS 8 /*Buckets of a histogram. Bucket 0 counts the values lower than 2^METRICS_HISTOGRAM_MIN_LOG2, bucket i the values in [2^(i+MIN_LOG2-1), 2^(i+MIN_LOG2)) and the last one all the greater values*/
+#define METRICS_HISTOGRAM_MIN_LOG2 4 /*Upper bound (log2) of the first bucket of the histograms*/
+#define METRICS_FRAME_TYPE 'M' /*First byte of the payload of a snapshot. It is followed by the system time in ms and the counters, gauges and histogram buckets (uint32_t, little endian)*/
+
+/* Enums */
+
+#define _METRICS_ENUM(name) METRIC_##name,
+
+enum METRICS_COUNTER {
+    METRICS_COUNTERS(_METRICS_ENUM)
+    METRICS_COUNTERS_NUMBER
+};
+
+enum METRICS_GAUGE {
+    METRICS_GAUGES(_METRICS_ENUM)
+    METRICS_GAUGES_NUMBER
+};
+
+enum METRICS_HISTOGRAM {
+    METRICS_HISTOGRAMS(_METRICS_ENUM)
+    METRICS_HISTOGRAMS_NUMBER
+};
+
+#define METRICS_SNAPSHOT_LENGTH (1 + 4 * (1 + METRICS_COUNTERS_NUMBER + METRICS_GAUGES_NUMBER + METRICS_HISTOGRAMS_NUMBER * METRICS_HISTOGRAM_BUCKETS)) /*Length of the payload of a snapshot in bytes*/
+
+/**
+ * @brief Update the registry. If USE_METRICS is not defined, they expand to nothing (or to the bare calls of fsm_fire(), the fire function and port_system_sleep()) and their arguments are not evaluated.
+ *
+ * A metric updated with METRICS_INC() or METRICS_ADD() must be updated from a single context (the main loop or one ISR), since the updates are not atomic. A counter updated from several contexts (e.g., the ISRs of all the USARTs, or their I/O thread on the native platform) must use METRICS_INC_SHARED(), an atomic read-modify-write (LDREX/STREX on the target).
+ */
+#ifdef USE_METRICS
+#define METRICS_INC(name) (metrics_counters[METRIC_##name]++)
+#define METRICS_ADD(name, n) (metrics_counters[METRIC_##name] += (uint32_t)(n))
+#define METRICS_INC_SHARED(name) ((void)__atomic_fetch_add(&metrics_counters[METRIC_##name], 1u, __ATOMIC_RELAXED))
+#define METRICS_SET(name, value) (metrics_gauges[METRIC_##name] = (uint32_t)(value))
+#define METRICS_OBSERVE(name, value) metrics_observe(METRIC_##name, (uint32_t)(value))
+#define METRICS_FSM_FIRE(p_fsm, name) metrics_fsm_fire((p_fsm), METRIC_TRANSITIONS_##name)
+#define METRICS_FSM_FIRE_WITH(p_fsm, name, fire) metrics_fsm_fire_with((p_fsm), (fire), METRIC_TRANSITIONS_##name)
+#define METRICS_SLEEP() metrics_sleep()
+#else
+#define METRICS_INC(name) ((void)0)
+#define METRICS_ADD(name, n) ((void)0)
+#define METRICS_INC_SHARED(name) ((void)0)
+#define METRICS_SET(name, value) ((void)0)
+#define METRICS_OBSERVE(name, value) ((void)0)
+#define METRICS_FSM_FIRE(p_fsm, name) fsm_fire(p_fsm)
+#define METRICS_FSM_FIRE_WITH(p_fsm, name, fire) (fire)(p_fsm)
+#define METRICS_SLEEP() port_system_sleep()
+#endif
+
+/* Global variables ------------------------------------------------------------*/
+#ifdef USE_METRICS
+extern volatile uint32_t metrics_counters[METRICS_COUNTERS_NUMBER]; /*Values of the counters*/
+extern volatile uint32_t metrics_gauges[METRICS_GAUGES_NUMBER]; /*Values of the gauges*/
+#endif
+
+/* Function prototypes and explanation -------------------------------------------------*/
+
+/**
+ * @brief Reset all the metrics.
+ */
+
+void metrics_init(void);
+
+/**
+ * @brief Add a value to a histogram. It is called by METRICS_OBSERVE().
+ *
+ * @param histogram Histogram (METRIC_<name>)
+ * @param value Value to add
+ */
+
+void metrics_observe(uint32_t histogram, uint32_t value);
+
+/**
+ * @brief Fire an FSM and count the call and the state change, if any. It is called by METRICS_FSM_FIRE().
+ *
+ * @param p_fsm Pointer to the FSM
+ * @param transitions Counter of the state changes of the FSM (METRIC_TRANSITIONS_<name>)
+ */
+
+void metrics_fsm_fire(fsm_t *p_fsm, uint32_t transitions);
+
+/**
+ * @brief Fire an FSM with its own fire function and count the call and the state change, if any. It is called by METRICS_FSM_FIRE_WITH(), for the FSMs with timed transitions (e.g., fsm_button_fire()).
+ *
+ * @param p_fsm Pointer to the FSM
+ * @param fire Function that fires the FSM
+ * @param transitions Counter of the state changes of the FSM (METRIC_TRANSITIONS_<name>)
+ */
+
+void metrics_fsm_fire_with(fsm_t *p_fsm, int (*fire)(fsm_t *), uint32_t transitions);
+
+/**
+ * @brief Sleep with port_system_sleep() and add the time slept to the idle time. It is called by METRICS_SLEEP().
+ */
+
+void metrics_sleep(void);
+
+/**
+ * @brief Write a snapshot of all the metrics. The gauge IDLE_PERMILLE is updated first with the idle time since the previous snapshot.
+ *
+ * @param p_out Pointer to the buffer where the payload is written
+ * @param size Size of the buffer in bytes
+ * @return uint32_t Length of the payload (METRICS_SNAPSHOT_LENGTH), or 0 if USE_METRICS is not defined or the buffer is too small
+ */
+
+uint32_t metrics_snapshot(uint8_t *p_out, uint32_t size);
+
+#endif /* METRICS_H_ */
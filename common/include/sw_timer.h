@@ -0,0 +1,126 @@
+/**
+ * @file sw_timer.h
+ * @brief Header for sw_timer.c file.
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+#ifndef SW_TIMER_H_
+#define SW_TIMER_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Other includes */
+#include "deadline.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+
+#define SW_TIMER_SLOT_BITS 5 /*Bits of the system tick that select the slot of a level of the wheel*/
+#define SW_TIMER_SLOTS (1U << SW_TIMER_SLOT_BITS) /*Slots of each level of the wheel: one bit of the occupancy bitmap of the level each*/
+#define SW_TIMER_LEVELS 6 /*Levels of the wheel. Level l holds the timers that expire in [32^l, 32^(l+1)) ms*/
+#define SW_TIMER_MAX_MS ((1U << (SW_TIMER_SLOT_BITS * SW_TIMER_LEVELS)) - 1) /*Longest timeout or period (about 12.4 days)*/
+#define SW_TIMER_NONE UINT32_MAX /*Returned by sw_timer_get_next_ms() when no timer is running*/
+
+/* Typedefs --------------------------------------------------------------------*/
+
+typedef void (*sw_timer_cb_t)(void *p_arg); /*Function called when a timer expires, from sw_timer_process()*/
+
+typedef struct sw_timer_t {
+    struct sw_timer_t *p_next; /*Next timer of the same slot*/
+    struct sw_timer_t *p_prev; /*Previous timer of the same slot, so a timer is unlinked in O(1)*/
+    deadline_t expiry; /*System tick at which the timer expires*/
+    uint32_t period_ms; /*Period of a periodic timer, 0 for a one-shot timer*/
+    sw_timer_cb_t cb; /*Function called when the timer expires*/
+    void *p_arg; /*Argument of the callback*/
+    uint16_t slot; /*1 + index of the slot of the wheel (level * SW_TIMER_SLOTS + slot) where the timer is linked, or 0 if it is stopped, so a timer initialized to zero is stopped*/
+} sw_timer_t;
+
+/* Function prototypes and explanation -------------------------------------------------*/
+
+/**
+ * @brief Initialize the timer service: the wheel starts empty at the current system tick. The timers that were running are forgotten, so set them up again.
+ */
+
+void sw_timer_init(void);
+
+/**
+ * @brief Set up a timer, stopped, with the function to call when it expires.
+ *
+ * @param p_timer Pointer to the timer. It must live as long as it runs: the wheel links it, it does not copy it
+ * @param cb Function called when the timer expires
+ * @param p_arg Argument of the callback
+ */
+
+void sw_timer_setup(sw_timer_t *p_timer, sw_timer_cb_t cb, void *p_arg);
+
+/**
+ * @brief Start a timer, or restart it if it is running. It is O(1): the timer is linked to the slot of the wheel of its expiry. The wake-up timer of the port is reprogrammed only if the timer expires before the nearest event of the wheel.
+ *
+ * @param p_timer Pointer to the timer, set up with sw_timer_setup()
+ * @param timeout_ms Time from now to the expiry, up to SW_TIMER_MAX_MS. A timeout of 0 expires at the next millisecond
+ * @param period_ms Period with which the timer starts again after each expiry, up to SW_TIMER_MAX_MS, or 0 for a one-shot timer
+ * @return true if the timer has been started
+ * @return false if the timeout or the period is too long
+ */
+
+bool sw_timer_start(sw_timer_t *p_timer, uint32_t timeout_ms, uint32_t period_ms);
+
+/**
+ * @brief Stop a timer. It is O(1): the timer is unlinked from its slot. Nothing happens if it is not running.
+ *
+ * The wake-up timer of the port is not reprogrammed: if the timer was the nearest event, the core wakes up once for nothing.
+ *
+ * @param p_timer Pointer to the timer
+ */
+
+void sw_timer_stop(sw_timer_t *p_timer);
+
+/**
+ * @brief Check if a timer is running.
+ *
+ * @param p_timer Pointer to the timer
+ * @return true if it is running
+ * @return false if it is stopped or has expired (one-shot)
+ */
+
+bool sw_timer_is_running(const sw_timer_t *p_timer);
+
+/**
+ * @brief Move the wheel up to the current system tick and call the callbacks of the timers that have expired, in order of expiry. Then the wake-up timer of the port is programmed for the next event of the wheel.
+ *
+ * It is called from the main loop, not from an ISR: the callbacks run in its context, so they can start or stop timers and fire FSMs. The cost does not depend on the time elapsed since the last call nor on the number of timers running, only on the timers that expire or move to a lower level of the wheel.
+ *
+ * @return uint32_t Number of timers that have expired
+ */
+
+uint32_t sw_timer_process(void);
+
+/**
+ * @brief Get the time to the next event of the wheel: the expiry of a timer, or the tick at which the timers of a slot of an upper level move to a lower level. The core can sleep until then.
+ *
+ * @return uint32_t Time to the next event in ms, 0 if sw_timer_process() must be called now, or SW_TIMER_NONE if no timer is running
+ */
+
+uint32_t sw_timer_get_next_ms(void);
+
+/**
+ * @brief Get the number of times the wake-up timer of the port has been programmed since sw_timer_init().
+ *
+ * @return uint32_t Number of times
+ */
+
+uint32_t sw_timer_get_hw_updates(void);
+
+/**
+ * @brief Callback that raises a flag, to wake up an FSM: pass a pointer to a `volatile bool` as the argument of the timer and check it, and clear it, in a check function of the FSM.
+ *
+ * @param p_arg Pointer to the flag (volatile bool)
+ */
+
+void sw_timer_set_flag(void *p_arg);
+
+#endif /* SW_TIMER_H_ */
@@ -0,0 +1,67 @@
+/**
+ * @file usart_brr.h
+ * @brief Header for usart_brr.c file.
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+#ifndef USART_BRR_H_
+#define USART_BRR_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+
+#define USART_BRR_MAX_ERROR_PPM 20000 /*Maximum baud rate error accepted (2 %)*/
+#define USART_BRR_SNAP_TOLERANCE_PPM 50000 /*Maximum distance (5 %) from a standard baud rate to snap a measured baud rate to it*/
+
+/* Typedefs --------------------------------------------------------------------*/
+
+typedef struct {
+    uint16_t brr; /*Value to write in the USART_BRR register*/
+    bool over8; /*true if oversampling by 8 (CR1 OVER8) must be selected, false for oversampling by 16*/
+    uint32_t actual_baudrate; /*Baud rate really achieved with this configuration*/
+    int32_t error_ppm; /*Relative error of the achieved baud rate, in parts per million*/
+} usart_brr_t;
+
+/* Function prototypes and explanation -------------------------------------------------*/
+
+/**
+ * @brief Compute the BRR register value (mantissa and fraction) and the oversampling mode for a given baud rate.
+ *
+ * The divider is rounded to the nearest value. Oversampling by 16 is preferred because it is more tolerant to clock deviations. Oversampling by 8 is only selected when the baud rate is too high for oversampling by 16 (clock lower than 16 times the baud rate).
+ *
+ * @param pclk_hz Frequency of the peripheral clock of the USART in Hz
+ * @param baudrate Requested baud rate in bits per second
+ * @param p_brr Pointer to the struct where the configuration is returned
+ * @return true if the baud rate can be achieved with an error lower than USART_BRR_MAX_ERROR_PPM
+ * @return false otherwise. In this case p_brr is still filled in if the divider fits in the register.
+ */
+
+bool usart_brr_compute(uint32_t pclk_hz, uint32_t baudrate, usart_brr_t *p_brr);
+
+/**
+ * @brief Compute the baud rate from the duration of a known number of bits measured on the RX line.
+ *
+ * @param clk_hz Frequency of the counter used for the measurement in Hz
+ * @param cycles Number of counter cycles measured
+ * @param bits Number of bit times contained in the measurement
+ * @return uint32_t Measured baud rate, or 0 if the measurement is not valid
+ */
+
+uint32_t usart_brr_baudrate_from_cycles(uint32_t clk_hz, uint32_t cycles, uint32_t bits);
+
+/**
+ * @brief Snap a measured baud rate to the closest standard baud rate.
+ *
+ * @param baudrate Measured baud rate
+ * @return uint32_t Closest standard baud rate if it is within USART_BRR_SNAP_TOLERANCE_PPM, the measured baud rate otherwise
+ */
+
+uint32_t usart_brr_snap_standard(uint32_t baudrate);
+
+#endif /* USART_BRR_H_ */
@@ -0,0 +1,58 @@
+/**
+ * @file usart_isr.h
+ * @brief Header for usart_isr.c file.
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+#ifndef USART_ISR_H_
+#define USART_ISR_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+
+#define USART_ISR_ORE (1u << 3) /*Overrun error flag of SR*/
+#define USART_ISR_RXNE (1u << 5) /*RX data register not empty: flag of SR and its interrupt enable (RXNEIE) of CR1*/
+#define USART_ISR_TC (1u << 6) /*Transmission complete: flag of SR and its interrupt enable (TCIE) of CR1*/
+#define USART_ISR_TXE (1u << 7) /*TX data register empty: flag of SR and its interrupt enable (TXEIE) of CR1*/
+
+/* Function prototypes and explanation -------------------------------------------------*/
+
+/**
+ * @brief Route the interrupts of a USART peripheral to a USART ID.
+ *
+ * @param p_table Dispatch table, with one entry per peripheral. A zeroed table routes no peripheral
+ * @param periph Index of the peripheral in the table
+ * @param usart_id USART ID that uses the peripheral
+ */
+
+void usart_isr_route(uint8_t *p_table, uint32_t periph, uint32_t usart_id);
+
+/**
+ * @brief Get the USART ID the interrupts of a USART peripheral are routed to.
+ *
+ * @param p_table Dispatch table
+ * @param periph Index of the peripheral in the table
+ * @param p_usart_id Pointer where the USART ID is returned
+ * @return true if the peripheral is routed
+ * @return false if no USART uses the peripheral: its interrupt must be ignored
+ */
+
+bool usart_isr_lookup(const uint8_t *p_table, uint32_t periph, uint32_t *p_usart_id);
+
+/**
+ * @brief Get the events a USART interrupt has to serve, from its status (SR) and control (CR1) registers.
+ *
+ * @param sr Value of SR
+ * @param cr1 Value of CR1
+ * @return uint32_t Mask of USART_ISR_RXNE, USART_ISR_TXE and USART_ISR_TC for the flags that are set and enabled, plus USART_ISR_ORE if a byte has been lost before the one to receive
+ */
+
+uint32_t usart_isr_events(uint32_t sr, uint32_t cr1);
+
+#endif /* USART_ISR_H_ */
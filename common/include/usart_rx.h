@@ -0,0 +1,123 @@
+/**
+ * @file usart_rx.h
+ * @brief Header for usart_rx.c file.
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+#ifndef USART_RX_H_
+#define USART_RX_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Other includes */
+#include "cobs_frame.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+
+#define USART_INPUT_BUFFER_LENGTH 64 /*USART input message length. Longer frames are discarded (text frames keep one byte for the empty char)*/
+#define USART_RX_RING_LENGTH 128 /*Size of the RX ring where the received frames are stored. It must be a power of two*/
+#define EMPTY_BUFFER_CONSTANT 0x0 /*Empty char constant*/
+#define END_CHAR_CONSTANT 0xA /*End char constant*/
+#define USART_RX_RTS_HIGH_WATER (USART_RX_RING_LENGTH - 16) /*Bytes in use of the RX ring above which the sender is asked to pause (RTS deasserted). The rest of the ring absorbs the bytes already in flight*/
+#define USART_RX_RTS_LOW_WATER (USART_RX_RING_LENGTH / 2) /*Bytes in use of the RX ring below which the sender is allowed to resume (RTS asserted)*/
+#define USART_FRAMING_TEXT 0 /*Frames are terminated by END_CHAR_CONSTANT*/
+#define USART_FRAMING_COBS 1 /*Frames are COBS-encoded, CRC-checked and delimited by COBS_FRAME_DELIMITER (see cobs_frame.h)*/
+#define USART_ADDRESS_MARK 0x100 /*9th bit of the words that carry a node address on a multi-drop (RS-485) bus*/
+#define USART_ADDRESS_MASK 0xF /*Bits of the address compared by the receiver of the USART (ADD[3:0]), so a bus has up to 16 addresses*/
+
+/* Typedefs --------------------------------------------------------------------*/
+
+typedef struct {
+    uint8_t ring[USART_RX_RING_LENGTH]; /*Received frames. Each frame is stored as one length byte followed by its payload*/
+    volatile uint32_t read; /*Free-running index of the next frame to read. Only written by the consumer*/
+    volatile uint32_t commit; /*Free-running index where the frame being received starts. Only written by the producer (ISR)*/
+    uint32_t frame_len; /*Number of bytes of the frame being received already stored after its length byte*/
+    uint32_t max_len; /*Maximum number of bytes that can be stored for one frame*/
+    bool discard; /*Flag to indicate that the frame being received is discarded (text framing)*/
+    uint8_t framing; /*USART_FRAMING_TEXT or USART_FRAMING_COBS*/
+    cobs_decoder_t decoder; /*Incremental decoder of the COBS framing*/
+    uint32_t frames; /*Number of frames received*/
+    uint32_t frame_errors; /*Number of frames discarded because they were corrupted, too long or the ring was full*/
+} usart_rx_t;
+
+/* Function prototypes and explanation -------------------------------------------------*/
+
+/**
+ * @brief Select the framing of an RX ring and flush it. The statistics are kept.
+ *
+ * @warning The producer must not push bytes while this function runs (e.g., disable the RX interrupt).
+ *
+ * @param p_rx Pointer to the RX ring
+ * @param framing USART_FRAMING_TEXT or USART_FRAMING_COBS
+ */
+
+void usart_rx_set_framing(usart_rx_t *p_rx, uint8_t framing);
+
+/**
+ * @brief Push a byte received from the link. The frame being received is written straight into the ring (decoded on the fly in COBS framing). It is committed when its terminator arrives, or rolled back if it is corrupted or it does not fit.
+ *
+ * This function runs in constant time. It is called by the producer only (the RX ISR of the port).
+ *
+ * @param p_rx Pointer to the RX ring
+ * @param byte Byte received
+ */
+
+void usart_rx_push(usart_rx_t *p_rx, uint8_t byte);
+
+/**
+ * @brief Check if there is, at least, one complete frame in the ring.
+ *
+ * @param p_rx Pointer to the RX ring
+ * @return true
+ * @return false
+ */
+
+bool usart_rx_available(const usart_rx_t *p_rx);
+
+/**
+ * @brief Get the number of bytes of the ring in use: the complete frames, with their length bytes, and the frame being received. It is used to drive the RTS line (see USART_RX_RTS_HIGH_WATER).
+ *
+ * @param p_rx Pointer to the RX ring
+ * @return uint32_t Number of bytes in use
+ */
+
+uint32_t usart_rx_get_used(const usart_rx_t *p_rx);
+
+/**
+ * @brief Model of the mute mode of the USART receiver with wakeup by address mark (WAKE = 1): decide if a 9-bit word received from a multi-drop bus reaches the RX ring.
+ *
+ * A word with USART_ADDRESS_MARK set mutes the receiver unless it carries its own address, in which case it wakes up. The data words are received only while it is awake. The address word itself is never data. On the target this is done by the hardware: this function is used where there is none (native platform, bus simulations).
+ *
+ * @param p_muted Pointer to the mute flag of the receiver (RWU). It is updated by the address words
+ * @param address Address of the receiver
+ * @param word Word received, with USART_ADDRESS_MARK set if it is an address
+ * @return true if the word is data for this receiver
+ * @return false if it is discarded
+ */
+
+bool usart_rx_wakeup(bool *p_muted, uint8_t address, uint16_t word);
+
+/**
+ * @brief Copy the oldest complete frame and release it from the ring. It is called by the consumer only.
+ *
+ * @param p_rx Pointer to the RX ring
+ * @param p_buffer Pointer to the buffer where the frame is copied. It must be USART_INPUT_BUFFER_LENGTH bytes long.
+ * @return uint32_t Length of the frame in bytes. 0 if there was no frame.
+ */
+
+uint32_t usart_rx_pop(usart_rx_t *p_rx, char *p_buffer);
+
+/**
+ * @brief Discard all the complete frames of the ring. It is called by the consumer only.
+ *
+ * @param p_rx Pointer to the RX ring
+ */
+
+void usart_rx_flush(usart_rx_t *p_rx);
+
+#endif /* USART_RX_H_ */
@@ -0,0 +1,223 @@
+/**
+ * @file binlog.c
+ * @brief Deferred binary logging: the log call sites store only the ID of their format string and their raw arguments in a ring of words, and the text is rebuilt on the host.
+ *
+ * The format strings are placed in the section binlog_fmt, so the ID of a format string is its offset in that section: it is known at link time and the host tool reads the strings from the ELF (tools/binlog_decode.py). A record is one word with the ID and the number of arguments, one word with the timestamp and one word per argument. Any context can write records (the interrupts are disabled while a record is appended) and only the main loop reads them.
+ *
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <stddef.h>
+
+/* Other libraries */
+#include "binlog.h"
+#include "fsm_usart.h"
+#include "port_system.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define BINLOG_RING_MASK (BINLOG_RING_WORDS - 1) /*Mask to wrap the free-running indexes*/
+#define BINLOG_ID_MASK ((1UL << BINLOG_ID_BITS) - 1) /*Mask of the format ID in the first word of a record*/
+
+/* Global variables ------------------------------------------------------------*/
+extern const char __start_binlog_fmt[] __attribute__((weak)); /*Start of the section binlog_fmt, defined by the linker if there is any BINLOG() call site*/
+
+/**
+ * @brief Ring of records. The indexes are free-running: head is written by the producers with the interrupts disabled and tail only by the consumer.
+ */
+static struct {
+    uint32_t ring[BINLOG_RING_WORDS]; /*Records*/
+    volatile uint32_t head; /*Index where the next record is appended*/
+    volatile uint32_t tail; /*Index of the oldest record*/
+    volatile uint32_t dropped; /*Records dropped because the ring was full*/
+    uint32_t dropped_reported; /*Records dropped already reported with a BINLOG_ID_DROPPED record*/
+} binlog;
+
+/* Private functions */
+
+/**
+ * @brief Write a word in little endian, whatever the endianness of the platform.
+ *
+ * @param p_out Pointer to the 4 bytes to write
+ * @param word Word to write
+ */
+
+static void _put_word(uint8_t *p_out, uint32_t word)
+{
+    p_out[0] = (uint8_t)word;
+    p_out[1] = (uint8_t)(word >> 8);
+    p_out[2] = (uint8_t)(word >> 16);
+    p_out[3] = (uint8_t)(word >> 24);
+}
+
+/**
+ * @brief Copy the oldest records into the payload of a binary frame without releasing them.
+ *
+ * @param p_out Pointer to the buffer where the payload is written
+ * @param size Size of the buffer in bytes
+ * @param p_tail Pointer where the index of the first record not copied is returned
+ * @param p_dropped Pointer where the number of dropped records reported in the payload is returned
+ * @return uint32_t Length of the payload in bytes, or 0 if there were no records or they do not fit
+ */
+
+static uint32_t _copy(uint8_t *p_out, uint32_t size, uint32_t *p_tail, uint32_t *p_dropped)
+{
+    uint32_t head = binlog.head;
+    uint32_t tail = binlog.tail;
+    uint32_t dropped = binlog.dropped;
+    uint32_t length = BINLOG_FRAME_HEADER_LENGTH;
+    uint32_t cycles_per_us = port_system_get_cycles_per_us();
+    if (size < BINLOG_FRAME_HEADER_LENGTH + 4 * (BINLOG_HEADER_WORDS + 1))
+    {
+        return 0;
+    }
+    p_out[0] = BINLOG_FRAME_TYPE;
+    p_out[1] = (uint8_t)cycles_per_us;
+    p_out[2] = (uint8_t)(cycles_per_us >> 8);
+
+    if (dropped != binlog.dropped_reported)
+    {
+        _put_word(&p_out[length], BINLOG_ID_DROPPED | (1UL << BINLOG_ID_BITS));
+        _put_word(&p_out[length + 4], port_system_get_cycles());
+        _put_word(&p_out[length + 8], dropped - binlog.dropped_reported);
+        length += 4 * (BINLOG_HEADER_WORDS + 1);
+    }
+    while (tail != head)
+    {
+        uint32_t words = BINLOG_HEADER_WORDS + (binlog.ring[tail & BINLOG_RING_MASK] >> BINLOG_ID_BITS);
+        if (length + 4 * words > size)
+        {
+            break;
+        }
+        for (uint32_t i = 0; i < words; i++)
+        {
+            _put_word(&p_out[length], binlog.ring[(tail + i) & BINLOG_RING_MASK]);
+            length += 4;
+        }
+        tail += words;
+    }
+    *p_tail = tail;
+    *p_dropped = dropped;
+    return (length > BINLOG_FRAME_HEADER_LENGTH) ? length : 0;
+}
+
+/* Public functions */
+
+/**
+ * @brief Discard all the records and reset the count of dropped records.
+ */
+
+void binlog_init(void)
+{
+    uint32_t state = port_system_irq_save();
+    binlog.head = 0;
+    binlog.tail = 0;
+    binlog.dropped = 0;
+    binlog.dropped_reported = 0;
+    port_system_irq_restore(state);
+}
+
+/**
+ * @brief Append a record to the ring. It is called by BINLOG(). If the ring is full the record is dropped and counted.
+ *
+ * This function runs in constant time with the interrupts disabled, so it can be called from any context.
+ *
+ * @param p_fmt Pointer to the format string. It must be placed in the section binlog_fmt.
+ * @param nargs Number of arguments (0 to BINLOG_MAX_ARGS)
+ * @param p_args Pointer to the arguments
+ */
+
+void binlog_write(const char *p_fmt, uint32_t nargs, const uint32_t *p_args)
+{
+    uint32_t id = (uint32_t)(p_fmt - __start_binlog_fmt) & BINLOG_ID_MASK;
+    uint32_t timestamp = port_system_get_cycles();
+    uint32_t state = port_system_irq_save();
+    uint32_t head = binlog.head;
+    if (BINLOG_RING_WORDS - (head - binlog.tail) < BINLOG_HEADER_WORDS + nargs)
+    {
+        binlog.dropped++;
+        port_system_irq_restore(state);
+        return;
+    }
+    binlog.ring[head & BINLOG_RING_MASK] = id | (nargs << BINLOG_ID_BITS);
+    binlog.ring[(head + 1) & BINLOG_RING_MASK] = timestamp;
+    for (uint32_t i = 0; i < nargs; i++)
+    {
+        binlog.ring[(head + BINLOG_HEADER_WORDS + i) & BINLOG_RING_MASK] = p_args[i];
+    }
+    binlog.head = head + BINLOG_HEADER_WORDS + nargs;
+    port_system_irq_restore(state);
+}
+
+/**
+ * @brief Get the format string of an ID, to decode the records on the MCU itself (e.g., in tests).
+ *
+ * @param id Format ID of a record
+ * @return const char* Pointer to the format string, or NULL if the ID is BINLOG_ID_DROPPED
+ */
+
+const char *binlog_get_format(uint32_t id)
+{
+    if ((id == BINLOG_ID_DROPPED) || (__start_binlog_fmt == NULL))
+    {
+        return NULL;
+    }
+    return &__start_binlog_fmt[id];
+}
+
+/**
+ * @brief Move the oldest records into the payload of a binary frame. Only whole records are moved. If records were dropped since the last call, a BINLOG_ID_DROPPED record is added first.
+ *
+ * @param p_out Pointer to the buffer where the payload is written
+ * @param size Size of the buffer in bytes
+ * @return uint32_t Length of the payload in bytes, or 0 if there were no records or they do not fit
+ */
+
+uint32_t binlog_read(uint8_t *p_out, uint32_t size)
+{
+    uint32_t tail;
+    uint32_t dropped;
+    uint32_t length = _copy(p_out, size, &tail, &dropped);
+    if (length > 0)
+    {
+        binlog.tail = tail;
+        binlog.dropped_reported = dropped;
+    }
+    return length;
+}
+
+/**
+ * @brief Send the oldest records as a binary frame of a USART FSM (see fsm_usart_send_frame()). The records are released only if the frame has been queued.
+ *
+ * @param p_usart Pointer to the USART FSM. Its peer must decode the frames with tools/binlog_decode.py.
+ * @return true if a frame has been queued
+ * @return false if there were no records or the TX queue is full
+ */
+
+bool binlog_drain(fsm_t *p_usart)
+{
+    uint8_t payload[USART_FRAME_MAX_PAYLOAD_LENGTH];
+    uint32_t tail;
+    uint32_t dropped;
+    uint32_t length = _copy(payload, sizeof(payload), &tail, &dropped);
+    if ((length == 0) || !fsm_usart_send_frame(p_usart, payload, length))
+    {
+        return false;
+    }
+    binlog.tail = tail;
+    binlog.dropped_reported = dropped;
+    return true;
+}
+
+/**
+ * @brief Get the number of records dropped because the ring was full since binlog_init().
+ *
+ * @return uint32_t Number of records dropped
+ */
+
+uint32_t binlog_get_dropped(void)
+{
+    return binlog.dropped;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file button_edges.c
+ * @brief Queue of timestamped button edges shared by all the button ports.
+ *
+ * The queue is single-producer (the EXTI or timer ISR, or the thread that plays the button on the native platform) and single-consumer (the button FSM). Each index is written by one side only, and the edge is stored before the head is published with release ordering, so no lock is needed.
+ *
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Other libraries */
+#include "button_edges.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define BUTTON_EDGES_MASK (BUTTON_EDGES_LENGTH - 1) /*Mask to wrap the free-running indexes*/
+
+/* Public functions */
+
+/**
+ * @brief Queue an edge of a button with its timestamps. If the queue is full, the edge is dropped and counted.
+ *
+ * It is lock-free and it is called by the producer only (the EXTI or timer ISR of the port).
+ *
+ * @param p_edges Pointer to the queue
+ * @param pressed Level of the button after the edge
+ * @param millis System tick when the edge happened
+ * @param cycles Cycle counter when the edge happened
+ * @return true if the edge has been queued
+ * @return false if it has been dropped
+ */
+
+bool button_edges_push(button_edges_t *p_edges, bool pressed, uint32_t millis, uint32_t cycles)
+{
+    uint32_t head = p_edges->head;
+    if (head - __atomic_load_n(&p_edges->tail, __ATOMIC_ACQUIRE) >= BUTTON_EDGES_LENGTH)
+    {
+        p_edges->dropped++;
+        return false;
+    }
+    button_edge_t *p_edge = &p_edges->ring[head & BUTTON_EDGES_MASK];
+    p_edge->millis = millis;
+    p_edge->cycles = cycles;
+    p_edge->pressed = pressed;
+    __atomic_store_n(&p_edges->head, head + 1, __ATOMIC_RELEASE); // Publish the edge once it has been written
+    return true;
+}
+
+/**
+ * @brief Take the oldest edge of the queue. It is called by the consumer only.
+ *
+ * @param p_edges Pointer to the queue
+ * @param p_edge Pointer where the edge is copied
+ * @return true if there was an edge
+ * @return false if the queue was empty
+ */
+
+bool button_edges_pop(button_edges_t *p_edges, button_edge_t *p_edge)
+{
+    uint32_t tail = p_edges->tail;
+    if (tail == __atomic_load_n(&p_edges->head, __ATOMIC_ACQUIRE))
+    {
+        return false;
+    }
+    *p_edge = p_edges->ring[tail & BUTTON_EDGES_MASK];
+    __atomic_store_n(&p_edges->tail, tail + 1, __ATOMIC_RELEASE); // Release the slot once it has been copied
+    return true;
+}
+
+/**
+ * @brief Discard all the queued edges. It is called by the consumer only.
+ *
+ * @param p_edges Pointer to the queue
+ */
+
+void button_edges_flush(button_edges_t *p_edges)
+{
+    __atomic_store_n(&p_edges->tail, __atomic_load_n(&p_edges->head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+}
@@ -0,0 +1,62 @@
+/**
+ * @file button_scan.c
+ * @brief Bit-sliced debouncer for the buttons that are sampled periodically instead of interrupting on each edge.
+ *
+ * Mechanical switches may bounce dozens of times per edge. Debouncing them from the EXTI interrupts costs one interrupt per bounce, while sampling them at a fixed rate costs the same whatever they do. The debouncer keeps one vertical counter per line, so a single call updates 32 lines.
+ *
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Other libraries */
+#include "button_scan.h"
+
+/* Public functions */
+
+/**
+ * @brief Debounce up to 32 lines at once with a vertical counter.
+ *
+ * Each line has a 2-bit counter stored across cnt0 and cnt1, so all the lines are updated with a handful of bitwise operations whatever their number. The counter of a line counts the consecutive samples that differ from its debounced state and is reset by any sample that agrees with it. A line changes its state on the BUTTON_SCAN_SAMPLES-th sample in a row, so the bounces never reach the state.
+ *
+ * @param p_scan Pointer to the debouncer
+ * @param sample Current level of the lines: bit n is set if line n is active
+ * @return uint32_t Lines whose debounced state has just changed
+ */
+
+uint32_t button_scan_update(button_scan_t *p_scan, uint32_t sample)
+{
+    uint32_t delta = sample ^ p_scan->state; // Lines that differ from their debounced state
+    uint32_t toggle = delta & p_scan->cnt0 & p_scan->cnt1; // Counter at 3: this is the 4th sample in a row
+    p_scan->cnt1 = (p_scan->cnt1 ^ p_scan->cnt0) & delta; // Count up the lines that differ, reset the rest
+    p_scan->cnt0 = ~p_scan->cnt0 & delta;
+    p_scan->state ^= toggle;
+    return toggle;
+}
+
+/**
+ * @brief Get the lines that are being debounced: their last sample differs from their debounced state.
+ *
+ * @param p_scan Pointer to the debouncer
+ * @return uint32_t Lines with a counter running
+ */
+
+uint32_t button_scan_busy(const button_scan_t *p_scan)
+{
+    return p_scan->cnt0 | p_scan->cnt1;
+}
+
+/**
+ * @brief Set the debounced state of some lines and stop their counters. The rest of the lines are not modified.
+ *
+ * @param p_scan Pointer to the debouncer
+ * @param lines Lines to set
+ * @param state Debounced state: bit n is set if line n is active
+ */
+
+void button_scan_set(button_scan_t *p_scan, uint32_t lines, uint32_t state)
+{
+    p_scan->state = (p_scan->state & ~lines) | (state & lines);
+    p_scan->cnt0 &= ~lines;
+    p_scan->cnt1 &= ~lines;
+}
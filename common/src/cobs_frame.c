@@ -0,0 +1,221 @@
+/**
+ * @file cobs_frame.c
+ * @brief COBS-encoded, CRC-checked frames for binary payloads.
+ *
+ * A frame is the payload followed by its CRC-16/CCITT-FALSE (big endian), encoded with Consistent Overhead Byte Stuffing (COBS) so that it does not contain any 0x00 byte, and terminated by a 0x00 delimiter.
+ * The overhead is 2 bytes of CRC, 1 byte of delimiter and 1 code byte every 254 bytes.
+ *
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Other libraries */
+#include "cobs_frame.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define COBS_MAX_CODE 0xFF /*Code of a group of 254 data bytes not followed by a zero*/
+
+/* Global variables */
+
+/**
+ * @brief CRC-16/CCITT-FALSE table indexed by nibble. It trades some speed for only 32 bytes of flash.
+ */
+static const uint16_t crc16_nibble_table[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF};
+
+/* Private functions */
+
+/**
+ * @brief Update a CRC-16/CCITT-FALSE with one byte.
+ *
+ * @param crc Current value of the CRC
+ * @param byte Byte to add
+ * @return uint16_t Updated CRC
+ */
+
+static uint16_t _crc16_update(uint16_t crc, uint8_t byte)
+{
+    crc = (uint16_t)((crc << 4) ^ crc16_nibble_table[((crc >> 12) ^ (byte >> 4)) & 0x0F]);
+    crc = (uint16_t)((crc << 4) ^ crc16_nibble_table[((crc >> 12) ^ (byte & 0x0F)) & 0x0F]);
+    return crc;
+}
+
+/**
+ * @brief Reset the decoder to wait for the first code byte of a new frame.
+ *
+ * @param p_dec Pointer to the decoder
+ */
+
+static void _decoder_reset(cobs_decoder_t *p_dec)
+{
+    p_dec->length = 0;
+    p_dec->crc = COBS_FRAME_CRC_INIT;
+    p_dec->code = 0;
+    p_dec->remaining = 0;
+    p_dec->error = false;
+}
+
+/* Public functions */
+
+/**
+ * @brief Update a CRC-16/CCITT-FALSE (polynomial 0x1021, no reflection, no final XOR) with a block of data.
+ *
+ * @param p_data Pointer to the data
+ * @param length Length of the data in bytes
+ * @param crc Current value of the CRC. Use COBS_FRAME_CRC_INIT for the first block.
+ * @return uint16_t Updated CRC
+ */
+
+uint16_t cobs_frame_crc16(const uint8_t *p_data, uint32_t length, uint16_t crc)
+{
+    for (uint32_t i = 0; i < length; i++)
+    {
+        crc = _crc16_update(crc, p_data[i]);
+    }
+    return crc;
+}
+
+/**
+ * @brief Build a frame: append the CRC to the payload, COBS-encode both and add the delimiter.
+ *
+ * @param p_payload Pointer to the payload. It can contain any byte value.
+ * @param length Length of the payload in bytes
+ * @param p_out Pointer to the buffer where the frame is written
+ * @param out_size Size of the output buffer. It must be at least COBS_FRAME_MAX_ENCODED_LENGTH(length).
+ * @return uint32_t Length of the frame, delimiter included, or 0 if the output buffer is too small
+ */
+
+uint32_t cobs_frame_encode(const uint8_t *p_payload, uint32_t length, uint8_t *p_out, uint32_t out_size)
+{
+    if (COBS_FRAME_MAX_ENCODED_LENGTH(length) > out_size)
+    {
+        return 0;
+    }
+    uint16_t crc = cobs_frame_crc16(p_payload, length, COBS_FRAME_CRC_INIT);
+    uint8_t crc_bytes[COBS_FRAME_CRC_LENGTH] = {(uint8_t)(crc >> 8), (uint8_t)(crc & 0xFF)};
+    uint32_t code_idx = 0;
+    uint32_t out_idx = 1;
+    uint8_t code = 1;
+
+    for (uint32_t i = 0; i < length + COBS_FRAME_CRC_LENGTH; i++)
+    {
+        uint8_t byte = (i < length) ? p_payload[i] : crc_bytes[i - length];
+        if (byte == 0)
+        {
+            p_out[code_idx] = code;
+            code_idx = out_idx++;
+            code = 1;
+        }
+        else
+        {
+            p_out[out_idx++] = byte;
+            code++;
+            if (code == COBS_MAX_CODE)
+            {
+                p_out[code_idx] = code;
+                code_idx = out_idx++;
+                code = 1;
+            }
+        }
+    }
+    p_out[code_idx] = code;
+    p_out[out_idx++] = COBS_FRAME_DELIMITER;
+    return out_idx;
+}
+
+/**
+ * @brief Initialize an incremental frame decoder.
+ *
+ * @param p_dec Pointer to the decoder
+ * @param max_length Maximum length of a decoded frame, CRC included
+ */
+
+void cobs_decoder_init(cobs_decoder_t *p_dec, uint32_t max_length)
+{
+    p_dec->max_length = max_length;
+    _decoder_reset(p_dec);
+}
+
+/**
+ * @brief Feed one byte received from the link to the decoder.
+ *
+ * Each byte produces at most one decoded byte, that the caller must store right after the previous one (e.g., directly in its RX ring). The last COBS_FRAME_CRC_LENGTH decoded bytes of a frame are its CRC.
+ * This function runs in constant time and it does not access any buffer, so it can be called from an ISR.
+ *
+ * @param p_dec Pointer to the decoder
+ * @param byte Byte received from the link
+ * @param p_out Pointer where the decoded byte is returned
+ * @param p_out_valid Pointer to a flag that is set to true if a decoded byte has been returned
+ * @return cobs_frame_status_t COBS_FRAME_OK or COBS_FRAME_ERROR when the delimiter closes a frame, COBS_FRAME_NONE otherwise
+ */
+
+cobs_frame_status_t cobs_decoder_push(cobs_decoder_t *p_dec, uint8_t byte, uint8_t *p_out, bool *p_out_valid)
+{
+    *p_out_valid = false;
+    if (byte == COBS_FRAME_DELIMITER)
+    {
+        cobs_frame_status_t status;
+        if ((p_dec->code == 0) && !p_dec->error)
+        {
+            status = COBS_FRAME_NONE; /* Empty frame: consecutive delimiters are used to resynchronize */
+        }
+        else if (!p_dec->error && (p_dec->remaining == 0) && (p_dec->length >= COBS_FRAME_CRC_LENGTH) && (p_dec->crc == 0))
+        {
+            status = COBS_FRAME_OK;
+        }
+        else
+        {
+            status = COBS_FRAME_ERROR;
+        }
+        _decoder_reset(p_dec);
+        return status;
+    }
+    if (p_dec->error)
+    {
+        return COBS_FRAME_NONE;
+    }
+
+    if (p_dec->remaining == 0)
+    {
+        /* Code byte: the previous group, if any, ends with an implicit zero unless it was a full group */
+        if ((p_dec->code != 0) && (p_dec->code != COBS_MAX_CODE))
+        {
+            *p_out = 0;
+            *p_out_valid = true;
+        }
+        p_dec->code = byte;
+        p_dec->remaining = byte - 1;
+    }
+    else
+    {
+        *p_out = byte;
+        *p_out_valid = true;
+        p_dec->remaining--;
+    }
+
+    if (*p_out_valid)
+    {
+        if (p_dec->length >= p_dec->max_length)
+        {
+            *p_out_valid = false;
+            p_dec->error = true;
+            return COBS_FRAME_NONE;
+        }
+        p_dec->length++;
+        p_dec->crc = _crc16_update(p_dec->crc, *p_out);
+    }
+    return COBS_FRAME_NONE;
+}
+
+/**
+ * @brief Discard the frame being decoded, e.g., because the caller has no room to store it. The decoder resynchronizes at the next delimiter.
+ *
+ * @param p_dec Pointer to the decoder
+ */
+
+void cobs_decoder_abort(cobs_decoder_t *p_dec)
+{
+    p_dec->error = true;
+}
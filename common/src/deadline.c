@@ -0,0 +1,84 @@
+/**
+ * @file deadline.c
+ * @brief Deadlines on the 32-bit system tick that are compared correctly across its wrap (about 49.7 days after the start of the system, or after any port_system_set_millis()).
+ *
+ * A comparison such as `now > next_timeout` fails across the wrap: a deadline set just before it wraps to a small value and expires at once, and a deadline just before the wrap is never reached by a tick that has wrapped. The functions of this module compare the signed difference of the ticks instead, which is right while the deadline is less than DEADLINE_MAX_MS away. Use port_system_get_millis64() for times that must not wrap at all, such as the uptime. The same functions compare deadlines on the microsecond count of port_system_get_micros(), for note timing or profiling, up to DEADLINE_MAX_US.
+ *
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Other libraries */
+#include "deadline.h"
+
+/* Public functions */
+
+/**
+ * @brief Deadline some time after a system tick.
+ *
+ * @param start_ms System tick to count from
+ * @param timeout_ms Time to the deadline, up to DEADLINE_MAX_MS
+ * @return deadline_t Deadline
+ */
+
+deadline_t deadline_after(uint32_t start_ms, uint32_t timeout_ms)
+{
+    return start_ms + timeout_ms;
+}
+
+/**
+ * @brief Check if a deadline has been reached (now >= deadline), also across the wrap of the system tick.
+ *
+ * @param deadline Deadline
+ * @param now_ms Current system tick
+ * @return true if the deadline has been reached
+ * @return false otherwise
+ */
+
+bool deadline_reached(deadline_t deadline, uint32_t now_ms)
+{
+    return (int32_t)(now_ms - deadline) >= 0;
+}
+
+/**
+ * @brief Check if a deadline has passed (now > deadline), also across the wrap of the system tick.
+ *
+ * @param deadline Deadline
+ * @param now_ms Current system tick
+ * @return true if the deadline has passed
+ * @return false otherwise
+ */
+
+bool deadline_passed(deadline_t deadline, uint32_t now_ms)
+{
+    return (int32_t)(now_ms - deadline) > 0;
+}
+
+/**
+ * @brief Time left to a deadline.
+ *
+ * @param deadline Deadline
+ * @param now_ms Current system tick
+ * @return uint32_t Time left in ms, 0 if the deadline has been reached
+ */
+
+uint32_t deadline_remaining(deadline_t deadline, uint32_t now_ms)
+{
+    return deadline_reached(deadline, now_ms) ? 0 : deadline - now_ms;
+}
+
+/**
+ * @brief Check if some time has elapsed since a system tick (now - start >= interval). The unsigned difference is right across the wrap of the system tick.
+ *
+ * @param start_ms System tick to count from
+ * @param interval_ms Time to check
+ * @param now_ms Current system tick
+ * @return true if the time has elapsed
+ * @return false otherwise
+ */
+
+bool deadline_elapsed(uint32_t start_ms, uint32_t interval_ms, uint32_t now_ms)
+{
+    return now_ms - start_ms >= interval_ms;
+}
@@ -24,14 +24,40 @@
  * > **TO-DO alumnos:**
  * >
  * > ✅ 1. Cast the generic FSM pointer to blink FSM pointer \n
- * > ✅ 2. Check if current system time is greater than or equal to the FSM's last time + half of its period
+ * > ✅ 2. Check if the FSM has been in its state for half of its period (with fsm_timed_after(), which also works across the wrap of the system tick), only if the hardware does not blink the LED
  *
  * @return true if the LED must toggle, false otherwise
  */
 static bool check_timeout(fsm_t *p_fsm)
 {
     fsm_blink_t * p_blink = ( fsm_blink_t *) p_fsm ;
-    return port_system_get_millis () >= p_blink -> last_time + p_blink -> period_ms / 2;
+    return !p_blink->hw_blink && fsm_timed_after(&p_blink->timed, FSM_BLINK_TIMEOUT_HALF_PERIOD); // Last, since a true check restarts the time in the state
+}
+
+/**
+ * @brief Checks if the period has been changed.
+ *
+ * @param p_fsm pointer to the blink FSM.
+ *
+ * @return true if a new period must be applied, false otherwise
+ */
+static bool check_new_period(fsm_t *p_fsm)
+{
+    fsm_blink_t *p_blink = (fsm_blink_t *)p_fsm;
+    return p_blink->new_period;
+}
+
+/**
+ * @brief Checks if the pattern has been changed.
+ *
+ * @param p_fsm pointer to the blink FSM.
+ *
+ * @return true if a new pattern must be applied, false otherwise
+ */
+static bool check_new_pattern(fsm_t *p_fsm)
+{
+    fsm_blink_t *p_blink = (fsm_blink_t *)p_fsm;
+    return p_blink->new_pattern;
 }
 
 /* State machine output or action functions */
@@ -43,19 +69,59 @@ static bool check_timeout(fsm_t *p_fsm)
  * > **TO-DO alumnos:**
  * >
  * > ✅ 1. Cast the generic FSM pointer to blink FSM pointer \n
- * > ✅ 2. Update FSM's last time to current system time \n
- * > ✅ 3. Toggle the LED using the right system function.
+ * > ✅ 2. Toggle the LED using the right system function (the time in the state is restarted by check_timeout()).
  *
  */
 static void do_toggle(fsm_t *p_fsm)
 {
-    fsm_blink_t * p_blink = ( fsm_blink_t *) p_fsm ;
-    p_blink -> last_time = port_system_get_millis () ;
     port_led_toggle () ;
 
 }
 
 
+/**
+ * @brief Applies a new period: the hardware blink is restarted with it, or the backend falls back to software if the hardware cannot blink at that period.
+ *
+ * @param p_fsm pointer to the blink FSM.
+ */
+static void do_set_period(fsm_t *p_fsm)
+{
+    fsm_blink_t *p_blink = (fsm_blink_t *)p_fsm;
+    p_blink->new_period = false;
+    if (p_blink->p_pattern != NULL)
+    {
+        return; // Applied when the pattern stops
+    }
+    bool hw_blink = port_led_blink_start(p_blink->period_ms);
+    if (p_blink->hw_blink && !hw_blink)
+    {
+        port_led_blink_stop();
+    }
+    p_blink->hw_blink = hw_blink;
+    fsm_timed_set_timeout(&p_blink->timed, FSM_BLINK_TIMEOUT_HALF_PERIOD, p_blink->period_ms / 2);
+    fsm_timed_enter(&p_blink->timed, port_system_get_millis()); // The software blink starts over with the new period
+}
+
+/**
+ * @brief Applies a new pattern: the hardware plays it, or the blink is restarted if the hardware cannot play it or there is no pattern.
+ *
+ * @param p_fsm pointer to the blink FSM.
+ */
+static void do_set_pattern(fsm_t *p_fsm)
+{
+    fsm_blink_t *p_blink = (fsm_blink_t *)p_fsm;
+    p_blink->new_pattern = false;
+    if ((p_blink->p_pattern != NULL) && port_led_pattern_start(p_blink->p_pattern))
+    {
+        p_blink->hw_blink = true;
+        return;
+    }
+    port_led_pattern_stop();
+    p_blink->p_pattern = NULL;
+    p_blink->hw_blink = false;
+    do_set_period(p_fsm);
+}
+
 /**
  * @brief Blink FSM transition table
  *
@@ -66,6 +132,8 @@ static void do_toggle(fsm_t *p_fsm)
  *
  */
 static fsm_trans_t fsm_blink_tt[] = {
+    {IDLE , check_new_pattern , IDLE , do_set_pattern },
+    {IDLE , check_new_period , IDLE , do_set_period },
     {IDLE , check_timeout , IDLE , do_toggle },
     { -1 , NULL , -1, NULL } ,
 };
@@ -83,10 +151,52 @@ fsm_t *fsm_blink_new(uint32_t period_ms)
 void fsm_blink_init(fsm_t *p_fsm, uint32_t period_ms)
 {
     fsm_blink_t *p_blink = (fsm_blink_t *)p_fsm;
-    fsm_init(&p_blink->fsm, fsm_blink_tt); // inicializo la FSM interna
-    p_blink -> last_time = port_system_get_millis () ;
+    fsm_timed_init(&p_blink->timed, fsm_blink_tt); // inicializo la FSM interna
+    fsm_timed_set_timeout(&p_blink->timed, FSM_BLINK_TIMEOUT_HALF_PERIOD, period_ms / 2);
     p_blink -> period_ms = period_ms ;
+    p_blink -> new_period = false;
+    p_blink -> p_pattern = NULL;
+    p_blink -> new_pattern = false;
     port_led_gpio_setup () ; // configuro el pin GPIO del LED
-    
-    
+    p_blink -> hw_blink = port_led_blink_start(period_ms); // el hardware hace parpadear el LED si puede
+}
+
+void fsm_blink_set_period(fsm_t *p_fsm, uint32_t period_ms)
+{
+    fsm_blink_t *p_blink = (fsm_blink_t *)p_fsm;
+    p_blink->period_ms = period_ms;
+    p_blink->new_period = true;
+}
+
+void fsm_blink_set_pattern(fsm_t *p_fsm, const led_pattern_t *p_pattern)
+{
+    fsm_blink_t *p_blink = (fsm_blink_t *)p_fsm;
+    p_blink->p_pattern = p_pattern;
+    p_blink->new_pattern = true;
+}
+
+bool fsm_blink_check_activity(fsm_t *p_fsm)
+{
+    fsm_blink_t *p_blink = (fsm_blink_t *)p_fsm;
+    return !p_blink->hw_blink || p_blink->new_period || p_blink->new_pattern;
+}
+
+int fsm_blink_fire(fsm_t *p_fsm)
+{
+    fsm_blink_t *p_blink = (fsm_blink_t *)p_fsm;
+    return fsm_timed_fire(&p_blink->timed);
+}
+
+uint32_t fsm_blink_get_next_ms(fsm_t *p_fsm)
+{
+    fsm_blink_t *p_blink = (fsm_blink_t *)p_fsm;
+    if (p_blink->new_period || p_blink->new_pattern)
+    {
+        return 0;
+    }
+    if (p_blink->hw_blink)
+    {
+        return FSM_TIMED_NONE;
+    }
+    return fsm_timed_get_remaining_ms(&p_blink->timed, FSM_BLINK_TIMEOUT_HALF_PERIOD); // check_timeout() combines AFTER() with hw_blink, so the state has no deadline of its own
 }
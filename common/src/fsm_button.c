@@ -10,6 +10,186 @@
 #include <stdlib.h>
 #include "fsm_button.h"
 #include "port_button.h"
+#include "metrics.h"
+#include "latency_probe.h"
+
+/* Private functions */
+/**
+ * @brief Take the edge of the button that the FSM has just seen from the edge queue of the port.
+ *
+ * In timer and scan debounce modes, it is the edge that _check_edge() has found. Otherwise, the edges of the other level and the bounces (edges closer than the debounce time to the last edge taken) are discarded. If only bounces are found (a press shorter than the debounce time), the last one of the right level is taken. If there is no edge in the queue (e.g., it overflowed or the port does not timestamp the edges), the current time is used.
+ *
+ * @param p_button Pointer to the button FSM.
+ * @param pressed Level of the edge: true for the press, false for the release.
+ * @param p_edge Pointer where the edge is copied.
+ */
+
+static void _take_edge(fsm_button_t *p_button, bool pressed, button_edge_t *p_edge)
+{
+    if (p_button->next_edge_queued) // Debounced by the port: the edge that fired the transition
+    {
+        *p_edge = p_button->next_edge;
+        p_button->next_edge_queued = false;
+        p_button->last_edge = *p_edge;
+        return;
+    }
+    bool found = false;
+    button_edge_t edge;
+    while (port_button_get_edge(p_button->button_id, &edge))
+    {
+        if (edge.pressed != pressed)
+        {
+            continue;
+        }
+        *p_edge = edge;
+        found = true;
+        if (deadline_elapsed(p_button->last_edge.millis, p_button->debounce_time, edge.millis))
+        {
+            break;
+        }
+    }
+    if (!found)
+    {
+        p_edge->millis = port_button_get_tick();
+        p_edge->cycles = port_system_get_cycles();
+        p_edge->pressed = pressed;
+    }
+    p_button->last_edge = *p_edge;
+}
+
+/**
+ * @brief Get the oldest edge debounced by the port that the FSM has not taken yet, without taking it.
+ *
+ * @param p_button Pointer to the button FSM.
+ *
+ * @return true if there is an edge in next_edge
+ * @return false if the edge queue of the port is empty
+ */
+
+static bool _peek_edge(fsm_button_t *p_button)
+{
+    if (!p_button->next_edge_queued)
+    {
+        p_button->next_edge_queued = port_button_get_edge(p_button->button_id, &p_button->next_edge);
+    }
+    return p_button->next_edge_queued;
+}
+
+/**
+ * @brief Check if the next edge debounced by the port has the given level. Every debounced edge is queued with its level, so a press and a release debounced between two fires are both seen, in order. The edges of the level the FSM is already in (e.g., lost with the queue full) are discarded.
+ *
+ * @param p_button Pointer to the button FSM.
+ * @param pressed Level of the edge: true for the press, false for the release.
+ *
+ * @return true if the next edge has that level. It is left in next_edge for _take_edge()
+ * @return false otherwise
+ */
+
+static bool _check_edge(fsm_button_t *p_button, bool pressed)
+{
+    port_button_get_event(p_button->button_id); // Clear the event. On the native platform, it also runs the model of the timer or the scan
+    while (_peek_edge(p_button))
+    {
+        if (p_button->next_edge.pressed == pressed)
+        {
+            return true;
+        }
+        p_button->next_edge_queued = false;
+    }
+    return false;
+}
+
+/**
+ * @brief Time between two edges in microseconds.
+ *
+ * It is computed from the cycle counter while it cannot have wrapped around, and from the system tick (millisecond resolution) otherwise.
+ *
+ * @param p_from Pointer to the first edge.
+ * @param p_to Pointer to the last edge.
+ *
+ * @return uint32_t Time between the edges in us.
+ */
+
+static uint32_t _edge_delta_us(const button_edge_t *p_from, const button_edge_t *p_to)
+{
+    uint32_t cycles_per_us = port_system_get_cycles_per_us();
+    uint32_t millis = p_to->millis - p_from->millis;
+    if (millis + 1 >= UINT32_MAX / cycles_per_us / 1000)
+    {
+        return millis * 1000; // The cycle counter may have wrapped around
+    }
+    return (p_to->cycles - p_from->cycles) / cycles_per_us;
+}
+
+/**
+ * @brief Notify an event to the subscribers interested in it.
+ *
+ * @param p_button Pointer to the button FSM.
+ * @param event Event: one of FSM_BUTTON_EVENTS.
+ */
+
+static void _emit(fsm_button_t *p_button, uint32_t event)
+{
+    for (uint32_t i = 0; i < p_button->subscribers_number; i++)
+    {
+        fsm_button_subscriber_t *p_sub = &p_button->subscribers[i];
+        if (p_sub->events & event)
+        {
+            p_sub->cb((fsm_t *)p_button, event, p_sub->p_arg);
+        }
+    }
+}
+
+/**
+ * @brief Update the gestures on a press. A pending click becomes the first half of a double click if the press is within the double click time (measured between the edges, so a stalled loop does not matter), or it is emitted.
+ *
+ * @param p_button Pointer to the button FSM.
+ */
+
+static void _gesture_press(fsm_button_t *p_button)
+{
+    if (p_button->click_pending)
+    {
+        p_button->click_pending = false;
+        if (!deadline_elapsed(p_button->tick_released, p_button->double_click_ms, p_button->tick_pressed))
+        {
+            p_button->second_press = true;
+        }
+        else
+        {
+            _emit(p_button, BUTTON_EVENT_CLICK);
+        }
+    }
+    p_button->long_sent = false;
+}
+
+/**
+ * @brief Update the gestures on a release: a short press is a double click, a click or a click pending for the double click time. A long press has already been emitted.
+ *
+ * @param p_button Pointer to the button FSM.
+ */
+
+static void _gesture_release(fsm_button_t *p_button)
+{
+    bool second_press = p_button->second_press;
+    p_button->second_press = false;
+    if (p_button->long_sent)
+    {
+        return;
+    }
+    if (second_press)
+    {
+        _emit(p_button, BUTTON_EVENT_DOUBLE_CLICK);
+    }
+    else if (p_button->double_click_ms == 0)
+    {
+        _emit(p_button, BUTTON_EVENT_CLICK);
+    }
+    else
+    {
+        p_button->click_pending = true;
+    }
+}
 
 /* State machine input or transition functions */
 /**
@@ -44,24 +224,84 @@ static bool check_button_released(fsm_t *p_this)
 }
 
 /**
- * @brief Checks if the debounce time has passed.
+ * @brief Checks if the timer or scan debounce has queued a press edge.
+ *
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_button_t.
+ *
+ * @return true
+ * @return false
+ */
+
+static bool check_event_pressed(fsm_t *p_this)
+{
+    fsm_button_t *p_button = (fsm_button_t *)p_this;
+    return _check_edge(p_button, true);
+}
+
+/**
+ * @brief Checks if the timer or scan debounce has queued a release edge.
+ *
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_button_t.
+ *
+ * @return true
+ * @return false
+ */
+
+static bool check_event_released(fsm_t *p_this)
+{
+    fsm_button_t *p_button = (fsm_button_t *)p_this;
+    return _check_edge(p_button, false);
+}
+
+/**
+ * @brief Checks if the button has been held for the long press time.
+ *
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_button_t.
+ *
+ * @return true
+ * @return false
+ */
+
+static bool check_long_press(fsm_t *p_this)
+{
+    fsm_button_t *p_button = (fsm_button_t *)p_this;
+    return (p_button->long_press_ms > 0) && !p_button->long_sent && deadline_elapsed(p_button->tick_pressed, p_button->long_press_ms, port_button_get_tick());
+}
+
+/**
+ * @brief Checks if an auto-repeat is due while the button is held after a long press.
  *
  * @param p_this Pointer to an fsm_t struct than contains an fsm_button_t.
  *
- * @return true if the current system time is greater than the last debounce timeout.
+ * @return true
+ * @return false
  */
 
-static bool check_timeout(fsm_t *p_this)
+static bool check_repeat(fsm_t *p_this)
 {
     fsm_button_t *p_button = (fsm_button_t *)p_this;
-    uint32_t now = port_button_get_tick();
-    return now > p_button->next_timeout;
+    return p_button->long_sent && (p_button->repeat_ms > 0) && deadline_reached(p_button->next_repeat, port_button_get_tick());
+}
+
+/**
+ * @brief Checks if the double click time has passed since the release of a pending click.
+ *
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_button_t.
+ *
+ * @return true
+ * @return false
+ */
+
+static bool check_click_timeout(fsm_t *p_this)
+{
+    fsm_button_t *p_button = (fsm_button_t *)p_this;
+    return p_button->click_pending && deadline_elapsed(p_button->tick_released, p_button->double_click_ms, port_button_get_tick());
 }
 
 /* State machine output or action functions */
 
 /**
- * @brief Store the system tick when the button was pressed.
+ * @brief Store the system tick when the button was pressed, taken from the edge queue of the port.
  *
  * @param p_this pointer to an fsm_t struct than contains an fsm_button_t.
  */
@@ -69,14 +309,20 @@ static bool check_timeout(fsm_t *p_this)
 static void do_store_tick_pressed(fsm_t *p_this)
 {
     fsm_button_t *p_button = (fsm_button_t *)p_this;
-    uint32_t now = port_button_get_tick();
+    button_edge_t edge;
+    _take_edge(p_button, true, &edge);
 
-    p_button->tick_pressed = now;
-    p_button->next_timeout = now + p_button->debounce_time;
+    p_button->tick_pressed = edge.millis;
+    fsm_timed_enter(&p_button->timed, edge.millis); // The debounce time counts from the edge, not from the fire
+    METRICS_INC(BUTTON_PRESSES);
+    if (p_button->subscribers_number > 0)
+    {
+        _gesture_press(p_button);
+    }
 }
 
 /**
- * @brief Store the duration of the button press.
+ * @brief Store the duration of the button press, from the timestamps of the press and release edges.
  *
  * @param p_this pointer to an fsm_t struct than contains an fsm_button_t.
  */
@@ -84,10 +330,65 @@ static void do_store_tick_pressed(fsm_t *p_this)
 static void do_set_duration(fsm_t *p_this)
 {
     fsm_button_t *p_button = (fsm_button_t *)p_this;
-    uint32_t now = port_button_get_tick();
+    button_edge_t pressed = p_button->last_edge;
+    button_edge_t edge;
+    _take_edge(p_button, false, &edge);
+
+    p_button->duration_us = _edge_delta_us(&pressed, &edge);
+    p_button->duration = p_button->duration_us / 1000;
+    fsm_timed_enter(&p_button->timed, edge.millis);
+    p_button->tick_released = edge.millis;
+    METRICS_OBSERVE(BUTTON_PRESS_MS, p_button->duration);
+    LATENCY_PROBE_EDGE(edge.millis, edge.cycles);
+    if (p_button->subscribers_number > 0)
+    {
+        _gesture_release(p_button);
+    }
+}
+
+/**
+ * @brief Emit the long press while the button is still held, and schedule the auto-repeat. If the press is the second one of a double click, the first click is emitted before.
+ *
+ * @param p_this pointer to an fsm_t struct than contains an fsm_button_t.
+ */
+
+static void do_long_press(fsm_t *p_this)
+{
+    fsm_button_t *p_button = (fsm_button_t *)p_this;
+    if (p_button->second_press)
+    {
+        p_button->second_press = false;
+        _emit(p_button, BUTTON_EVENT_CLICK);
+    }
+    p_button->long_sent = true;
+    p_button->next_repeat = deadline_after(p_button->tick_pressed, p_button->long_press_ms + p_button->repeat_ms);
+    _emit(p_button, BUTTON_EVENT_LONG_PRESS);
+}
+
+/**
+ * @brief Emit an auto-repeat and schedule the next one.
+ *
+ * @param p_this pointer to an fsm_t struct than contains an fsm_button_t.
+ */
+
+static void do_repeat(fsm_t *p_this)
+{
+    fsm_button_t *p_button = (fsm_button_t *)p_this;
+    p_button->next_repeat = deadline_after(p_button->next_repeat, p_button->repeat_ms);
+    _emit(p_button, BUTTON_EVENT_REPEAT);
+}
 
-    p_button->duration = now - p_button->tick_pressed;
-    p_button->next_timeout = now + p_button->debounce_time;
+/**
+ * @brief Emit a click once the double click time has passed without a second press.
+ *
+ * @param p_this pointer to an fsm_t struct than contains an fsm_button_t.
+ */
+
+static void do_click(fsm_t *p_this)
+{
+    fsm_button_t *p_button = (fsm_button_t *)p_this;
+    p_button->click_pending = false;
+    _emit(p_button, BUTTON_EVENT_CLICK);
 }
 
 /**
@@ -98,12 +399,77 @@ static void do_set_duration(fsm_t *p_this)
 static fsm_trans_t fsm_trans_button[] = // {EstadoIni , FuncCompruebaCondicion, EstadoSig, FuncAccionesSiTransicion}
     {
         {BUTTON_RELEASED, check_button_pressed, BUTTON_PRESSED_WAIT, do_store_tick_pressed},
-        {BUTTON_PRESSED_WAIT, check_timeout, BUTTON_PRESSED, NULL},
+        {BUTTON_PRESSED_WAIT, AFTER(FSM_BUTTON_TIMEOUT_DEBOUNCE), BUTTON_PRESSED, NULL},
+        {BUTTON_PRESSED, check_button_released, BUTTON_RELEASED_WAIT, do_set_duration},
+        {BUTTON_RELEASED_WAIT, AFTER(FSM_BUTTON_TIMEOUT_DEBOUNCE), BUTTON_RELEASED, NULL},
+        {-1, NULL, -1, NULL}
+
+};
+
+/**
+ * @brief Array representing the transitions table of the FSM button in timer or scan debounce mode. The debounce is done by the port, so there are no wait states.
+ *
+ */
+
+static fsm_trans_t fsm_trans_button_timer[] =
+    {
+        {BUTTON_RELEASED, check_event_pressed, BUTTON_PRESSED, do_store_tick_pressed},
+        {BUTTON_PRESSED, check_event_released, BUTTON_RELEASED, do_set_duration},
+        {-1, NULL, -1, NULL}
+
+};
+
+/**
+ * @brief Array representing the transitions table of the FSM button with subscribers to the gesture events. The gestures that depend on the time are transitions to the same state, evaluated after the edges.
+ *
+ */
+
+static fsm_trans_t fsm_trans_button_gestures[] =
+    {
+        {BUTTON_RELEASED, check_button_pressed, BUTTON_PRESSED_WAIT, do_store_tick_pressed},
+        {BUTTON_RELEASED, check_click_timeout, BUTTON_RELEASED, do_click},
+        {BUTTON_PRESSED_WAIT, AFTER(FSM_BUTTON_TIMEOUT_DEBOUNCE), BUTTON_PRESSED, NULL},
         {BUTTON_PRESSED, check_button_released, BUTTON_RELEASED_WAIT, do_set_duration},
-        {BUTTON_RELEASED_WAIT, check_timeout, BUTTON_RELEASED, NULL},
+        {BUTTON_PRESSED, check_long_press, BUTTON_PRESSED, do_long_press},
+        {BUTTON_PRESSED, check_repeat, BUTTON_PRESSED, do_repeat},
+        {BUTTON_RELEASED_WAIT, AFTER(FSM_BUTTON_TIMEOUT_DEBOUNCE), BUTTON_RELEASED, NULL},
+        {-1, NULL, -1, NULL}
+
+};
+
+/**
+ * @brief Array representing the transitions table of the FSM button in timer or scan debounce mode with subscribers to the gesture events.
+ *
+ */
+
+static fsm_trans_t fsm_trans_button_timer_gestures[] =
+    {
+        {BUTTON_RELEASED, check_event_pressed, BUTTON_PRESSED, do_store_tick_pressed},
+        {BUTTON_RELEASED, check_click_timeout, BUTTON_RELEASED, do_click},
+        {BUTTON_PRESSED, check_event_released, BUTTON_RELEASED, do_set_duration},
+        {BUTTON_PRESSED, check_long_press, BUTTON_PRESSED, do_long_press},
+        {BUTTON_PRESSED, check_repeat, BUTTON_PRESSED, do_repeat},
         {-1, NULL, -1, NULL}
 
 };
+
+/**
+ * @brief Select the transitions table for the debounce mode of the button and for its subscribers.
+ *
+ * @param p_button Pointer to the button FSM.
+ *
+ * @return fsm_trans_t* Transitions table
+ */
+
+static fsm_trans_t *_transitions(fsm_button_t *p_button)
+{
+    bool port_debounce = p_button->timer_debounce || p_button->scan_debounce;
+    if (p_button->subscribers_number > 0)
+    {
+        return port_debounce ? fsm_trans_button_timer_gestures : fsm_trans_button_gestures;
+    }
+    return port_debounce ? fsm_trans_button_timer : fsm_trans_button;
+}
 /* State machine output or action functions */
 
 /**
@@ -120,6 +486,34 @@ uint32_t fsm_button_get_duration(fsm_t *p_this)
     return p_button->duration;
 }
 
+/**
+ * @brief Returns the ID of the button measured by the FSM.
+ * 
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_button_t.
+ * 
+ * @return uint32_t 
+ */
+
+uint32_t fsm_button_get_id(fsm_t *p_this)
+{
+    fsm_button_t *p_button = (fsm_button_t *)p_this;
+    return p_button->button_id;
+}
+
+/**
+ * @brief Returns the duration of the last button press in microseconds, from the timestamps of its edges.
+ * 
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_button_t.
+ * 
+ * @return uint32_t 
+ */
+
+uint32_t fsm_button_get_duration_us(fsm_t *p_this)
+{
+    fsm_button_t *p_button = (fsm_button_t *)p_this;
+    return p_button->duration_us;
+}
+
 /**
  * @brief Reset the duration of the last button press.
  * 
@@ -130,10 +524,11 @@ void fsm_button_reset_duration(fsm_t *p_this)
 {
     fsm_button_t *p_button = (fsm_button_t *)p_this;
     p_button->duration = 0;
+    p_button->duration_us = 0;
 }
 
 /**
- * @brief Checks if the button FSM is active, or not. The button is inactive when it is in the status BUTTON_RELEASED.
+ * @brief Checks if the button FSM is active, or not. The button is inactive when it is in the status BUTTON_RELEASED, or always in timer debounce mode: every transition is then triggered by an interrupt, which wakes up the core. In scan debounce mode it is active while the port is settling an edge. In both modes it is active while the port has queued edges the FSM has not taken yet. With subscribers, it is also active while a gesture depends on the time.
  * 
  * @param p_this Pointer to an fsm_t struct than contains an fsm_button_t.
  * 
@@ -144,7 +539,143 @@ void fsm_button_reset_duration(fsm_t *p_this)
 bool fsm_button_check_activity(fsm_t *p_this)
 {
     fsm_button_t *p_button = (fsm_button_t *)p_this;
-    return !(p_button->f.current_state == BUTTON_RELEASED);
+    if ((p_button->subscribers_number > 0) &&
+        (p_button->click_pending || ((p_button->f.current_state == BUTTON_PRESSED) && (p_button->long_press_ms > 0) && (!p_button->long_sent || (p_button->repeat_ms > 0)))))
+    {
+        return true; // A gesture depends on the time
+    }
+    if ((p_button->timer_debounce || p_button->scan_debounce) && _peek_edge(p_button))
+    {
+        return true; // Another edge was debounced before the last fire: it is taken at the next one, not at the next interrupt
+    }
+    if (p_button->scan_debounce)
+    {
+        return port_button_is_debouncing(p_button->button_id);
+    }
+    return !p_button->timer_debounce && !(p_button->f.current_state == BUTTON_RELEASED);
+}
+
+/**
+ * @brief Fire the button FSM with fsm_timed_fire().
+ *
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_button_t.
+ *
+ * @return int 1 if a transition has fired, 0 otherwise
+ */
+
+int fsm_button_fire(fsm_t *p_this)
+{
+    fsm_button_t *p_button = (fsm_button_t *)p_this;
+    return fsm_timed_fire(&p_button->timed);
+}
+
+/**
+ * @brief Get the time the main loop can sleep before it fires the button FSM again: the deadline of the state if it only waits for it or for an interrupt, or 0 if it polls something else.
+ *
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_button_t.
+ *
+ * @return uint32_t Time in ms: 0 to fire it again now, or FSM_TIMED_NONE to sleep until an interrupt
+ */
+
+uint32_t fsm_button_get_next_ms(fsm_t *p_this)
+{
+    fsm_button_t *p_button = (fsm_button_t *)p_this;
+    uint32_t next_ms = fsm_timed_get_next_ms(&p_button->timed);
+    if (p_button->timed.timed_only || !fsm_button_check_activity(p_this))
+    {
+        return next_ms; // Nothing but the deadline or an interrupt can fire a transition
+    }
+    return 0;
+}
+
+/**
+ * @brief Select who debounces the button: the FSM (default) or the port, with the EXTI interrupt and a one-shot timer. The FSM goes back to BUTTON_RELEASED.
+ * 
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_button_t.
+ * @param enable true to debounce with the timer, false to debounce in the FSM
+ */
+
+void fsm_button_set_timer_debounce(fsm_t *p_this, bool enable)
+{
+    fsm_button_t *p_button = (fsm_button_t *)p_this;
+    if (p_button->scan_debounce)
+    {
+        port_button_set_scan_debounce(p_button->button_id, false);
+    }
+    port_button_set_timer_debounce(p_button->button_id, enable, p_button->debounce_time);
+    p_button->timer_debounce = enable;
+    p_button->scan_debounce = false;
+    fsm_timed_set_transitions(&p_button->timed, _transitions(p_button));
+    fsm_set_state(p_this, BUTTON_RELEASED);
+    p_button->last_edge.millis = port_button_get_tick() - p_button->debounce_time; // Any edge from now on is a new one
+    p_button->next_edge_queued = false; // The port has flushed its queue
+}
+
+/**
+ * @brief Select who debounces the button: the FSM (default) or the port, sampling all the buttons periodically in the SysTick ISR. The FSM goes back to BUTTON_RELEASED.
+ * 
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_button_t.
+ * @param enable true to debounce with the scan, false to debounce in the FSM
+ */
+
+void fsm_button_set_scan_debounce(fsm_t *p_this, bool enable)
+{
+    fsm_button_t *p_button = (fsm_button_t *)p_this;
+    if (p_button->timer_debounce)
+    {
+        port_button_set_timer_debounce(p_button->button_id, false, p_button->debounce_time);
+    }
+    port_button_set_scan_debounce(p_button->button_id, enable);
+    p_button->timer_debounce = false;
+    p_button->scan_debounce = enable;
+    fsm_timed_set_transitions(&p_button->timed, _transitions(p_button));
+    fsm_set_state(p_this, BUTTON_RELEASED);
+    p_button->last_edge.millis = port_button_get_tick() - p_button->debounce_time; // Any edge from now on is a new one
+    p_button->next_edge_queued = false; // The port has flushed its queue
+}
+
+/**
+ * @brief Subscribe to the gesture events of a button FSM. The transitions table with the gestures is selected, keeping the current state.
+ * 
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_button_t.
+ * @param events Mask of FSM_BUTTON_EVENTS to be notified of
+ * @param cb Callback
+ * @param p_arg Argument passed to the callback
+ * 
+ * @return true 
+ * @return false 
+ */
+
+bool fsm_button_subscribe(fsm_t *p_this, uint32_t events, fsm_button_event_cb_t cb, void *p_arg)
+{
+    fsm_button_t *p_button = (fsm_button_t *)p_this;
+    if ((cb == NULL) || (p_button->subscribers_number == FSM_BUTTON_SUBSCRIBERS))
+    {
+        return false;
+    }
+    fsm_button_subscriber_t *p_sub = &p_button->subscribers[p_button->subscribers_number++];
+    p_sub->events = events;
+    p_sub->cb = cb;
+    p_sub->p_arg = p_arg;
+    fsm_timed_set_transitions(&p_button->timed, _transitions(p_button));
+    return true;
+}
+
+/**
+ * @brief Set the thresholds of the gestures of a button FSM.
+ * 
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_button_t.
+ * @param double_click_ms Maximum time in ms between a release and the next press of a double click. 0 to disable the double click
+ * @param long_press_ms Time in ms the button must be held for a long press. 0 to disable the long press and the auto-repeat
+ * @param repeat_ms Period in ms of the auto-repeat after a long press. 0 to disable it
+ */
+
+void fsm_button_set_gestures(fsm_t *p_this, uint32_t double_click_ms, uint32_t long_press_ms, uint32_t repeat_ms)
+{
+    fsm_button_t *p_button = (fsm_button_t *)p_this;
+    p_button->double_click_ms = double_click_ms;
+    p_button->long_press_ms = long_press_ms;
+    p_button->repeat_ms = repeat_ms;
 }
 
 /* Other auxiliary functions */
@@ -177,10 +708,27 @@ fsm_t *fsm_button_new(uint32_t debounce_time, uint32_t button_id)
 void fsm_button_init(fsm_t *p_this, uint32_t debounce_time, uint32_t button_id)
 {
     fsm_button_t *p_fsm = (fsm_button_t *)(p_this);
-    fsm_init(p_this, fsm_trans_button);
+    fsm_timed_init(&p_fsm->timed, fsm_trans_button);
+    fsm_timed_set_timeout(&p_fsm->timed, FSM_BUTTON_TIMEOUT_DEBOUNCE, debounce_time);
     p_fsm-> debounce_time = debounce_time ;
     p_fsm -> tick_pressed = 0;
     p_fsm -> duration = 0;
+    p_fsm -> duration_us = 0;
     p_fsm -> button_id = button_id;
+    p_fsm -> timer_debounce = false;
+    p_fsm -> scan_debounce = false;
+    p_fsm -> double_click_ms = FSM_BUTTON_DOUBLE_CLICK_MS;
+    p_fsm -> long_press_ms = FSM_BUTTON_LONG_PRESS_MS;
+    p_fsm -> repeat_ms = FSM_BUTTON_REPEAT_MS;
+    p_fsm -> tick_released = 0;
+    p_fsm -> next_repeat = 0;
+    p_fsm -> long_sent = false;
+    p_fsm -> click_pending = false;
+    p_fsm -> second_press = false;
+    p_fsm -> subscribers_number = 0;
     port_button_init (button_id); /* Initialize the button HW */
+    p_fsm -> last_edge.millis = port_button_get_tick() - debounce_time; /* Any edge from now on is a new one */
+    p_fsm -> last_edge.cycles = port_system_get_cycles();
+    p_fsm -> last_edge.pressed = false;
+    p_fsm -> next_edge_queued = false;
 }
@@ -17,6 +17,8 @@
 #include "port_buzzer.h"
 #include "fsm_buzzer.h"
 #include "melodies.h"
+#include "metrics.h"
+#include "latency_probe.h"
 
 /* State machine input or transition functions */
 
@@ -33,6 +35,7 @@ static void _start_note (fsm_t *p_this, double freq, uint32_t duration){
     uint32_t note_duration = (uint32_t) round(((double) duration) / p_fsm->player_speed);
     port_buzzer_set_note_duration (p_fsm->buzzer_id, note_duration);
     port_buzzer_set_note_frequency (p_fsm->buzzer_id, freq);
+    METRICS_INC(NOTES_PLAYED);
 }
 
 /**
@@ -163,6 +166,7 @@ static void do_melody_start (fsm_t *p_this){
 
 static void do_player_start (fsm_t *p_this){
     do_melody_start(p_this);
+    LATENCY_PROBE_ACTION(BUZZER);
 }
 
 /**
@@ -202,6 +206,7 @@ static void do_player_stop (fsm_t *p_this){
     fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
     port_buzzer_stop(p_fsm->buzzer_id);
     p_fsm->note_index = 0;
+    LATENCY_PROBE_ACTION(BUZZER);
 }
 
 /**
@@ -0,0 +1,492 @@
+/**
+ * @file fsm_command.c
+ * @brief Command interpreter FSM main file.
+ *
+ * The keywords are looked up in a table indexed by a perfect hash of their length, first and last chars (COMMAND_HASH()), so every lookup costs one hash and one string comparison. The table is built at compile time: if two keywords collide, their designated initializers overlap and the build fails (-Woverride-init).
+ *
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+/* Other libraries */
+#include "fsm_command.h"
+#include "fsm_usart.h"
+#include "fsm_buzzer.h"
+#include "melodies.h"
+#include "metrics.h"
+#include "latency_probe.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define COMMAND_REPLY_LINE_LENGTH 48 /*Maximum length of the reply to one command*/
+
+/* Typedefs ------------------------------------------------------------------*/
+
+/**
+ * @brief Handler of a command. It can write a reply in p_reply; if it writes nothing, "ok" or "err" is replied depending on the returned value.
+ *
+ * @param p_fsm Pointer to the command interpreter FSM
+ * @param p_arg Pointer to the argument of the command (not NUL-terminated)
+ * @param arg_length Length of the argument. 0 if there is no argument.
+ * @param p_reply Pointer to the reply buffer (COMMAND_REPLY_LINE_LENGTH bytes)
+ * @return true if the command has been executed
+ * @return false if the argument is not valid
+ */
+typedef bool (*command_handler_t)(fsm_command_t *p_fsm, const char *p_arg, uint32_t arg_length, char *p_reply);
+
+typedef struct{
+    const char *p_keyword; /*Keyword of the command. NULL for empty slots*/
+    uint8_t length; /*Length of the keyword*/
+    command_handler_t handler; /*Function that executes the command*/
+} command_entry_t;
+
+/* Private functions */
+
+static bool _cmd_play(fsm_command_t *p_fsm, const char *p_arg, uint32_t arg_length, char *p_reply);
+static bool _cmd_pause(fsm_command_t *p_fsm, const char *p_arg, uint32_t arg_length, char *p_reply);
+static bool _cmd_stop(fsm_command_t *p_fsm, const char *p_arg, uint32_t arg_length, char *p_reply);
+static bool _cmd_speed(fsm_command_t *p_fsm, const char *p_arg, uint32_t arg_length, char *p_reply);
+static bool _cmd_melody(fsm_command_t *p_fsm, const char *p_arg, uint32_t arg_length, char *p_reply);
+static bool _cmd_status(fsm_command_t *p_fsm, const char *p_arg, uint32_t arg_length, char *p_reply);
+static bool _cmd_metrics(fsm_command_t *p_fsm, const char *p_arg, uint32_t arg_length, char *p_reply);
+static bool _cmd_latency(fsm_command_t *p_fsm, const char *p_arg, uint32_t arg_length, char *p_reply);
+
+/* Global variables */
+
+/**
+ * @brief Keyword table indexed by COMMAND_HASH().
+ */
+#define COMMAND_ENTRY(keyword, first, last, handler) [COMMAND_HASH(sizeof(keyword) - 1, first, last)] = {keyword, sizeof(keyword) - 1, handler}
+static const command_entry_t command_table[COMMAND_HASH_SIZE] = {
+    COMMAND_ENTRY("play", 'p', 'y', _cmd_play),
+    COMMAND_ENTRY("pause", 'p', 'e', _cmd_pause),
+    COMMAND_ENTRY("stop", 's', 'p', _cmd_stop),
+    COMMAND_ENTRY("speed", 's', 'd', _cmd_speed),
+    COMMAND_ENTRY("melody", 'm', 'y', _cmd_melody),
+    COMMAND_ENTRY("status", 's', 's', _cmd_status),
+    COMMAND_ENTRY("metrics", 'm', 's', _cmd_metrics),
+    COMMAND_ENTRY("latency", 'l', 'y', _cmd_latency),
+};
+
+/**
+ * @brief Melodies that can be selected with the command `melody`, by name or by index.
+ */
+static const melody_t *const melodies_list[] = {&scale_melody, &happy_birthday_melody, &tetris_melody};
+#define MELODIES_LIST_LENGTH (sizeof(melodies_list) / sizeof(melodies_list[0]))
+
+/**
+ * @brief Look up a keyword in the command table.
+ *
+ * @param p_keyword Pointer to the keyword (not NUL-terminated)
+ * @param length Length of the keyword
+ * @return const command_entry_t* Entry of the command, or NULL if the keyword is unknown
+ */
+
+static const command_entry_t *_command_lookup(const char *p_keyword, uint32_t length)
+{
+    if (length == 0)
+    {
+        return NULL;
+    }
+    const command_entry_t *p_entry = &command_table[COMMAND_HASH(length, p_keyword[0], p_keyword[length - 1])];
+    if ((p_entry->p_keyword != NULL) && (p_entry->length == length) && (memcmp(p_entry->p_keyword, p_keyword, length) == 0))
+    {
+        return p_entry;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Parse an unsigned decimal number with up to two decimals (e.g., "1", "1.5", "0.25") as hundredths.
+ *
+ * @param p_arg Pointer to the number (not NUL-terminated)
+ * @param length Length of the number
+ * @param p_value Pointer where the value in hundredths is returned
+ * @return true if the number is valid
+ * @return false otherwise
+ */
+
+static bool _parse_hundredths(const char *p_arg, uint32_t length, uint32_t *p_value)
+{
+    uint32_t value = 0;
+    int32_t decimals = -1;
+    for (uint32_t i = 0; i < length; i++)
+    {
+        if ((p_arg[i] == '.') && (decimals < 0))
+        {
+            decimals = 0;
+        }
+        else if ((p_arg[i] >= '0') && (p_arg[i] <= '9') && (decimals < 2) && (value < 100000))
+        {
+            value = value * 10 + (uint32_t)(p_arg[i] - '0');
+            if (decimals >= 0)
+            {
+                decimals++;
+            }
+        }
+        else
+        {
+            return false;
+        }
+    }
+    if ((length == 0) || (decimals == 0))
+    {
+        return false;
+    }
+    for (int32_t d = (decimals < 0) ? 0 : decimals; d < 2; d++)
+    {
+        value *= 10;
+    }
+    *p_value = value;
+    return true;
+}
+
+/**
+ * @brief Queue the batched replies in the USART and empty the reply buffer.
+ *
+ * @param p_fsm Pointer to the command interpreter FSM
+ */
+
+static void _reply_flush(fsm_command_t *p_fsm)
+{
+    if (p_fsm->reply_length == 0)
+    {
+        return;
+    }
+    if ((p_fsm->p_fsm_usart != NULL) && !fsm_usart_set_out_data(p_fsm->p_fsm_usart, p_fsm->reply, p_fsm->reply_length))
+    {
+        p_fsm->stats.replies_dropped++;
+    }
+    p_fsm->reply_length = 0;
+}
+
+/**
+ * @brief Append one reply line to the reply buffer. The buffer is flushed first if the line does not fit.
+ *
+ * @param p_fsm Pointer to the command interpreter FSM
+ * @param p_line Pointer to the line, including its new line char
+ * @param length Length of the line
+ */
+
+static void _reply_append(fsm_command_t *p_fsm, const char *p_line, uint32_t length)
+{
+    if (p_fsm->reply_length + length > USART_OUTPUT_BUFFER_LENGTH)
+    {
+        _reply_flush(p_fsm);
+    }
+    memcpy(&p_fsm->reply[p_fsm->reply_length], p_line, length);
+    p_fsm->reply_length += length;
+}
+
+/**
+ * @brief Execute one command and append its reply.
+ *
+ * @param p_fsm Pointer to the command interpreter FSM
+ * @param p_cmd Pointer to the command, without separators
+ * @param length Length of the command
+ */
+
+static void _command_run(fsm_command_t *p_fsm, const char *p_cmd, uint32_t length)
+{
+    char line[COMMAND_REPLY_LINE_LENGTH];
+    uint32_t key_length = 0;
+    while ((key_length < length) && (p_cmd[key_length] != ' '))
+    {
+        key_length++;
+    }
+    const char *p_arg = &p_cmd[key_length];
+    uint32_t arg_length = length - key_length;
+    while ((arg_length > 0) && (*p_arg == ' '))
+    {
+        p_arg++;
+        arg_length--;
+    }
+
+    const command_entry_t *p_entry = _command_lookup(p_cmd, key_length);
+    if (p_entry == NULL)
+    {
+        int n = snprintf(line, sizeof(line), "? %.*s\n", (int)((key_length < 16) ? key_length : 16), p_cmd);
+        p_fsm->stats.errors++;
+        _reply_append(p_fsm, line, (uint32_t)n);
+        return;
+    }
+
+    char reply[COMMAND_REPLY_LINE_LENGTH] = {0};
+    bool ok = p_entry->handler(p_fsm, p_arg, arg_length, reply);
+    if (ok)
+    {
+        p_fsm->stats.commands++;
+    }
+    else
+    {
+        p_fsm->stats.errors++;
+    }
+    int n = snprintf(line, sizeof(line), "%s %s\n", p_entry->p_keyword, (reply[0] != 0) ? reply : (ok ? "ok" : "err"));
+    _reply_append(p_fsm, line, ((uint32_t)n < sizeof(line)) ? (uint32_t)n : sizeof(line) - 1);
+}
+
+/* Command handlers */
+
+/**
+ * @brief Command `play`: start or resume the player.
+ */
+
+static bool _cmd_play(fsm_command_t *p_fsm, const char *p_arg, uint32_t arg_length, char *p_reply)
+{
+    fsm_buzzer_set_action(p_fsm->p_fsm_buzzer, PLAY);
+    return true;
+}
+
+/**
+ * @brief Command `pause`: pause the player.
+ */
+
+static bool _cmd_pause(fsm_command_t *p_fsm, const char *p_arg, uint32_t arg_length, char *p_reply)
+{
+    fsm_buzzer_set_action(p_fsm->p_fsm_buzzer, PAUSE);
+    return true;
+}
+
+/**
+ * @brief Command `stop`: stop the player.
+ */
+
+static bool _cmd_stop(fsm_command_t *p_fsm, const char *p_arg, uint32_t arg_length, char *p_reply)
+{
+    fsm_buzzer_set_action(p_fsm->p_fsm_buzzer, STOP);
+    return true;
+}
+
+/**
+ * @brief Command `speed <x>`: set the speed of the player, between COMMAND_SPEED_MIN and COMMAND_SPEED_MAX hundredths.
+ */
+
+static bool _cmd_speed(fsm_command_t *p_fsm, const char *p_arg, uint32_t arg_length, char *p_reply)
+{
+    uint32_t speed;
+    if (!_parse_hundredths(p_arg, arg_length, &speed) || (speed < COMMAND_SPEED_MIN) || (speed > COMMAND_SPEED_MAX))
+    {
+        return false;
+    }
+    fsm_buzzer_set_speed(p_fsm->p_fsm_buzzer, speed / 100.0);
+    return true;
+}
+
+/**
+ * @brief Command `melody <name|index>`: select the melody to play.
+ */
+
+static bool _cmd_melody(fsm_command_t *p_fsm, const char *p_arg, uint32_t arg_length, char *p_reply)
+{
+    for (uint32_t i = 0; i < MELODIES_LIST_LENGTH; i++)
+    {
+        const char *p_name = melodies_list[i]->p_name;
+        bool by_index = (arg_length == 1) && ((uint32_t)(p_arg[0] - '0') == i);
+        bool by_name = (strlen(p_name) == arg_length) && (memcmp(p_name, p_arg, arg_length) == 0);
+        if (by_index || by_name)
+        {
+            fsm_buzzer_set_melody(p_fsm->p_fsm_buzzer, melodies_list[i]);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Command `status`: reply with the action, the melody, the speed (in hundredths) and the progress of the player.
+ */
+
+static bool _cmd_status(fsm_command_t *p_fsm, const char *p_arg, uint32_t arg_length, char *p_reply)
+{
+    static const char *const actions[] = {[STOP] = "stop", [PLAY] = "play", [PAUSE] = "pause"};
+    fsm_buzzer_t *p_buzzer = (fsm_buzzer_t *)(p_fsm->p_fsm_buzzer);
+    uint8_t action = fsm_buzzer_get_action(p_fsm->p_fsm_buzzer);
+    const melody_t *p_melody = p_buzzer->p_melody;
+    snprintf(p_reply, COMMAND_REPLY_LINE_LENGTH - 8, "%s %s %u %u/%u",
+             (action <= PAUSE) ? actions[action] : "?",
+             (p_melody != NULL) ? p_melody->p_name : "-",
+             (unsigned)(p_buzzer->player_speed * 100.0 + 0.5),
+             (unsigned)p_buzzer->note_index,
+             (p_melody != NULL) ? (unsigned)p_melody->melody_length : 0u);
+    return true;
+}
+
+/**
+ * @brief Command `metrics`: send a snapshot of the metrics registry (see metrics.h) as a binary frame. The replies of the previous commands of the frame are sent first, and the reply line of this command follows the snapshot.
+ *
+ * It fails if the metrics are compiled out (USE_METRICS not defined) or there is no room in the TX queue.
+ */
+
+static bool _cmd_metrics(fsm_command_t *p_fsm, const char *p_arg, uint32_t arg_length, char *p_reply)
+{
+#ifdef USE_METRICS
+    _Static_assert(METRICS_SNAPSHOT_LENGTH <= USART_FRAME_MAX_PAYLOAD_LENGTH, "The snapshot of the metrics must fit in one frame");
+    uint8_t snapshot[METRICS_SNAPSHOT_LENGTH];
+    uint32_t length = metrics_snapshot(snapshot, sizeof(snapshot));
+    if (p_fsm->p_fsm_usart == NULL)
+    {
+        return false;
+    }
+    _reply_flush(p_fsm);
+    return fsm_usart_send_frame(p_fsm->p_fsm_usart, snapshot, length);
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Command `latency <probe>`: send a snapshot of the histogram of a latency probe (see latency_probe.h), selected by index or by name, as a binary frame. The replies of the previous commands of the frame are sent first, and the reply line of this command follows the snapshot.
+ *
+ * It fails if the probes are compiled out (USE_LATENCY_PROBE not defined), the probe does not exist or there is no room in the TX queue.
+ */
+
+static bool _cmd_latency(fsm_command_t *p_fsm, const char *p_arg, uint32_t arg_length, char *p_reply)
+{
+#ifdef USE_LATENCY_PROBE
+    _Static_assert(LATENCY_PROBE_SNAPSHOT_LENGTH <= USART_FRAME_MAX_PAYLOAD_LENGTH, "The snapshot of a latency probe must fit in one frame");
+    uint8_t snapshot[LATENCY_PROBE_SNAPSHOT_LENGTH];
+    int32_t probe = latency_probe_lookup(p_arg, arg_length);
+    if ((probe < 0) || (p_fsm->p_fsm_usart == NULL))
+    {
+        return false;
+    }
+    uint32_t length = latency_probe_snapshot(probe, snapshot, sizeof(snapshot));
+    _reply_flush(p_fsm);
+    return fsm_usart_send_frame(p_fsm->p_fsm_usart, snapshot, length);
+#else
+    return false;
+#endif
+}
+
+/* State machine input or transition functions */
+
+/**
+ * @brief Checks if the USART FSM has received a frame.
+ *
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_command_t struct
+ * @return true
+ * @return false
+ */
+
+static bool check_command_rx(fsm_t *p_this)
+{
+    fsm_command_t *p_fsm = (fsm_command_t *)(p_this);
+    return (p_fsm->p_fsm_usart != NULL) && fsm_usart_check_data_received(p_fsm->p_fsm_usart);
+}
+
+/* State machine output or action functions */
+
+/**
+ * @brief Executes all the commands of the received frame and releases it, so that the USART FSM can fetch the next one.
+ *
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_command_t struct
+ */
+
+static void do_execute_commands(fsm_t *p_this)
+{
+    fsm_command_t *p_fsm = (fsm_command_t *)(p_this);
+    char frame[USART_INPUT_BUFFER_LENGTH];
+    fsm_usart_get_in_data(p_fsm->p_fsm_usart, frame);
+    uint32_t length = fsm_usart_get_in_length(p_fsm->p_fsm_usart);
+    fsm_usart_reset_input_data(p_fsm->p_fsm_usart);
+    fsm_command_execute(p_this, frame, length);
+}
+
+static fsm_trans_t fsm_trans_command[] = {
+    {WAIT_COMMAND, check_command_rx, WAIT_COMMAND, do_execute_commands},
+    {-1, NULL, -1, NULL}
+};
+
+/* Public functions */
+
+/**
+ * @brief Execute all the commands of a frame and send their replies.
+ *
+ * This function is called by the FSM for each received frame, but it can also be called directly.
+ *
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_command_t struct
+ * @param p_frame Pointer to the frame
+ * @param length Length of the frame in bytes
+ * @return uint32_t Number of commands found in the frame, including the invalid ones
+ */
+
+uint32_t fsm_command_execute(fsm_t *p_this, const char *p_frame, uint32_t length)
+{
+    fsm_command_t *p_fsm = (fsm_command_t *)(p_this);
+    uint32_t count = 0;
+    uint32_t start = 0;
+    p_fsm->stats.frames++;
+    for (uint32_t i = 0; i <= length; i++)
+    {
+        if ((i == length) || (p_frame[i] == COMMAND_SEPARATOR) || (p_frame[i] == '\n') || (p_frame[i] == '\r') || (p_frame[i] == EMPTY_BUFFER_CONSTANT))
+        {
+            while ((start < i) && (p_frame[start] == ' '))
+            {
+                start++;
+            }
+            uint32_t end = i;
+            while ((end > start) && (p_frame[end - 1] == ' '))
+            {
+                end--;
+            }
+            if (end > start)
+            {
+                _command_run(p_fsm, &p_frame[start], end - start);
+                count++;
+            }
+            start = i + 1;
+        }
+    }
+    _reply_flush(p_fsm);
+    return count;
+}
+
+/**
+ * @brief Get the statistics of the command interpreter.
+ *
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_command_t struct
+ * @param p_stats Pointer to the struct where the statistics will be copied
+ */
+
+void fsm_command_get_stats(fsm_t *p_this, fsm_command_stats_t *p_stats)
+{
+    fsm_command_t *p_fsm = (fsm_command_t *)(p_this);
+    *p_stats = p_fsm->stats;
+}
+
+/**
+ * @brief Create a new command interpreter FSM.
+ *
+ * @param p_fsm_usart Pointer to the USART FSM. It can be NULL to run the interpreter without a USART (e.g., benchmarks).
+ * @param p_fsm_buzzer Pointer to the buzzer melody player FSM
+ * @return fsm_t* A pointer to the command interpreter FSM
+ */
+
+fsm_t *fsm_command_new(fsm_t *p_fsm_usart, fsm_t *p_fsm_buzzer)
+{
+    fsm_t *p_fsm = malloc(sizeof(fsm_command_t)); /* Do malloc to reserve memory of all other FSM elements, although it is interpreted as fsm_t (the first element of the structure) */
+    fsm_command_init(p_fsm, p_fsm_usart, p_fsm_buzzer);
+    return p_fsm;
+}
+
+/**
+ * @brief Initialize the default values of the FSM struct.
+ *
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_command_t struct
+ * @param p_fsm_usart Pointer to the USART FSM. It can be NULL.
+ * @param p_fsm_buzzer Pointer to the buzzer melody player FSM
+ */
+
+void fsm_command_init(fsm_t *p_this, fsm_t *p_fsm_usart, fsm_t *p_fsm_buzzer)
+{
+    fsm_command_t *p_fsm = (fsm_command_t *)(p_this);
+    fsm_init(p_this, fsm_trans_command);
+    p_fsm->p_fsm_usart = p_fsm_usart;
+    p_fsm->p_fsm_buzzer = p_fsm_buzzer;
+    p_fsm->reply_length = 0;
+    memset(&p_fsm->stats, 0, sizeof(fsm_command_stats_t));
+}
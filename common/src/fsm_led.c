@@ -4,6 +4,7 @@
 #include "fsm_led.h"
 #include "port_led.h"
 #include "port_system.h"
+#include "latency_probe.h"
 
 static bool check_button_duration(fsm_t *p_fsm)
 {
@@ -15,7 +16,24 @@ static void do_toggle(fsm_t *p_fsm)
 {
     fsm_led_t *p_led = (fsm_led_t *)p_fsm;
     fsm_button_reset_duration(p_led->p_button);
-    port_led_toggle();
+    if (p_led->p_pattern == NULL)
+    {
+        port_led_toggle();
+    }
+    else if (p_led->pattern_on && port_led_pattern_is_running())
+    {
+        port_led_pattern_stop();
+        p_led->pattern_on = false;
+    }
+    else
+    {
+        p_led->pattern_on = port_led_pattern_start(p_led->p_pattern); /* Una vez arrancado, el patrón no gasta CPU */
+        if (!p_led->pattern_on)
+        {
+            port_led_toggle();
+        }
+    }
+    LATENCY_PROBE_ACTION(LED);
 }
 
 static fsm_trans_t fsm_trans_led[] = {
@@ -37,5 +55,18 @@ void fsm_led_init(fsm_t *p_fsm, fsm_t *p_button, uint32_t min_duration)
     fsm_init(&p_led->fsm, fsm_trans_led);
     p_led->p_button = p_button;
     p_led->min_duration = min_duration;
+    p_led->p_pattern = NULL;
+    p_led->pattern_on = false;
     port_led_gpio_setup(); /* Inicializa el HW del LED */
 }
+
+void fsm_led_set_pattern(fsm_t *p_fsm, const led_pattern_t *p_pattern)
+{
+    fsm_led_t *p_led = (fsm_led_t *)p_fsm;
+    if (p_led->pattern_on)
+    {
+        port_led_pattern_stop();
+        p_led->pattern_on = false;
+    }
+    p_led->p_pattern = p_pattern;
+}
@@ -0,0 +1,296 @@
+/**
+ * @file fsm_timed.c
+ * @brief Timed transitions for the FSMs of the library: the time at which an FSM entered its state is recorded once for the whole FSM, and the transitions that fire after some time in the state are declared in the transitions table with AFTER(), instead of each FSM checking its own timeouts.
+ *
+ * The input function of a transition AFTER(index) is one of fsm_timed_after_0() to fsm_timed_after_3(), so the table is scanned to know which transitions of a state are timed: at the entry in a state, the deadline of the FSM is the entry time plus the shortest of the timeouts of its AFTER() transitions. fsm_timed_fire() does not call any input function before that deadline when all the transitions of the state are timed, and fsm_timed_get_next_ms() reports it to the main loop, so that it can sleep until then (e.g. with a software timer, see sw_timer.h).
+ *
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Other libraries */
+#include "fsm_timed.h"
+#include "port_system.h"
+
+/* Global variables ------------------------------------------------------------*/
+static const fsm_input_func_t afters[FSM_TIMED_TIMEOUTS] = {fsm_timed_after_0, fsm_timed_after_1, fsm_timed_after_2, fsm_timed_after_3}; /*Input function of AFTER() of each index*/
+
+/* Private functions */
+
+/**
+ * @brief Index of the timeout of an input function of AFTER().
+ *
+ * @param in Input function of a transition
+ * @return int Index of the timeout, or -1 if the transition is not an AFTER() transition
+ */
+
+static int _after_index(fsm_input_func_t in)
+{
+    for (int i = 0; i < FSM_TIMED_TIMEOUTS; i++)
+    {
+        if (afters[i] == in)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Record the entry of the FSM in a state, and compute the deadline of the state from its AFTER() transitions.
+ *
+ * @param p_this Pointer to the FSM
+ * @param state State entered
+ * @param entered_ms System tick at which the FSM entered the state
+ */
+
+static void _enter(fsm_timed_t *p_this, int state, uint32_t entered_ms)
+{
+    uint32_t timeout_ms = UINT32_MAX;
+    p_this->state = state;
+    p_this->entered = entered_ms;
+    p_this->entry_recorded = true;
+    p_this->has_deadline = false;
+    p_this->timed_only = true;
+    for (fsm_trans_t *p_t = p_this->f.p_tt; p_t->orig_state >= 0; p_t++)
+    {
+        if (p_t->orig_state != state)
+        {
+            continue;
+        }
+        int index = _after_index(p_t->in);
+        if (index < 0)
+        {
+            p_this->timed_only = false;
+        }
+        else
+        {
+            p_this->has_deadline = true;
+            timeout_ms = (p_this->timeouts_ms[index] < timeout_ms) ? p_this->timeouts_ms[index] : timeout_ms;
+        }
+    }
+    p_this->timed_only = p_this->timed_only && p_this->has_deadline; // A state with no transition at all is left alone
+    p_this->deadline = p_this->has_deadline ? deadline_after(entered_ms, timeout_ms) : entered_ms;
+}
+
+/**
+ * @brief Record the entry of the FSM in its current state now, if the state has changed with no record (a transition fired by fsm_fire()).
+ *
+ * @param p_this Pointer to the FSM
+ * @param now_ms Current system tick
+ */
+
+static void _update(fsm_timed_t *p_this, uint32_t now_ms)
+{
+    if (p_this->state != p_this->f.current_state)
+    {
+        _enter(p_this, p_this->f.current_state, now_ms);
+    }
+}
+
+/**
+ * @brief Destination state of the transition of the current state with an input function.
+ *
+ * @param p_this Pointer to the FSM
+ * @param in Input function
+ * @return int Destination state, or the current state if no transition of the current state has that input function
+ */
+
+static int _destination(fsm_timed_t *p_this, fsm_input_func_t in)
+{
+    for (fsm_trans_t *p_t = p_this->f.p_tt; p_t->orig_state >= 0; p_t++)
+    {
+        if ((p_t->orig_state == p_this->f.current_state) && (p_t->in == in))
+        {
+            return p_t->dest_state;
+        }
+    }
+    return p_this->f.current_state;
+}
+
+/* Public functions */
+
+/**
+ * @brief Initialize an FSM with timed transitions: the FSM of the library is initialized with the transitions table, all the timeouts are 0 and the FSM enters its first state now.
+ *
+ * @param p_this Pointer to the FSM
+ * @param p_tt Transitions table. Its input functions can be AFTER() of the timeouts of the FSM
+ */
+
+void fsm_timed_init(fsm_timed_t *p_this, fsm_trans_t *p_tt)
+{
+    fsm_init(&p_this->f, p_tt);
+    for (uint32_t i = 0; i < FSM_TIMED_TIMEOUTS; i++)
+    {
+        p_this->timeouts_ms[i] = 0;
+    }
+    _enter(p_this, p_this->f.current_state, port_system_get_millis());
+}
+
+/**
+ * @brief Change the transitions table of the FSM, keeping its state and the time at which it entered it.
+ *
+ * @param p_this Pointer to the FSM
+ * @param p_tt Transitions table
+ */
+
+void fsm_timed_set_transitions(fsm_timed_t *p_this, fsm_trans_t *p_tt)
+{
+    p_this->f.p_tt = p_tt;
+    if (p_this->state == p_this->f.current_state) // Otherwise the entry is recorded at the next update, with the new table
+    {
+        _enter(p_this, p_this->state, p_this->entered);
+    }
+}
+
+/**
+ * @brief Set the timeout of an index of AFTER(). If the FSM is in a state with a transition AFTER() that index, its deadline is computed again from the time at which it entered the state.
+ *
+ * @param p_this Pointer to the FSM
+ * @param index Index of the timeout, 0 to FSM_TIMED_TIMEOUTS - 1
+ * @param timeout_ms Timeout in ms, up to DEADLINE_MAX_MS
+ */
+
+void fsm_timed_set_timeout(fsm_timed_t *p_this, uint32_t index, uint32_t timeout_ms)
+{
+    if (index >= FSM_TIMED_TIMEOUTS)
+    {
+        return;
+    }
+    p_this->timeouts_ms[index] = timeout_ms;
+    fsm_timed_set_transitions(p_this, p_this->f.p_tt);
+}
+
+/**
+ * @brief Record the time at which the FSM entered the state of the transition being fired, when it is not the current system tick.
+ *
+ * @param p_this Pointer to the FSM
+ * @param entered_ms System tick at which the FSM entered the state
+ */
+
+void fsm_timed_enter(fsm_timed_t *p_this, uint32_t entered_ms)
+{
+    _enter(p_this, p_this->f.current_state, entered_ms); // The library moves to the destination state before it calls the output function
+}
+
+/**
+ * @brief Check if the FSM has been in its current state for the timeout of an index.
+ *
+ * @param p_this Pointer to the FSM
+ * @param index Index of the timeout, 0 to FSM_TIMED_TIMEOUTS - 1
+ * @return true if the timeout has elapsed since the FSM entered its state. The FSM then enters the destination state of the transition that fires
+ * @return false otherwise
+ */
+
+bool fsm_timed_after(fsm_timed_t *p_this, uint32_t index)
+{
+    uint32_t now = port_system_get_millis();
+    _update(p_this, now);
+    if ((index >= FSM_TIMED_TIMEOUTS) || !deadline_elapsed(p_this->entered, p_this->timeouts_ms[index], now))
+    {
+        return false;
+    }
+    _enter(p_this, _destination(p_this, afters[index]), now); // Also for a transition to the same state, which fsm_fire() does not tell apart
+    return true;
+}
+
+/**
+ * @brief Fire the FSM as fsm_fire() does, but without calling the input functions when all the transitions of the state are AFTER() transitions and none is due yet.
+ *
+ * @param p_this Pointer to the FSM
+ * @return int 1 if a transition has fired, 0 otherwise
+ */
+
+int fsm_timed_fire(fsm_timed_t *p_this)
+{
+    uint32_t now = port_system_get_millis();
+    _update(p_this, now);
+    if (p_this->timed_only && !deadline_reached(p_this->deadline, now))
+    {
+        return 0;
+    }
+    p_this->entry_recorded = false;
+    int fired = fsm_fire(&p_this->f);
+    if (fired && !p_this->entry_recorded)
+    {
+        _enter(p_this, p_this->f.current_state, now);
+    }
+    return fired;
+}
+
+/**
+ * @brief Get the time to the first AFTER() transition of the current state.
+ *
+ * @param p_this Pointer to the FSM
+ * @return uint32_t Time to the deadline in ms, 0 if it has been reached, or FSM_TIMED_NONE if the state has no AFTER() transition
+ */
+
+uint32_t fsm_timed_get_next_ms(fsm_timed_t *p_this)
+{
+    uint32_t now = port_system_get_millis();
+    _update(p_this, now);
+    return p_this->has_deadline ? deadline_remaining(p_this->deadline, now) : FSM_TIMED_NONE;
+}
+
+/**
+ * @brief Get the time until the FSM has been in its current state for the timeout of an index.
+ *
+ * @param p_this Pointer to the FSM
+ * @param index Index of the timeout, 0 to FSM_TIMED_TIMEOUTS - 1
+ * @return uint32_t Time to the timeout in ms, 0 if it has elapsed, or FSM_TIMED_NONE if the index is not valid
+ */
+
+uint32_t fsm_timed_get_remaining_ms(fsm_timed_t *p_this, uint32_t index)
+{
+    uint32_t now = port_system_get_millis();
+    _update(p_this, now);
+    if (index >= FSM_TIMED_TIMEOUTS)
+    {
+        return FSM_TIMED_NONE;
+    }
+    return deadline_remaining(deadline_after(p_this->entered, p_this->timeouts_ms[index]), now);
+}
+
+/**
+ * @brief Get the time to the first AFTER() transition of several FSMs.
+ *
+ * @param pp_fsms Array of pointers to the FSMs
+ * @param n Number of FSMs
+ * @return uint32_t Time to the first deadline in ms, 0 if one has been reached, or FSM_TIMED_NONE if no FSM is in a state with AFTER() transitions
+ */
+
+uint32_t fsm_timed_get_next_ms_all(fsm_timed_t *const *pp_fsms, uint32_t n)
+{
+    uint32_t next = FSM_TIMED_NONE;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        uint32_t next_i = fsm_timed_get_next_ms(pp_fsms[i]);
+        next = (next_i < next) ? next_i : next;
+    }
+    return next;
+}
+
+/**
+ * @brief Input functions of AFTER() of each index.
+ */
+
+bool fsm_timed_after_0(fsm_t *p_fsm)
+{
+    return fsm_timed_after((fsm_timed_t *)p_fsm, 0);
+}
+
+bool fsm_timed_after_1(fsm_t *p_fsm)
+{
+    return fsm_timed_after((fsm_timed_t *)p_fsm, 1);
+}
+
+bool fsm_timed_after_2(fsm_t *p_fsm)
+{
+    return fsm_timed_after((fsm_timed_t *)p_fsm, 2);
+}
+
+bool fsm_timed_after_3(fsm_t *p_fsm)
+{
+    return fsm_timed_after((fsm_timed_t *)p_fsm, 3);
+}
@@ -13,10 +13,47 @@
 /* Other libraries */
 #include "port_usart.h"
 #include "fsm_usart.h"
+#include "cobs_frame.h"
+#include "metrics.h"
+
+/* Private functions */
+
+/**
+ * @brief Reserve the next free slot of the TX queue and fill in its fields.
+ *
+ * @param p_fsm Pointer to the USART FSM
+ * @param length Length of the payload in bytes
+ * @param cb Completion callback
+ * @param p_arg Argument of the completion callback
+ * @return fsm_usart_tx_msg_t* Pointer to the reserved slot, or NULL if the queue is full
+ */
+
+static fsm_usart_tx_msg_t *_tx_queue_push(fsm_usart_t *p_fsm, uint32_t length, fsm_usart_tx_cb_t cb, void *p_arg)
+{
+    if (p_fsm->tx_count >= USART_TX_QUEUE_LENGTH)
+    {
+        p_fsm->tx_stats.messages_dropped++;
+        return NULL;
+    }
+    uint8_t idx = (p_fsm->tx_head + p_fsm->tx_count) % USART_TX_QUEUE_LENGTH;
+    fsm_usart_tx_msg_t *p_msg = &p_fsm->tx_queue[idx];
+    p_msg->length = length;
+    p_msg->cb = cb;
+    p_msg->p_arg = p_arg;
+    p_fsm->tx_count++;
+    p_fsm->tx_stats.messages_queued++;
+    p_fsm->tx_stats.depth = p_fsm->tx_count;
+    if (p_fsm->tx_count > p_fsm->tx_stats.max_depth)
+    {
+        p_fsm->tx_stats.max_depth = p_fsm->tx_count;
+    }
+    return p_msg;
+}
+
 /* State machine input or transition functions */
 
 /**
- * @brief Checks if data have been received.
+ * @brief Checks if data have been received. Further frames are kept in the RX ring of the PORT layer until the user has reset the current one.
  *
  * @param p_this Pointer to an fsm_t struct than contains an fsm_usart_t.
  * @return true
@@ -26,7 +63,7 @@
 static bool check_data_rx(fsm_t *p_this)
 {
     fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
-    return port_usart_rx_done(p_fsm->usart_id);
+    return !p_fsm->data_received && port_usart_rx_done(p_fsm->usart_id);
 }
 
 /**
@@ -40,7 +77,7 @@ static bool check_data_rx(fsm_t *p_this)
 static bool check_data_tx(fsm_t *p_this)
 {
     fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
-    return (p_fsm->out_data[0] != EMPTY_BUFFER_CONSTANT);
+    return (p_fsm->tx_count > 0);
 }
 
 /**
@@ -58,7 +95,7 @@ static bool check_tx_end(fsm_t *p_this)
 }
 
 /**
- * @brief Gets the data received by the USART that still remains in the internal buffer of the PORT layer.
+ * @brief Gets the oldest frame received by the USART from the RX ring of the PORT layer.
  *
  * @param p_this Pointer to an fsm_t struct than contains an fsm_usart_t struct
  */
@@ -66,14 +103,14 @@ static bool check_tx_end(fsm_t *p_this)
 static void do_get_data_rx(fsm_t *p_this)
 {
     fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
-    port_usart_get_from_input_buffer(p_fsm->usart_id, p_fsm->in_data); 
-    port_usart_reset_input_buffer(p_fsm->usart_id);
+    memset(p_fsm->in_data, EMPTY_BUFFER_CONSTANT, USART_INPUT_BUFFER_LENGTH);
+    p_fsm->in_length = port_usart_get_from_input_buffer(p_fsm->usart_id, p_fsm->in_data);
     p_fsm->data_received = true;
 }
 
 /**
- * @brief Sets the data to be sent by the USART to the internal buffer of the PORT layer.
- * @note The order of write_data and enable_tx_interrupt is important because of how the USART HW and its interrupts work.
+ * @brief Hands the message at the head of the TX queue to the PORT layer and starts the transmission.
+ * @note The PORT layer sends the payload straight from the queue slot, so it is not copied again. The first byte is written by the ISR as soon as the TX interrupt is enabled, so this function never waits for the TXE flag.
  *
  * @param p_this Pointer to an fsm_t struct than contains an fsm_usart_t struct
  */
@@ -81,15 +118,13 @@ static void do_get_data_rx(fsm_t *p_this)
 static void do_set_data_tx(fsm_t *p_this)
 {
     fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
-    port_usart_reset_output_buffer(p_fsm->usart_id);
-    port_usart_copy_to_output_buffer(p_fsm->usart_id,p_fsm->out_data, USART_OUTPUT_BUFFER_LENGTH);
-    while(!port_usart_get_txr_status(p_fsm->usart_id)){}
-    port_usart_write_data(p_fsm->usart_id);
+    fsm_usart_tx_msg_t *p_msg = &p_fsm->tx_queue[p_fsm->tx_head];
+    port_usart_set_output_buffer(p_fsm->usart_id, p_msg->p_data, p_msg->length);
     port_usart_enable_tx_interrupt(p_fsm->usart_id);
 }
 
 /**
- * @brief Finishes the data transmission by resetting the output data in the PORT layer.
+ * @brief Finishes the data transmission: releases the head of the TX queue, resets the output data in the PORT layer and calls the completion callback, if any.
  *
  * @param p_this Pointer to an fsm_t struct than contains an fsm_usart_t struct
  */
@@ -97,8 +132,20 @@ static void do_set_data_tx(fsm_t *p_this)
 static void do_tx_end(fsm_t *p_this)
 {
     fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
+    fsm_usart_tx_msg_t *p_msg = &p_fsm->tx_queue[p_fsm->tx_head];
+    fsm_usart_tx_cb_t cb = p_msg->cb;
+    void *p_arg = p_msg->p_arg;
+
     port_usart_reset_output_buffer(p_fsm->usart_id);
-    memset(p_fsm->out_data, EMPTY_BUFFER_CONSTANT, USART_OUTPUT_BUFFER_LENGTH);
+    METRICS_ADD(USART_TX_BYTES, p_msg->length);
+    p_fsm->tx_head = (p_fsm->tx_head + 1) % USART_TX_QUEUE_LENGTH;
+    p_fsm->tx_count--;
+    p_fsm->tx_stats.depth = p_fsm->tx_count;
+    p_fsm->tx_stats.messages_sent++;
+    if (cb != NULL)
+    {
+        cb(p_this, p_arg);
+    }
 }
 
 static fsm_trans_t 	fsm_trans_usart [] = 
@@ -114,7 +161,7 @@ static fsm_trans_t 	fsm_trans_usart [] =
 
 /**
  * @brief Check if the USART FSM is active, or not.
- * @note The USART is active either when it is in the state SEND_DATA or there is data to be read (indicated as true in the field data_received).
+ * @note The USART is active either when it is in the state SEND_DATA, there are messages waiting in the TX queue, there is data to be read (indicated as true in the field data_received) or there are complete frames waiting in the RX ring of the port.
  *
  * @param p_this Pointer to an fsm_t struct than contains an fsm_usart_t struct
  * @return true
@@ -124,8 +171,7 @@ static fsm_trans_t 	fsm_trans_usart [] =
 bool fsm_usart_check_activity(fsm_t *p_this)
 {
     fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
-    return (p_fsm->f.current_state == SEND_DATA | p_fsm->data_received == true);
-
+    return ((p_fsm->f.current_state == SEND_DATA) || (p_fsm->tx_count > 0) || p_fsm->data_received || port_usart_rx_done(p_fsm->usart_id));
 }
 
 /**
@@ -200,6 +246,7 @@ void fsm_usart_reset_input_data(fsm_t *p_this)
 {
     fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
     memset(p_fsm->in_data, EMPTY_BUFFER_CONSTANT, USART_INPUT_BUFFER_LENGTH);
+    p_fsm->in_length = 0;
     p_fsm->data_received = false;
 }
 
@@ -219,18 +266,161 @@ void fsm_usart_get_in_data(fsm_t *p_this, char *p_data)
 }
 
 /**
- * @brief Set the data to send.
+ * @brief Returns the length of the data received by the USART. Binary frames can contain empty chars, so this is the only way to know their length.
+ *
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_usart_t struct
+ * @return uint32_t Length of the received data in bytes. 0 if there is no data.
+ */
+
+uint32_t fsm_usart_get_in_length(fsm_t *p_this)
+{
+    fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
+    return p_fsm->in_length;
+}
+
+/**
+ * @brief Select the framing of the received data: text lines terminated by END_CHAR_CONSTANT or COBS-encoded, CRC-checked binary frames. Pending received frames are discarded.
+ *
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_usart_t struct
+ * @param framing USART_FRAMING_TEXT or USART_FRAMING_COBS
+ */
+
+void fsm_usart_set_framing(fsm_t *p_this, uint8_t framing)
+{
+    fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
+    port_usart_set_framing(p_fsm->usart_id, framing);
+}
+
+/**
+ * @brief Get the number of received frames that have been discarded because they were corrupted, too long or did not fit in the RX ring.
+ *
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_usart_t struct
+ * @return uint32_t Number of discarded frames
+ */
+
+uint32_t fsm_usart_get_rx_frame_errors(fsm_t *p_this)
+{
+    fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
+    return port_usart_get_rx_frame_errors(p_fsm->usart_id);
+}
+
+/**
+ * @brief Queue a message to send. The payload is copied once into a free slot of the TX queue, so the caller can reuse its buffer right after the call.
+ * @note Only the given number of bytes is sent. No terminator or empty character is added or searched for.
+ *
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_usart_t struct
+ * @param p_data Pointer to the payload to send
+ * @param length Length of the payload in bytes (1 to USART_OUTPUT_BUFFER_LENGTH)
+ * @return true if the message has been queued
+ * @return false if the queue is full or the length is not valid
+ */
+
+bool fsm_usart_set_out_data(fsm_t *p_this, const char *p_data, uint32_t length)
+{
+    fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
+    if ((length == 0) || (length > USART_OUTPUT_BUFFER_LENGTH))
+    {
+        p_fsm->tx_stats.messages_dropped++;
+        return false;
+    }
+    fsm_usart_tx_msg_t *p_msg = _tx_queue_push(p_fsm, length, NULL, NULL);
+    if (p_msg == NULL)
+    {
+        return false;
+    }
+    memcpy(p_msg->buffer, p_data, length);
+    p_msg->p_data = p_msg->buffer;
+    p_fsm->tx_stats.bytes_copied += length;
+    p_fsm->tx_stats.last_bytes_copied = length;
+    return true;
+}
+
+/**
+ * @brief Queue a caller-owned message to send without copying it.
+ * @warning The buffer must not be modified until the completion callback is called.
+ *
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_usart_t struct
+ * @param p_data Pointer to the payload to send
+ * @param length Length of the payload in bytes (at least 1)
+ * @param cb Completion callback, called from the FSM once the message has been sent. It can be NULL.
+ * @param p_arg Argument passed to the completion callback
+ * @return true if the message has been queued
+ * @return false if the queue is full or the length is not valid
+ */
+
+bool fsm_usart_set_out_data_ref(fsm_t *p_this, const char *p_data, uint32_t length, fsm_usart_tx_cb_t cb, void *p_arg)
+{
+    fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
+    if ((length == 0) || (p_data == NULL))
+    {
+        p_fsm->tx_stats.messages_dropped++;
+        return false;
+    }
+    fsm_usart_tx_msg_t *p_msg = _tx_queue_push(p_fsm, length, cb, p_arg);
+    if (p_msg == NULL)
+    {
+        return false;
+    }
+    p_msg->p_data = p_data;
+    p_fsm->tx_stats.last_bytes_copied = 0;
+    return true;
+}
+
+/**
+ * @brief Queue a binary payload to send as a COBS-encoded frame with CRC. The frame is encoded straight into a free slot of the TX queue, so the caller can reuse its buffer right after the call.
+ *
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_usart_t struct
+ * @param p_payload Pointer to the payload to send. It can contain any byte value.
+ * @param length Length of the payload in bytes (1 to USART_FRAME_MAX_PAYLOAD_LENGTH)
+ * @return true if the frame has been queued
+ * @return false if the queue is full or the length is not valid
+ */
+
+bool fsm_usart_send_frame(fsm_t *p_this, const uint8_t *p_payload, uint32_t length)
+{
+    fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
+    if ((length == 0) || (length > USART_FRAME_MAX_PAYLOAD_LENGTH))
+    {
+        p_fsm->tx_stats.messages_dropped++;
+        return false;
+    }
+    fsm_usart_tx_msg_t *p_msg = _tx_queue_push(p_fsm, 0, NULL, NULL);
+    if (p_msg == NULL)
+    {
+        return false;
+    }
+    p_msg->length = cobs_frame_encode(p_payload, length, (uint8_t *)p_msg->buffer, USART_OUTPUT_BUFFER_LENGTH);
+    p_msg->p_data = p_msg->buffer;
+    p_fsm->tx_stats.bytes_copied += p_msg->length;
+    p_fsm->tx_stats.last_bytes_copied = p_msg->length;
+    return true;
+}
+
+/**
+ * @brief Get the statistics of the TX queue.
+ *
+ * @param p_this Pointer to an fsm_t struct than contains an fsm_usart_t struct
+ * @param p_stats Pointer to the struct where the statistics will be copied
+ */
+
+void fsm_usart_get_tx_stats(fsm_t *p_this, fsm_usart_tx_stats_t *p_stats)
+{
+    fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
+    *p_stats = p_fsm->tx_stats;
+}
+
+/**
+ * @brief Reset the statistics of the TX queue. The current depth is kept.
  *
  * @param p_this Pointer to an fsm_t struct than contains an fsm_usart_t struct
- * @param p_data Pointer to an array from where the data will be copied to the out_data array
  */
 
-void fsm_usart_set_out_data(fsm_t *p_this, char *p_data)
+void fsm_usart_reset_tx_stats(fsm_t *p_this)
 {
     fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
-    // Ensure to reset the output data before setting a new one
-    memset(p_fsm->out_data, EMPTY_BUFFER_CONSTANT, USART_OUTPUT_BUFFER_LENGTH);
-    memcpy(p_fsm->out_data, p_data, USART_OUTPUT_BUFFER_LENGTH);
+    memset(&p_fsm->tx_stats, 0, sizeof(fsm_usart_tx_stats_t));
+    p_fsm->tx_stats.depth = p_fsm->tx_count;
+    p_fsm->tx_stats.max_depth = p_fsm->tx_count;
 }
 
 /**
@@ -242,13 +432,17 @@ void fsm_usart_set_out_data(fsm_t *p_this, char *p_data)
  * @attention The user is required to reset the in_data array once it has been read. Otherwise, this value may be misinterpreted by the user, if successive calls are made without having received new data. In such a case we would be reading past information. In order to reset the value, the function fsm_usart_reset_input_data() must be called.
  *
  * @param usart_id Unique USART identifier number
- * @return fsm_t* A pointer to the USART FSM
+ * @return fsm_t* A pointer to the USART FSM, or NULL if the port refuses the USART (the console, see port_usart_init())
  */
 
 fsm_t *fsm_usart_new(uint32_t usart_id)
 {
     fsm_t *p_fsm = malloc(sizeof(fsm_usart_t)); /* Do malloc to reserve memory of all other FSM elements, although it is interpreted as fsm_t (the first element of the structure) */
-    fsm_usart_init(p_fsm, usart_id);
+    if (!fsm_usart_init(p_fsm, usart_id))
+    {
+        free(p_fsm);
+        return NULL;
+    }
     return p_fsm;
 }
 
@@ -257,15 +451,19 @@ fsm_t *fsm_usart_new(uint32_t usart_id)
  *
  * @param p_this Pointer to an fsm_t struct than contains an fsm_usart_t struct
  * @param usart_id
+ * @return true if the HW has been initialized, false if the port refuses the USART (the console, see port_usart_init())
  */
 
-void fsm_usart_init(fsm_t *p_this, uint32_t usart_id)
+bool fsm_usart_init(fsm_t *p_this, uint32_t usart_id)
 {
     fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
     fsm_init(p_this, fsm_trans_usart);
     p_fsm-> usart_id = usart_id;
     p_fsm -> data_received = false; 
     memset(p_fsm->in_data, EMPTY_BUFFER_CONSTANT, USART_INPUT_BUFFER_LENGTH);
-    memset(p_fsm->out_data, EMPTY_BUFFER_CONSTANT, USART_OUTPUT_BUFFER_LENGTH);
-    port_usart_init (usart_id); /* Initialize the button HW */
+    p_fsm->in_length = 0;
+    p_fsm->tx_head = 0;
+    p_fsm->tx_count = 0;
+    memset(&p_fsm->tx_stats, 0, sizeof(fsm_usart_tx_stats_t));
+    return port_usart_init (usart_id); /* Initialize the button HW */
 }
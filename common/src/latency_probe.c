@@ -0,0 +1,189 @@
+/**
+ * @file latency_probe.c
+ * @brief Latency probes: log-scale histograms of the time from a button edge to the action it causes (LED toggle, buzzer start or stop), that can be read on the field through the USART (see the command `latency` of fsm_command.c and tools/latency_cli.py).
+ *
+ * The start of each latency is the timestamp taken with the cycle counter at the entry of the EXTI ISR of the button and queued with the edge (button_edges.h), so the time the edge waits in the queue until the main loop wakes up and fires the FSMs is included. The code is instrumented with LATENCY_PROBE_EDGE() and LATENCY_PROBE_ACTION(): if USE_LATENCY_PROBE is not defined, they expand to nothing and the histograms stay empty.
+ *
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <string.h>
+#include <ctype.h>
+
+/* Other libraries */
+#include "latency_probe.h"
+
+/* Typedefs --------------------------------------------------------------------*/
+
+typedef struct {
+    bool armed; /*Flag to indicate that an edge is waiting for the action*/
+    uint32_t edge_millis; /*System tick of the edge*/
+    uint32_t edge_cycles; /*Cycle counter at the edge*/
+    uint32_t count; /*Latencies recorded*/
+    uint32_t min_us; /*Minimum latency in us*/
+    uint32_t max_us; /*Maximum latency in us*/
+    uint32_t buckets[LATENCY_PROBE_BUCKETS]; /*Buckets of the histogram*/
+} latency_probe_t;
+
+/* Global variables ------------------------------------------------------------*/
+static latency_probe_t probes[LATENCY_PROBES_NUMBER]; /*Probes*/
+
+#define _LATENCY_PROBE_NAME(name) #name,
+static const char *const probes_names[LATENCY_PROBES_NUMBER] = {LATENCY_PROBES(_LATENCY_PROBE_NAME)}; /*Names of the probes, in upper case*/
+
+/* Private functions */
+
+/**
+ * @brief Write a word in little endian, whatever the endianness of the platform.
+ *
+ * @param p_out Pointer to the 4 bytes to write
+ * @param word Word to write
+ */
+
+static void _put_word(uint8_t *p_out, uint32_t word)
+{
+    p_out[0] = (uint8_t)word;
+    p_out[1] = (uint8_t)(word >> 8);
+    p_out[2] = (uint8_t)(word >> 16);
+    p_out[3] = (uint8_t)(word >> 24);
+}
+
+/* Public functions */
+
+/**
+ * @brief Reset all the probes.
+ */
+
+void latency_probe_init(void)
+{
+    memset(probes, 0, sizeof(probes));
+    for (uint32_t i = 0; i < LATENCY_PROBES_NUMBER; i++)
+    {
+        probes[i].min_us = UINT32_MAX;
+    }
+}
+
+/**
+ * @brief Arm all the probes with the timestamp of an edge. It is called by LATENCY_PROBE_EDGE().
+ *
+ * @param millis System tick of the edge
+ * @param cycles Cycle counter at the edge
+ */
+
+void latency_probe_edge(uint32_t millis, uint32_t cycles)
+{
+    for (uint32_t i = 0; i < LATENCY_PROBES_NUMBER; i++)
+    {
+        probes[i].armed = true;
+        probes[i].edge_millis = millis;
+        probes[i].edge_cycles = cycles;
+    }
+}
+
+/**
+ * @brief Record the latency of an action since the edge that armed the probe, and disarm it. Nothing is recorded if the probe is not armed or the edge is older than LATENCY_PROBE_WINDOW_MS. It is called by LATENCY_PROBE_ACTION().
+ *
+ * @param probe Probe (LATENCY_PROBE_<name>)
+ */
+
+void latency_probe_action(uint32_t probe)
+{
+    uint32_t cycles = port_system_get_cycles();
+    latency_probe_t *p_probe = &probes[probe];
+    if (!p_probe->armed)
+    {
+        return;
+    }
+    p_probe->armed = false;
+    if (port_system_get_millis() - p_probe->edge_millis > LATENCY_PROBE_WINDOW_MS)
+    {
+        return; // The cycle counter may have wrapped around, and the action is not a response to the edge anyway
+    }
+    latency_probe_observe(probe, (cycles - p_probe->edge_cycles) / port_system_get_cycles_per_us());
+}
+
+/**
+ * @brief Add a latency to the histogram of a probe.
+ *
+ * @param probe Probe (LATENCY_PROBE_<name>)
+ * @param us Latency in us
+ */
+
+void latency_probe_observe(uint32_t probe, uint32_t us)
+{
+    latency_probe_t *p_probe = &probes[probe];
+    uint32_t bucket = 0;
+    uint32_t value = us >> LATENCY_PROBE_MIN_LOG2;
+    while ((value != 0) && (bucket < LATENCY_PROBE_BUCKETS - 1))
+    {
+        value >>= 1;
+        bucket++;
+    }
+    p_probe->buckets[bucket]++;
+    p_probe->count++;
+    p_probe->min_us = (us < p_probe->min_us) ? us : p_probe->min_us;
+    p_probe->max_us = (us > p_probe->max_us) ? us : p_probe->max_us;
+}
+
+/**
+ * @brief Look up a probe by its index or its name (case insensitive).
+ *
+ * @param p_name Pointer to the index or the name (not NUL-terminated)
+ * @param length Length of the index or the name
+ * @return int32_t Probe, or -1 if there is no such probe
+ */
+
+int32_t latency_probe_lookup(const char *p_name, uint32_t length)
+{
+    if ((length == 1) && (p_name[0] >= '0') && (p_name[0] < '0' + LATENCY_PROBES_NUMBER))
+    {
+        return p_name[0] - '0';
+    }
+    for (uint32_t i = 0; i < LATENCY_PROBES_NUMBER; i++)
+    {
+        const char *p_probe_name = probes_names[i];
+        uint32_t j = 0;
+        while ((j < length) && (p_probe_name[j] != '\0') && (toupper((unsigned char)p_name[j]) == p_probe_name[j]))
+        {
+            j++;
+        }
+        if ((j == length) && (p_probe_name[j] == '\0'))
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Write a snapshot of the histogram of a probe.
+ *
+ * @param probe Probe (LATENCY_PROBE_<name>)
+ * @param p_out Pointer to the buffer where the payload is written
+ * @param size Size of the buffer in bytes
+ * @return uint32_t Length of the payload (LATENCY_PROBE_SNAPSHOT_LENGTH), or 0 if the probe does not exist or the buffer is too small
+ */
+
+uint32_t latency_probe_snapshot(uint32_t probe, uint8_t *p_out, uint32_t size)
+{
+    if ((probe >= LATENCY_PROBES_NUMBER) || (size < LATENCY_PROBE_SNAPSHOT_LENGTH))
+    {
+        return 0;
+    }
+    latency_probe_t *p_probe = &probes[probe];
+    uint32_t length = 0;
+    p_out[length++] = LATENCY_PROBE_FRAME_TYPE;
+    p_out[length++] = (uint8_t)probe;
+    _put_word(&p_out[length], p_probe->count);
+    _put_word(&p_out[length + 4], (p_probe->count > 0) ? p_probe->min_us : 0);
+    _put_word(&p_out[length + 8], p_probe->max_us);
+    length += 12;
+    for (uint32_t b = 0; b < LATENCY_PROBE_BUCKETS; b++, length += 4)
+    {
+        _put_word(&p_out[length], p_probe->buckets[b]);
+    }
+    return length;
+}
@@ -0,0 +1,196 @@
+/**
+ * @file led_pattern.c
+ * @brief LED patterns: tables of duty cycles (breathe, heartbeat, blinks, VU-meter level) that the port plays on the LED at a fixed step without the CPU (see port_led_pattern_start()), and a model of how they are played, used to render them to CSV on the host.
+ *
+ * The tables are computed once, when the pattern is chosen. On the STM32F4 the PWM timer requests a DMA transfer at the start of each step, which copies the next entry of the table to the compare register, so a running pattern costs no CPU time and no interrupts.
+ *
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <stdio.h>
+
+/* Other libraries */
+#include "led_pattern.h"
+
+/* Global variables ------------------------------------------------------------*/
+static const uint16_t heartbeat_shape[LED_PATTERN_HEARTBEAT_MIN_LENGTH] = {1000, 600, 250, 80, 700, 350, 120, 30, 0, 0, 0, 0, 0, 0, 0, 0}; /*Duty cycles of a heartbeat, stretched to the length of the table*/
+
+/* Public functions */
+
+/**
+ * @brief Duty cycle that gives a perceived brightness, with a gamma of 2 (the eye is more sensitive to changes at low brightness).
+ *
+ * @param brightness Perceived brightness, from 0 to LED_PATTERN_DUTY_MAX (greater values are saturated)
+ * @return uint16_t Duty cycle
+ */
+
+uint16_t led_pattern_gamma(uint32_t brightness)
+{
+    if (brightness > LED_PATTERN_DUTY_MAX)
+    {
+        brightness = LED_PATTERN_DUTY_MAX;
+    }
+    return (uint16_t)((brightness * brightness + LED_PATTERN_DUTY_MAX / 2) / LED_PATTERN_DUTY_MAX);
+}
+
+/**
+ * @brief Fill a table with one breath: the brightness rises linearly from off to full at the middle of the table and falls back.
+ *
+ * @param p_duty Table to fill
+ * @param length Length of the table, at least 2
+ * @return uint32_t Steps filled: length, or 0 if the table is too short
+ */
+
+uint32_t led_pattern_breathe(uint16_t *p_duty, uint32_t length)
+{
+    if (length < 2)
+    {
+        return 0;
+    }
+    for (uint32_t i = 0; i < length; i++)
+    {
+        uint32_t distance = (2 * i <= length) ? 2 * i : 2 * (length - i); // Twice the distance to the nearest end of the breath
+        p_duty[i] = led_pattern_gamma(distance * LED_PATTERN_DUTY_MAX / length);
+    }
+    return length;
+}
+
+/**
+ * @brief Fill a table with one heartbeat: a strong beat, a weaker one and a rest until the end of the table.
+ *
+ * @param p_duty Table to fill
+ * @param length Length of the table, at least LED_PATTERN_HEARTBEAT_MIN_LENGTH
+ * @return uint32_t Steps filled: length, or 0 if the table is too short
+ */
+
+uint32_t led_pattern_heartbeat(uint16_t *p_duty, uint32_t length)
+{
+    if (length < LED_PATTERN_HEARTBEAT_MIN_LENGTH)
+    {
+        return 0;
+    }
+    for (uint32_t i = 0; i < length; i++)
+    {
+        p_duty[i] = heartbeat_shape[i * LED_PATTERN_HEARTBEAT_MIN_LENGTH / length];
+    }
+    return length;
+}
+
+/**
+ * @brief Fill a table with n blinks at full brightness. The table ends with the LED off.
+ *
+ * @param p_duty Table to fill
+ * @param length Length of the table
+ * @param n Number of blinks
+ * @param on_steps Steps that the LED is on in each blink
+ * @param off_steps Steps that the LED is off after each blink
+ * @return uint32_t Steps filled: n * (on_steps + off_steps), or 0 if they do not fit in the table
+ */
+
+uint32_t led_pattern_blinks(uint16_t *p_duty, uint32_t length, uint32_t n, uint32_t on_steps, uint32_t off_steps)
+{
+    uint32_t steps = n * (on_steps + off_steps);
+    if ((n == 0) || (on_steps == 0) || (off_steps == 0) || (steps > length))
+    {
+        return 0;
+    }
+    for (uint32_t i = 0; i < steps; i++)
+    {
+        p_duty[i] = ((i % (on_steps + off_steps)) < on_steps) ? LED_PATTERN_DUTY_MAX : 0;
+    }
+    return steps;
+}
+
+/**
+ * @brief Fill a table with a constant brightness proportional to a level, as a VU meter. To follow the level, loop a table of one step and call this function again on it at each new level: it costs a single store.
+ *
+ * @param p_duty Table to fill
+ * @param length Length of the table
+ * @param level Level to show (greater values than level_max are saturated)
+ * @param level_max Level shown at full brightness. It must not be 0
+ * @return uint32_t Steps filled: length
+ */
+
+uint32_t led_pattern_level(uint16_t *p_duty, uint32_t length, uint32_t level, uint32_t level_max)
+{
+    if (level > level_max)
+    {
+        level = level_max;
+    }
+    uint16_t duty = led_pattern_gamma((uint32_t)((uint64_t)level * LED_PATTERN_DUTY_MAX / level_max));
+    for (uint32_t i = 0; i < length; i++)
+    {
+        p_duty[i] = duty;
+    }
+    return length;
+}
+
+/**
+ * @brief Check that a pattern can be played: it has a table of at least one step and its step is in range.
+ *
+ * @param p_pattern Pattern to check
+ * @return true if the pattern can be played
+ * @return false otherwise
+ */
+
+bool led_pattern_is_valid(const led_pattern_t *p_pattern)
+{
+    return (p_pattern != NULL) && (p_pattern->p_duty != NULL) && (p_pattern->length > 0) && (p_pattern->step_ms > 0) && (p_pattern->step_ms <= LED_PATTERN_MAX_STEP_MS);
+}
+
+/**
+ * @brief Duty cycle of the LED at a time from the start of a pattern, as the timer plays it.
+ *
+ * @param p_pattern Pattern
+ * @param t_ms Time since the start of the pattern in ms
+ * @return uint16_t Duty cycle
+ */
+
+uint16_t led_pattern_sample(const led_pattern_t *p_pattern, uint32_t t_ms)
+{
+    uint32_t step = t_ms / p_pattern->step_ms;
+    if (p_pattern->loop)
+    {
+        step %= p_pattern->length;
+    }
+    else if (step >= p_pattern->length)
+    {
+        step = p_pattern->length - 1;
+    }
+    return p_pattern->p_duty[step];
+}
+
+/**
+ * @brief Render a pattern to a CSV of duty cycle versus time: a header LED_PATTERN_CSV_HEADER and a line "t_ms,duty" for each sample. It can be plotted or compared on the host.
+ *
+ * @param p_pattern Pattern to render
+ * @param duration_ms Time rendered in ms
+ * @param resolution_ms Time between two samples in ms. It must not be 0
+ * @param p_buf Buffer for the CSV, ended by a null character
+ * @param size Size of the buffer
+ * @return uint32_t Length of the CSV, or 0 if it does not fit in the buffer
+ */
+
+uint32_t led_pattern_render_csv(const led_pattern_t *p_pattern, uint32_t duration_ms, uint32_t resolution_ms, char *p_buf, uint32_t size)
+{
+    int n = snprintf(p_buf, size, "%s", LED_PATTERN_CSV_HEADER);
+    if ((n < 0) || ((uint32_t)n >= size))
+    {
+        return 0;
+    }
+    uint32_t length = (uint32_t)n;
+    for (uint32_t t = 0; t < duration_ms; t += resolution_ms)
+    {
+        n = snprintf(&p_buf[length], size - length, "%lu,%u\n", (unsigned long)t, (unsigned)led_pattern_sample(p_pattern, t));
+        if ((n < 0) || ((uint32_t)n >= size - length))
+        {
+            p_buf[0] = '\0';
+            return 0;
+        }
+        length += (uint32_t)n;
+    }
+    return length;
+}
@@ -0,0 +1,192 @@
+/**
+ * @file metrics.c
+ * @brief Registry of metrics (counters, gauges and histograms) that can be read on the field through the USART (see the command `metrics` of fsm_command.c and tools/metrics_cli.py).
+ *
+ * The metrics are declared in the tables of metrics.h and updated with the METRICS_*() macros. If USE_METRICS is not defined, the macros expand to nothing and the registry is empty, so the instrumented code costs nothing.
+ *
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <string.h>
+
+/* Other libraries */
+#include "metrics.h"
+
+#ifdef USE_METRICS
+
+/* Global variables ------------------------------------------------------------*/
+volatile uint32_t metrics_counters[METRICS_COUNTERS_NUMBER]; /*Values of the counters*/
+volatile uint32_t metrics_gauges[METRICS_GAUGES_NUMBER]; /*Values of the gauges*/
+static volatile uint32_t metrics_histograms[METRICS_HISTOGRAMS_NUMBER][METRICS_HISTOGRAM_BUCKETS]; /*Buckets of the histograms*/
+static uint64_t idle_cycles; /*Cycles spent in metrics_sleep() since the previous snapshot*/
+static uint32_t last_snapshot_ms; /*System time of the previous snapshot*/
+
+/* Private functions */
+
+/**
+ * @brief Write a word in little endian, whatever the endianness of the platform.
+ *
+ * @param p_out Pointer to the 4 bytes to write
+ * @param word Word to write
+ */
+
+static void _put_word(uint8_t *p_out, uint32_t word)
+{
+    p_out[0] = (uint8_t)word;
+    p_out[1] = (uint8_t)(word >> 8);
+    p_out[2] = (uint8_t)(word >> 16);
+    p_out[3] = (uint8_t)(word >> 24);
+}
+
+#endif
+
+/* Public functions */
+
+/**
+ * @brief Reset all the metrics.
+ */
+
+void metrics_init(void)
+{
+#ifdef USE_METRICS
+    memset((void *)metrics_counters, 0, sizeof(metrics_counters));
+    memset((void *)metrics_gauges, 0, sizeof(metrics_gauges));
+    memset((void *)metrics_histograms, 0, sizeof(metrics_histograms));
+    idle_cycles = 0;
+    last_snapshot_ms = port_system_get_millis();
+#endif
+}
+
+/**
+ * @brief Add a value to a histogram. It is called by METRICS_OBSERVE().
+ *
+ * @param histogram Histogram (METRIC_<name>)
+ * @param value Value to add
+ */
+
+void metrics_observe(uint32_t histogram, uint32_t value)
+{
+#ifdef USE_METRICS
+    uint32_t bucket = 0;
+    value >>= METRICS_HISTOGRAM_MIN_LOG2;
+    while ((value != 0) && (bucket < METRICS_HISTOGRAM_BUCKETS - 1))
+    {
+        value >>= 1;
+        bucket++;
+    }
+    metrics_histograms[histogram][bucket]++;
+#endif
+}
+
+/**
+ * @brief Fire an FSM and count the call and the state change, if any. It is called by METRICS_FSM_FIRE().
+ *
+ * @param p_fsm Pointer to the FSM
+ * @param transitions Counter of the state changes of the FSM (METRIC_TRANSITIONS_<name>)
+ */
+
+void metrics_fsm_fire(fsm_t *p_fsm, uint32_t transitions)
+{
+#ifdef USE_METRICS
+    int state = fsm_get_state(p_fsm);
+    fsm_fire(p_fsm);
+    metrics_counters[METRIC_FSM_FIRES]++;
+    if (fsm_get_state(p_fsm) != state)
+    {
+        metrics_counters[transitions]++;
+    }
+#else
+    fsm_fire(p_fsm);
+#endif
+}
+
+/**
+ * @brief Fire an FSM with its own fire function and count the call and the state change, if any. It is called by METRICS_FSM_FIRE_WITH().
+ *
+ * @param p_fsm Pointer to the FSM
+ * @param fire Function that fires the FSM
+ * @param transitions Counter of the state changes of the FSM (METRIC_TRANSITIONS_<name>)
+ */
+
+void metrics_fsm_fire_with(fsm_t *p_fsm, int (*fire)(fsm_t *), uint32_t transitions)
+{
+#ifdef USE_METRICS
+    int state = fsm_get_state(p_fsm);
+    fire(p_fsm);
+    metrics_counters[METRIC_FSM_FIRES]++;
+    if (fsm_get_state(p_fsm) != state)
+    {
+        metrics_counters[transitions]++;
+    }
+#else
+    fire(p_fsm);
+#endif
+}
+
+/**
+ * @brief Sleep with port_system_sleep() and add the time slept to the idle time. It is called by METRICS_SLEEP().
+ */
+
+void metrics_sleep(void)
+{
+#ifdef USE_METRICS
+    uint32_t start = port_system_get_cycles();
+    port_system_sleep();
+    idle_cycles += port_system_get_cycles() - start;
+#else
+    port_system_sleep();
+#endif
+}
+
+/**
+ * @brief Write a snapshot of all the metrics. The gauge IDLE_PERMILLE is updated first with the idle time since the previous snapshot.
+ *
+ * @param p_out Pointer to the buffer where the payload is written
+ * @param size Size of the buffer in bytes
+ * @return uint32_t Length of the payload (METRICS_SNAPSHOT_LENGTH), or 0 if USE_METRICS is not defined or the buffer is too small
+ */
+
+uint32_t metrics_snapshot(uint8_t *p_out, uint32_t size)
+{
+#ifdef USE_METRICS
+    if (size < METRICS_SNAPSHOT_LENGTH)
+    {
+        return 0;
+    }
+    uint32_t now = port_system_get_millis();
+    uint64_t window_cycles = (uint64_t)(now - last_snapshot_ms) * port_system_get_cycles_per_us() * 1000;
+    if (window_cycles > 0)
+    {
+        uint64_t idle = (idle_cycles < window_cycles) ? idle_cycles : window_cycles;
+        metrics_gauges[METRIC_IDLE_PERMILLE] = (uint32_t)((idle * 1000) / window_cycles);
+        idle_cycles = 0;
+        last_snapshot_ms = now;
+    }
+
+    uint32_t length = 0;
+    p_out[length++] = METRICS_FRAME_TYPE;
+    _put_word(&p_out[length], now);
+    length += 4;
+    for (uint32_t i = 0; i < METRICS_COUNTERS_NUMBER; i++, length += 4)
+    {
+        _put_word(&p_out[length], metrics_counters[i]);
+    }
+    for (uint32_t i = 0; i < METRICS_GAUGES_NUMBER; i++, length += 4)
+    {
+        _put_word(&p_out[length], metrics_gauges[i]);
+    }
+    for (uint32_t i = 0; i < METRICS_HISTOGRAMS_NUMBER; i++)
+    {
+        for (uint32_t b = 0; b < METRICS_HISTOGRAM_BUCKETS; b++, length += 4)
+        {
+            _put_word(&p_out[length], metrics_histograms[i][b]);
+        }
+    }
+    return length;
+#else
+    return 0;
+#endif
+}
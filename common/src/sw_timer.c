@@ -0,0 +1,353 @@
+/**
+ * @file sw_timer.c
+ * @brief Software timers on a hierarchical timing wheel, driven by the system tick and by a single hardware wake-up timer (port_system_wakeup_timer_set()).
+ *
+ * The wheel has SW_TIMER_LEVELS levels of SW_TIMER_SLOTS slots. A timer that expires in less than 32 ms is linked to the slot of level 0 of its expiry tick; one that expires in [32^l, 32^(l+1)) ms, to the slot of level l selected by bits [5l, 5l+5) of its expiry. When the wheel reaches the tick at which a slot of level l starts, the timers of that slot are linked again to a lower level (cascade), until they reach level 0 and expire. Start and stop are O(1): a timer is linked to or unlinked from a doubly linked list. An occupancy bitmap per level gives the next event of the wheel with a count of trailing zeros, so sw_timer_process() jumps straight from one event to the next, and the wake-up timer of the port is programmed only for the nearest one. FSMs are woken up with a callback such as sw_timer_set_flag(), instead of polling their own timeouts.
+ *
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <string.h>
+
+/* Other libraries */
+#include "sw_timer.h"
+#include "port_system.h"
+
+/* Typedefs --------------------------------------------------------------------*/
+
+typedef struct {
+    sw_timer_t *p_slots[SW_TIMER_LEVELS][SW_TIMER_SLOTS]; /*First timer of each slot*/
+    uint32_t occupied[SW_TIMER_LEVELS]; /*Bitmap of the slots of each level that hold timers*/
+    uint32_t now; /*System tick up to which the wheel has been processed*/
+    uint32_t hw_at; /*System tick at which the wake-up timer of the port fires*/
+    bool hw_armed; /*Flag to indicate that the wake-up timer of the port is programmed*/
+    uint32_t hw_updates; /*Times the wake-up timer of the port has been programmed*/
+} sw_timer_wheel_t;
+
+/* Global variables ------------------------------------------------------------*/
+static sw_timer_wheel_t wheel; /*Timing wheel*/
+
+/* Private functions */
+
+/**
+ * @brief Link a timer to the slot of its expiry, relative to the tick of the wheel.
+ *
+ * @param p_timer Pointer to the timer. Its expiry must not be before the tick of the wheel
+ */
+
+static void _link(sw_timer_t *p_timer)
+{
+    uint32_t delta = p_timer->expiry - wheel.now;
+    uint32_t level = (delta == 0) ? 0 : (31U - (uint32_t)__builtin_clz(delta)) / SW_TIMER_SLOT_BITS; // delta is 0 for a timer cascaded at its expiry tick: it expires now
+    if (level >= SW_TIMER_LEVELS)
+    {
+        level = SW_TIMER_LEVELS - 1; // Only if the wheel lags far behind the system tick: the timer is linked again when its slot is cascaded
+    }
+    uint32_t index = (p_timer->expiry >> (level * SW_TIMER_SLOT_BITS)) & (SW_TIMER_SLOTS - 1);
+    sw_timer_t **pp_head = &wheel.p_slots[level][index];
+    p_timer->p_prev = NULL;
+    p_timer->p_next = *pp_head;
+    if (*pp_head != NULL)
+    {
+        (*pp_head)->p_prev = p_timer;
+    }
+    *pp_head = p_timer;
+    wheel.occupied[level] |= 1U << index;
+    p_timer->slot = (uint16_t)(1 + level * SW_TIMER_SLOTS + index);
+}
+
+/**
+ * @brief Unlink a timer from its slot.
+ *
+ * @param p_timer Pointer to the timer. It must be linked
+ */
+
+static void _unlink(sw_timer_t *p_timer)
+{
+    uint32_t level = (p_timer->slot - 1U) / SW_TIMER_SLOTS;
+    uint32_t index = (p_timer->slot - 1U) % SW_TIMER_SLOTS;
+    if (p_timer->p_prev != NULL)
+    {
+        p_timer->p_prev->p_next = p_timer->p_next;
+    }
+    else
+    {
+        wheel.p_slots[level][index] = p_timer->p_next;
+        if (p_timer->p_next == NULL)
+        {
+            wheel.occupied[level] &= ~(1U << index);
+        }
+    }
+    if (p_timer->p_next != NULL)
+    {
+        p_timer->p_next->p_prev = p_timer->p_prev;
+    }
+    p_timer->slot = 0;
+}
+
+/**
+ * @brief Time from the tick of the wheel to its next event: the expiry of the first occupied slot of level 0 or the start of the first occupied slot of an upper level, whichever comes first.
+ *
+ * @return uint32_t Time to the next event in ms, or SW_TIMER_NONE if the wheel is empty
+ */
+
+static uint32_t _next_delta(void)
+{
+    uint32_t next = SW_TIMER_NONE;
+    for (uint32_t level = 0; level < SW_TIMER_LEVELS; level++)
+    {
+        uint32_t occupied = wheel.occupied[level];
+        if (occupied == 0)
+        {
+            continue;
+        }
+        uint32_t shift = level * SW_TIMER_SLOT_BITS;
+        uint32_t index = (wheel.now >> shift) & (SW_TIMER_SLOTS - 1);
+        uint32_t turn = wheel.now & ~((SW_TIMER_SLOTS << shift) - 1); // Tick at which the current turn of the level started
+        uint32_t later = (index == SW_TIMER_SLOTS - 1) ? 0 : occupied & (~0U << (index + 1)); // Slots still ahead in the current turn
+        uint32_t tick = (later != 0) ? turn + ((uint32_t)__builtin_ctz(later) << shift) : turn + (SW_TIMER_SLOTS << shift) + ((uint32_t)__builtin_ctz(occupied) << shift);
+        uint32_t delta = tick - wheel.now;
+        if (delta < next)
+        {
+            next = delta;
+        }
+    }
+    return next;
+}
+
+/**
+ * @brief Move the timers of the slots that start at the tick of the wheel to lower levels, from the upper level down.
+ */
+
+static void _cascade(void)
+{
+    uint32_t top = 1;
+    while ((top < SW_TIMER_LEVELS) && ((wheel.now & ((1U << (top * SW_TIMER_SLOT_BITS)) - 1)) == 0))
+    {
+        top++;
+    }
+    for (uint32_t level = top - 1; level > 0; level--)
+    {
+        uint32_t index = (wheel.now >> (level * SW_TIMER_SLOT_BITS)) & (SW_TIMER_SLOTS - 1);
+        sw_timer_t *p_timer = wheel.p_slots[level][index];
+        wheel.p_slots[level][index] = NULL;
+        wheel.occupied[level] &= ~(1U << index);
+        while (p_timer != NULL)
+        {
+            sw_timer_t *p_next = p_timer->p_next;
+            _link(p_timer);
+            p_timer = p_next;
+        }
+    }
+}
+
+/**
+ * @brief Expire the timers of the slot of level 0 of the tick of the wheel: start the periodic ones again and call the callbacks.
+ *
+ * @return uint32_t Number of timers that have expired
+ */
+
+static uint32_t _expire(void)
+{
+    uint32_t index = wheel.now & (SW_TIMER_SLOTS - 1);
+    uint32_t expired = 0;
+    sw_timer_t *p_timer;
+    while ((p_timer = wheel.p_slots[0][index]) != NULL)
+    {
+        _unlink(p_timer);
+        if (p_timer->period_ms > 0)
+        {
+            p_timer->expiry += p_timer->period_ms; // From the expiry, not from now: the period does not drift
+            _link(p_timer);
+        }
+        if (p_timer->cb != NULL)
+        {
+            p_timer->cb(p_timer->p_arg);
+        }
+        expired++;
+    }
+    return expired;
+}
+
+/**
+ * @brief Program the wake-up timer of the port for the next event of the wheel, if it is not programmed to fire before it.
+ */
+
+static void _update_hw(void)
+{
+    uint32_t delta = _next_delta();
+    if (delta == SW_TIMER_NONE)
+    {
+        return; // Left as it is: a wake-up for nothing is cheaper than stopping it
+    }
+    deadline_t at = deadline_after(wheel.now, delta);
+    if (wheel.hw_armed && deadline_reached(wheel.hw_at, at))
+    {
+        return; // It already fires before the next event
+    }
+    uint32_t now = port_system_get_millis();
+    uint32_t delay = deadline_remaining(at, now);
+    delay = port_system_wakeup_timer_set((delay == 0) ? 1 : delay);
+    wheel.hw_at = deadline_after(now, delay);
+    wheel.hw_armed = true;
+    wheel.hw_updates++;
+}
+
+/* Public functions */
+
+/**
+ * @brief Initialize the timer service: the wheel starts empty at the current system tick. The timers that were running are forgotten, so set them up again.
+ */
+
+void sw_timer_init(void)
+{
+    memset(&wheel, 0, sizeof(wheel));
+    wheel.now = port_system_get_millis();
+    port_system_wakeup_timer_stop();
+}
+
+/**
+ * @brief Set up a timer, stopped, with the function to call when it expires.
+ *
+ * @param p_timer Pointer to the timer. It must live as long as it runs: the wheel links it, it does not copy it
+ * @param cb Function called when the timer expires
+ * @param p_arg Argument of the callback
+ */
+
+void sw_timer_setup(sw_timer_t *p_timer, sw_timer_cb_t cb, void *p_arg)
+{
+    memset(p_timer, 0, sizeof(*p_timer));
+    p_timer->cb = cb;
+    p_timer->p_arg = p_arg;
+}
+
+/**
+ * @brief Start a timer, or restart it if it is running. It is O(1): the timer is linked to the slot of the wheel of its expiry. The wake-up timer of the port is reprogrammed only if the timer expires before the nearest event of the wheel.
+ *
+ * @param p_timer Pointer to the timer, set up with sw_timer_setup()
+ * @param timeout_ms Time from now to the expiry, up to SW_TIMER_MAX_MS. A timeout of 0 expires at the next millisecond
+ * @param period_ms Period with which the timer starts again after each expiry, up to SW_TIMER_MAX_MS, or 0 for a one-shot timer
+ * @return true if the timer has been started
+ * @return false if the timeout or the period is too long
+ */
+
+bool sw_timer_start(sw_timer_t *p_timer, uint32_t timeout_ms, uint32_t period_ms)
+{
+    if ((timeout_ms > SW_TIMER_MAX_MS) || (period_ms > SW_TIMER_MAX_MS))
+    {
+        return false;
+    }
+    sw_timer_stop(p_timer);
+    deadline_t expiry = deadline_after(port_system_get_millis(), timeout_ms);
+    if (deadline_reached(expiry, wheel.now))
+    {
+        expiry = wheel.now + 1; // The tick of the wheel has been processed already: expire at the next one
+    }
+    p_timer->expiry = expiry;
+    p_timer->period_ms = period_ms;
+    _link(p_timer);
+    _update_hw();
+    return true;
+}
+
+/**
+ * @brief Stop a timer. It is O(1): the timer is unlinked from its slot. Nothing happens if it is not running.
+ *
+ * The wake-up timer of the port is not reprogrammed: if the timer was the nearest event, the core wakes up once for nothing.
+ *
+ * @param p_timer Pointer to the timer
+ */
+
+void sw_timer_stop(sw_timer_t *p_timer)
+{
+    if (p_timer->slot != 0)
+    {
+        _unlink(p_timer);
+    }
+}
+
+/**
+ * @brief Check if a timer is running.
+ *
+ * @param p_timer Pointer to the timer
+ * @return true if it is running
+ * @return false if it is stopped or has expired (one-shot)
+ */
+
+bool sw_timer_is_running(const sw_timer_t *p_timer)
+{
+    return p_timer->slot != 0;
+}
+
+/**
+ * @brief Move the wheel up to the current system tick and call the callbacks of the timers that have expired, in order of expiry. Then the wake-up timer of the port is programmed for the next event of the wheel.
+ *
+ * It is called from the main loop, not from an ISR: the callbacks run in its context, so they can start or stop timers and fire FSMs. The cost does not depend on the time elapsed since the last call nor on the number of timers running, only on the timers that expire or move to a lower level of the wheel.
+ *
+ * @return uint32_t Number of timers that have expired
+ */
+
+uint32_t sw_timer_process(void)
+{
+    uint32_t now = port_system_get_millis();
+    if (wheel.hw_armed && deadline_reached(wheel.hw_at, now))
+    {
+        wheel.hw_armed = false;
+    }
+    uint32_t expired = 0;
+    while (deadline_passed(wheel.now, now))
+    {
+        uint32_t delta = _next_delta();
+        if (delta > now - wheel.now)
+        {
+            wheel.now = now; // No event up to now
+            break;
+        }
+        wheel.now += delta;
+        _cascade();
+        expired += _expire();
+    }
+    _update_hw();
+    return expired;
+}
+
+/**
+ * @brief Get the time to the next event of the wheel: the expiry of a timer, or the tick at which the timers of a slot of an upper level move to a lower level. The core can sleep until then.
+ *
+ * @return uint32_t Time to the next event in ms, 0 if sw_timer_process() must be called now, or SW_TIMER_NONE if no timer is running
+ */
+
+uint32_t sw_timer_get_next_ms(void)
+{
+    uint32_t delta = _next_delta();
+    if (delta == SW_TIMER_NONE)
+    {
+        return SW_TIMER_NONE;
+    }
+    return deadline_remaining(deadline_after(wheel.now, delta), port_system_get_millis());
+}
+
+/**
+ * @brief Get the number of times the wake-up timer of the port has been programmed since sw_timer_init().
+ *
+ * @return uint32_t Number of times
+ */
+
+uint32_t sw_timer_get_hw_updates(void)
+{
+    return wheel.hw_updates;
+}
+
+/**
+ * @brief Callback that raises a flag, to wake up an FSM: pass a pointer to a `volatile bool` as the argument of the timer and check it, and clear it, in a check function of the FSM.
+ *
+ * @param p_arg Pointer to the flag (volatile bool)
+ */
+
+void sw_timer_set_flag(void *p_arg)
+{
+    *(volatile bool *)p_arg = true;
+}
@@ -0,0 +1,110 @@
+/**
+ * @file usart_brr.c
+ * @brief Baud rate register computation for USARTs with fractional baud rate generator.
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <stdlib.h>
+/* Other libraries */
+#include "usart_brr.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define BRR_MAX_DIV_OVER16 0xFFFF /*Maximum divider with oversampling by 16: 12-bit mantissa and 4-bit fraction*/
+#define BRR_MAX_DIV_OVER8 0x7FFF  /*Maximum divider with oversampling by 8: 12-bit mantissa and 3-bit fraction*/
+#define BRR_MIN_DIV_OVER16 16     /*Minimum divider with oversampling by 16 (mantissa equal to 1)*/
+#define BRR_MIN_DIV_OVER8 8       /*Minimum divider with oversampling by 8 (mantissa equal to 1)*/
+
+/* Global variables */
+
+/**
+ * @brief Standard baud rates, in increasing order, used to snap a measured baud rate.
+ */
+static const uint32_t standard_baudrates[] = {1200, 2400, 4800, 9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600, 1000000};
+
+/* Public functions */
+
+/**
+ * @brief Compute the BRR register value (mantissa and fraction) and the oversampling mode for a given baud rate.
+ *
+ * With oversampling by 16, USARTDIV = fCK / (16 x baud) and BRR holds USARTDIV with 4 fractional bits, so BRR = fCK / baud.
+ * With oversampling by 8, USARTDIV = fCK / (8 x baud) with 3 fractional bits, so the divider is the same, but its 3 LSBs are the fraction and bit 3 must be kept cleared.
+ *
+ * @param pclk_hz Frequency of the peripheral clock of the USART in Hz
+ * @param baudrate Requested baud rate in bits per second
+ * @param p_brr Pointer to the struct where the configuration is returned
+ * @return true if the baud rate can be achieved with an error lower than USART_BRR_MAX_ERROR_PPM
+ * @return false otherwise. In this case p_brr is still filled in if the divider fits in the register.
+ */
+
+bool usart_brr_compute(uint32_t pclk_hz, uint32_t baudrate, usart_brr_t *p_brr)
+{
+    if ((baudrate == 0) || (pclk_hz == 0))
+    {
+        return false;
+    }
+    uint32_t div = (uint32_t)(((uint64_t)pclk_hz + baudrate / 2) / baudrate);
+
+    if ((div >= BRR_MIN_DIV_OVER16) && (div <= BRR_MAX_DIV_OVER16))
+    {
+        p_brr->over8 = false;
+        p_brr->brr = (uint16_t)div;
+    }
+    else if ((div >= BRR_MIN_DIV_OVER8) && (div < BRR_MIN_DIV_OVER16))
+    {
+        p_brr->over8 = true;
+        p_brr->brr = (uint16_t)(((div >> 3) << 4) | (div & 0x7));
+    }
+    else
+    {
+        return false;
+    }
+    p_brr->actual_baudrate = (pclk_hz + div / 2) / div;
+    p_brr->error_ppm = (int32_t)((((int64_t)p_brr->actual_baudrate - (int64_t)baudrate) * 1000000) / (int64_t)baudrate);
+    return (abs(p_brr->error_ppm) <= USART_BRR_MAX_ERROR_PPM);
+}
+
+/**
+ * @brief Compute the baud rate from the duration of a known number of bits measured on the RX line.
+ *
+ * @param clk_hz Frequency of the counter used for the measurement in Hz
+ * @param cycles Number of counter cycles measured
+ * @param bits Number of bit times contained in the measurement
+ * @return uint32_t Measured baud rate, or 0 if the measurement is not valid
+ */
+
+uint32_t usart_brr_baudrate_from_cycles(uint32_t clk_hz, uint32_t cycles, uint32_t bits)
+{
+    if (cycles == 0)
+    {
+        return 0;
+    }
+    return (uint32_t)(((uint64_t)clk_hz * bits + cycles / 2) / cycles);
+}
+
+/**
+ * @brief Snap a measured baud rate to the closest standard baud rate.
+ *
+ * @param baudrate Measured baud rate
+ * @return uint32_t Closest standard baud rate if it is within USART_BRR_SNAP_TOLERANCE_PPM, the measured baud rate otherwise
+ */
+
+uint32_t usart_brr_snap_standard(uint32_t baudrate)
+{
+    uint32_t n = sizeof(standard_baudrates) / sizeof(standard_baudrates[0]);
+    uint32_t best = baudrate;
+    uint32_t best_diff = UINT32_MAX;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        uint32_t std = standard_baudrates[i];
+        uint32_t diff = (baudrate > std) ? (baudrate - std) : (std - baudrate);
+        if ((diff < best_diff) && ((uint64_t)diff * 1000000 <= (uint64_t)std * USART_BRR_SNAP_TOLERANCE_PPM))
+        {
+            best = std;
+            best_diff = diff;
+        }
+    }
+    return best;
+}
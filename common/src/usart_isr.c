@@ -0,0 +1,67 @@
+/**
+ * @file usart_isr.c
+ * @brief Dispatch of the USART interrupts: the peripheral that raised an interrupt is mapped to the USART ID that uses it, and the events to serve are decoded from its registers.
+ *
+ * The flags of SR and their interrupt enables of CR1 are at the same bit positions, so the events to serve are the bits set in both registers. The functions only take register values, so the dispatch is tested on any platform against modelled registers.
+ *
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Other libraries */
+#include "usart_isr.h"
+
+/* Public functions */
+
+/**
+ * @brief Route the interrupts of a USART peripheral to a USART ID.
+ *
+ * @param p_table Dispatch table, with one entry per peripheral. A zeroed table routes no peripheral
+ * @param periph Index of the peripheral in the table
+ * @param usart_id USART ID that uses the peripheral
+ */
+
+void usart_isr_route(uint8_t *p_table, uint32_t periph, uint32_t usart_id)
+{
+    p_table[periph] = (uint8_t)(usart_id + 1); // 0 is left for the peripherals that are not routed
+}
+
+/**
+ * @brief Get the USART ID the interrupts of a USART peripheral are routed to.
+ *
+ * @param p_table Dispatch table
+ * @param periph Index of the peripheral in the table
+ * @param p_usart_id Pointer where the USART ID is returned
+ * @return true if the peripheral is routed
+ * @return false if no USART uses the peripheral: its interrupt must be ignored
+ */
+
+bool usart_isr_lookup(const uint8_t *p_table, uint32_t periph, uint32_t *p_usart_id)
+{
+    uint8_t entry = p_table[periph];
+    if (entry == 0)
+    {
+        return false;
+    }
+    *p_usart_id = entry - 1;
+    return true;
+}
+
+/**
+ * @brief Get the events a USART interrupt has to serve, from its status (SR) and control (CR1) registers.
+ *
+ * @param sr Value of SR
+ * @param cr1 Value of CR1
+ * @return uint32_t Mask of USART_ISR_RXNE, USART_ISR_TXE and USART_ISR_TC for the flags that are set and enabled, plus USART_ISR_ORE if a byte has been lost before the one to receive
+ */
+
+uint32_t usart_isr_events(uint32_t sr, uint32_t cr1)
+{
+    uint32_t events = sr & cr1 & (USART_ISR_RXNE | USART_ISR_TXE | USART_ISR_TC);
+    if (events & USART_ISR_RXNE)
+    {
+        events |= sr & USART_ISR_ORE; // Cleared by the read of DR that follows
+    }
+    return events;
+}
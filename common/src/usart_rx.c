@@ -0,0 +1,231 @@
+/**
+ * @file usart_rx.c
+ * @brief RX ring of received frames shared by all the USART ports.
+ *
+ * The ring is single-producer (the RX ISR, or the I/O thread on the native platform) and single-consumer (the USART FSM). The producer writes the frame being received after a reserved length byte and publishes it by moving the commit index once the length has been written, so the consumer never sees partial frames. The indexes are published with release stores and read with acquire loads, so neither the compiler nor the CPU moves the accesses to the ring across them (a DMB on the target).
+ *
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Other libraries */
+#include "usart_rx.h"
+#include "metrics.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define USART_RX_RING_MASK (USART_RX_RING_LENGTH - 1) /*Mask to wrap the free-running indexes*/
+
+/* Private functions */
+
+/**
+ * @brief Append a byte to the frame being received, right after the bytes already stored in the ring.
+ *
+ * @param p_rx Pointer to the RX ring
+ * @param byte Byte to store
+ * @return true if the byte has been stored
+ * @return false if the frame is too long or there is no room left in the ring
+ */
+
+static bool _rx_put(usart_rx_t *p_rx, uint8_t byte)
+{
+    uint32_t idx = p_rx->commit + 1 + p_rx->frame_len; // The byte at commit is reserved for the length
+    if ((p_rx->frame_len >= p_rx->max_len) || (idx - __atomic_load_n(&p_rx->read, __ATOMIC_ACQUIRE) >= USART_RX_RING_LENGTH))
+    {
+        return false;
+    }
+    p_rx->ring[idx & USART_RX_RING_MASK] = byte;
+    p_rx->frame_len++;
+    return true;
+}
+
+/**
+ * @brief Make the frame being received visible to the consumer. Empty frames are ignored.
+ *
+ * @param p_rx Pointer to the RX ring
+ * @param length Length of the frame. It can be lower than the number of bytes stored to drop a trailer (e.g., the CRC).
+ */
+
+static void _rx_commit(usart_rx_t *p_rx, uint32_t length)
+{
+    if (length > 0)
+    {
+        p_rx->ring[p_rx->commit & USART_RX_RING_MASK] = (uint8_t)length;
+        __atomic_store_n(&p_rx->commit, p_rx->commit + 1 + length, __ATOMIC_RELEASE); // Publish the frame only once its length and its bytes have been written
+        p_rx->frames++;
+    }
+    p_rx->frame_len = 0;
+}
+
+/**
+ * @brief Discard the frame being received. Its bytes are released from the ring.
+ *
+ * @param p_rx Pointer to the RX ring
+ */
+
+static void _rx_rollback(usart_rx_t *p_rx)
+{
+    p_rx->frame_len = 0;
+    p_rx->frame_errors++;
+    METRICS_INC_SHARED(USART_RX_ERRORS);
+}
+
+/* Public functions */
+
+/**
+ * @brief Select the framing of an RX ring and flush it. The statistics are kept.
+ *
+ * @warning The producer must not push bytes while this function runs (e.g., disable the RX interrupt).
+ *
+ * @param p_rx Pointer to the RX ring
+ * @param framing USART_FRAMING_TEXT or USART_FRAMING_COBS
+ */
+
+void usart_rx_set_framing(usart_rx_t *p_rx, uint8_t framing)
+{
+    p_rx->framing = framing;
+    if (framing == USART_FRAMING_COBS)
+    {
+        p_rx->max_len = USART_INPUT_BUFFER_LENGTH + COBS_FRAME_CRC_LENGTH; // The CRC is stored and then dropped at commit
+    }
+    else
+    {
+        p_rx->max_len = USART_INPUT_BUFFER_LENGTH - 1; // Keep room for the empty char that terminates the text
+    }
+    p_rx->frame_len = 0;
+    p_rx->discard = false;
+    cobs_decoder_init(&p_rx->decoder, p_rx->max_len);
+    __atomic_store_n(&p_rx->read, __atomic_load_n(&p_rx->commit, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Push a byte received from the link. The frame being received is written straight into the ring (decoded on the fly in COBS framing). It is committed when its terminator arrives, or rolled back if it is corrupted or it does not fit.
+ *
+ * This function runs in constant time. It is called by the producer only (the RX ISR of the port).
+ *
+ * @param p_rx Pointer to the RX ring
+ * @param byte Byte received
+ */
+
+void usart_rx_push(usart_rx_t *p_rx, uint8_t byte)
+{
+    METRICS_INC_SHARED(USART_RX_BYTES);
+    if (p_rx->framing == USART_FRAMING_COBS)
+    {
+        uint8_t decoded;
+        bool decoded_valid;
+        cobs_frame_status_t status = cobs_decoder_push(&p_rx->decoder, byte, &decoded, &decoded_valid);
+        if (decoded_valid && !_rx_put(p_rx, decoded))
+        {
+            cobs_decoder_abort(&p_rx->decoder);
+        }
+        if (status == COBS_FRAME_OK)
+        {
+            _rx_commit(p_rx, p_rx->frame_len - COBS_FRAME_CRC_LENGTH);
+        }
+        else if (status == COBS_FRAME_ERROR)
+        {
+            _rx_rollback(p_rx);
+        }
+        return;
+    }
+
+    if (byte == END_CHAR_CONSTANT)
+    {
+        if (p_rx->discard)
+        {
+            p_rx->discard = false;
+            _rx_rollback(p_rx);
+        }
+        else
+        {
+            _rx_commit(p_rx, p_rx->frame_len);
+        }
+    }
+    else if (!p_rx->discard && !_rx_put(p_rx, byte))
+    {
+        p_rx->discard = true; // Wait for the end char to resynchronize
+    }
+}
+
+/**
+ * @brief Check if there is, at least, one complete frame in the ring.
+ *
+ * @param p_rx Pointer to the RX ring
+ * @return true
+ * @return false
+ */
+
+bool usart_rx_available(const usart_rx_t *p_rx)
+{
+    return p_rx->read != __atomic_load_n(&p_rx->commit, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Get the number of bytes of the ring in use: the complete frames, with their length bytes, and the frame being received. It is used to drive the RTS line (see USART_RX_RTS_HIGH_WATER).
+ *
+ * @param p_rx Pointer to the RX ring
+ * @return uint32_t Number of bytes in use
+ */
+
+uint32_t usart_rx_get_used(const usart_rx_t *p_rx)
+{
+    return p_rx->commit + 1 + p_rx->frame_len - p_rx->read;
+}
+
+/**
+ * @brief Model of the mute mode of the USART receiver with wakeup by address mark (WAKE = 1): decide if a 9-bit word received from a multi-drop bus reaches the RX ring.
+ *
+ * A word with USART_ADDRESS_MARK set mutes the receiver unless it carries its own address, in which case it wakes up. The data words are received only while it is awake. The address word itself is never data. On the target this is done by the hardware: this function is used where there is none (native platform, bus simulations).
+ *
+ * @param p_muted Pointer to the mute flag of the receiver (RWU). It is updated by the address words
+ * @param address Address of the receiver
+ * @param word Word received, with USART_ADDRESS_MARK set if it is an address
+ * @return true if the word is data for this receiver
+ * @return false if it is discarded
+ */
+
+bool usart_rx_wakeup(bool *p_muted, uint8_t address, uint16_t word)
+{
+    if (word & USART_ADDRESS_MARK)
+    {
+        *p_muted = ((word ^ address) & USART_ADDRESS_MASK) != 0;
+        return false;
+    }
+    return !*p_muted;
+}
+
+/**
+ * @brief Copy the oldest complete frame and release it from the ring. It is called by the consumer only.
+ *
+ * @param p_rx Pointer to the RX ring
+ * @param p_buffer Pointer to the buffer where the frame is copied. It must be USART_INPUT_BUFFER_LENGTH bytes long.
+ * @return uint32_t Length of the frame in bytes. 0 if there was no frame.
+ */
+
+uint32_t usart_rx_pop(usart_rx_t *p_rx, char *p_buffer)
+{
+    uint32_t read = p_rx->read;
+    if (read == __atomic_load_n(&p_rx->commit, __ATOMIC_ACQUIRE))
+    {
+        return 0;
+    }
+    uint32_t length = p_rx->ring[read & USART_RX_RING_MASK];
+    for (uint32_t i = 0; i < length; i++)
+    {
+        p_buffer[i] = (char)p_rx->ring[(read + 1 + i) & USART_RX_RING_MASK];
+    }
+    __atomic_store_n(&p_rx->read, read + 1 + length, __ATOMIC_RELEASE); // Release the frame once it has been copied
+    return length;
+}
+
+/**
+ * @brief Discard all the complete frames of the ring. It is called by the consumer only.
+ *
+ * @param p_rx Pointer to the RX ring
+ */
+
+void usart_rx_flush(usart_rx_t *p_rx)
+{
+    __atomic_store_n(&p_rx->read, __atomic_load_n(&p_rx->commit, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+}
@@ -0,0 +1,126 @@
+/**
+ * @file port_button.h
+ * @brief Header for port_button.c file (native platform).
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+#ifndef PORT_BUTTON_H_
+#define PORT_BUTTON_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include "port_system.h"
+#include "button_edges.h"
+#include "button_scan.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define BUTTON_0_ID 0                 /*Button identifier*/
+#define BUTTON_0_PIN 13               /*Line of the button. Kept for compatibility with the target*/
+#define BUTTON_0_DEBOUNCE_TIME_MS 150 /*Debounce time of the button in ms*/
+#define BUTTONS_NUMBER 1              /*Number of elements of the buttons_arr[] array*/
+#define BUTTON_SCAN_PERIOD_MS 5       /*Sampling period of the scan debounce*/
+
+/* Typedefs --------------------------------------------------------------------*/
+
+typedef struct
+{
+    uint8_t pin; /*Line of the button*/
+    bool flag_pressed; /*Flag to indicate that the button is pressed. It is written by the tests or by the host application*/
+    bool timer_debounce; /*Flag to indicate that the button is debounced by the port (model of the EXTI and the one-shot timer of the target) instead of the FSM*/
+    uint32_t debounce_ms; /*Debounce time of the timer debounce in ms*/
+    bool scan_debounce; /*Flag to indicate that the button is debounced by the port with the model of the scan of the target*/
+    bool debounced; /*Debounced state of the button in timer or scan debounce mode*/
+    bool last_level; /*Level of flag_pressed when it was last sampled, to detect the edges*/
+    bool timer_running; /*Flag to indicate that the debounce timer is running: the edges are ignored meanwhile*/
+    uint32_t timer_start; /*System tick when the debounce timer was started*/
+    uint32_t timer_start_cycles; /*Cycle counter when the debounce timer was started*/
+    button_edges_t edges; /*Timestamped edges of the button. In raw mode they are pushed by the tests or by the host application along with flag_pressed; in timer debounce mode, by the model of the timer*/
+} port_button_hw_t;
+
+/* Global variables */
+
+extern port_button_hw_t buttons_arr[];
+
+/* Function prototypes and explanation -------------------------------------------------*/
+
+/**
+ * @brief Configure the button. It starts released.
+ *
+ * @param button_id Button ID. This index is used to select the element of the buttons_arr[] array
+ */
+
+void port_button_init(uint32_t button_id);
+
+/**
+ * @brief Return the status of the button (pressed or not). In timer or scan debounce mode, it is the debounced state.
+ *
+ * @param button_id Button ID. This index is used to select the element of the buttons_arr[] array
+ * @return true If the button has been pressed
+ * @return false If the button has not been pressed
+ */
+
+bool port_button_is_pressed(uint32_t button_id);
+
+/**
+ * @brief Enable or disable the timer debounce of a given button. The EXTI line and the one-shot timer of the target are modelled with the system tick when port_button_get_event() is called: the first change of flag_pressed starts the timer, the next ones are ignored until it expires, and then the level is sampled.
+ *
+ * @param button_id Button ID. This index is used to select the element of the buttons_arr[] array
+ * @param enable true to debounce with the timer, false to go back to the raw flag
+ * @param debounce_ms Debounce time in ms
+ */
+
+void port_button_set_timer_debounce(uint32_t button_id, bool enable, uint32_t debounce_ms);
+
+/**
+ * @brief Enable or disable the scan debounce of a given button. The periodic scan of the target is modelled with the system tick when port_button_get_event() or port_button_is_debouncing() are called: flag_pressed is taken as the sample of every BUTTON_SCAN_PERIOD_MS elapsed since the last call (up to BUTTON_SCAN_SAMPLES, or only one if it has changed) and all the buttons are debounced at once by button_scan_update().
+ *
+ * @param button_id Button ID. This index is used to select the element of the buttons_arr[] array
+ * @param enable true to debounce with the scan, false to go back to the raw flag
+ */
+
+void port_button_set_scan_debounce(uint32_t button_id, bool enable);
+
+/**
+ * @brief Check if the scan debounce of a given button has an edge to settle.
+ *
+ * @param button_id Button ID. This index is used to select the element of the buttons_arr[] array
+ * @return true if flag_pressed differs from the debounced state
+ * @return false otherwise
+ */
+
+bool port_button_is_debouncing(uint32_t button_id);
+
+/**
+ * @brief Check if the timer or scan debounce has posted a press or release event since the last call, and clear it.
+ *
+ * @param button_id Button ID. This index is used to select the element of the buttons_arr[] array
+ * @return true if the debounced state has changed
+ * @return false otherwise
+ */
+
+bool port_button_get_event(uint32_t button_id);
+
+/**
+ * @brief Take the oldest edge of a given button, with the time when it happened.
+ *
+ * @param button_id Button ID. This index is used to select the element of the buttons_arr[] array
+ * @param p_edge Pointer where the edge is copied
+ * @return true if there was an edge
+ * @return false if there are no edges queued
+ */
+
+bool port_button_get_edge(uint32_t button_id, button_edge_t *p_edge);
+
+/**
+ * @brief Return the count of the system tick in milliseconds.
+ *
+ * @return uint32_t
+ */
+
+uint32_t port_button_get_tick();
+
+#endif
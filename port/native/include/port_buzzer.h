@@ -0,0 +1,83 @@
+/**
+ * @file port_buzzer.h
+ * @brief Header for port_buzzer.c file (native platform).
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+#ifndef PORT_BUZZER_H_
+#define PORT_BUZZER_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* HW dependent includes */
+#include "port_system.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define BUZZER_0_ID 0 /*Buzzer melody player identifier*/
+
+/* Typedefs --------------------------------------------------------------------*/
+
+typedef struct {
+    double frequency_hz; /*Frequency of the note being played. 0 if the buzzer is silent*/
+    uint32_t note_start; /*System tick when the note started*/
+    uint32_t note_duration; /*Duration of the note in ms*/
+    bool timer_running; /*Flag to indicate that the duration of the note is being timed*/
+    bool note_end; /*Flag to indicate that the note has ended*/
+}port_buzzer_hw_t;
+
+/* Global variables */
+
+extern port_buzzer_hw_t buzzers_arr [];
+
+/* Function prototypes and explanation -------------------------------------------------*/
+
+/**
+ * @brief Configure the buzzer melody player. It starts silent.
+ *
+ * @param buzzer_id Buzzer melody player ID. This index is used to select the element of the buzzers_arr[] array
+ */
+
+void port_buzzer_init (uint32_t buzzer_id);
+
+/**
+ * @brief Set the duration of the note. The note ends once the duration has elapsed, as the timer of the target does.
+ *
+ * @param buzzer_id Buzzer melody player ID. This index is used to select the element of the buzzers_arr[] array
+ * @param duration_ms Duration of the note in ms
+ */
+
+void port_buzzer_set_note_duration (uint32_t buzzer_id, uint32_t duration_ms);
+
+/**
+ * @brief Set the frequency of the note.
+ *
+ * @param buzzer_id Buzzer melody player ID. This index is used to select the element of the buzzers_arr[] array
+ * @param frequency_hz Frequency of the note in Hz
+ */
+
+void port_buzzer_set_note_frequency (uint32_t buzzer_id, double frequency_hz);
+
+/**
+ * @brief Check if the note has ended.
+ *
+ * @param buzzer_id Buzzer melody player ID. This index is used to select the element of the buzzers_arr[] array
+ * @return true If the note has ended
+ * @return false If the note has not ended
+ */
+
+bool port_buzzer_get_note_timeout (uint32_t buzzer_id);
+
+/**
+ * @brief Stop the note being played.
+ *
+ * @param buzzer_id Buzzer melody player ID. This index is used to select the element of the buzzers_arr[] array
+ */
+
+void port_buzzer_stop (uint32_t buzzer_id);
+
+#endif
@@ -0,0 +1,87 @@
+/**
+ * @file port_led.h
+ * @brief Header for port_led.c file (native platform).
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+#ifndef PORT_LED_H_
+#define PORT_LED_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Other includes */
+#include "led_pattern.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define LD2_HW_BLINK true /*!< The LED can be blinked by the (modelled) hardware. Set it to false to blink it by software */
+#define LD2_HW_BLINK_MIN_PERIOD_MS 2 /*!< Minimum blinking period of the hardware blink */
+#define LD2_HW_PATTERN true /*!< The LED can play patterns (led_pattern.h) by the (modelled) hardware. Set it to false to disable the patterns */
+
+/* Function prototypes and explanation -------------------------------------------------*/
+
+/**
+ * @brief Configure the LED. On the native platform the LED is a variable and it starts off.
+ */
+void port_led_gpio_setup(void);
+
+/**
+ * @brief Get the status of the LED.
+ *
+ * @return true if the LED is on
+ * @return false if the LED is off
+ */
+bool port_led_get(void);
+
+/**
+ * @brief Toggle the LED.
+ */
+void port_led_toggle(void);
+
+/**
+ * @brief Blink the LED by hardware. On the native platform the timer is modelled: the state of the LED is computed from the time elapsed since the start of the blink. The blink starts from the current state of the LED. It can be called again to change the period.
+ *
+ * @param period_ms Blinking period in ms (at least LD2_HW_BLINK_MIN_PERIOD_MS)
+ * @return true if the LED blinks by hardware
+ * @return false if the LED cannot blink by hardware: it must be toggled by software
+ */
+bool port_led_blink_start(uint32_t period_ms);
+
+/**
+ * @brief Stop the hardware blink, keeping the current state of the LED.
+ */
+void port_led_blink_stop(void);
+
+/**
+ * @brief Play a pattern on the LED by hardware. On the native platform the PWM timer and the DMA are modelled: the duty cycle is computed from the time elapsed since the start of the pattern (see led_pattern_sample()). It replaces the hardware blink or the pattern that is running, if any.
+ *
+ * @param p_pattern Pattern to play. Its table must stay in memory while it runs
+ * @return true if the pattern is played by hardware
+ * @return false if the pattern is not valid (see led_pattern_is_valid()) or LD2_HW_PATTERN is false
+ */
+bool port_led_pattern_start(const led_pattern_t *p_pattern);
+
+/**
+ * @brief Stop the pattern, with the LED off.
+ */
+void port_led_pattern_stop(void);
+
+/**
+ * @brief Check if a pattern is running: a pattern that does not loop stops after its last step has started.
+ *
+ * @return true if a pattern is running
+ * @return false otherwise
+ */
+bool port_led_pattern_is_running(void);
+
+/**
+ * @brief Get the duty cycle of the LED: the one of the pattern that is played, or the state of the LED otherwise.
+ *
+ * @return uint16_t Duty cycle, from 0 to LED_PATTERN_DUTY_MAX
+ */
+uint16_t port_led_get_duty(void);
+
+#endif // PORT_LED_H_
@@ -0,0 +1,193 @@
+/**
+ * @file port_system.h
+ * @brief Header for port_system.c file (native platform).
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+#ifndef PORT_SYSTEM_H_
+#define PORT_SYSTEM_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define BIT_POS_TO_MASK(x) (0x01 << (x))                    /*!< Convert the index of a bit into a mask by left shifting */
+#define BASE_MASK_TO_POS(m, p) ((m) << (p))                 /*!< Move a mask defined in the LSBs to upper positions by shifting left p bits */
+
+/* GPIOs */
+#define HIGH true /*!< Logic 1 */
+#define LOW false /*!< Logic 0 */
+
+/* Function prototypes and explanation -------------------------------------------------*/
+
+/**
+ * @brief Initialize the time base of the native platform. The millisecond and cycle counters start from 0.
+ *
+ * @retval Init status (always 0)
+ */
+size_t port_system_init(void);
+
+/**
+ * @brief Get the number of milliseconds since the system started. It is computed from CLOCK_MONOTONIC.
+ *
+ * @note It wraps after about 49.7 days: compare the ticks with the functions of deadline.h, not with < or >.
+ *
+ * @return uint32_t
+ */
+uint32_t port_system_get_millis(void);
+
+/**
+ * @brief Sets the number of milliseconds since the system started. The time base keeps running from the given value. The upper half of the 64-bit count is cleared.
+ *
+ * @param ms New number of milliseconds since the system started.
+ */
+void port_system_set_millis(uint32_t ms);
+
+/**
+ * @brief Get the number of milliseconds since the system started, on 64 bits: it does not wrap. The 32-bit count returned by port_system_get_millis() is its lower half and wraps after about 49.7 days, so compare it only with the functions of deadline.h.
+ *
+ * @return uint64_t
+ */
+uint64_t port_system_get_millis64(void);
+
+/**
+ * @brief Sets the 64-bit number of milliseconds since the system started. The time base keeps running from the given value.
+ *
+ * @param ms New number of milliseconds since the system started.
+ */
+void port_system_set_millis64(uint64_t ms);
+
+/**
+ * @brief Get the number of microseconds since the system started. It is computed from CLOCK_MONOTONIC, like port_system_get_millis(), and wraps after about 71.6 minutes: compare the values only with the functions of deadline.h.
+ *
+ * @return uint32_t Number of microseconds
+ */
+uint32_t port_system_get_micros(void);
+
+/**
+ * @brief Wait for some microseconds. The thread sleeps until the deadline with clock_nanosleep().
+ *
+ * @param us Number of microseconds to wait
+ */
+void port_system_delay_us(uint32_t us);
+
+/**
+ * @brief Get the value of the cycle counter. On the native platform a cycle is one nanosecond of CLOCK_MONOTONIC, so the counter wraps around every 4.29 s.
+ *
+ * @return uint32_t Number of nanoseconds
+ */
+uint32_t port_system_get_cycles(void);
+
+/**
+ * @brief Get the number of cycles of port_system_get_cycles() per microsecond, to convert cycle counts into time.
+ *
+ * @return uint32_t 1000 (a cycle is one nanosecond)
+ */
+uint32_t port_system_get_cycles_per_us(void);
+
+/**
+ * @brief Enter a short critical section. There are no interrupts on the native platform: a recursive mutex excludes the other threads of the process instead. Critical sections can be nested.
+ *
+ * @return uint32_t State to pass to port_system_irq_restore() (unused)
+ */
+uint32_t port_system_irq_save(void);
+
+/**
+ * @brief Leave a critical section entered with port_system_irq_save().
+ *
+ * @param state Value returned by port_system_irq_save()
+ */
+void port_system_irq_restore(uint32_t state);
+
+/**
+ * @brief Wait for some milliseconds
+ *
+ * @param ms Number of milliseconds to wait
+ *
+ * @retval None
+ */
+void port_system_delay_ms(uint32_t ms);
+
+/**
+ * @brief Wait for some milliseconds from a time reference.
+ *
+ * @note It also updates the time reference to the system time at return.
+ *
+ * @param p_t Pointer to the time reference
+ * @param ms Number of milliseconds to wait
+ *
+ * @retval None
+ */
+void port_system_delay_until_ms(uint32_t *p_t, uint32_t ms);
+
+/**
+ * @brief Resume the time base. The native time base never stops, so it does nothing.
+ */
+
+void port_system_systick_resume();
+
+/**
+ * @brief Suspend the time base. The native time base never stops, so it does nothing.
+ */
+
+void port_system_systick_suspend();
+
+/**
+ * @brief Program the one-shot wake-up timer of the timer service (sw_timer.h). port_system_sleep() already returns at every millisecond tick on the native platform, so it only reports the delay.
+ *
+ * @param delay_ms Time to the wake-up in ms
+ * @return uint32_t Time to the wake-up actually programmed in ms (delay_ms)
+ */
+uint32_t port_system_wakeup_timer_set(uint32_t delay_ms);
+
+/**
+ * @brief Stop the wake-up timer of the timer service. It does nothing on the native platform.
+ */
+void port_system_wakeup_timer_stop(void);
+
+/**
+ * @brief Enable interrupts of a GPIO line (pin). There are no GPIOs on the native platform, so it does nothing.
+ *
+ * @param pin Pin/line of the GPIO (index from 0 to 15)
+ * @param priority Priority level (from highest priority: 0, to lowest priority: 15)
+ * @param subpriority Subpriority level (from highest priority: 0, to lowest priority: 15)
+ */
+void port_system_gpio_exti_enable(uint8_t pin, uint8_t priority, uint8_t subpriority);
+
+/**
+ * @brief Disable interrupts of a GPIO line (pin). There are no GPIOs on the native platform, so it does nothing.
+ *
+ * @param pin Pin/line of the GPIO (index from 0 to 15)
+ */
+void port_system_gpio_exti_disable(uint8_t pin);
+
+/**
+ * @brief Wait for an interrupt in stop mode. See port_system_sleep().
+ */
+
+void port_system_power_stop();
+
+/**
+ * @brief Wait for an interrupt in sleep mode. See port_system_sleep().
+ */
+
+void port_system_power_sleep();
+
+/**
+ * @brief Wait for an interrupt, like __WFI() does on the target. The thread sleeps until a peripheral of the native port calls port_system_wakeup() or the next millisecond tick arrives.
+ */
+
+void port_system_sleep(void);
+
+/**
+ * @brief Wake up the thread that is waiting in port_system_sleep(). It is the native equivalent of raising an interrupt, and it is called by the I/O thread of the peripherals once they have served an event.
+ */
+
+void port_system_wakeup(void);
+
+#endif /* PORT_SYSTEM_H_ */
@@ -0,0 +1,365 @@
+/**
+ * @file port_usart.h
+ * @brief Header for port_usart.c file (native platform).
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+#ifndef PORT_USART_H_
+#define PORT_USART_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Other includes */
+#include "usart_rx.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+
+#define USART_0_ID 0 /*USART identifier*/
+#define USART_0_BAUDRATE 9600 /*USART default baud rate*/
+#define USART_1_ID 1 /*USART identifier*/
+#define USART_1_BAUDRATE 115200 /*USART default baud rate*/
+#define USART_2_ID 2 /*USART identifier*/
+#define USART_2_BAUDRATE 115200 /*USART default baud rate*/
+#define USART_3_ID 3 /*USART identifier*/
+#define USART_3_BAUDRATE 115200 /*USART default baud rate*/
+#define USART_4_ID 4 /*USART identifier*/
+#define USART_4_BAUDRATE 115200 /*USART default baud rate*/
+#define USARTS_NUMBER 5 /*Number of elements of the usart_arr[] array*/
+#define USART_OUTPUT_BUFFER_LENGTH 100 /*USART output message length*/
+#define USART_PTY_FIFO_LENGTH 256 /*Bytes buffered between the pseudo-terminal and the USART in each direction (the "line")*/
+#define USART_PTY_NAME_LENGTH 64 /*Maximum length of the path of the pseudo-terminal*/
+#define USART_BITS_PER_BYTE 10 /*Bit times per byte on the line: start bit, 8 data bits and stop bit*/
+#define USART_RS485_BITS_PER_WORD 11 /*Bit times per word on the RS-485 bus: start bit, 9 data bits (address mark) and stop bit*/
+#define PRIORITY_2 2             // Kept for compatibility with the target
+#define SUBPRIORITY_0 0           // Kept for compatibility with the target
+
+/* Typedefs --------------------------------------------------------------------*/
+
+typedef struct {
+    int fd_master; /*Master side of the pseudo-terminal, used by the I/O thread. -1 until port_usart_init() is called*/
+    int fd_slave; /*Slave side of the pseudo-terminal. It is kept open so the master does not hang up when the host closes the device*/
+    char pty_name[USART_PTY_NAME_LENGTH]; /*Path of the slave side, to be opened by the host (e.g., /dev/pts/3)*/
+    usart_rx_t rx; /*RX ring of received frames*/
+    uint8_t rx_line[USART_PTY_FIFO_LENGTH]; /*Bytes read from the pseudo-terminal and not received yet*/
+    uint32_t rx_line_head; /*Index of the oldest byte of rx_line*/
+    uint32_t rx_line_count; /*Number of bytes in rx_line*/
+    uint8_t tx_line[USART_PTY_FIFO_LENGTH]; /*Bytes sent and not written to the pseudo-terminal yet*/
+    uint32_t tx_line_head; /*Index of the oldest byte of tx_line*/
+    uint32_t tx_line_count; /*Number of bytes in tx_line*/
+    bool rxne; /*Equivalent of the RXNE flag: a byte can be received*/
+    bool txe; /*Equivalent of the TXE flag: a byte can be sent*/
+    bool rx_interrupt; /*Equivalent of the RXNEIE bit*/
+    bool tx_interrupt; /*Equivalent of the TXEIE bit*/
+    const char * p_tx_data; /*Message being sent. It is owned by the upper layer until write_complete is set*/
+    uint32_t tx_length; /*Length of the message being sent*/
+    uint32_t o_idx; /*Index of the next byte to send*/
+    bool write_complete;
+    uint32_t baudrate; /*Configured baud rate*/
+    bool loopback; /*Flag to send the bytes to the receiver of the same USART instead of the pseudo-terminal*/
+    bool flow_control; /*Flag to indicate that RTS/CTS flow control is enabled*/
+    bool rts_paused; /*Flag to indicate that RTS is deasserted: the bytes of the line are held back until the RX ring is drained*/
+    uint32_t overruns; /*Number of bytes lost because they were not received in time. The pseudo-terminal holds the bytes back instead, so only the RS-485 bus overruns*/
+    bool rs485; /*Flag to indicate that the USART is a node of the simulated multi-drop bus shared by all the USARTs in RS-485 mode, instead of the pseudo-terminal*/
+    uint8_t rs485_address; /*Own address in RS-485 mode*/
+    uint8_t rs485_destination; /*Address sent before each message in RS-485 mode*/
+    bool address_sent; /*Flag to indicate that the address of the message being sent has already been sent*/
+    bool muted; /*Equivalent of the RWU bit: the receiver ignores the bus until its address is sent*/
+    bool byte_pacing; /*Flag to deliver and send one byte per byte time at the configured baud rate. Otherwise bytes go as fast as the host allows*/
+    uint64_t byte_ns; /*Byte time in nanoseconds at the configured baud rate*/
+    uint64_t rx_next_ns; /*CLOCK_MONOTONIC time when the next byte can be received (byte pacing)*/
+    uint64_t tx_next_ns; /*CLOCK_MONOTONIC time when the next byte can be sent (byte pacing)*/
+    uint32_t epoll_events; /*Events of fd_master currently registered in the I/O thread*/
+    bool autobaud_done; /*Flag to indicate that the auto-baud detection has finished*/
+}port_usart_hw_t;
+
+/* Global variables */
+
+extern port_usart_hw_t usart_arr [];
+
+/* Function prototypes and explanation -------------------------------------------------*/
+
+/**
+ * @brief Open the pseudo-terminal of a given USART and register it in the I/O thread. The thread is started by the first call.
+ *
+ * The slave side is set to raw mode. Its path can be read with port_usart_get_pty_name() and opened by the host as a serial port.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return true, since the native platform has no console USART
+ */
+
+bool port_usart_init (uint32_t usart_id);
+
+/**
+ * @brief Get the path of the slave side of the pseudo-terminal of a given USART.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return const char* Path of the device. Empty if the USART has not been initialized or the pseudo-terminal could not be opened.
+ */
+
+const char *port_usart_get_pty_name (uint32_t usart_id);
+
+/**
+ * @brief Enable or disable the byte pacing of a given USART. When it is enabled, each byte is received and sent one byte time (USART_BITS_PER_BYTE bit times at the configured baud rate) after the previous one, as on the target. When it is disabled, bytes go as fast as the host allows.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param enable true to model the byte time
+ */
+
+void port_usart_set_byte_pacing (uint32_t usart_id, bool enable);
+
+/**
+ * @brief Check if the byte pacing of a given USART is enabled, i.e. if its throughput is bound by the baud rate rather than by the host.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return true if each byte takes its byte time
+ * @return false if bytes go as fast as the host allows
+ */
+
+bool port_usart_get_byte_pacing (uint32_t usart_id);
+
+/**
+ * @brief Configure the baud rate of a given USART. It sets the byte time used by the byte pacing.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param baudrate Baud rate in bits per second
+ * @return true if the baud rate has been set
+ * @return false if the baud rate is 0. The previous configuration is kept.
+ */
+
+bool port_usart_set_baudrate (uint32_t usart_id, uint32_t baudrate);
+
+/**
+ * @brief Get the baud rate of a given USART.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return uint32_t Baud rate in bits per second
+ */
+
+uint32_t port_usart_get_baudrate (uint32_t usart_id);
+
+/**
+ * @brief Get the relative error between the achieved and the requested baud rate. Any baud rate is exact on the native platform.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return int32_t Error in parts per million (always 0)
+ */
+
+int32_t port_usart_get_baudrate_error_ppm (uint32_t usart_id);
+
+/**
+ * @brief Start the auto-baud detection of a given USART. There is no line to measure on the native platform, so it finishes at once and the configured baud rate is kept.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ */
+
+void port_usart_autobaud_start (uint32_t usart_id);
+
+/**
+ * @brief Check if the auto-baud detection has finished.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return true
+ * @return false
+ */
+
+bool port_usart_autobaud_done (uint32_t usart_id);
+
+/**
+ * @brief Check if a transmission is complete.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return true
+ * @return false
+ */
+
+bool port_usart_tx_done (uint32_t usart_id);
+
+/**
+ * @brief Check if there is, at least, one complete frame in the RX ring.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return true
+ * @return false
+ */
+
+bool port_usart_rx_done (uint32_t usart_id);
+
+/**
+ * @brief Get the oldest frame received through the USART, store it in the buffer passed as argument and release it from the RX ring.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param p_buffer Pointer to the buffer where the message will be stored. It must be USART_INPUT_BUFFER_LENGTH bytes long.
+ * @return uint32_t Length of the frame in bytes. 0 if there was no frame.
+ */
+
+uint32_t port_usart_get_from_input_buffer (uint32_t usart_id, char *p_buffer);
+
+/**
+ * @brief Select the framing of the received data. The RX ring is flushed.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param framing USART_FRAMING_TEXT or USART_FRAMING_COBS
+ */
+
+void port_usart_set_framing (uint32_t usart_id, uint8_t framing);
+
+/**
+ * @brief Get the number of received frames that have been discarded because they were corrupted, too long or did not fit in the RX ring.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return uint32_t Number of discarded frames
+ */
+
+uint32_t port_usart_get_rx_frame_errors (uint32_t usart_id);
+
+/**
+ * @brief Check if the USART is ready to send a new byte.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return true
+ * @return false
+ */
+
+bool port_usart_get_txr_status (uint32_t usart_id);
+
+/**
+ * @brief Connect the receiver of a given USART to its own transmitter, so every byte sent is received back, as a TX-RX jumper does. The pseudo-terminal is not used meanwhile.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param enable true to loop back, false to go back to the pseudo-terminal
+ */
+
+void port_usart_set_loopback (uint32_t usart_id, bool enable);
+
+/**
+ * @brief Enable or disable the RTS/CTS flow control of a given USART. RTS follows the occupancy of the RX ring as on the target: it is deasserted above USART_RX_RTS_HIGH_WATER bytes and asserted again below USART_RX_RTS_LOW_WATER bytes. While it is deasserted, the bytes of the line are held back as a sender that honors CTS would do (in loopback, the transmitter of the same USART stops).
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param enable true to enable the flow control, false to disable it
+ * @return true
+ */
+
+bool port_usart_set_flow_control (uint32_t usart_id, bool enable);
+
+/**
+ * @brief Get the number of received bytes lost because they were not received in time (overrun error). The pseudo-terminal never overruns: the bytes wait in it until the USART can receive them. The RS-485 bus does when the RX line of a node is full.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return uint32_t Number of overruns
+ */
+
+uint32_t port_usart_get_overruns (uint32_t usart_id);
+
+/**
+ * @brief Make a given USART a node of the simulated multi-drop RS-485 bus, or go back to the pseudo-terminal.
+ *
+ * All the USARTs in RS-485 mode share one bus: each word sent by one of them reaches the receivers of the rest. Each message is preceded by the address of its destination (see port_usart_set_rs485_destination()), sent as a word with USART_ADDRESS_MARK set, and the mute mode of the receivers is modelled by usart_rx_wakeup(), so the frames sent to other nodes never reach their RX line. With byte pacing, the byte time accounts for the 9 data bits (USART_RS485_BITS_PER_WORD).
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param enable true to join the bus, false to go back to the pseudo-terminal
+ * @param address Own address of the node on the bus
+ * @return true
+ */
+
+bool port_usart_set_rs485 (uint32_t usart_id, bool enable, uint8_t address);
+
+/**
+ * @brief Select the node the next messages of a given USART in RS-485 mode are sent to.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param address Address of the destination node
+ */
+
+void port_usart_set_rs485_destination (uint32_t usart_id, uint8_t address);
+
+/**
+ * @brief Set the message to send through the USART. The message is not copied: the I/O thread reads it straight from the given buffer.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param p_data Pointer to the message to send. It must remain valid until the transmission is complete.
+ * @param length Length of the message to send.
+ */
+
+void port_usart_set_output_buffer (uint32_t usart_id, const char *p_data, uint32_t length);
+
+/**
+ * @brief Reset the input buffer of the USART. All the complete frames pending in the RX ring are discarded.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ */
+
+void port_usart_reset_input_buffer (uint32_t usart_id);
+
+/**
+ * @brief Reset the output buffer of the USART.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ */
+
+void port_usart_reset_output_buffer (uint32_t usart_id);
+
+/**
+ * @brief Equivalent of the interrupt service routine of the USARTs: serve the RXNE and TXE events of a given USART. It is called by the I/O thread.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ */
+
+void port_usart_isr (uint32_t usart_id);
+
+/**
+ * @brief Receive the oldest byte of the line and store it in the RX ring.
+ *
+ * This function is called from port_usart_isr() when the RXNE flag is set. The framing of the byte is handled by usart_rx_push().
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ */
+
+void port_usart_store_data (uint32_t usart_id);
+
+/**
+ * @brief Send the next byte of the output message to the line.
+ *
+ * This function is called from port_usart_isr() when the TXE flag is set. Once the last byte has been sent, it disables the TX interrupt and flags the transmission as complete.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ */
+
+void port_usart_write_data (uint32_t usart_id);
+
+/**
+ * @brief Disable USART RX interrupt. The bytes sent by the host wait in the pseudo-terminal meanwhile.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ */
+
+void port_usart_disable_rx_interrupt (uint32_t usart_id);
+
+/**
+ * @brief Disable USART TX interrupts.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ */
+
+void port_usart_disable_tx_interrupt (uint32_t usart_id);
+
+/**
+ * @brief Enable USART RX interrupt.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ */
+
+void port_usart_enable_rx_interrupt (uint32_t usart_id);
+
+/**
+ * @brief Enable USART TX interrupts.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ */
+
+void port_usart_enable_tx_interrupt (uint32_t usart_id);
+
+#endif
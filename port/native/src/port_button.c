@@ -0,0 +1,165 @@
+/**
+ * @file port_button.c
+ * @brief Portable functions to interact with the button FSM library on the native platform. The status of the button is written by the tests or by the host application.
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* HW dependent includes */
+#include "port_button.h"
+
+/* Global variables ------------------------------------------------------------*/
+port_button_hw_t buttons_arr[] = {
+    [BUTTON_0_ID] = {.pin = BUTTON_0_PIN, .flag_pressed = false, .timer_debounce = false, .debounce_ms = BUTTON_0_DEBOUNCE_TIME_MS, .scan_debounce = false, .debounced = false, .last_level = false, .timer_running = false, .timer_start = 0, .timer_start_cycles = 0},
+};
+
+_Static_assert(sizeof(buttons_arr) / sizeof(buttons_arr[0]) == BUTTONS_NUMBER, "BUTTONS_NUMBER must match the elements of buttons_arr[]");
+
+static button_scan_t scan; /*Debouncer of the buttons in scan debounce mode. Bit n is the button n*/
+static uint32_t scan_lines; /*Buttons in scan debounce mode*/
+static uint32_t scan_last; /*System tick of the last sample*/
+static uint32_t scan_sample; /*Last sample*/
+static uint32_t scan_events; /*Buttons whose debounced state has changed since the last port_button_get_event()*/
+
+/* Private functions */
+
+/**
+ * @brief Take the samples of the scan debounce elapsed since the last call.
+ */
+
+static void _scan(void)
+{
+    uint32_t now = port_system_get_millis();
+    uint32_t samples = (now - scan_last) / BUTTON_SCAN_PERIOD_MS;
+    if ((samples == 0) || (scan_lines == 0))
+    {
+        return;
+    }
+    scan_last += samples * BUTTON_SCAN_PERIOD_MS;
+    uint32_t sample = 0;
+    for (uint32_t button_id = 0; button_id < BUTTONS_NUMBER; button_id++)
+    {
+        sample |= buttons_arr[button_id].flag_pressed ? (1U << button_id) : 0;
+    }
+    sample &= scan_lines;
+    if (sample != scan_sample)
+    {
+        samples = 1; // The level changed at some point since the last sample: take it as recent
+    }
+    samples = (samples < BUTTON_SCAN_SAMPLES) ? samples : BUTTON_SCAN_SAMPLES;
+    scan_sample = sample;
+    for (uint32_t i = 0; i < samples; i++)
+    {
+        uint32_t toggle = button_scan_update(&scan, sample);
+        while (toggle)
+        {
+            uint32_t button_id = __builtin_ctz(toggle);
+            toggle &= toggle - 1;
+            port_button_hw_t *p_hw = &buttons_arr[button_id];
+            p_hw->debounced = (scan.state >> button_id) & 1;
+            button_edges_push(&p_hw->edges, p_hw->debounced, now, port_system_get_cycles());
+            scan_events |= 1U << button_id;
+        }
+    }
+}
+
+/* Public functions */
+
+void port_button_init(uint32_t button_id)
+{
+    buttons_arr[button_id].flag_pressed = false;
+    buttons_arr[button_id].timer_debounce = false;
+    button_edges_flush(&buttons_arr[button_id].edges);
+}
+
+bool port_button_is_pressed(uint32_t button_id)
+{
+    if (buttons_arr[button_id].timer_debounce || buttons_arr[button_id].scan_debounce)
+    {
+        return buttons_arr[button_id].debounced;
+    }
+    return buttons_arr[button_id].flag_pressed;
+}
+
+void port_button_set_timer_debounce(uint32_t button_id, bool enable, uint32_t debounce_ms)
+{
+    port_button_hw_t *p_hw = &buttons_arr[button_id];
+    p_hw->debounce_ms = debounce_ms;
+    p_hw->debounced = p_hw->flag_pressed;
+    p_hw->last_level = p_hw->flag_pressed;
+    p_hw->timer_running = false;
+    p_hw->timer_debounce = enable;
+    if (enable && p_hw->scan_debounce)
+    {
+        port_button_set_scan_debounce(button_id, false);
+    }
+    button_edges_flush(&p_hw->edges);
+}
+
+void port_button_set_scan_debounce(uint32_t button_id, bool enable)
+{
+    port_button_hw_t *p_hw = &buttons_arr[button_id];
+    uint32_t mask = 1U << button_id;
+    if (enable && p_hw->timer_debounce)
+    {
+        port_button_set_timer_debounce(button_id, false, p_hw->debounce_ms);
+    }
+    _scan();
+    button_scan_set(&scan, mask, p_hw->flag_pressed ? mask : 0);
+    scan_sample = (scan_sample & ~mask) | (p_hw->flag_pressed ? mask : 0);
+    scan_lines = enable ? (scan_lines | mask) : (scan_lines & ~mask);
+    scan_events &= ~mask;
+    p_hw->debounced = p_hw->flag_pressed;
+    p_hw->scan_debounce = enable;
+    button_edges_flush(&p_hw->edges);
+}
+
+bool port_button_is_debouncing(uint32_t button_id)
+{
+    port_button_hw_t *p_hw = &buttons_arr[button_id];
+    _scan();
+    return p_hw->scan_debounce && (p_hw->flag_pressed != p_hw->debounced);
+}
+
+bool port_button_get_event(uint32_t button_id)
+{
+    port_button_hw_t *p_hw = &buttons_arr[button_id];
+    if (p_hw->scan_debounce)
+    {
+        _scan();
+        bool event = scan_events & (1U << button_id);
+        scan_events &= ~(1U << button_id);
+        return event;
+    }
+    uint32_t now = port_system_get_millis();
+    if (!p_hw->timer_running && (p_hw->flag_pressed != p_hw->last_level))
+    {
+        p_hw->timer_running = true; // Edge: the EXTI line is masked and the timer started
+        p_hw->timer_start = now;
+        p_hw->timer_start_cycles = port_system_get_cycles();
+    }
+    p_hw->last_level = p_hw->flag_pressed;
+    if (!p_hw->timer_running || (now - p_hw->timer_start < p_hw->debounce_ms))
+    {
+        return false;
+    }
+    p_hw->timer_running = false;
+    if (p_hw->flag_pressed == p_hw->debounced)
+    {
+        return false;
+    }
+    p_hw->debounced = p_hw->flag_pressed;
+    button_edges_push(&p_hw->edges, p_hw->debounced, p_hw->timer_start, p_hw->timer_start_cycles);
+    return true;
+}
+
+bool port_button_get_edge(uint32_t button_id, button_edge_t *p_edge)
+{
+    return button_edges_pop(&buttons_arr[button_id].edges, p_edge);
+}
+
+uint32_t port_button_get_tick()
+{
+    return port_system_get_millis();
+}
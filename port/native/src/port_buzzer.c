@@ -0,0 +1,49 @@
+/**
+ * @file port_buzzer.c
+ * @brief Portable functions to interact with the Buzzer melody player FSM library on the native platform. The timer of the note is modelled with the system tick.
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+/* Includes ------------------------------------------------------------------*/
+/* HW dependent includes */
+#include "port_buzzer.h"
+
+/* Global variables */
+port_buzzer_hw_t buzzers_arr[] = {
+    [BUZZER_0_ID] = {.frequency_hz = 0, .note_start = 0, .note_duration = 0, .timer_running = false, .note_end = true},
+};
+
+void port_buzzer_init(uint32_t buzzer_id)
+{
+    port_buzzer_stop(buzzer_id);
+}
+
+void port_buzzer_set_note_duration(uint32_t buzzer_id, uint32_t duration_ms)
+{
+    buzzers_arr[buzzer_id].note_start = port_system_get_millis();
+    buzzers_arr[buzzer_id].note_duration = duration_ms;
+    buzzers_arr[buzzer_id].timer_running = true;
+    buzzers_arr[buzzer_id].note_end = false;
+}
+
+void port_buzzer_set_note_frequency(uint32_t buzzer_id, double frequency_hz)
+{
+    buzzers_arr[buzzer_id].frequency_hz = frequency_hz;
+}
+
+bool port_buzzer_get_note_timeout(uint32_t buzzer_id)
+{
+    port_buzzer_hw_t *p_hw = &buzzers_arr[buzzer_id];
+    if (p_hw->timer_running && (port_system_get_millis() - p_hw->note_start >= p_hw->note_duration))
+    {
+        p_hw->timer_running = false;
+        p_hw->note_end = true;
+    }
+    return p_hw->note_end;
+}
+
+void port_buzzer_stop(uint32_t buzzer_id)
+{
+    buzzers_arr[buzzer_id].frequency_hz = 0;
+    buzzers_arr[buzzer_id].timer_running = false;
+}
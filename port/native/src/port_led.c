@@ -0,0 +1,101 @@
+/**
+ * @file port_led.c
+ * @brief Portable functions to interact with the LED of the native platform. The LED is modelled as a variable.
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+/* Includes ------------------------------------------------------------------*/
+/* HW dependent includes */
+#include "port_led.h"
+#include "port_system.h"
+
+/* Global variables ------------------------------------------------------------*/
+static bool led_on = false; /*!< Status of the LED. While blinking by hardware, status at the start of the blink */
+static uint32_t blink_period_ms = 0; /*!< Period of the hardware blink. 0 if the LED is not blinking by hardware */
+static uint32_t blink_start_ms; /*!< System time at the start of the hardware blink */
+static const led_pattern_t *p_pattern_running = NULL; /*!< Pattern played by the modelled timer. NULL if there is none */
+static uint32_t pattern_start_ms; /*!< System time at the start of the pattern */
+
+void port_led_gpio_setup(void)
+{
+    led_on = false;
+    blink_period_ms = 0;
+    p_pattern_running = NULL;
+}
+
+bool port_led_get(void)
+{
+    if (p_pattern_running != NULL)
+    {
+        return port_led_get_duty() > 0;
+    }
+    if (blink_period_ms == 0)
+    {
+        return led_on;
+    }
+    uint32_t toggles = (port_system_get_millis() - blink_start_ms) / (blink_period_ms / 2);
+    return (toggles % 2 == 0) ? led_on : !led_on;
+}
+
+void port_led_toggle(void)
+{
+    if ((blink_period_ms == 0) && (p_pattern_running == NULL))
+    {
+        led_on = !led_on;
+    }
+}
+
+bool port_led_blink_start(uint32_t period_ms)
+{
+    if (!LD2_HW_BLINK || (period_ms < LD2_HW_BLINK_MIN_PERIOD_MS))
+    {
+        return false;
+    }
+    led_on = port_led_get();
+    p_pattern_running = NULL; // The blink replaces a pattern
+    blink_start_ms = port_system_get_millis();
+    blink_period_ms = period_ms;
+    return true;
+}
+
+void port_led_blink_stop(void)
+{
+    led_on = port_led_get();
+    blink_period_ms = 0;
+}
+
+bool port_led_pattern_start(const led_pattern_t *p_pattern)
+{
+    if (!LD2_HW_PATTERN || !led_pattern_is_valid(p_pattern))
+    {
+        return false;
+    }
+    blink_period_ms = 0;
+    p_pattern_running = p_pattern;
+    pattern_start_ms = port_system_get_millis();
+    return true;
+}
+
+void port_led_pattern_stop(void)
+{
+    p_pattern_running = NULL;
+    led_on = false;
+}
+
+bool port_led_pattern_is_running(void)
+{
+    if (p_pattern_running == NULL)
+    {
+        return false;
+    }
+    return p_pattern_running->loop || ((port_system_get_millis() - pattern_start_ms) / p_pattern_running->step_ms < p_pattern_running->length - 1);
+}
+
+uint16_t port_led_get_duty(void)
+{
+    if (p_pattern_running != NULL)
+    {
+        return led_pattern_sample(p_pattern_running, port_system_get_millis() - pattern_start_ms);
+    }
+    return port_led_get() ? LED_PATTERN_DUTY_MAX : 0;
+}
@@ -0,0 +1,219 @@
+/**
+ * @file port_system.c
+ * @brief Time base and low power functions of the native platform.
+ *
+ * The millisecond tick and the cycle counter are derived from CLOCK_MONOTONIC. port_system_sleep() models the __WFI() instruction of the target: the caller sleeps until the next tick or until a peripheral of the native port raises an event through port_system_wakeup().
+ *
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <time.h>
+#include <pthread.h>
+
+/* HW dependent libraries */
+#include "port_system.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define NS_PER_US 1000U /*!< Nanoseconds per microsecond */
+#define NS_PER_MS 1000000ULL /*!< Nanoseconds per millisecond */
+#define NS_PER_S 1000000000ULL /*!< Nanoseconds per second */
+
+/* Global variables ------------------------------------------------------------*/
+static uint64_t start_ns = 0; /*!< CLOCK_MONOTONIC time that matches the tick 0 */
+static pthread_mutex_t wakeup_mutex = PTHREAD_MUTEX_INITIALIZER; /*!< Mutex of the wake-up event */
+static pthread_cond_t wakeup_cond; /*!< Condition signaled by port_system_wakeup() */
+static bool wakeup_pending = false; /*!< Event raised while nobody was sleeping */
+static pthread_once_t wakeup_once = PTHREAD_ONCE_INIT; /*!< Initialization of wakeup_cond */
+static pthread_mutex_t irq_mutex; /*!< Recursive mutex of the critical sections */
+static pthread_once_t irq_once = PTHREAD_ONCE_INIT; /*!< Initialization of irq_mutex */
+
+/* Private functions */
+
+/**
+ * @brief Get the CLOCK_MONOTONIC time in nanoseconds.
+ *
+ * @return uint64_t
+ */
+
+static uint64_t _get_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NS_PER_S + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Initialize the wake-up condition on CLOCK_MONOTONIC, so the timeouts are not affected by changes of the wall-clock time.
+ */
+
+static void _wakeup_init(void)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&wakeup_cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+/**
+ * @brief Initialize the recursive mutex of the critical sections.
+ */
+
+static void _irq_init(void)
+{
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&irq_mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+/* Public functions */
+
+size_t port_system_init()
+{
+    pthread_once(&wakeup_once, _wakeup_init);
+    start_ns = _get_ns();
+    return 0;
+}
+
+uint32_t port_system_get_millis()
+{
+    return (uint32_t)port_system_get_millis64();
+}
+
+void port_system_set_millis(uint32_t ms)
+{
+    port_system_set_millis64(ms);
+}
+
+uint64_t port_system_get_millis64()
+{
+    return (_get_ns() - start_ns) / NS_PER_MS;
+}
+
+void port_system_set_millis64(uint64_t ms)
+{
+    start_ns = _get_ns() - ms * NS_PER_MS;
+}
+
+uint32_t port_system_get_micros()
+{
+    return (uint32_t)((_get_ns() - start_ns) / NS_PER_US);
+}
+
+void port_system_delay_us(uint32_t us)
+{
+    uint64_t deadline = _get_ns() + (uint64_t)us * NS_PER_US;
+    struct timespec ts = {.tv_sec = deadline / NS_PER_S, .tv_nsec = deadline % NS_PER_S};
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0)
+    {
+        // Interrupted by a signal: sleep again until the deadline
+    }
+}
+
+uint32_t port_system_get_cycles()
+{
+    return (uint32_t)(_get_ns() - start_ns);
+}
+
+uint32_t port_system_get_cycles_per_us()
+{
+    return NS_PER_US;
+}
+
+uint32_t port_system_irq_save(void)
+{
+    pthread_once(&irq_once, _irq_init);
+    pthread_mutex_lock(&irq_mutex);
+    return 0;
+}
+
+void port_system_irq_restore(uint32_t state)
+{
+    pthread_mutex_unlock(&irq_mutex);
+}
+
+void port_system_delay_ms(uint32_t ms)
+{
+    uint32_t tickstart = port_system_get_millis();
+    port_system_delay_until_ms(&tickstart, ms);
+}
+
+void port_system_delay_until_ms(uint32_t *p_t, uint32_t ms)
+{
+    uint64_t now_ms = port_system_get_millis64();
+    uint64_t until_ms = now_ms - (int32_t)((uint32_t)now_ms - *p_t) + ms; // *p_t in the 64-bit time base, also across the wrap of the 32-bit tick
+    uint64_t deadline = start_ns + until_ms * NS_PER_MS;
+    struct timespec ts = {.tv_sec = deadline / NS_PER_S, .tv_nsec = deadline % NS_PER_S};
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0)
+    {
+        // Interrupted by a signal: sleep again until the deadline
+    }
+    *p_t = port_system_get_millis();
+}
+
+void port_system_systick_resume()
+{
+}
+
+void port_system_systick_suspend()
+{
+}
+
+uint32_t port_system_wakeup_timer_set(uint32_t delay_ms)
+{
+    return delay_ms;
+}
+
+void port_system_wakeup_timer_stop(void)
+{
+}
+
+void port_system_gpio_exti_enable(uint8_t pin, uint8_t priority, uint8_t subpriority)
+{
+}
+
+void port_system_gpio_exti_disable(uint8_t pin)
+{
+}
+
+void port_system_power_stop()
+{
+    port_system_sleep();
+}
+
+void port_system_power_sleep()
+{
+    port_system_sleep();
+}
+
+void port_system_sleep()
+{
+    pthread_once(&wakeup_once, _wakeup_init);
+    uint64_t now = _get_ns();
+    uint64_t tick = now + NS_PER_MS - ((now - start_ns) % NS_PER_MS); // Next millisecond tick
+    struct timespec ts = {.tv_sec = tick / NS_PER_S, .tv_nsec = tick % NS_PER_S};
+    pthread_mutex_lock(&wakeup_mutex);
+    while (!wakeup_pending)
+    {
+        if (pthread_cond_timedwait(&wakeup_cond, &wakeup_mutex, &ts) != 0)
+        {
+            break; // Timeout: the tick "interrupt" wakes up the core
+        }
+    }
+    wakeup_pending = false;
+    pthread_mutex_unlock(&wakeup_mutex);
+}
+
+void port_system_wakeup()
+{
+    pthread_once(&wakeup_once, _wakeup_init);
+    pthread_mutex_lock(&wakeup_mutex);
+    wakeup_pending = true;
+    pthread_cond_signal(&wakeup_cond);
+    pthread_mutex_unlock(&wakeup_mutex);
+}
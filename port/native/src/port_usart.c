@@ -0,0 +1,942 @@
+/**
+ * @file port_usart.c
+ * @brief Portable functions to interact with the USART FSM library on the native platform.
+ *
+ * Each USART is backed by a pseudo-terminal that the host opens as a serial port. A single I/O thread waits with epoll on the master side of all the pseudo-terminals, a timerfd (byte pacing deadlines) and an eventfd (interrupt enable requests). It plays the role of the USART hardware: it fills the RXNE and TXE flags and calls port_usart_isr(), which serves them with the same RX ring and TX logic as the target.
+ *
+ * All the state is protected by a recursive mutex, taken both by the public functions and by the I/O thread around the ISR, so the FSM can run in another thread as if interrupts were disabled while it accesses the port.
+ *
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <termios.h>
+#include <sys/prctl.h>
+#include <pty.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+/* HW dependent libraries */
+#include "port_system.h"
+#include "port_usart.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define NS_PER_S 1000000000ULL /*!< Nanoseconds per second */
+#define USART_NO_DEADLINE UINT64_MAX /*!< No byte pacing deadline pending */
+#define USART_EPOLL_EVENTS (USARTS_NUMBER + 2) /*!< Pseudo-terminals, timerfd and eventfd */
+
+/* Global variables */
+
+port_usart_hw_t usart_arr [USARTS_NUMBER] = {
+    [USART_0_ID] = {.fd_master = -1, .fd_slave = -1, .rx = {.framing = USART_FRAMING_TEXT}, .baudrate = USART_0_BAUDRATE, .loopback = false, .flow_control = false, .rts_paused = false, .overruns = 0, .rs485 = false, .rs485_address = 0, .rs485_destination = 0, .address_sent = false, .muted = false, .byte_pacing = false, .autobaud_done = false,},
+    [USART_1_ID] = {.fd_master = -1, .fd_slave = -1, .rx = {.framing = USART_FRAMING_TEXT}, .baudrate = USART_1_BAUDRATE, .loopback = false, .flow_control = false, .rts_paused = false, .overruns = 0, .rs485 = false, .rs485_address = 0, .rs485_destination = 0, .address_sent = false, .muted = false, .byte_pacing = false, .autobaud_done = false,},
+    [USART_2_ID] = {.fd_master = -1, .fd_slave = -1, .rx = {.framing = USART_FRAMING_TEXT}, .baudrate = USART_2_BAUDRATE, .loopback = false, .flow_control = false, .rts_paused = false, .overruns = 0, .rs485 = false, .rs485_address = 0, .rs485_destination = 0, .address_sent = false, .muted = false, .byte_pacing = false, .autobaud_done = false,},
+    [USART_3_ID] = {.fd_master = -1, .fd_slave = -1, .rx = {.framing = USART_FRAMING_TEXT}, .baudrate = USART_3_BAUDRATE, .loopback = false, .flow_control = false, .rts_paused = false, .overruns = 0, .rs485 = false, .rs485_address = 0, .rs485_destination = 0, .address_sent = false, .muted = false, .byte_pacing = false, .autobaud_done = false,},
+    [USART_4_ID] = {.fd_master = -1, .fd_slave = -1, .rx = {.framing = USART_FRAMING_TEXT}, .baudrate = USART_4_BAUDRATE, .loopback = false, .flow_control = false, .rts_paused = false, .overruns = 0, .rs485 = false, .rs485_address = 0, .rs485_destination = 0, .address_sent = false, .muted = false, .byte_pacing = false, .autobaud_done = false,},
+};
+
+static pthread_mutex_t usart_mutex; /*!< Recursive mutex that protects usart_arr[] */
+static pthread_once_t usart_once = PTHREAD_ONCE_INIT; /*!< Start of the I/O thread */
+static pthread_t usart_thread; /*!< I/O thread */
+static int usart_epoll_fd = -1; /*!< epoll instance of the I/O thread */
+static int usart_timer_fd = -1; /*!< Timer of the byte pacing deadlines */
+static int usart_event_fd = -1; /*!< Wake-up requests for the I/O thread */
+static bool usart_bus_pending = false; /*!< Words have been sent on the RS-485 bus since the USARTs were last served */
+
+/* Private functions */
+
+/**
+ * @brief Get the CLOCK_MONOTONIC time in nanoseconds.
+ *
+ * @return uint64_t
+ */
+
+static uint64_t _get_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NS_PER_S + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Wake up the I/O thread so it serves the new configuration of the USARTs (e.g., an interrupt has been enabled).
+ */
+
+static void _kick(void)
+{
+    uint64_t one = 1;
+    if (usart_event_fd >= 0)
+    {
+        (void)!write(usart_event_fd, &one, sizeof(one));
+    }
+}
+
+/**
+ * @brief Move the TX pacing deadline forward if the line has been idle for longer than a byte time. A line that is just late keeps its deadline, so it catches up without bursts.
+ *
+ * @param p_next_ns Pointer to the deadline
+ * @param now Current time in nanoseconds
+ * @param byte_ns Byte time in nanoseconds
+ */
+
+static void _pace_idle(uint64_t *p_next_ns, uint64_t now, uint64_t byte_ns)
+{
+    if (*p_next_ns + byte_ns < now)
+    {
+        *p_next_ns = now + byte_ns; // The first byte after an idle period takes a whole byte time
+    }
+}
+
+/**
+ * @brief Compute the RXNE and TXE flags of a USART.
+ *
+ * @param p_hw Pointer to the USART HW struct
+ * @param now Current time in nanoseconds
+ * @return true if there is an enabled event to serve
+ * @return false otherwise
+ */
+
+static bool _update_flags(port_usart_hw_t *p_hw, uint64_t now)
+{
+    p_hw->rxne = (p_hw->rx_line_count > 0) && !p_hw->rts_paused && (!p_hw->byte_pacing || now >= p_hw->rx_next_ns);
+    p_hw->txe = (p_hw->tx_line_count < USART_PTY_FIFO_LENGTH) && (!p_hw->byte_pacing || now >= p_hw->tx_next_ns);
+    return (p_hw->rxne && p_hw->rx_interrupt) || (p_hw->txe && p_hw->tx_interrupt);
+}
+
+/**
+ * @brief Drive the RTS line of a USART from the occupancy of its RX ring, with hysteresis between USART_RX_RTS_LOW_WATER and USART_RX_RTS_HIGH_WATER.
+ *
+ * @param p_hw Pointer to the USART HW struct
+ * @return true if RTS has been asserted again, so the I/O thread must serve the bytes held back
+ * @return false otherwise
+ */
+
+static bool _update_rts(port_usart_hw_t *p_hw)
+{
+    uint32_t used = usart_rx_get_used(&p_hw->rx);
+    if (p_hw->flow_control && !p_hw->rts_paused && (used >= USART_RX_RTS_HIGH_WATER))
+    {
+        p_hw->rts_paused = true;
+    }
+    else if (p_hw->rts_paused && (!p_hw->flow_control || (used <= USART_RX_RTS_LOW_WATER)))
+    {
+        p_hw->rts_paused = false;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Check if a USART is connected to its pseudo-terminal: it is not in loopback nor on the RS-485 bus.
+ *
+ * @param p_hw Pointer to the USART HW struct
+ * @return true
+ * @return false
+ */
+
+static bool _uses_pty(const port_usart_hw_t *p_hw)
+{
+    return !p_hw->loopback && !p_hw->rs485;
+}
+
+/**
+ * @brief Send a word on the RS-485 bus: it reaches the RX line of the rest of the USARTs in RS-485 mode that are not muted (see usart_rx_wakeup()). A word that does not fit in a full RX line is lost and counted as an overrun.
+ *
+ * @param p_src Pointer to the HW struct of the USART that sends the word
+ * @param word Word sent, with USART_ADDRESS_MARK set if it is an address
+ */
+
+static void _bus_send(const port_usart_hw_t *p_src, uint16_t word)
+{
+    uint64_t now = _get_ns();
+    for (uint32_t usart_id = 0; usart_id < USARTS_NUMBER; usart_id++)
+    {
+        port_usart_hw_t *p_hw = &usart_arr[usart_id];
+        if ((p_hw == p_src) || !p_hw->rs485 || (p_hw->fd_master < 0) || !usart_rx_wakeup(&p_hw->muted, p_hw->rs485_address, word))
+        {
+            continue;
+        }
+        if (p_hw->rx_line_count >= USART_PTY_FIFO_LENGTH)
+        {
+            p_hw->overruns++;
+            continue;
+        }
+        if ((p_hw->rx_line_count == 0) && (p_hw->rx_next_ns < now + p_hw->byte_ns))
+        {
+            p_hw->rx_next_ns = now + p_hw->byte_ns; // The word takes a whole word time to be received
+        }
+        p_hw->rx_line[(p_hw->rx_line_head + p_hw->rx_line_count) % USART_PTY_FIFO_LENGTH] = (uint8_t)word;
+        p_hw->rx_line_count++;
+    }
+    usart_bus_pending = true;
+}
+
+/**
+ * @brief Read the bytes sent by the host into the RX line of a USART, as long as the RX interrupt is enabled and there is room.
+ *
+ * With byte pacing, bytes that arrive to an empty line start being received now, so the first of them is available one byte time later.
+ *
+ * @param p_hw Pointer to the USART HW struct
+ * @param now Current time in nanoseconds
+ * @return true if some bytes have been read
+ * @return false otherwise
+ */
+
+static bool _fill_rx_line(port_usart_hw_t *p_hw, uint64_t now)
+{
+    bool progress = false;
+    bool was_empty = (p_hw->rx_line_count == 0);
+    while (_uses_pty(p_hw) && p_hw->rx_interrupt && (p_hw->rx_line_count < USART_PTY_FIFO_LENGTH))
+    {
+        uint32_t tail = (p_hw->rx_line_head + p_hw->rx_line_count) % USART_PTY_FIFO_LENGTH;
+        uint32_t room = USART_PTY_FIFO_LENGTH - tail; // Contiguous room up to the end of the line
+        if (tail < p_hw->rx_line_head)
+        {
+            room = p_hw->rx_line_head - tail; // Contiguous room up to the oldest byte
+        }
+        ssize_t n = read(p_hw->fd_master, &p_hw->rx_line[tail], room);
+        if (n <= 0)
+        {
+            break;
+        }
+        p_hw->rx_line_count += (uint32_t)n;
+        progress = true;
+    }
+    if (progress && was_empty && (p_hw->rx_next_ns < now + p_hw->byte_ns))
+    {
+        p_hw->rx_next_ns = now + p_hw->byte_ns;
+    }
+    return progress;
+}
+
+/**
+ * @brief Write the bytes sent by a USART to the host.
+ *
+ * @param p_hw Pointer to the USART HW struct
+ * @return true if some bytes have been written
+ * @return false otherwise
+ */
+
+static bool _flush_tx_line(port_usart_hw_t *p_hw)
+{
+    bool progress = false;
+    while (p_hw->tx_line_count > 0)
+    {
+        uint32_t chunk = USART_PTY_FIFO_LENGTH - p_hw->tx_line_head;
+        if (chunk > p_hw->tx_line_count)
+        {
+            chunk = p_hw->tx_line_count;
+        }
+        ssize_t n = write(p_hw->fd_master, &p_hw->tx_line[p_hw->tx_line_head], chunk);
+        if (n <= 0)
+        {
+            break; // The host is not reading: wait for EPOLLOUT
+        }
+        p_hw->tx_line_head = (p_hw->tx_line_head + (uint32_t)n) % USART_PTY_FIFO_LENGTH;
+        p_hw->tx_line_count -= (uint32_t)n;
+        progress = true;
+    }
+    return progress;
+}
+
+/**
+ * @brief Move the bytes sent by a USART in loopback to its own RX line, as long as there is room. With byte pacing, the bytes have already taken their byte time on the TX side, so they can be received at once.
+ *
+ * @param p_hw Pointer to the USART HW struct
+ * @param now Current time in nanoseconds
+ * @return true if some bytes have been moved
+ * @return false otherwise
+ */
+
+static bool _loop_tx_line(port_usart_hw_t *p_hw, uint64_t now)
+{
+    bool progress = false;
+    if (p_hw->rx_line_count == 0)
+    {
+        p_hw->rx_next_ns = now;
+    }
+    while ((p_hw->tx_line_count > 0) && (p_hw->rx_line_count < USART_PTY_FIFO_LENGTH))
+    {
+        p_hw->rx_line[(p_hw->rx_line_head + p_hw->rx_line_count) % USART_PTY_FIFO_LENGTH] = p_hw->tx_line[p_hw->tx_line_head];
+        p_hw->rx_line_count++;
+        p_hw->tx_line_head = (p_hw->tx_line_head + 1) % USART_PTY_FIFO_LENGTH;
+        p_hw->tx_line_count--;
+        progress = true;
+    }
+    return progress;
+}
+
+/**
+ * @brief Register in the epoll instance the events of the pseudo-terminal that the USART can serve: input while the RX interrupt is enabled and the RX line has room, output while there are bytes waiting to be written.
+ *
+ * @param p_hw Pointer to the USART HW struct
+ */
+
+static void _update_epoll(port_usart_hw_t *p_hw)
+{
+    uint32_t events = 0;
+    if (_uses_pty(p_hw) && p_hw->rx_interrupt && (p_hw->rx_line_count < USART_PTY_FIFO_LENGTH))
+    {
+        events |= EPOLLIN;
+    }
+    if (_uses_pty(p_hw) && (p_hw->tx_line_count > 0))
+    {
+        events |= EPOLLOUT;
+    }
+    if (events != p_hw->epoll_events)
+    {
+        struct epoll_event ev = {.events = events, .data.u32 = (uint32_t)(p_hw - usart_arr)};
+        epoll_ctl(usart_epoll_fd, EPOLL_CTL_MOD, p_hw->fd_master, &ev);
+        p_hw->epoll_events = events;
+    }
+}
+
+/**
+ * @brief Serve all the pending events of a USART: read from the host, run the ISR as long as there are enabled events and write to the host (or to its own RX line in loopback).
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param now Current time in nanoseconds
+ * @return uint64_t Next byte pacing deadline of the USART, or USART_NO_DEADLINE
+ */
+
+static uint64_t _serve(uint32_t usart_id, uint64_t now)
+{
+    port_usart_hw_t *p_hw = &usart_arr[usart_id];
+    bool progress = true;
+    while (progress)
+    {
+        progress = _fill_rx_line(p_hw, now);
+        _pace_idle(&p_hw->tx_next_ns, now, p_hw->byte_ns);
+        while (_update_flags(p_hw, now))
+        {
+            port_usart_isr(usart_id);
+            progress = true;
+        }
+        progress |= p_hw->loopback ? _loop_tx_line(p_hw, now) : _flush_tx_line(p_hw);
+    }
+    _update_epoll(p_hw);
+
+    uint64_t deadline = USART_NO_DEADLINE;
+    if (p_hw->byte_pacing)
+    {
+        if (p_hw->rx_interrupt && (p_hw->rx_line_count > 0))
+        {
+            deadline = p_hw->rx_next_ns;
+        }
+        if (p_hw->tx_interrupt && (p_hw->tx_line_count < USART_PTY_FIFO_LENGTH) && (p_hw->tx_next_ns < deadline))
+        {
+            deadline = p_hw->tx_next_ns;
+        }
+    }
+    return deadline;
+}
+
+/**
+ * @brief Main loop of the I/O thread.
+ *
+ * @param p_arg Not used
+ * @return void* Never returns
+ */
+
+static void *_io_thread(void *p_arg)
+{
+    struct epoll_event events[USART_EPOLL_EVENTS];
+    prctl(PR_SET_TIMERSLACK, 1UL); // Wake up on time for the byte pacing deadlines (the default slack is 50 us)
+    for (;;)
+    {
+        int n = epoll_wait(usart_epoll_fd, events, USART_EPOLL_EVENTS, -1);
+        for (int i = 0; i < n; i++)
+        {
+            uint64_t count;
+            if (events[i].data.u32 >= USARTS_NUMBER)
+            {
+                (void)!read(events[i].data.u32 == USARTS_NUMBER ? usart_timer_fd : usart_event_fd, &count, sizeof(count));
+            }
+        }
+
+        pthread_mutex_lock(&usart_mutex);
+        uint64_t now = _get_ns();
+        uint64_t deadline;
+        do
+        {
+            usart_bus_pending = false;
+            deadline = USART_NO_DEADLINE;
+            for (uint32_t usart_id = 0; usart_id < USARTS_NUMBER; usart_id++)
+            {
+                if (usart_arr[usart_id].fd_master >= 0)
+                {
+                    uint64_t next = _serve(usart_id, now);
+                    deadline = next < deadline ? next : deadline;
+                }
+            }
+        } while (usart_bus_pending); // The words sent on the RS-485 bus may be for USARTs already served
+        struct itimerspec its = {0};
+        if (deadline != USART_NO_DEADLINE)
+        {
+            its.it_value.tv_sec = deadline / NS_PER_S;
+            its.it_value.tv_nsec = deadline % NS_PER_S;
+        }
+        timerfd_settime(usart_timer_fd, TFD_TIMER_ABSTIME, &its, NULL);
+        pthread_mutex_unlock(&usart_mutex);
+
+        port_system_wakeup(); // The "interrupt" wakes up the FSM
+    }
+    return NULL;
+}
+
+/**
+ * @brief Create the mutex, the epoll instance and the I/O thread. It is called once, by the first port_usart_init().
+ */
+
+static void _start_io_thread(void)
+{
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&usart_mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+
+    usart_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    usart_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    usart_event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    struct epoll_event ev = {.events = EPOLLIN, .data.u32 = USARTS_NUMBER};
+    epoll_ctl(usart_epoll_fd, EPOLL_CTL_ADD, usart_timer_fd, &ev);
+    ev.data.u32 = USARTS_NUMBER + 1;
+    epoll_ctl(usart_epoll_fd, EPOLL_CTL_ADD, usart_event_fd, &ev);
+    if (pthread_create(&usart_thread, NULL, _io_thread, NULL) != 0)
+    {
+        perror("port_usart: pthread_create");
+        return;
+    }
+    pthread_detach(usart_thread);
+}
+
+/**
+ * @brief Open the pseudo-terminal of a USART. The slave side is set to raw mode and the master side to non-blocking mode.
+ *
+ * @param p_hw Pointer to the USART HW struct
+ * @return true if the pseudo-terminal is open
+ * @return false otherwise
+ */
+
+static bool _open_pty(port_usart_hw_t *p_hw)
+{
+    if (p_hw->fd_master >= 0)
+    {
+        return true;
+    }
+    if (openpty(&p_hw->fd_master, &p_hw->fd_slave, NULL, NULL, NULL) != 0)
+    {
+        perror("port_usart: openpty");
+        p_hw->fd_master = -1;
+        p_hw->fd_slave = -1;
+        return false;
+    }
+    struct termios tio;
+    tcgetattr(p_hw->fd_slave, &tio);
+    cfmakeraw(&tio); // No echo and no line discipline: bytes go through untouched
+    tcsetattr(p_hw->fd_slave, TCSANOW, &tio);
+    fcntl(p_hw->fd_master, F_SETFL, fcntl(p_hw->fd_master, F_GETFL) | O_NONBLOCK);
+    fcntl(p_hw->fd_master, F_SETFD, FD_CLOEXEC);
+    fcntl(p_hw->fd_slave, F_SETFD, FD_CLOEXEC);
+    snprintf(p_hw->pty_name, sizeof(p_hw->pty_name), "%s", ttyname(p_hw->fd_slave));
+    struct epoll_event ev = {.events = 0, .data.u32 = (uint32_t)(p_hw - usart_arr)};
+    epoll_ctl(usart_epoll_fd, EPOLL_CTL_ADD, p_hw->fd_master, &ev);
+    p_hw->epoll_events = 0;
+    return true;
+}
+
+/* Public functions */
+
+/**
+ * @brief Get the path of the slave side of the pseudo-terminal of a given USART.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return const char* Path of the device. Empty if the USART has not been initialized or the pseudo-terminal could not be opened.
+ */
+
+const char *port_usart_get_pty_name (uint32_t usart_id){
+    return usart_arr[usart_id].pty_name;
+}
+
+/**
+ * @brief Enable or disable the byte pacing of a given USART. When it is enabled, each byte is received and sent one byte time (USART_BITS_PER_BYTE bit times at the configured baud rate) after the previous one, as on the target. When it is disabled, bytes go as fast as the host allows.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param enable true to model the byte time
+ */
+
+void port_usart_set_byte_pacing (uint32_t usart_id, bool enable){
+    pthread_once(&usart_once, _start_io_thread);
+    pthread_mutex_lock(&usart_mutex);
+    usart_arr[usart_id].byte_pacing = enable;
+    usart_arr[usart_id].rx_next_ns = 0;
+    usart_arr[usart_id].tx_next_ns = 0;
+    pthread_mutex_unlock(&usart_mutex);
+    _kick();
+}
+
+/**
+ * @brief Check if the byte pacing of a given USART is enabled, i.e. if its throughput is bound by the baud rate rather than by the host.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return true if each byte takes its byte time
+ * @return false if bytes go as fast as the host allows
+ */
+
+bool port_usart_get_byte_pacing (uint32_t usart_id){
+    return usart_arr[usart_id].byte_pacing;
+}
+
+/**
+ * @brief Configure the baud rate of a given USART. It sets the byte time used by the byte pacing.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param baudrate Baud rate in bits per second
+ * @return true if the baud rate has been set
+ * @return false if the baud rate is 0. The previous configuration is kept.
+ */
+
+bool port_usart_set_baudrate (uint32_t usart_id, uint32_t baudrate){
+    if (baudrate == 0)
+    {
+        return false;
+    }
+    pthread_once(&usart_once, _start_io_thread);
+    pthread_mutex_lock(&usart_mutex);
+    usart_arr[usart_id].baudrate = baudrate;
+    uint64_t bits = usart_arr[usart_id].rs485 ? USART_RS485_BITS_PER_WORD : USART_BITS_PER_BYTE;
+    usart_arr[usart_id].byte_ns = (bits * NS_PER_S + baudrate / 2) / baudrate;
+    pthread_mutex_unlock(&usart_mutex);
+    return true;
+}
+
+/**
+ * @brief Get the baud rate of a given USART.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return uint32_t Baud rate in bits per second
+ */
+
+uint32_t port_usart_get_baudrate (uint32_t usart_id){
+    return usart_arr[usart_id].baudrate;
+}
+
+/**
+ * @brief Get the relative error between the achieved and the requested baud rate. Any baud rate is exact on the native platform.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return int32_t Error in parts per million (always 0)
+ */
+
+int32_t port_usart_get_baudrate_error_ppm (uint32_t usart_id){
+    return 0;
+}
+
+/**
+ * @brief Start the auto-baud detection of a given USART. There is no line to measure on the native platform, so it finishes at once and the configured baud rate is kept.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ */
+
+void port_usart_autobaud_start (uint32_t usart_id){
+    usart_arr[usart_id].autobaud_done = true;
+}
+
+/**
+ * @brief Check if the auto-baud detection has finished.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return true
+ * @return false
+ */
+
+bool port_usart_autobaud_done (uint32_t usart_id){
+    return usart_arr[usart_id].autobaud_done;
+}
+
+/**
+ * @brief Check if a transmission is complete.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return true
+ * @return false
+ */
+
+bool port_usart_tx_done (uint32_t usart_id){
+    pthread_mutex_lock(&usart_mutex);
+    bool done = usart_arr[usart_id].write_complete;
+    pthread_mutex_unlock(&usart_mutex);
+    return done;
+}
+
+/**
+ * @brief Check if there is, at least, one complete frame in the RX ring.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return true
+ * @return false
+ */
+
+bool port_usart_rx_done (uint32_t usart_id){
+    pthread_mutex_lock(&usart_mutex);
+    bool done = usart_rx_available(&usart_arr[usart_id].rx);
+    pthread_mutex_unlock(&usart_mutex);
+    return done;
+}
+
+/**
+ * @brief Get the oldest frame received through the USART, store it in the buffer passed as argument and release it from the RX ring.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param p_buffer Pointer to the buffer where the message will be stored. It must be USART_INPUT_BUFFER_LENGTH bytes long.
+ * @return uint32_t Length of the frame in bytes. 0 if there was no frame.
+ */
+
+uint32_t port_usart_get_from_input_buffer (uint32_t usart_id, char *p_buffer){
+    pthread_mutex_lock(&usart_mutex);
+    uint32_t length = usart_rx_pop(&usart_arr[usart_id].rx, p_buffer);
+    bool resumed = _update_rts(&usart_arr[usart_id]);
+    pthread_mutex_unlock(&usart_mutex);
+    if (resumed)
+    {
+        _kick();
+    }
+    return length;
+}
+
+/**
+ * @brief Select the framing of the received data. The RX ring is flushed.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param framing USART_FRAMING_TEXT or USART_FRAMING_COBS
+ */
+
+void port_usart_set_framing (uint32_t usart_id, uint8_t framing){
+    pthread_mutex_lock(&usart_mutex);
+    usart_rx_set_framing(&usart_arr[usart_id].rx, framing);
+    bool resumed = _update_rts(&usart_arr[usart_id]);
+    pthread_mutex_unlock(&usart_mutex);
+    if (resumed)
+    {
+        _kick();
+    }
+}
+
+/**
+ * @brief Get the number of received frames that have been discarded because they were corrupted, too long or did not fit in the RX ring.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return uint32_t Number of discarded frames
+ */
+
+uint32_t port_usart_get_rx_frame_errors (uint32_t usart_id){
+    return usart_arr[usart_id].rx.frame_errors;
+}
+
+/**
+ * @brief Check if the USART is ready to send a new byte.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return true
+ * @return false
+ */
+
+bool port_usart_get_txr_status (uint32_t usart_id){
+    return usart_arr[usart_id].tx_line_count < USART_PTY_FIFO_LENGTH;
+}
+
+/**
+ * @brief Connect the receiver of a given USART to its own transmitter, so every byte sent is received back, as a TX-RX jumper does. The pseudo-terminal is not used meanwhile.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param enable true to loop back, false to go back to the pseudo-terminal
+ */
+
+void port_usart_set_loopback (uint32_t usart_id, bool enable){
+    pthread_mutex_lock(&usart_mutex);
+    usart_arr[usart_id].loopback = enable;
+    pthread_mutex_unlock(&usart_mutex);
+    _kick();
+}
+
+/**
+ * @brief Enable or disable the RTS/CTS flow control of a given USART. RTS follows the occupancy of the RX ring as on the target: it is deasserted above USART_RX_RTS_HIGH_WATER bytes and asserted again below USART_RX_RTS_LOW_WATER bytes. While it is deasserted, the bytes of the line are held back as a sender that honors CTS would do (in loopback, the transmitter of the same USART stops).
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param enable true to enable the flow control, false to disable it
+ * @return true
+ */
+
+bool port_usart_set_flow_control (uint32_t usart_id, bool enable){
+    pthread_mutex_lock(&usart_mutex);
+    usart_arr[usart_id].flow_control = enable;
+    _update_rts(&usart_arr[usart_id]);
+    pthread_mutex_unlock(&usart_mutex);
+    _kick();
+    return true;
+}
+
+/**
+ * @brief Get the number of received bytes lost because they were not received in time (overrun error). The pseudo-terminal never overruns: the bytes wait in it until the USART can receive them. The RS-485 bus does when the RX line of a node is full.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return uint32_t Number of overruns
+ */
+
+uint32_t port_usart_get_overruns (uint32_t usart_id){
+    return usart_arr[usart_id].overruns;
+}
+
+/**
+ * @brief Make a given USART a node of the simulated multi-drop RS-485 bus, or go back to the pseudo-terminal.
+ *
+ * All the USARTs in RS-485 mode share one bus: each word sent by one of them reaches the receivers of the rest. Each message is preceded by the address of its destination (see port_usart_set_rs485_destination()), sent as a word with USART_ADDRESS_MARK set, and the mute mode of the receivers is modelled by usart_rx_wakeup(), so the frames sent to other nodes never reach their RX line. With byte pacing, the byte time accounts for the 9 data bits (USART_RS485_BITS_PER_WORD).
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param enable true to join the bus, false to go back to the pseudo-terminal
+ * @param address Own address of the node on the bus
+ * @return true
+ */
+
+bool port_usart_set_rs485 (uint32_t usart_id, bool enable, uint8_t address){
+    pthread_mutex_lock(&usart_mutex);
+    port_usart_hw_t *p_hw = &usart_arr[usart_id];
+    p_hw->flow_control = false;
+    _update_rts(p_hw);
+    p_hw->rs485 = enable;
+    p_hw->rs485_address = address & USART_ADDRESS_MASK;
+    p_hw->muted = enable; // Mute until the node is addressed
+    port_usart_set_baudrate(usart_id, p_hw->baudrate); // Word time of the bus
+    pthread_mutex_unlock(&usart_mutex);
+    _kick();
+    return true;
+}
+
+/**
+ * @brief Select the node the next messages of a given USART in RS-485 mode are sent to.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param address Address of the destination node
+ */
+
+void port_usart_set_rs485_destination (uint32_t usart_id, uint8_t address){
+    pthread_mutex_lock(&usart_mutex);
+    usart_arr[usart_id].rs485_destination = address & USART_ADDRESS_MASK;
+    pthread_mutex_unlock(&usart_mutex);
+}
+
+/**
+ * @brief Set the message to send through the USART. The message is not copied: the I/O thread reads it straight from the given buffer.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param p_data Pointer to the message to send. It must remain valid until the transmission is complete.
+ * @param length Length of the message to send.
+ */
+
+void port_usart_set_output_buffer (uint32_t usart_id, const char *p_data, uint32_t length){
+    pthread_mutex_lock(&usart_mutex);
+    usart_arr[usart_id].p_tx_data = p_data;
+    usart_arr[usart_id].tx_length = length;
+    usart_arr[usart_id].o_idx = 0;
+    usart_arr[usart_id].write_complete = false;
+    usart_arr[usart_id].address_sent = false;
+    pthread_mutex_unlock(&usart_mutex);
+}
+
+/**
+ * @brief Reset the input buffer of the USART. All the complete frames pending in the RX ring are discarded.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ */
+
+void port_usart_reset_input_buffer (uint32_t usart_id){
+    pthread_mutex_lock(&usart_mutex);
+    usart_rx_flush(&usart_arr[usart_id].rx);
+    bool resumed = _update_rts(&usart_arr[usart_id]);
+    pthread_mutex_unlock(&usart_mutex);
+    if (resumed)
+    {
+        _kick();
+    }
+}
+
+/**
+ * @brief Reset the output buffer of the USART.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ */
+
+void port_usart_reset_output_buffer (uint32_t usart_id){
+    pthread_mutex_lock(&usart_mutex);
+    usart_arr[usart_id].p_tx_data = NULL;
+    usart_arr[usart_id].tx_length = 0;
+    usart_arr[usart_id].o_idx = 0;
+    usart_arr[usart_id].write_complete = false;
+    pthread_mutex_unlock(&usart_mutex);
+}
+
+/**
+ * @brief Equivalent of the interrupt service routine of the USARTs: serve the RXNE and TXE events of a given USART. It is called by the I/O thread.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ */
+
+void port_usart_isr (uint32_t usart_id){
+    port_usart_hw_t *p_hw = &usart_arr[usart_id];
+    if (p_hw->rxne && p_hw->rx_interrupt)
+    {
+        port_usart_store_data(usart_id);
+    }
+    if (p_hw->txe && p_hw->tx_interrupt)
+    {
+        port_usart_write_data(usart_id);
+    }
+}
+
+/**
+ * @brief Receive the oldest byte of the line and store it in the RX ring.
+ *
+ * This function is called from port_usart_isr() when the RXNE flag is set. The framing of the byte is handled by usart_rx_push().
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ */
+
+void port_usart_store_data (uint32_t usart_id){
+    port_usart_hw_t *p_hw = &usart_arr[usart_id];
+    uint8_t byte_read = p_hw->rx_line[p_hw->rx_line_head];
+    p_hw->rx_line_head = (p_hw->rx_line_head + 1) % USART_PTY_FIFO_LENGTH;
+    p_hw->rx_line_count--;
+    p_hw->rx_next_ns += p_hw->byte_ns;
+    p_hw->rxne = false;
+    usart_rx_push(&p_hw->rx, byte_read);
+    _update_rts(p_hw);
+}
+
+/**
+ * @brief Send the next byte of the output message to the line.
+ *
+ * This function is called from port_usart_isr() when the TXE flag is set. Once the last byte has been sent, it disables the TX interrupt and flags the transmission as complete. In RS-485 mode, the address of the destination is sent first and the words go to the bus.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ */
+
+void port_usart_write_data (uint32_t usart_id){
+    port_usart_hw_t *p_hw = &usart_arr[usart_id];
+    if (p_hw->rs485 && !p_hw->address_sent)
+    {
+        _bus_send(p_hw, USART_ADDRESS_MARK | p_hw->rs485_destination);
+        p_hw->address_sent = true;
+        p_hw->tx_next_ns += p_hw->byte_ns;
+        p_hw->txe = false;
+        return;
+    }
+    if (p_hw->o_idx < p_hw->tx_length)
+    {
+        if (p_hw->rs485)
+        {
+            _bus_send(p_hw, (uint8_t)p_hw->p_tx_data[p_hw->o_idx]);
+        }
+        else
+        {
+            p_hw->tx_line[(p_hw->tx_line_head + p_hw->tx_line_count) % USART_PTY_FIFO_LENGTH] = (uint8_t)p_hw->p_tx_data[p_hw->o_idx];
+            p_hw->tx_line_count++;
+        }
+        p_hw->tx_next_ns += p_hw->byte_ns;
+        p_hw->txe = false;
+        p_hw->o_idx++;
+    }
+    if (p_hw->o_idx >= p_hw->tx_length)
+    {
+        port_usart_disable_tx_interrupt(usart_id);
+        p_hw->write_complete = true;
+    }
+}
+
+/**
+ * @brief Disable USART RX interrupt. The bytes sent by the host wait in the pseudo-terminal meanwhile.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ */
+
+void port_usart_disable_rx_interrupt (uint32_t usart_id){
+    pthread_mutex_lock(&usart_mutex);
+    usart_arr[usart_id].rx_interrupt = false;
+    pthread_mutex_unlock(&usart_mutex);
+}
+
+/**
+ * @brief Disable USART TX interrupts.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ */
+
+void port_usart_disable_tx_interrupt (uint32_t usart_id){
+    pthread_mutex_lock(&usart_mutex);
+    usart_arr[usart_id].tx_interrupt = false;
+    pthread_mutex_unlock(&usart_mutex);
+}
+
+/**
+ * @brief Enable USART RX interrupt.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ */
+
+void port_usart_enable_rx_interrupt (uint32_t usart_id){
+    pthread_mutex_lock(&usart_mutex);
+    usart_arr[usart_id].rx_interrupt = true;
+    pthread_mutex_unlock(&usart_mutex);
+    _kick();
+}
+
+/**
+ * @brief Enable USART TX interrupts.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ */
+
+void port_usart_enable_tx_interrupt (uint32_t usart_id){
+    pthread_mutex_lock(&usart_mutex);
+    usart_arr[usart_id].tx_interrupt = true;
+    pthread_mutex_unlock(&usart_mutex);
+    _kick();
+}
+
+/**
+ * @brief Open the pseudo-terminal of a given USART and register it in the I/O thread. The thread is started by the first call.
+ *
+ * The slave side is set to raw mode. Its path can be read with port_usart_get_pty_name() and opened by the host as a serial port.
+ *
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return true, since the native platform has no console USART
+ */
+
+bool port_usart_init(uint32_t usart_id)
+{
+    pthread_once(&usart_once, _start_io_thread);
+    pthread_mutex_lock(&usart_mutex);
+    port_usart_hw_t *p_hw = &usart_arr[usart_id];
+    port_usart_disable_tx_interrupt(usart_id);
+    port_usart_disable_rx_interrupt(usart_id);
+    _open_pty(p_hw);
+    p_hw->rx_line_head = 0;
+    p_hw->rx_line_count = 0;
+    p_hw->tx_line_head = 0;
+    p_hw->tx_line_count = 0;
+    port_usart_set_baudrate(usart_id, p_hw->baudrate);
+    memset(p_hw->rx.ring, EMPTY_BUFFER_CONSTANT, USART_RX_RING_LENGTH);
+    port_usart_set_framing(usart_id, p_hw->rx.framing);
+    port_usart_reset_output_buffer(usart_id);
+    pthread_mutex_unlock(&usart_mutex);
+    _kick();
+    return true;
+}
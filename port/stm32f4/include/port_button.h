@@ -14,6 +14,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "port_system.h"
+#include "button_edges.h"
+#include "button_scan.h"
 
 /* HW dependent includes */
 
@@ -24,6 +26,7 @@
 #define BUTTON_0_GPIO GPIOC       // GPIO a la que está conectada el botón de usuario en la placa (A, B o C).
 #define BUTTON_0_PIN 13           // Pin/ línea de la GPIO del botón.
 #define BUTTON_0_DEBOUNCE_TIME_MS 150  // Tiempo del anti-rebotes del botón en ms.
+#define BUTTONS_NUMBER 1          // Number of elements of the buttons_arr[] array. Each button must use a different EXTI line
 #define GPIO_MODE_INPUT 0         // Configuración GPIO en modo input
 #define GPIO_NOPULL 0             // Configuración GPIO sin pull up ni pull down
 #define GPIO_RISING_EDGE 0x01U    // Enables rising edge
@@ -31,6 +34,10 @@
 #define GPIO_ENABLE_INT 0x08U     // Enables the interrupt request
 #define GPIO_EDGES_AND_INT (GPIO_RISING_EDGE|GPIO_FALLING_EDGE|GPIO_ENABLE_INT)     // Enables rising and falling edges and interrupt request
 #define PRIORITY_1 1              // Set priority level to 1
+#define BUTTON_DEBOUNCE_TIMER TIM4 // One-shot timer of the debounce driven from the EXTI interrupt (see port_button_set_timer_debounce())
+#define BUTTON_DEBOUNCE_TIMER_TICK_HZ 10000 // Tick of the debounce timer: debounce times up to 6.5 s
+#define BUTTON_SCAN_PERIOD_MS 5   // Sampling period of the scan debounce: a change is accepted after BUTTON_SCAN_SAMPLES equal samples (15 to 20 ms)
+#define BUTTON_SCAN_PORTS 3       // GPIO ports that can hold buttons in scan debounce mode
 #define SUBPRIORITY_0 0           // Set subpriority level to 0
 
 /* Typedefs --------------------------------------------------------------------*/
@@ -40,6 +47,13 @@ typedef struct
     GPIO_TypeDef *p_port;
     uint8_t pin;
     bool flag_pressed;
+    bool timer_debounce; /*Flag to indicate that the button is debounced by the EXTI and BUTTON_DEBOUNCE_TIMER instead of the FSM*/
+    uint32_t debounce_ms; /*Debounce time of the timer debounce in ms*/
+    volatile bool event; /*Flag to indicate that the debounced state has changed (timer or scan debounce). It is cleared by port_button_get_event()*/
+    bool scan_debounce; /*Flag to indicate that the button is sampled and debounced in the SysTick ISR (see port_button_set_scan_debounce())*/
+    uint32_t edge_millis; /*System tick of the first edge debounced by the timer*/
+    uint32_t edge_cycles; /*Cycle counter of the first edge debounced by the timer*/
+    button_edges_t edges; /*Edges of the button timestamped by the ISRs (see port_button_get_edge())*/
 } port_button_hw_t;
 
 /* Global variables */
@@ -70,6 +84,104 @@ void port_button_init(uint32_t button_id);
 
 bool port_button_is_pressed(uint32_t button_id);
 
+/**
+ * @brief Serve the pending EXTI lines of all the buttons.
+ *
+ * EXTI->PR is read once and its pending bits are visited with count-trailing-zeros, so the cost depends on the edges pending and not on the number of buttons. A lookup table built by port_button_init() maps each line to its button, whose state is updated as the edge requires: in raw mode the level is read, timestamped and queued (see port_button_get_edge()); in timer debounce mode port_button_debounce_edge() is called. The edges pending at the same time share the same timestamp.
+ *
+ * This function is called from every EXTI ISR (EXTI0_IRQHandler() to EXTI4_IRQHandler(), EXTI9_5_IRQHandler() and EXTI15_10_IRQHandler()).
+ */
+
+void port_button_isr(void);
+
+/**
+ * @brief Enable or disable the timer debounce of a given button.
+ *
+ * When it is enabled, the first edge of the button masks its EXTI line and starts the one-shot timer BUTTON_DEBOUNCE_TIMER, so the bounces raise no more interrupts. When the timer expires, its ISR samples the pin and, if the level differs from the last debounced one, updates the flag returned by port_button_is_pressed() and posts one event (see port_button_get_event()). Then the EXTI line is unmasked again. The FSM never needs to poll the time.
+ *
+ * @note There is one debounce timer: only one button can use this mode.
+ *
+ * @param button_id Button ID. This index is used to select the element of the buttons_arr[] array
+ * @param enable true to debounce with the timer, false to go back to the raw EXTI edges
+ * @param debounce_ms Debounce time in ms
+ */
+
+void port_button_set_timer_debounce(uint32_t button_id, bool enable, uint32_t debounce_ms);
+
+/**
+ * @brief Enable or disable the scan debounce of a given button.
+ *
+ * When it is enabled, the SysTick ISR reads the IDR of every port with scanned buttons once every BUTTON_SCAN_PERIOD_MS and debounces all their lines at once with a vertical counter (see button_scan_update()). When the debounced state of a button changes, the flag returned by port_button_is_pressed() is updated, the edge is queued and one event is posted (see port_button_get_event()), as with the timer debounce. The cost per tick does not depend on the number of buttons or on how much they bounce.
+ *
+ * The first edge of a button still raises its EXTI interrupt, so it wakes up the core and resumes the SysTick. The EXTI line is then masked until the scan has settled, so the bounces raise no more interrupts.
+ *
+ * @param button_id Button ID. This index is used to select the element of the buttons_arr[] array
+ * @param enable true to debounce with the scan, false to go back to the raw EXTI edges
+ */
+
+void port_button_set_scan_debounce(uint32_t button_id, bool enable);
+
+/**
+ * @brief Sample and debounce all the buttons in scan debounce mode.
+ *
+ * This function is called from the ISR SysTick_Handler() on every tick, and it samples the buttons once every BUTTON_SCAN_PERIOD_MS.
+ */
+
+void port_button_scan(void);
+
+/**
+ * @brief Check if the scan debounce of a given button has an edge to settle. Meanwhile the SysTick must not be suspended.
+ *
+ * @param button_id Button ID. This index is used to select the element of the buttons_arr[] array
+ * @return true if an edge has been detected and the scan has not settled yet
+ * @return false otherwise
+ */
+
+bool port_button_is_debouncing(uint32_t button_id);
+
+/**
+ * @brief Check if the timer or scan debounce has posted a press or release event since the last call, and clear it.
+ *
+ * @param button_id Button ID. This index is used to select the element of the buttons_arr[] array
+ * @return true if the debounced state has changed
+ * @return false otherwise
+ */
+
+bool port_button_get_event(uint32_t button_id);
+
+/**
+ * @brief Take the oldest edge of a given button, with the time when it happened.
+ *
+ * The EXTI ISR timestamps every edge with the system tick and the cycle counter (DWT) as soon as it is served, so the FSM can compute exact durations however late it runs. In timer debounce mode only the debounced edges are queued, with the time of their first bounce.
+ *
+ * @param button_id Button ID. This index is used to select the element of the buttons_arr[] array
+ * @param p_edge Pointer where the edge is copied
+ * @return true if there was an edge
+ * @return false if there are no edges queued
+ */
+
+bool port_button_get_edge(uint32_t button_id, button_edge_t *p_edge);
+
+/**
+ * @brief Serve an edge of a button in timer debounce mode: timestamp it, mask its EXTI line and start the debounce timer.
+ *
+ * This function is called from the ISR EXTI15_10_IRQHandler().
+ *
+ * @param button_id Button ID. This index is used to select the element of the buttons_arr[] array
+ */
+
+void port_button_debounce_edge(uint32_t button_id);
+
+/**
+ * @brief Serve the expiration of the debounce timer: sample the pin, post an event and queue the edge if the debounced state has changed, and unmask the EXTI line.
+ *
+ * This function is called from the ISR TIM4_IRQHandler().
+ *
+ * @param button_id Button ID. This index is used to select the element of the buttons_arr[] array
+ */
+
+void port_button_debounce_timeout(uint32_t button_id);
+
 /**
  * @brief Return the count of the System tick in ms.
  *
@@ -11,6 +11,15 @@
 /* Includes ------------------------------------------------------------------*/
 /* Standard C includes */
 #include <stdbool.h>
+#include <stdint.h>
+
+/* Other includes */
+#include "led_pattern.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define LD2_HW_BLINK true /*!< LD2 (PA5) can be blinked by the hardware, with TIM8_CH1N in output compare toggle mode. Set it to false to blink it by software */
+#define LD2_HW_BLINK_MIN_PERIOD_MS 2 /*!< Minimum blinking period of the hardware blink */
+#define LD2_HW_PATTERN true /*!< LD2 (PA5) can play patterns (led_pattern.h) by hardware: TIM8_CH1N in PWM mode, with the duty cycles copied to TIM8_CCR1 by DMA2 Stream 1 (channel 7, TIM8_UP) at each step. Set it to false to disable the patterns */
 
 /* Function prototypes and explanation -------------------------------------------------*/
 /**
@@ -49,4 +58,47 @@ bool port_led_get(void);
  */
 void port_led_toggle(void);
 
+/**
+ * @brief Blink the LED by hardware: PA5 is routed to TIM8_CH1N (AF3) and the timer toggles it every half period in output compare toggle mode, with no interrupts. The blink starts from the current state of the LED. It can be called again to change the period.
+ *
+ * @param period_ms Blinking period in ms (at least LD2_HW_BLINK_MIN_PERIOD_MS)
+ * @return true if the LED blinks by hardware
+ * @return false if the LED cannot blink by hardware (LD2_HW_BLINK is false or the period is too short): it must be toggled by software
+ */
+bool port_led_blink_start(uint32_t period_ms);
+
+/**
+ * @brief Stop the hardware blink. The timer is stopped and PA5 is set back as a GPIO output, keeping the current state of the LED.
+ */
+void port_led_blink_stop(void);
+
+/**
+ * @brief Play a pattern on the LED by hardware, with no CPU time: TIM8 drives PA5 (TIM8_CH1N, AF3) with a PWM of LED_PATTERN_DUTY_MAX levels at LED_PATTERN_PWM_HZ, and its repetition counter requests a DMA transfer of the next duty cycle of the table to TIM8_CCR1 at the start of each step. The DMA stream runs in circular mode for a looping pattern. It replaces the hardware blink or the pattern that is running, if any.
+ *
+ * @param p_pattern Pattern to play. Its table must stay in memory while it runs
+ * @return true if the pattern is played by hardware
+ * @return false if the pattern is not valid (see led_pattern_is_valid()) or LD2_HW_PATTERN is false
+ */
+bool port_led_pattern_start(const led_pattern_t *p_pattern);
+
+/**
+ * @brief Stop the pattern. The timer and the DMA stream are stopped and PA5 is set back as a GPIO output, with the LED off.
+ */
+void port_led_pattern_stop(void);
+
+/**
+ * @brief Check if a pattern is running: the DMA stream disables itself after the last step of a pattern that does not loop has started.
+ *
+ * @return true if a pattern is running
+ * @return false otherwise
+ */
+bool port_led_pattern_is_running(void);
+
+/**
+ * @brief Get the duty cycle of the LED: the compare register of the PWM while a pattern is played, or the state of the LED otherwise.
+ *
+ * @return uint16_t Duty cycle, from 0 to LED_PATTERN_DUTY_MAX
+ */
+uint16_t port_led_get_duty(void);
+
 #endif // PORT_LED_H_
@@ -31,6 +31,8 @@
                                                          4 bits for subpriority */
 #define NVIC_PRIORITY_GROUP_4 ((uint32_t)0x00000003) /*!< 4 bits for pre-emption priority, \
                                                          0 bit  for subpriority */
+#define WAKEUP_TIMER_TICK_HZ 2000U                   /*!< Frequency of the counter of the wake-up timer (TIM7) */
+#define WAKEUP_TIMER_MAX_MS (0x10000U * 1000U / WAKEUP_TIMER_TICK_HZ) /*!< Longest delay of the wake-up timer: one turn of its 16-bit counter */
 
 /* Power */
 #define POWER_REGULATOR_VOLTAGE_SCALE3 0x01 /*!< Scale 3 mode: the maximum value of fHCLK is 120 MHz. */
@@ -84,13 +86,15 @@ size_t port_system_init(void);
  * >
  * > ✅ 1. Return System tick \n
  *
+ * @note It wraps after about 49.7 days: compare the ticks with the functions of deadline.h, not with < or >.
+ *
  * @return uint32_t
  */
 uint32_t port_system_get_millis(void);
 
 /**
  * @brief Sets the number of milliseconds since the system started.
- * @warning This function must be used only by the SysTick_Handler() ISR in file `interr.c`.
+ * @warning This function must not be used by the application; the tests use it to move the time base, e.g., just before the wrap of the 32-bit count. The upper half of the 64-bit count is cleared.
  *
  * > **TO-DO alumnos:**
  * >
@@ -100,6 +104,67 @@ uint32_t port_system_get_millis(void);
 º */
 void port_system_set_millis(uint32_t ms);
 
+/**
+ * @brief Get the number of milliseconds since the system started, on 64 bits: it does not wrap. The 32-bit count returned by port_system_get_millis() is its lower half and wraps after about 49.7 days, so compare it only with the functions of deadline.h.
+ *
+ * The count is read with the interrupts disabled, since the SysTick ISR can update it between the reads of its two halves.
+ *
+ * @return uint64_t
+ */
+uint64_t port_system_get_millis64(void);
+
+/**
+ * @brief Sets the 64-bit number of milliseconds since the system started. The SysTick_Handler() ISR in file `interr.c` increments it with this function.
+ *
+ * @param ms New number of milliseconds since the system started.
+ */
+void port_system_set_millis64(uint64_t ms);
+
+/**
+ * @brief Get the value of the CPU cycle counter (DWT->CYCCNT). It runs at SystemCoreClock and wraps around every 2^32 cycles.
+ * @note The counter is enabled by port_system_init().
+ *
+ * @return uint32_t Number of CPU cycles
+ */
+uint32_t port_system_get_cycles(void);
+
+/**
+ * @brief Get the number of cycles of port_system_get_cycles() per microsecond, to convert cycle counts into time.
+ *
+ * @return uint32_t SystemCoreClock in MHz
+ */
+uint32_t port_system_get_cycles_per_us(void);
+
+/**
+ * @brief Get the number of microseconds since the system started, from TIM5: a 32-bit timer that counts freely at 1 MHz from port_system_init(). It wraps after about 71.6 minutes, so compare the values only with the functions of deadline.h.
+ *
+ * It is a single load of TIM5_CNT, with no lock and no interrupt masking, so it can be called from any context, ISRs included. Cost per read on target: one load through the AHB/APB1 bridge, a few CPU cycles (about 5 at 16 MHz with APB1 at HCLK; see test_micros_bench). DWT->CYCCNT was not used: it is faster to read but wraps after 2^32 cycles (about 4.5 minutes at 16 MHz), and extending it to a longer count needs an overflow ISR and a lock to read both halves.
+ *
+ * @return uint32_t Number of microseconds
+ */
+uint32_t port_system_get_micros(void);
+
+/**
+ * @brief Wait for some microseconds, polling port_system_get_micros(). It waits at least us microseconds.
+ *
+ * @param us Number of microseconds to wait, up to DEADLINE_MAX_US
+ */
+void port_system_delay_us(uint32_t us);
+
+/**
+ * @brief Disable the interrupts and return the previous state of PRIMASK, to enter a short critical section. Critical sections can be nested.
+ *
+ * @return uint32_t State to pass to port_system_irq_restore()
+ */
+uint32_t port_system_irq_save(void);
+
+/**
+ * @brief Leave a critical section entered with port_system_irq_save(). The interrupts are enabled again only if they were enabled when it was entered.
+ *
+ * @param state Value returned by port_system_irq_save()
+ */
+void port_system_irq_restore(uint32_t state);
+
 /**
  * @brief Wait for some milliseconds
  *
@@ -137,6 +202,31 @@ void port_system_systick_resume();
 
 void port_system_systick_suspend();
 
+/**
+ * @brief Program the one-shot wake-up timer of the timer service (sw_timer.h): TIM7 raises an interrupt after delay_ms, so the core can sleep with the SysTick suspended until the next event of the timer wheel.
+ *
+ * Delays longer than WAKEUP_TIMER_MAX_MS are cut to it: the core wakes up earlier and the timer service programs the rest.
+ *
+ * @param delay_ms Time to the wake-up in ms
+ * @return uint32_t Time to the wake-up actually programmed in ms
+ */
+
+uint32_t port_system_wakeup_timer_set(uint32_t delay_ms);
+
+/**
+ * @brief Stop the wake-up timer of the timer service.
+ */
+
+void port_system_wakeup_timer_stop(void);
+
+/**
+ * @brief Serve the expiration of the wake-up timer. The SysTick does not count while the core sleeps with it suspended (see port_system_sleep()), so the system tick is moved forward to the tick at which the timer was programmed to fire, if it is behind.
+ *
+ * This function is called from the ISR TIM7_IRQHandler().
+ */
+
+void port_system_wakeup_timer_isr(void);
+
 
 /** @verbatim
       ==============================================================================
@@ -287,7 +377,7 @@ bool port_system_gpio_read (GPIO_TypeDef *p_port, uint8_t pin);
 void port_system_gpio_write (GPIO_TypeDef *p_port, uint8_t pin, bool value);
 
 /**
- * @brief Toggle the value of a GPIO.
+ * @brief Toggle the value of a GPIO atomically: the output latch (ODR) is read and the new value is written with a single BSRR store, so the other pins of the port are never written.
  * 
  * @param p_port Port of the GPIO (CMSIS struct like)
  * @param pin Pin/line of the GPIO (index from 0 to 15)
@@ -295,6 +385,25 @@ void port_system_gpio_write (GPIO_TypeDef *p_port, uint8_t pin, bool value);
 
 void port_system_gpio_toggle (GPIO_TypeDef *p_port, uint8_t pin);
 
+/**
+ * @brief Toggle several GPIOs of a port atomically, with a single BSRR store.
+ * 
+ * @param p_port Port of the GPIOs (CMSIS struct like)
+ * @param pins Mask of the pins to toggle (bit i for pin i)
+ */
+
+void port_system_gpio_toggle_pins (GPIO_TypeDef *p_port, uint16_t pins);
+
+/**
+ * @brief Set and reset several GPIOs of a port atomically, with a single BSRR store. The other pins of the port are not changed.
+ * 
+ * @param p_port Port of the GPIOs (CMSIS struct like)
+ * @param set Mask of the pins to set to HIGH (bit i for pin i)
+ * @param reset Mask of the pins to set to LOW. A pin in both masks is set to HIGH.
+ */
+
+void port_system_gpio_write_pins (GPIO_TypeDef *p_port, uint16_t set, uint16_t reset);
+
 /**
  * @brief The function sets the state of the power regulator in stop mode.
  * After that, the function sets the system mode in sleep mode, to enter in stop mode when calling __WFI() (wait for interruption).
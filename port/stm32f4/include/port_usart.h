@@ -14,6 +14,9 @@
 #include <stdbool.h>
 #include "stm32f4xx.h"
 
+/* Other includes */
+#include "usart_rx.h"
+
 /* HW dependent includes */
 
 
@@ -28,13 +31,75 @@
 #define USART_0_PIN_RX 11 /*USART GPIO pin for RX*/
 #define USART_0_AF_TX 7 /*USART alternate function for TX*/
 #define USART_0_AF_RX 7 /*USART alternate function for RX*/
-#define USART_INPUT_BUFFER_LENGTH 10 /*USART input message length*/
+#define USART_0_BAUDRATE 9600 /*USART default baud rate*/
+#define USART_0_GPIO_CTS GPIOB /*USART GPIO port for CTS pin (hardware flow control)*/
+#define USART_0_PIN_CTS 13 /*USART GPIO pin for CTS*/
+#define USART_0_AF_CTS 7 /*USART alternate function for CTS*/
+#define USART_0_GPIO_RTS GPIOB /*USART GPIO port for RTS pin. It is driven as a GPIO from the occupancy of the RX ring*/
+#define USART_0_PIN_RTS 14 /*USART GPIO pin for RTS*/
+#define USART_1_ID 1 /*USART identifier*/
+#define USART_1 USART2 /*USART connected to the ST-LINK virtual COM port*/
+#define USART_1_GPIO_TX GPIOA /*USART GPIO port for TX pin*/
+#define USART_1_GPIO_RX GPIOA /*USART GPIO port for RX pin*/
+#define USART_1_PIN_TX 2 /*USART GPIO pin for TX*/
+#define USART_1_PIN_RX 3 /*USART GPIO pin for RX*/
+#define USART_1_AF_TX 7 /*USART alternate function for TX*/
+#define USART_1_AF_RX 7 /*USART alternate function for RX*/
+#define USART_1_BAUDRATE 115200 /*USART default baud rate*/
+#define USART_2_ID 2 /*USART identifier*/
+#define USART_2 USART1 /*USART used connected to the GPIO*/
+#define USART_2_GPIO_TX GPIOA /*USART GPIO port for TX pin*/
+#define USART_2_GPIO_RX GPIOA /*USART GPIO port for RX pin*/
+#define USART_2_PIN_TX 9 /*USART GPIO pin for TX*/
+#define USART_2_PIN_RX 10 /*USART GPIO pin for RX*/
+#define USART_2_AF_TX 7 /*USART alternate function for TX*/
+#define USART_2_AF_RX 7 /*USART alternate function for RX*/
+#define USART_2_BAUDRATE 115200 /*USART default baud rate*/
+#define USART_2_GPIO_CTS GPIOA /*USART GPIO port for CTS pin (hardware flow control)*/
+#define USART_2_PIN_CTS 11 /*USART GPIO pin for CTS*/
+#define USART_2_AF_CTS 7 /*USART alternate function for CTS*/
+#define USART_2_GPIO_RTS GPIOA /*USART GPIO port for RTS pin. It is driven as a GPIO from the occupancy of the RX ring*/
+#define USART_2_PIN_RTS 12 /*USART GPIO pin for RTS*/
+#define USART_3_ID 3 /*USART identifier*/
+#define USART_3 UART4 /*UART used connected to the GPIO*/
+#define USART_3_GPIO_TX GPIOA /*UART GPIO port for TX pin*/
+#define USART_3_GPIO_RX GPIOA /*UART GPIO port for RX pin*/
+#define USART_3_PIN_TX 0 /*UART GPIO pin for TX*/
+#define USART_3_PIN_RX 1 /*UART GPIO pin for RX*/
+#define USART_3_AF_TX 8 /*UART alternate function for TX*/
+#define USART_3_AF_RX 8 /*UART alternate function for RX*/
+#define USART_3_BAUDRATE 115200 /*UART default baud rate*/
+#define USART_4_ID 4 /*USART identifier*/
+#define USART_4 UART5 /*UART used connected to the GPIO*/
+#define USART_4_GPIO_TX GPIOC /*UART GPIO port for TX pin*/
+#define USART_4_GPIO_RX GPIOD /*UART GPIO port for RX pin*/
+#define USART_4_PIN_TX 12 /*UART GPIO pin for TX*/
+#define USART_4_PIN_RX 2 /*UART GPIO pin for RX*/
+#define USART_4_AF_TX 8 /*UART alternate function for TX*/
+#define USART_4_AF_RX 8 /*UART alternate function for RX*/
+#define USART_4_BAUDRATE 115200 /*UART default baud rate*/
+#define USARTS_NUMBER 5 /*Number of elements of the usart_arr[] array*/
+#define USART_CONSOLE_ID USART_1_ID /*USART used by printf() when USE_STDIO_USART is defined (ST-LINK virtual COM port). port_usart_init() refuses it meanwhile*/
+#define USART_CONSOLE_RING_LENGTH 1024 /*Size of the TX ring of the console. It must be a power of two*/
 #define USART_OUTPUT_BUFFER_LENGTH 100 /*USART output message length*/
-#define EMPTY_BUFFER_CONSTANT 0x0 /*Empty char constant*/
-#define END_CHAR_CONSTANT 0xA /*End char constant*/
+#define USART_AUTOBAUD_SYNC_CHAR 0x55 /*Sync char expected by the auto-baud detection ('U')*/
+#define USART_AUTOBAUD_SYNC_EDGES 5 /*Falling edges of the sync char: start bit and bits 1, 3, 5 and 7*/
+#define USART_AUTOBAUD_SYNC_BITS 8 /*Bit times between the first and the last falling edge of the sync char*/
 #define PRIORITY_2 2             // Set priority level to 1
 #define SUBPRIORITY_0 0           // Set subpriority level to 0
 
+/* Enums */
+
+enum USART_PERIPH {
+  USART_PERIPH_1 = 0, /*USART1*/
+  USART_PERIPH_2, /*USART2*/
+  USART_PERIPH_3, /*USART3*/
+  USART_PERIPH_UART4, /*UART4*/
+  USART_PERIPH_UART5, /*UART5*/
+  USART_PERIPH_6, /*USART6*/
+  USART_PERIPH_NUMBER
+};
+
 /* Typedefs --------------------------------------------------------------------*/
 
 typedef struct {
@@ -45,12 +110,27 @@ typedef struct {
     uint8_t pin_rx;
     uint8_t alt_func_tx;
     uint8_t alt_func_rx;
-    char input_buffer[USART_INPUT_BUFFER_LENGTH];
-    uint8_t i_idx;
-    bool read_complete;
-    char output_buffer[USART_OUTPUT_BUFFER_LENGTH];
-    uint8_t o_idx;
+    GPIO_TypeDef * p_port_cts; /*GPIO port of the CTS pin. NULL if the USART has no flow control pins*/
+    GPIO_TypeDef * p_port_rts; /*GPIO port of the RTS pin. NULL if the USART has no flow control pins*/
+    uint8_t pin_cts; /*GPIO pin of the CTS input*/
+    uint8_t pin_rts; /*GPIO pin of the RTS output*/
+    uint8_t alt_func_cts; /*Alternate function of the CTS pin*/
+    bool flow_control; /*Flag to indicate that RTS/CTS flow control is enabled*/
+    bool rts_paused; /*Flag to indicate that RTS is deasserted: the sender is asked to pause until the RX ring is drained*/
+    volatile uint32_t overruns; /*Number of bytes lost because DR was not read in time (ORE flag)*/
+    bool rs485; /*Flag to indicate that the USART is a node of a multi-drop RS-485 bus. The RTS pin drives the driver enable (DE) of the transceiver*/
+    uint8_t rs485_destination; /*Address sent before each message in RS-485 mode*/
+    bool address_sent; /*Flag to indicate that the address of the message being sent has already been written*/
+    usart_rx_t rx; /*RX ring of received frames*/
+    const char * p_tx_data; /*Message being sent. It is owned by the upper layer until write_complete is set*/
+    uint32_t tx_length; /*Length of the message being sent*/
+    uint32_t o_idx; /*Index of the next byte to send*/
     bool write_complete;
+    uint32_t baudrate; /*Configured baud rate*/
+    int32_t baud_error_ppm; /*Error of the achieved baud rate in parts per million*/
+    uint8_t autobaud_edges; /*Number of falling edges of the sync char detected. 0 when auto-baud is not running*/
+    uint32_t autobaud_first_cycle; /*Cycle counter value at the first falling edge of the sync char*/
+    bool autobaud_done; /*Flag to indicate that the auto-baud detection has finished*/
 }port_usart_hw_t;
 
 /* Global variables */
@@ -62,10 +142,92 @@ extern port_usart_hw_t usart_arr [];
 /**
  * @brief Configures the HW specifications of a given USART.
  * 
+ * If USE_STDIO_USART is defined, USART_CONSOLE_ID is reserved for printf() and it is refused.
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return true if the USART has been configured, false if it is the console
+ */
+
+bool port_usart_init (uint32_t usart_id);
+
+/**
+ * @brief Configure the baud rate of a given USART. The BRR value and the oversampling mode are computed from the current frequency of the peripheral clock (derived from SystemCoreClock).
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param baudrate Baud rate in bits per second (up to the peripheral clock frequency divided by 8)
+ * @return true if the baud rate has been set with an error lower than USART_BRR_MAX_ERROR_PPM
+ * @return false if the baud rate cannot be achieved. The previous configuration is kept.
+ */
+
+bool port_usart_set_baudrate (uint32_t usart_id, uint32_t baudrate);
+
+/**
+ * @brief Get the baud rate really achieved by a given USART.
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return uint32_t Achieved baud rate in bits per second
+ */
+
+uint32_t port_usart_get_baudrate (uint32_t usart_id);
+
+/**
+ * @brief Get the relative error between the achieved and the requested baud rate.
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return int32_t Error in parts per million
+ */
+
+int32_t port_usart_get_baudrate_error_ppm (uint32_t usart_id);
+
+/**
+ * @brief Enable or disable the byte pacing of a given USART. On the target, each byte always takes its byte time on the line, so there is nothing to configure: the function exists for the code shared with the native platform.
+ * 
  * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param enable Ignored
  */
 
-void port_usart_init (uint32_t usart_id);
+void port_usart_set_byte_pacing (uint32_t usart_id, bool enable);
+
+/**
+ * @brief Check if the byte pacing of a given USART is enabled. It always is on the target.
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return true
+ */
+
+bool port_usart_get_byte_pacing (uint32_t usart_id);
+
+/**
+ * @brief Start the auto-baud detection of a given USART.
+ * 
+ * The RX pin is temporarily configured as an EXTI input on falling edges. The sender must transmit the sync char USART_AUTOBAUD_SYNC_CHAR ('U', 0x55), whose falling edges are one every two bit times. The time between the first and the last one is measured with the cycle counter and the baud rate is set to the closest standard baud rate.
+ * 
+ * @note The measurement includes the EXTI latency jitter, so it is intended for baud rates up to 115200 bps.
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ */
+
+void port_usart_autobaud_start (uint32_t usart_id);
+
+/**
+ * @brief Register a falling edge of the RX line during the auto-baud detection.
+ * 
+ * This function is called from port_usart_autobaud_isr() when the EXTI line of the RX pin is pending.
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ */
+
+void port_usart_autobaud_edge (uint32_t usart_id);
+
+/**
+ * @brief Check if the auto-baud detection has finished. Once it has finished, the new baud rate can be read with port_usart_get_baudrate().
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return true 
+ * @return false 
+ */
+
+bool port_usart_autobaud_done (uint32_t usart_id);
 
 /**
  * @brief Check if a transmission is complete.
@@ -78,7 +240,7 @@ void port_usart_init (uint32_t usart_id);
 bool port_usart_tx_done (uint32_t usart_id);
 
 /**
- * @brief Check if a reception is complete.
+ * @brief Check if there is, at least, one complete frame in the RX ring.
  * 
  * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
  * @return true 
@@ -88,15 +250,34 @@ bool port_usart_tx_done (uint32_t usart_id);
 bool port_usart_rx_done (uint32_t usart_id);
 
 /**
- * @brief Get the message received through the USART and store it in the buffer passed as argument.
+ * @brief Get the oldest frame received through the USART, store it in the buffer passed as argument and release it from the RX ring.
  * 
  * This function is called from the function do_get_data_rx() of the FSM to store the message received to the buffer of the FSM.
  * 
  * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
- * @param p_buffer Pointer to the buffer where the message will be stored.
+ * @param p_buffer Pointer to the buffer where the message will be stored. It must be USART_INPUT_BUFFER_LENGTH bytes long.
+ * @return uint32_t Length of the frame in bytes. 0 if there was no frame.
+ */
+
+uint32_t port_usart_get_from_input_buffer (uint32_t usart_id, char *p_buffer);
+
+/**
+ * @brief Select the framing of the received data. The RX ring is flushed.
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param framing USART_FRAMING_TEXT or USART_FRAMING_COBS
  */
 
-void port_usart_get_from_input_buffer (uint32_t usart_id, char *p_buffer);
+void port_usart_set_framing (uint32_t usart_id, uint8_t framing);
+
+/**
+ * @brief Get the number of received frames that have been discarded because they were corrupted, too long or did not fit in the RX ring.
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return uint32_t Number of discarded frames
+ */
+
+uint32_t port_usart_get_rx_frame_errors (uint32_t usart_id);
 
 /**
  * @brief Check if the USART is ready to receive a new message.
@@ -109,21 +290,75 @@ void port_usart_get_from_input_buffer (uint32_t usart_id, char *p_buffer);
 bool port_usart_get_txr_status (uint32_t usart_id);
 
 /**
- * @brief Copy the message passed as argument to the output buffer of the USART.
+ * @brief Connect the receiver of a given USART to its own transmitter, so every byte sent is received back. It uses the half-duplex mode (HDSEL): the line is the TX pin and the RX pin is released.
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param enable true to loop back, false to go back to the full-duplex mode
+ */
+
+void port_usart_set_loopback (uint32_t usart_id, bool enable);
+
+/**
+ * @brief Enable or disable the RTS/CTS hardware flow control of a given USART.
+ * 
+ * CTS is served by the peripheral (CTSE): the transmitter does not start a byte while the peer deasserts it, so it must be connected. RTS is driven as a GPIO from the occupancy of the RX ring instead of the RXNE flag (RTSE): it is deasserted above USART_RX_RTS_HIGH_WATER bytes and asserted again once the ring is drained below USART_RX_RTS_LOW_WATER bytes, so the sender pauses instead of losing data while the main loop is busy.
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param enable true to enable the flow control, false to disable it
+ * @return true if the flow control has been configured
+ * @return false if the USART has no flow control pins
+ */
+
+bool port_usart_set_flow_control (uint32_t usart_id, bool enable);
+
+/**
+ * @brief Get the number of received bytes lost because the previous one had not been read from DR yet (overrun error, ORE).
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return uint32_t Number of overruns
+ */
+
+uint32_t port_usart_get_overruns (uint32_t usart_id);
+
+/**
+ * @brief Make a given USART a node of a multi-drop RS-485 bus, or go back to the point-to-point mode.
+ * 
+ * The transceiver is half-duplex: its driver enable (DE) is driven from the RTS pin, asserted when a message is set and released from the transmission complete (TC) interrupt, once the stop bit of the last byte has left the line. Each message is preceded by the address of its destination (see port_usart_set_rs485_destination()), sent as a 9-bit word with USART_ADDRESS_MARK set. The receiver is in mute mode with wakeup by address mark (WAKE and RWU), so the frames sent to other nodes are discarded by the hardware and raise no interrupt.
+ * 
+ * @note The receiver compares the 4 LSBs of the address (ADD), so a bus has up to 16 nodes. The RTS/CTS flow control is disabled.
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param enable true to join the bus, false to go back to the point-to-point mode
+ * @param address Own address of the node on the bus
+ * @return true if the mode has been configured
+ * @return false if the USART has no RTS pin to drive DE
+ */
+
+bool port_usart_set_rs485 (uint32_t usart_id, bool enable, uint8_t address);
+
+/**
+ * @brief Select the node the next messages of a given USART in RS-485 mode are sent to.
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param address Address of the destination node
+ */
+
+void port_usart_set_rs485_destination (uint32_t usart_id, uint8_t address);
+
+/**
+ * @brief Set the message to send through the USART. The message is not copied: the ISR reads it straight from the given buffer.
  * 
  * This function is called from the function do_set_data_tx() of the FSM to set the message to send to the USART.
  * 
  * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
- * @param p_data Pointer to the message to send.
+ * @param p_data Pointer to the message to send. It must remain valid until the transmission is complete.
  * @param length Length of the message to send.
  */
 
-void port_usart_copy_to_output_buffer (uint32_t usart_id, char *p_data, uint32_t length);
+void port_usart_set_output_buffer (uint32_t usart_id, const char *p_data, uint32_t length);
 
 /**
- * @brief Reset the input buffer of the USART.
- * 
- * This function is called from the function do_get_data_rx() to reset the input buffer of the USART after the message has been read.
+ * @brief Reset the input buffer of the USART. All the complete frames pending in the RX ring are discarded.
  * 
  * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
  */
@@ -133,7 +368,7 @@ void port_usart_reset_input_buffer (uint32_t usart_id);
 /**
  * @brief Reset the output buffer of the USART.
  * 
- * This function is called from the function do_set_data_tx() and do_tx_end() to reset the output buffer of the USART after the message has been sent.
+ * This function is called from the function do_tx_end() to release the output buffer of the USART after the message has been sent.
  * 
  * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
  */
@@ -141,9 +376,35 @@ void port_usart_reset_input_buffer (uint32_t usart_id);
 void port_usart_reset_output_buffer (uint32_t usart_id);
 
 /**
- * @brief Function to read the data from the USART Data Register and store it in the input buffer.
+ * @brief Shared body of the interrupt service routines of all the USARTs: serve the RXNE, TXE and TC events of a given USART.
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ */
+
+void port_usart_isr (uint32_t usart_id);
+
+/**
+ * @brief Serve the interrupt of a USART peripheral. The peripheral is mapped to the element of usart_arr[] that uses it, through a table filled in by port_usart_init().
+ * 
+ * This function is called from the ISRs USARTx_IRQHandler() and UARTx_IRQHandler(). Interrupts of peripherals that have not been initialized are ignored.
+ * 
+ * @param periph Peripheral that raised the interrupt (see enum USART_PERIPH)
+ */
+
+void port_usart_isr_dispatch (uint32_t periph);
+
+/**
+ * @brief Serve the EXTI interrupts of the RX pins of the USARTs that are running the auto-baud detection.
  * 
- * This function is called from the ISR USART3_IRQHandler() when the RXNE flag is set.
+ * This function is called from the ISR EXTI15_10_IRQHandler(), so the auto-baud detection is available for RX pins 10 to 15.
+ */
+
+void port_usart_autobaud_isr (void);
+
+/**
+ * @brief Function to read the data from the USART Data Register and store it in the RX ring.
+ * 
+ * This function is called from port_usart_isr() when the RXNE flag is set. The framing of the byte is handled by usart_rx_push().
  * 
  * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
  */
@@ -151,9 +412,9 @@ void port_usart_reset_output_buffer (uint32_t usart_id);
 void port_usart_store_data (uint32_t usart_id);
 
 /**
- * @brief Function to write the data from the output buffer to the USART Data Register.
+ * @brief Function to write the next byte of the output message to the USART Data Register.
  * 
- * This function is called from the ISR USART3_IRQHandler() when the TXE flag is set.
+ * This function is called from port_usart_isr() when the TXE flag is set. Once the last byte has been written, it disables the TX interrupt and flags the transmission as complete.
  * 
  * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
  */
@@ -169,7 +430,7 @@ void port_usart_write_data (uint32_t usart_id);
 void port_usart_disable_rx_interrupt (uint32_t usart_id);
 
 /**
- * @brief Enable USART TX interrupts.
+ * @brief Disable USART TX interrupts.
  * 
  * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
  */
@@ -192,4 +453,38 @@ void port_usart_enable_rx_interrupt (uint32_t usart_id);
 
 void port_usart_enable_tx_interrupt (uint32_t usart_id);
 
+/**
+ * @brief Configure the console: the USART USART_CONSOLE_ID sends the bytes of a TX ring from its TXE interrupt. It is called by the first port_usart_console_write(), so printf() needs no explicit initialization.
+ */
+
+void port_usart_console_init (void);
+
+/**
+ * @brief Append bytes to the TX ring of the console and start sending them. It never waits: the bytes that do not fit in the ring are dropped and counted.
+ * 
+ * This function is called from _write() (syscalls.c), so it is the back end of printf(). The ring is lock-free with one producer, so it must not be called from interrupts.
+ * 
+ * @param p_data Pointer to the bytes to send
+ * @param length Number of bytes to send
+ * @return uint32_t Number of bytes appended to the ring
+ */
+
+uint32_t port_usart_console_write (const char *p_data, uint32_t length);
+
+/**
+ * @brief Wait until all the bytes of the TX ring of the console have left the USART.
+ * 
+ * @warning It relies on the TXE interrupt, so it must not be called with interrupts disabled.
+ */
+
+void port_usart_console_flush (void);
+
+/**
+ * @brief Get the number of bytes dropped by the console because its TX ring was full.
+ * 
+ * @return uint32_t Number of bytes dropped
+ */
+
+uint32_t port_usart_console_get_dropped (void);
+
 #endif
\ No newline at end of file
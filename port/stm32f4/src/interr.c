@@ -19,37 +19,93 @@
 
 /**
  * @brief Interrupt service routine for the System tick timer (SysTick).
- * @note This ISR is called when the SysTick timer generates an interrupt. The program flow jumps to this ISR and increments the tick counter by one millisecond.
+ * @note This ISR is called when the SysTick timer generates an interrupt. The program flow jumps to this ISR and increments the tick counter by one millisecond. It also samples the buttons in scan debounce mode (see port_button_scan()).
  */
 
 void SysTick_Handler(){
-    port_system_set_millis(port_system_get_millis() + 1);
+    port_system_set_millis64(port_system_get_millis64() + 1);
+    port_button_scan();
 }
 
 /**
- * @brief This function handles Px10-Px15 global interrupts.
+ * @brief This function handles Px0 global interrupts.
  * 
- * @note First, this function identifies where the interruption has been raised. Then, perform the desired action. Before leaving it cleans the interrupt pending register.
+ * @note The pending lines of the buttons are served by port_button_isr(), which clears them.
  */
 
-void EXTI15_10_IRQHandler ( void )
+void EXTI0_IRQHandler(void)
 {
     port_system_systick_resume();
-/* ISR user button */
-if (EXTI ->PR & BIT_POS_TO_MASK( buttons_arr[ BUTTON_0_ID ]. pin ))
+    port_button_isr();
+}
+
+/**
+ * @brief This function handles Px1 global interrupts.
+ */
+
+void EXTI1_IRQHandler(void)
 {
-    if(buttons_arr[BUTTON_0_ID].p_port->IDR & BIT_POS_TO_MASK(buttons_arr[ BUTTON_0_ID ]. pin))
-        buttons_arr[BUTTON_0_ID].flag_pressed = false;
-    else
-        buttons_arr[BUTTON_0_ID].flag_pressed = true;
-    EXTI->PR |= BIT_POS_TO_MASK(buttons_arr[ BUTTON_0_ID ]. pin);
+    port_system_systick_resume();
+    port_button_isr();
 }
+
+/**
+ * @brief This function handles Px2 global interrupts.
+ */
+
+void EXTI2_IRQHandler(void)
+{
+    port_system_systick_resume();
+    port_button_isr();
 }
 
 /**
- * @brief This function handles USART3 global interrupt.
+ * @brief This function handles Px3 global interrupts.
+ */
+
+void EXTI3_IRQHandler(void)
+{
+    port_system_systick_resume();
+    port_button_isr();
+}
+
+/**
+ * @brief This function handles Px4 global interrupts.
+ */
+
+void EXTI4_IRQHandler(void)
+{
+    port_system_systick_resume();
+    port_button_isr();
+}
+
+/**
+ * @brief This function handles Px5-Px9 global interrupts.
+ */
+
+void EXTI9_5_IRQHandler(void)
+{
+    port_system_systick_resume();
+    port_button_isr();
+}
+
+/**
+ * @brief This function handles Px10-Px15 global interrupts.
  * 
- * First, this function identifies where the interruption has been raised. Then, perform the desired action. Before leaving it cleans the interrupt pending register.
+ * @note The pending lines of the buttons are served by port_button_isr(), and the RX lines of the USARTs during the auto-baud detection by port_usart_autobaud_isr(). Each one clears its own lines.
+ */
+
+void EXTI15_10_IRQHandler ( void )
+{
+    port_system_systick_resume();
+/* ISR buttons */
+port_button_isr();
+/* ISR USART RX lines during the auto-baud detection */
+port_usart_autobaud_isr();
+}
+
+/**
+ * @brief This function handles USART3 global interrupt.
  * 
  * The program flow jumps to this ISR when the USART3 generates an interrupt. It can be due to:
  * 
@@ -57,21 +113,91 @@ if (EXTI ->PR & BIT_POS_TO_MASK( buttons_arr[ BUTTON_0_ID ]. pin ))
  * Transmission of a byte has finished (TC), although for this project we don't contemplate this option
  * Transmission buffer is empty (TXE)
  * 
+ * The interrupt is served by the element of usart_arr[] that uses this peripheral. The rest of the USART and UART ISRs work the same way.
  */
 
 void USART3_IRQHandler (void)
 {
     port_system_systick_resume();
-    if((USART3->SR & USART_SR_RXNE) & (USART3->CR1 & USART_CR1_RXNEIE))
-    {
-        port_usart_store_data(USART_0_ID);
-    }
-    if((USART3->SR & USART_SR_TXE) & (USART3->CR1 & USART_CR1_TXEIE))
+    port_usart_isr_dispatch(USART_PERIPH_3);
+}
+
+/**
+ * @brief This function handles USART1 global interrupt.
+ */
+
+void USART1_IRQHandler (void)
+{
+    port_system_systick_resume();
+    port_usart_isr_dispatch(USART_PERIPH_1);
+}
+
+/**
+ * @brief This function handles USART2 global interrupt.
+ */
+
+void USART2_IRQHandler (void)
+{
+    port_system_systick_resume();
+    port_usart_isr_dispatch(USART_PERIPH_2);
+}
+
+/**
+ * @brief This function handles UART4 global interrupt.
+ */
+
+void UART4_IRQHandler (void)
+{
+    port_system_systick_resume();
+    port_usart_isr_dispatch(USART_PERIPH_UART4);
+}
+
+/**
+ * @brief This function handles UART5 global interrupt.
+ */
+
+void UART5_IRQHandler (void)
+{
+    port_system_systick_resume();
+    port_usart_isr_dispatch(USART_PERIPH_UART5);
+}
+
+/**
+ * @brief This function handles USART6 global interrupt.
+ */
+
+void USART6_IRQHandler (void)
+{
+    port_system_systick_resume();
+    port_usart_isr_dispatch(USART_PERIPH_6);
+}
+
+/**
+ * @brief This function handles TIM4 global interrupt. This timer is the one-shot debounce of the button in timer debounce mode: when it expires, the button is sampled.
+ */
+
+void TIM4_IRQHandler(void)
+{
+    port_system_systick_resume();
+    for (uint32_t button_id = 0; button_id < BUTTONS_NUMBER; button_id++)
     {
-        port_usart_write_data(USART_0_ID);
+        if (buttons_arr[button_id].timer_debounce)
+        {
+            port_button_debounce_timeout(button_id); // Only one button can use the debounce timer
+        }
     }
 }
 
+/**
+ * @brief This function handles TIM7 global interrupt. This timer is the one-shot wake-up of the timer service (sw_timer.h): it fires at the next event of the timer wheel, which the main loop serves with sw_timer_process().
+ */
+
+void TIM7_IRQHandler(void)
+{
+    port_system_systick_resume();
+    port_system_wakeup_timer_isr();
+}
+
 /**
  * @brief This function handles TIM2 global interrupt. This timer is used to control the duration of the note. When the timer expires, it generates an interrupt.
  * 
@@ -12,6 +12,9 @@
 /* Includes ------------------------------------------------------------------*/
 #include "port_button.h"
 
+/* Defines -------------------------------------------------------------------*/
+#define EXTI_LINES_NUMBER 16 /*EXTI lines that can be connected to a GPIO*/
+
 /* Global variables ------------------------------------------------------------*/
 
 /**
@@ -19,9 +22,30 @@
  */
 
 port_button_hw_t buttons_arr[] = {
-    [BUTTON_0_ID] = {.p_port = BUTTON_0_GPIO, .pin = BUTTON_0_PIN, .flag_pressed = false},
+    [BUTTON_0_ID] = {.p_port = BUTTON_0_GPIO, .pin = BUTTON_0_PIN, .flag_pressed = false, .timer_debounce = false, .debounce_ms = BUTTON_0_DEBOUNCE_TIME_MS, .event = false, .scan_debounce = false, .edge_millis = 0, .edge_cycles = 0},
 };
 
+_Static_assert(sizeof(buttons_arr) / sizeof(buttons_arr[0]) == BUTTONS_NUMBER, "BUTTONS_NUMBER must match the elements of buttons_arr[]");
+
+static uint8_t buttons_lut[EXTI_LINES_NUMBER]; /*Button ID of each EXTI line. Only valid for the lines in buttons_lines*/
+static uint32_t buttons_lines; /*Mask of the EXTI lines used by the buttons initialized*/
+
+/**
+ * @brief Port sampled by the scan debounce.
+ */
+typedef struct
+{
+    GPIO_TypeDef *p_port; /*GPIO port*/
+    uint32_t lines; /*Lines of the port with a button in scan debounce mode*/
+    button_scan_t scan; /*Debouncer of the lines*/
+} port_button_scan_t;
+
+static port_button_scan_t scan_ports[BUTTON_SCAN_PORTS]; /*Ports sampled by the scan debounce*/
+static uint32_t scan_ports_number; /*Elements of scan_ports[] in use*/
+static uint32_t scan_countdown; /*Ticks until the next sample*/
+static volatile uint32_t scan_wake; /*EXTI lines masked after an edge until the scan settles*/
+static volatile uint32_t scan_busy; /*EXTI lines whose scan counter is running*/
+
 /*Functions -------------------------------------------------------------*/
 
 /**
@@ -37,6 +61,9 @@ void port_button_init(uint32_t button_id)
 
     port_system_gpio_config(p_port, pin, GPIO_MODE_INPUT, GPIO_NOPULL);
     port_system_gpio_config_exti(p_port, pin, GPIO_EDGES_AND_INT);
+    button_edges_flush(&buttons_arr[button_id].edges);
+    buttons_lut[pin] = button_id;
+    buttons_lines |= BIT_POS_TO_MASK(pin);
     port_system_gpio_exti_enable(pin, PRIORITY_1, SUBPRIORITY_0);
 }
 
@@ -53,6 +80,273 @@ bool port_button_is_pressed(uint32_t button_id)
     return buttons_arr[button_id].flag_pressed;
 }
 
+/**
+ * @brief Serve the pending EXTI lines of all the buttons.
+ * 
+ * EXTI->PR is read once and its pending bits are visited with count-trailing-zeros, so the cost depends on the edges pending and not on the number of buttons. A lookup table built by port_button_init() maps each line to its button, whose state is updated as the edge requires: in raw mode the level is read, timestamped and queued (see port_button_get_edge()); in timer debounce mode port_button_debounce_edge() is called; in scan debounce mode the line is masked until the scan settles. The edges pending at the same time share the same timestamp.
+ */
+
+void port_button_isr(void)
+{
+    uint32_t pending = EXTI->PR & EXTI->IMR & buttons_lines;
+    if (pending == 0)
+    {
+        return;
+    }
+    uint32_t cycles = port_system_get_cycles(); // Timestamp of the edges, as early as possible
+    uint32_t millis = port_system_get_millis();
+    EXTI->PR = pending; // Cleared before reading the levels: an edge during the dispatch is served again
+    while (pending)
+    {
+        uint32_t line = __builtin_ctz(pending);
+        pending &= pending - 1;
+        uint32_t button_id = buttons_lut[line];
+        port_button_hw_t *p_hw = &buttons_arr[button_id];
+        if (p_hw->timer_debounce)
+        {
+            port_button_debounce_edge(button_id);
+            continue;
+        }
+        if (p_hw->scan_debounce)
+        {
+            EXTI->IMR &= ~BIT_POS_TO_MASK(line); // Only the first edge: the scan takes it from here
+            scan_wake |= BIT_POS_TO_MASK(line);
+            continue;
+        }
+        p_hw->flag_pressed = !(p_hw->p_port->IDR & BIT_POS_TO_MASK(line)); // The buttons are active low
+        button_edges_push(&p_hw->edges, p_hw->flag_pressed, millis, cycles);
+    }
+}
+
+/**
+ * @brief Enable or disable the timer debounce of a given button.
+ * 
+ * When it is enabled, the first edge of the button masks its EXTI line and starts the one-shot timer BUTTON_DEBOUNCE_TIMER, so the bounces raise no more interrupts. When the timer expires, its ISR samples the pin and, if the level differs from the last debounced one, updates the flag returned by port_button_is_pressed() and posts one event (see port_button_get_event()). Then the EXTI line is unmasked again. The FSM never needs to poll the time.
+ * 
+ * @param button_id Button ID. This index is used to select the element of the buttons_arr[] array
+ * @param enable true to debounce with the timer, false to go back to the raw EXTI edges
+ * @param debounce_ms Debounce time in ms
+ */
+
+void port_button_set_timer_debounce(uint32_t button_id, bool enable, uint32_t debounce_ms)
+{
+    port_button_hw_t *p_hw = &buttons_arr[button_id];
+    TIM_TypeDef *p_tim = BUTTON_DEBOUNCE_TIMER;
+    RCC->APB1ENR |= RCC_APB1ENR_TIM4EN;
+    p_tim->CR1 &= ~TIM_CR1_CEN;
+    if (!enable)
+    {
+        NVIC_DisableIRQ(TIM4_IRQn);
+        p_hw->timer_debounce = false;
+        EXTI->IMR |= BIT_POS_TO_MASK(p_hw->pin); // In case the timer was running
+        return;
+    }
+    if (p_hw->scan_debounce)
+    {
+        port_button_set_scan_debounce(button_id, false);
+    }
+    p_tim->CR1 |= TIM_CR1_OPM | TIM_CR1_URS; // One shot. UG does not raise the interrupt
+    p_tim->PSC = SystemCoreClock / BUTTON_DEBOUNCE_TIMER_TICK_HZ - 1;
+    p_tim->ARR = (debounce_ms * BUTTON_DEBOUNCE_TIMER_TICK_HZ) / 1000 - 1;
+    p_tim->EGR = TIM_EGR_UG;
+    p_tim->SR = ~TIM_SR_UIF;
+    p_tim->DIER |= TIM_DIER_UIE;
+    NVIC_SetPriority(TIM4_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), PRIORITY_1, SUBPRIORITY_0)); // Same as the EXTI: they do not preempt each other
+    NVIC_EnableIRQ(TIM4_IRQn);
+
+    p_hw->debounce_ms = debounce_ms;
+    p_hw->flag_pressed = !port_system_gpio_read(p_hw->p_port, p_hw->pin); // The button is active low
+    p_hw->event = false;
+    p_hw->timer_debounce = true;
+    button_edges_flush(&p_hw->edges);
+    EXTI->PR = BIT_POS_TO_MASK(p_hw->pin);
+    EXTI->IMR |= BIT_POS_TO_MASK(p_hw->pin);
+}
+
+/**
+ * @brief Enable or disable the scan debounce of a given button.
+ * 
+ * When it is enabled, the SysTick ISR reads the IDR of every port with scanned buttons once every BUTTON_SCAN_PERIOD_MS and debounces all their lines at once with a vertical counter (see button_scan_update()). When the debounced state of a button changes, the flag returned by port_button_is_pressed() is updated, the edge is queued and one event is posted (see port_button_get_event()), as with the timer debounce. The cost per tick does not depend on the number of buttons or on how much they bounce.
+ * 
+ * The first edge of a button still raises its EXTI interrupt, so it wakes up the core and resumes the SysTick. The EXTI line is then masked until the scan has settled, so the bounces raise no more interrupts.
+ * 
+ * @param button_id Button ID. This index is used to select the element of the buttons_arr[] array
+ * @param enable true to debounce with the scan, false to go back to the raw EXTI edges
+ */
+
+void port_button_set_scan_debounce(uint32_t button_id, bool enable)
+{
+    port_button_hw_t *p_hw = &buttons_arr[button_id];
+    uint32_t mask = BIT_POS_TO_MASK(p_hw->pin);
+    if (enable && p_hw->timer_debounce)
+    {
+        port_button_set_timer_debounce(button_id, false, p_hw->debounce_ms);
+    }
+    uint32_t port_idx = 0;
+    while ((port_idx < scan_ports_number) && (scan_ports[port_idx].p_port != p_hw->p_port))
+    {
+        port_idx++;
+    }
+    if ((port_idx == scan_ports_number) && (!enable || (scan_ports_number == BUTTON_SCAN_PORTS)))
+    {
+        return; // Not scanned, or no room for another port
+    }
+    port_button_scan_t *p_scan = &scan_ports[port_idx];
+    p_scan->p_port = p_hw->p_port;
+
+    uint32_t state = port_system_irq_save();
+    bool pressed = !port_system_gpio_read(p_hw->p_port, p_hw->pin); // The button is active low
+    button_scan_set(&p_scan->scan, mask, pressed ? mask : 0);
+    p_scan->lines = enable ? (p_scan->lines | mask) : (p_scan->lines & ~mask);
+    scan_ports_number += (port_idx == scan_ports_number) ? 1 : 0;
+    p_hw->flag_pressed = pressed;
+    p_hw->event = false;
+    p_hw->scan_debounce = enable;
+    button_edges_flush(&p_hw->edges);
+    scan_wake &= ~mask;
+    scan_busy &= ~mask;
+    EXTI->PR = mask;
+    EXTI->IMR |= mask;
+    port_system_irq_restore(state);
+}
+
+/**
+ * @brief Sample and debounce all the buttons in scan debounce mode.
+ * 
+ * The IDR of each port is read once and all its lines are debounced at once. Only the lines whose debounced state changes are visited, with count-trailing-zeros. The EXTI lines of the buttons that have settled are unmasked again.
+ * 
+ * This function is called from the ISR SysTick_Handler() on every tick, and it samples the buttons once every BUTTON_SCAN_PERIOD_MS.
+ */
+
+void port_button_scan(void)
+{
+    if ((scan_ports_number == 0) || (scan_countdown-- > 0))
+    {
+        return;
+    }
+    scan_countdown = BUTTON_SCAN_PERIOD_MS - 1;
+    uint32_t cycles = port_system_get_cycles();
+    uint32_t millis = port_system_get_millis();
+    uint32_t busy = 0;
+    for (uint32_t i = 0; i < scan_ports_number; i++)
+    {
+        port_button_scan_t *p_scan = &scan_ports[i];
+        uint32_t toggle = button_scan_update(&p_scan->scan, ~p_scan->p_port->IDR & p_scan->lines); // The buttons are active low
+        busy |= button_scan_busy(&p_scan->scan);
+        while (toggle)
+        {
+            uint32_t line = __builtin_ctz(toggle);
+            toggle &= toggle - 1;
+            port_button_hw_t *p_hw = &buttons_arr[buttons_lut[line]];
+            p_hw->flag_pressed = (p_scan->scan.state >> line) & 1;
+            button_edges_push(&p_hw->edges, p_hw->flag_pressed, millis, cycles);
+            p_hw->event = true;
+        }
+    }
+    scan_busy = busy;
+    uint32_t settled = scan_wake & ~busy;
+    if (settled)
+    {
+        scan_wake &= ~settled;
+        EXTI->PR = settled; // The bounces while it was masked are already debounced
+        EXTI->IMR |= settled;
+    }
+}
+
+/**
+ * @brief Check if the scan debounce of a given button has an edge to settle. Meanwhile the SysTick must not be suspended.
+ * 
+ * @param button_id Button ID. This index is used to select the element of the buttons_arr[] array
+ * @return true if an edge has been detected and the scan has not settled yet
+ * @return false otherwise
+ */
+
+bool port_button_is_debouncing(uint32_t button_id)
+{
+    return ((scan_wake | scan_busy) & BIT_POS_TO_MASK(buttons_arr[button_id].pin)) != 0;
+}
+
+/**
+ * @brief Check if the timer or scan debounce has posted a press or release event since the last call, and clear it.
+ * 
+ * @param button_id Button ID. This index is used to select the element of the buttons_arr[] array
+ * @return true if the debounced state has changed
+ * @return false otherwise
+ */
+
+bool port_button_get_event(uint32_t button_id)
+{
+    if (!buttons_arr[button_id].event)
+    {
+        return false;
+    }
+    buttons_arr[button_id].event = false;
+    return true;
+}
+
+/**
+ * @brief Take the oldest edge of a given button, with the time when it happened.
+ * 
+ * The EXTI ISR timestamps every edge with the system tick and the cycle counter (DWT) as soon as it is served, so the FSM can compute exact durations however late it runs. In timer debounce mode only the debounced edges are queued, with the time of their first bounce.
+ * 
+ * @param button_id Button ID. This index is used to select the element of the buttons_arr[] array
+ * @param p_edge Pointer where the edge is copied
+ * @return true if there was an edge
+ * @return false if there are no edges queued
+ */
+
+bool port_button_get_edge(uint32_t button_id, button_edge_t *p_edge)
+{
+    return button_edges_pop(&buttons_arr[button_id].edges, p_edge);
+}
+
+/**
+ * @brief Serve an edge of a button in timer debounce mode: timestamp it, mask its EXTI line and start the debounce timer.
+ * 
+ * This function is called from the ISR EXTI15_10_IRQHandler().
+ * 
+ * @param button_id Button ID. This index is used to select the element of the buttons_arr[] array
+ */
+
+void port_button_debounce_edge(uint32_t button_id)
+{
+    buttons_arr[button_id].edge_cycles = port_system_get_cycles();
+    buttons_arr[button_id].edge_millis = port_system_get_millis();
+    uint32_t mask = BIT_POS_TO_MASK(buttons_arr[button_id].pin);
+    EXTI->IMR &= ~mask; // The bounces raise no interrupt until the timer expires
+    EXTI->PR = mask;
+    BUTTON_DEBOUNCE_TIMER->CNT = 0;
+    BUTTON_DEBOUNCE_TIMER->CR1 |= TIM_CR1_CEN;
+}
+
+/**
+ * @brief Serve the expiration of the debounce timer: sample the pin, post an event and queue the edge if the debounced state has changed, and unmask the EXTI line.
+ * 
+ * This function is called from the ISR TIM4_IRQHandler().
+ * 
+ * @param button_id Button ID. This index is used to select the element of the buttons_arr[] array
+ */
+
+void port_button_debounce_timeout(uint32_t button_id)
+{
+    port_button_hw_t *p_hw = &buttons_arr[button_id];
+    uint32_t mask = BIT_POS_TO_MASK(p_hw->pin);
+    BUTTON_DEBOUNCE_TIMER->SR = ~TIM_SR_UIF;
+    bool pressed = !port_system_gpio_read(p_hw->p_port, p_hw->pin);
+    if (pressed != p_hw->flag_pressed)
+    {
+        p_hw->flag_pressed = pressed;
+        button_edges_push(&p_hw->edges, pressed, p_hw->edge_millis, p_hw->edge_cycles); // Queued before the event, so the FSM finds it
+        p_hw->event = true;
+    }
+    EXTI->PR = mask;
+    EXTI->IMR |= mask;
+    if (!port_system_gpio_read(p_hw->p_port, p_hw->pin) != pressed)
+    {
+        EXTI->SWIER |= mask; // The level changed after the sample: debounce it as a new edge
+    }
+}
+
 /**
  * @brief Return the count of the System tick in milliseconds (ms).
  * 
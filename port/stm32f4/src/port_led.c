@@ -23,6 +23,31 @@
 #define IDR5_MASK (GPIO_IDR_ID0 << LD2_PIN) /*!< Mask for IDR register using LD2_PIN */
 #define ODR5_MASK (GPIO_ODR_OD0 << LD2_PIN) /*!< Mask for ODR register using LD2_PIN */
 
+#define ALT_FUNC3_TIM8 3 /*!< TIM8 alternate function mapping of PA5 (TIM8_CH1N) */
+#define LD2_BLINK_TIMER TIM8 /*!< Timer that blinks LD2 */
+#define OC1M_TOGGLE (0x3U << TIM_CCMR1_OC1M_Pos) /*!< Output compare mode 011: toggle OC1REF on match */
+#define OC1M_FORCE_INACTIVE (0x4U << TIM_CCMR1_OC1M_Pos) /*!< Output compare mode 100: force OC1REF low */
+#define OC1M_FORCE_ACTIVE (0x5U << TIM_CCMR1_OC1M_Pos) /*!< Output compare mode 101: force OC1REF high */
+#define OC1M_PWM1 (0x6U << TIM_CCMR1_OC1M_Pos) /*!< Output compare mode 110: OC1REF high while CNT < CCR1 */
+
+#define LD2_PATTERN_DMA_STREAM DMA2_Stream1 /*!< DMA stream that copies the duty cycles of a pattern to TIM8_CCR1 */
+#define LD2_PATTERN_DMA_CHANNEL 7 /*!< DMA channel of the TIM8_UP request on DMA2 Stream 1 */
+#define LD2_PATTERN_DMA_FLAGS (DMA_LIFCR_CTCIF1 | DMA_LIFCR_CHTIF1 | DMA_LIFCR_CTEIF1 | DMA_LIFCR_CDMEIF1 | DMA_LIFCR_CFEIF1) /*!< Flags of DMA2 Stream 1 in LIFCR */
+
+/* Private functions ----------------------------------------------------------*/
+/**
+ * @brief Stop the DMA requests of the timer and disable the DMA stream of the patterns. The stream is disabled once its current transfer ends.
+ */
+static void _pattern_dma_stop(void)
+{
+    LD2_BLINK_TIMER->DIER &= ~TIM_DIER_UDE;
+    LD2_PATTERN_DMA_STREAM->CR &= ~DMA_SxCR_EN;
+    while (LD2_PATTERN_DMA_STREAM->CR & DMA_SxCR_EN)
+    {
+    }
+    DMA2->LIFCR = LD2_PATTERN_DMA_FLAGS;
+}
+
 void port_led_gpio_setup ( void )
 {
 /* Primero , habilitamos siempre el reloj de los perifericos */
@@ -35,17 +60,161 @@ LD2_GPIO_PORT -> MODER |= MODER5_AS_OUTPUT ;
 LD2_GPIO_PORT -> PUPDR |= PUPDR5_AS_NOPUPD ;
 }
 
-void port_led_toggle ()
+bool port_led_get(void)
+{
+    return (LD2_GPIO_PORT->IDR & IDR5_MASK) != 0; /* IDR follows the pin also when it is driven by the timer */
+}
+
+void port_led_toggle(void)
+{
+    port_system_gpio_toggle(LD2_GPIO_PORT, LD2_PIN); /* Una sola escritura en BSRR: no pisa los cambios de una ISR en otros pines */
+}
+
+/**
+ * @brief Blink the LED by hardware: PA5 is routed to TIM8_CH1N (AF3) and the timer toggles it every half period in output compare toggle mode, with no interrupts. The blink starts from the current state of the LED. It can be called again to change the period.
+ *
+ * TIM8 is clocked from APB2 at SystemCoreClock. With only the complementary output enabled, OC1N follows OC1REF (CC1NP = 0), so the LED is on while OC1REF is high.
+ *
+ * @param period_ms Blinking period in ms (at least LD2_HW_BLINK_MIN_PERIOD_MS)
+ * @return true if the LED blinks by hardware
+ * @return false if the LED cannot blink by hardware (LD2_HW_BLINK is false or the period is too short): it must be toggled by software
+ */
+bool port_led_blink_start(uint32_t period_ms)
+{
+    if (!LD2_HW_BLINK || (period_ms < LD2_HW_BLINK_MIN_PERIOD_MS))
+    {
+        return false;
+    }
+    bool on = port_led_get();
+
+    /* Time base: one update event every half period */
+    uint64_t clocks = ((uint64_t)SystemCoreClock / 1000U) * period_ms / 2U;
+    uint32_t psc = (uint32_t)((clocks - 1U) / 65536U);
+    uint32_t arr = (uint32_t)(clocks / (psc + 1U)) - 1U;
+
+    RCC->APB2ENR |= RCC_APB2ENR_TIM8EN;
+    LD2_BLINK_TIMER->CR1 &= ~TIM_CR1_CEN;
+    _pattern_dma_stop(); // The blink replaces a pattern
+    LD2_BLINK_TIMER->PSC = psc;
+    LD2_BLINK_TIMER->ARR = arr;
+    LD2_BLINK_TIMER->RCR = 0;
+    LD2_BLINK_TIMER->CCR1 = arr; // Toggle at the end of each half period
+    LD2_BLINK_TIMER->CNT = 0;
+    LD2_BLINK_TIMER->EGR = TIM_EGR_UG;
+
+    /* Force OC1REF to the current state of the LED, then toggle from there */
+    LD2_BLINK_TIMER->CCMR1 &= ~(TIM_CCMR1_CC1S | TIM_CCMR1_OC1M | TIM_CCMR1_OC1PE);
+    LD2_BLINK_TIMER->CCMR1 |= on ? OC1M_FORCE_ACTIVE : OC1M_FORCE_INACTIVE;
+    LD2_BLINK_TIMER->CCER &= ~(TIM_CCER_CC1E | TIM_CCER_CC1NP);
+    LD2_BLINK_TIMER->CCER |= TIM_CCER_CC1NE;
+    LD2_BLINK_TIMER->BDTR |= TIM_BDTR_MOE;
+    LD2_BLINK_TIMER->CCMR1 = (LD2_BLINK_TIMER->CCMR1 & ~TIM_CCMR1_OC1M) | OC1M_TOGGLE;
+
+    /* Route PA5 to the timer */
+    port_system_gpio_config_alternate(LD2_GPIO_PORT, LD2_PIN, ALT_FUNC3_TIM8);
+    port_system_gpio_config(LD2_GPIO_PORT, LD2_PIN, GPIO_MODE_ALTERNATE, GPIO_PUPDR_NOPULL);
+    LD2_BLINK_TIMER->CR1 |= TIM_CR1_CEN;
+    return true;
+}
+
+/**
+ * @brief Stop the hardware blink. The timer is stopped and PA5 is set back as a GPIO output, keeping the current state of the LED.
+ */
+void port_led_blink_stop(void)
+{
+    bool on = port_led_get();
+    LD2_BLINK_TIMER->CR1 &= ~TIM_CR1_CEN;
+    LD2_BLINK_TIMER->BDTR &= ~TIM_BDTR_MOE;
+    LD2_BLINK_TIMER->CCER &= ~TIM_CCER_CC1NE;
+    port_system_gpio_write(LD2_GPIO_PORT, LD2_PIN, on);
+    port_system_gpio_config(LD2_GPIO_PORT, LD2_PIN, GPIO_MODE_OUT, GPIO_PUPDR_NOPULL);
+}
+
+/**
+ * @brief Play a pattern on the LED by hardware, with no CPU time: TIM8 drives PA5 (TIM8_CH1N, AF3) with a PWM of LED_PATTERN_DUTY_MAX levels at LED_PATTERN_PWM_HZ, and its repetition counter requests a DMA transfer of the next duty cycle of the table to TIM8_CCR1 at the start of each step. The DMA stream runs in circular mode for a looping pattern. It replaces the hardware blink or the pattern that is running, if any.
+ *
+ * OC1PE is cleared, so each duty cycle applies from the PWM period in which the DMA writes it. The repetition counter is loaded with 0 by the update generation and the counter starts at ARR, so the first update event (and the transfer of the first step) comes at the first tick; from then on, there is one update event every step.
+ *
+ * @param p_pattern Pattern to play. Its table must stay in memory while it runs
+ * @return true if the pattern is played by hardware
+ * @return false if the pattern is not valid (see led_pattern_is_valid()) or LD2_HW_PATTERN is false
+ */
+bool port_led_pattern_start(const led_pattern_t *p_pattern)
 {
-/* Leemos el valor previo del LED en IDR */
-uint32_t prev_value = ( LD2_GPIO_PORT -> IDR & IDR5_MASK ) ;
-/* Segun corresponda , apagamos o encendemos el LED en ODR */
-if ( prev_value )
+    if (!LD2_HW_PATTERN || !led_pattern_is_valid(p_pattern))
     {
-        LD2_GPIO_PORT -> ODR &= ~ ODR5_MASK ; /* Apagar : escribimos un 0 logico */
+        return false;
     }
-else
+    RCC->APB2ENR |= RCC_APB2ENR_TIM8EN;
+    RCC->AHB1ENR |= RCC_AHB1ENR_DMA2EN;
+    LD2_BLINK_TIMER->CR1 &= ~TIM_CR1_CEN;
+    _pattern_dma_stop();
+
+    /* Time base: one PWM period of LED_PATTERN_DUTY_MAX ticks, repeated for each step */
+    LD2_BLINK_TIMER->PSC = SystemCoreClock / (LED_PATTERN_PWM_HZ * LED_PATTERN_DUTY_MAX) - 1U;
+    LD2_BLINK_TIMER->ARR = LED_PATTERN_DUTY_MAX - 1U; // A duty cycle of LED_PATTERN_DUTY_MAX is greater than ARR: always on
+    LD2_BLINK_TIMER->CCR1 = 0;
+    LD2_BLINK_TIMER->RCR = 0;
+    LD2_BLINK_TIMER->EGR = TIM_EGR_UG;
+    LD2_BLINK_TIMER->RCR = p_pattern->step_ms * LED_PATTERN_PWM_HZ / 1000U - 1U; // Loaded at the first update event
+    LD2_BLINK_TIMER->CNT = LED_PATTERN_DUTY_MAX - 1U;
+
+    /* PWM mode 1 on the complementary output */
+    LD2_BLINK_TIMER->CCMR1 &= ~(TIM_CCMR1_CC1S | TIM_CCMR1_OC1M | TIM_CCMR1_OC1PE);
+    LD2_BLINK_TIMER->CCMR1 |= OC1M_PWM1;
+    LD2_BLINK_TIMER->CCER &= ~(TIM_CCER_CC1E | TIM_CCER_CC1NP);
+    LD2_BLINK_TIMER->CCER |= TIM_CCER_CC1NE;
+    LD2_BLINK_TIMER->BDTR |= TIM_BDTR_MOE;
+
+    /* DMA: one half word of the table to CCR1 at each update event */
+    LD2_PATTERN_DMA_STREAM->CR = (LD2_PATTERN_DMA_CHANNEL << DMA_SxCR_CHSEL_Pos) | DMA_SxCR_MSIZE_0 | DMA_SxCR_PSIZE_0 | DMA_SxCR_MINC | DMA_SxCR_DIR_0 | (p_pattern->loop ? DMA_SxCR_CIRC : 0);
+    LD2_PATTERN_DMA_STREAM->PAR = (uint32_t)(uintptr_t)&LD2_BLINK_TIMER->CCR1;
+    LD2_PATTERN_DMA_STREAM->M0AR = (uint32_t)(uintptr_t)p_pattern->p_duty;
+    LD2_PATTERN_DMA_STREAM->NDTR = p_pattern->length;
+    LD2_PATTERN_DMA_STREAM->CR |= DMA_SxCR_EN;
+    LD2_BLINK_TIMER->DIER |= TIM_DIER_UDE;
+
+    /* Route PA5 to the timer */
+    port_system_gpio_config_alternate(LD2_GPIO_PORT, LD2_PIN, ALT_FUNC3_TIM8);
+    port_system_gpio_config(LD2_GPIO_PORT, LD2_PIN, GPIO_MODE_ALTERNATE, GPIO_PUPDR_NOPULL);
+    LD2_BLINK_TIMER->CR1 |= TIM_CR1_CEN;
+    return true;
+}
+
+/**
+ * @brief Stop the pattern. The timer and the DMA stream are stopped and PA5 is set back as a GPIO output, with the LED off.
+ */
+void port_led_pattern_stop(void)
+{
+    LD2_BLINK_TIMER->CR1 &= ~TIM_CR1_CEN;
+    _pattern_dma_stop();
+    LD2_BLINK_TIMER->BDTR &= ~TIM_BDTR_MOE;
+    LD2_BLINK_TIMER->CCER &= ~TIM_CCER_CC1NE;
+    port_system_gpio_write(LD2_GPIO_PORT, LD2_PIN, false);
+    port_system_gpio_config(LD2_GPIO_PORT, LD2_PIN, GPIO_MODE_OUT, GPIO_PUPDR_NOPULL);
+}
+
+/**
+ * @brief Check if a pattern is running: the DMA stream disables itself after the last step of a pattern that does not loop has started.
+ *
+ * @return true if a pattern is running
+ * @return false otherwise
+ */
+bool port_led_pattern_is_running(void)
+{
+    return (LD2_BLINK_TIMER->DIER & TIM_DIER_UDE) && (LD2_PATTERN_DMA_STREAM->CR & DMA_SxCR_EN);
+}
+
+/**
+ * @brief Get the duty cycle of the LED: the compare register of the PWM while a pattern is played, or the state of the LED otherwise.
+ *
+ * @return uint16_t Duty cycle, from 0 to LED_PATTERN_DUTY_MAX
+ */
+uint16_t port_led_get_duty(void)
+{
+    if (LD2_BLINK_TIMER->DIER & TIM_DIER_UDE)
     {
-        LD2_GPIO_PORT -> ODR |= ODR5_MASK ; /* Encender : escribimos un 1 logico */
+        return (uint16_t)LD2_BLINK_TIMER->CCR1;
     }
+    return port_led_get() ? LED_PATTERN_DUTY_MAX : 0;
 }
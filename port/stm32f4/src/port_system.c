@@ -7,12 +7,18 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "port_system.h"
+#include "gpio_bsrr.h"
+#include "deadline.h"
 
 /* Defines -------------------------------------------------------------------*/
 #define HSI_VALUE ((uint32_t)16000000) /*!< Value of the Internal oscillator in Hz */
+#define MICROS_TIMER TIM5 /*!< 32-bit timer of the microsecond time base */
+#define WAKEUP_TIMER TIM7 /*!< One-shot timer that wakes up the core at the next event of the timer service */
+#define WAKEUP_TIMER_PRIORITY 3U /*!< Priority of the wake-up timer interrupt: below the EXTI, USART and timers of the peripherals */
 
 /* GLOBAL VARIABLES */
-static volatile uint32_t msTicks = 0; /*!< Variable to store millisecond ticks. @warning **It must be declared volatile!** Just because it is modified in an ISR. **Add it to the definition** after *static*. */
+static volatile uint64_t msTicks = 0; /*!< Variable to store millisecond ticks, on 64 bits so that it does not wrap. @warning **It must be declared volatile!** Just because it is modified in an ISR. **Add it to the definition** after *static*. */
+static volatile uint32_t wakeup_deadline = 0; /*!< System tick at which the wake-up timer fires */
 
 /* These variables are declared extern in CMSIS (system_stm32f4xx.h) */
 uint32_t SystemCoreClock = HSI_VALUE;                                               /*!< Frequency of the System clock */
@@ -116,6 +122,20 @@ size_t port_system_init()
   /* Configure the system clock */
   system_clock_config();
 
+  /* Enable the CPU cycle counter of the Data Watchpoint and Trace unit */
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  /* Microsecond time base: TIM5 counts freely at 1 MHz over its 32 bits (APB1 timer clock = SystemCoreClock) */
+  RCC->APB1ENR |= RCC_APB1ENR_TIM5EN;
+  MICROS_TIMER->CR1 = 0;
+  MICROS_TIMER->PSC = SystemCoreClock / 1000000U - 1U;
+  MICROS_TIMER->ARR = 0xFFFFFFFFU;
+  MICROS_TIMER->CNT = 0;
+  MICROS_TIMER->EGR = TIM_EGR_UG; // Load the prescaler
+  MICROS_TIMER->CR1 = TIM_CR1_CEN;
+
   return 0;
 }
 
@@ -124,12 +144,62 @@ size_t port_system_init()
 //------------------------------------------------------
 uint32_t port_system_get_millis()
 {
-  return msTicks;
+  return (uint32_t)msTicks; // A single load of the lower half: it cannot be torn by the SysTick ISR
 }
 
 void port_system_set_millis(uint32_t ms)
 {
+  port_system_set_millis64(ms);
+}
+
+uint64_t port_system_get_millis64(void)
+{
+  uint32_t state = port_system_irq_save();
+  uint64_t ms = msTicks;
+  port_system_irq_restore(state);
+  return ms;
+}
+
+void port_system_set_millis64(uint64_t ms)
+{
+  uint32_t state = port_system_irq_save();
   msTicks = ms;
+  port_system_irq_restore(state);
+}
+
+uint32_t port_system_get_micros(void)
+{
+  return MICROS_TIMER->CNT;
+}
+
+void port_system_delay_us(uint32_t us)
+{
+  deadline_t until = deadline_after(port_system_get_micros(), us);
+  while (!deadline_passed(until, port_system_get_micros())) // Passed, not reached: the first microsecond may be partial
+  {
+  }
+}
+
+uint32_t port_system_get_cycles(void)
+{
+  return DWT->CYCCNT;
+}
+
+uint32_t port_system_get_cycles_per_us(void)
+{
+  return SystemCoreClock / 1000000U;
+}
+
+uint32_t port_system_irq_save(void)
+{
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  return primask;
+}
+
+void port_system_irq_restore(uint32_t state)
+{
+  __set_PRIMASK(state);
 }
 
 void port_system_delay_ms(uint32_t ms)
@@ -143,11 +213,11 @@ void port_system_delay_ms(uint32_t ms)
 
 void port_system_delay_until_ms(uint32_t *p_t, uint32_t ms)
 {
-  uint32_t until = *p_t + ms;
+  deadline_t until = deadline_after(*p_t, ms);
   uint32_t now = port_system_get_millis();
-  if (until > now)
+  if (!deadline_reached(until, now))
   {
-    port_system_delay_ms(until - now);
+    port_system_delay_ms(deadline_remaining(until, now));
   }
   *p_t = port_system_get_millis();
 }
@@ -162,6 +232,49 @@ void port_system_systick_suspend()
   SysTick->CTRL &= ~SysTick_CTRL_TICKINT_Msk;
 }
 
+uint32_t port_system_wakeup_timer_set(uint32_t delay_ms)
+{
+  if (delay_ms > WAKEUP_TIMER_MAX_MS)
+  {
+    delay_ms = WAKEUP_TIMER_MAX_MS;
+  }
+  if (delay_ms == 0)
+  {
+    delay_ms = 1;
+  }
+  RCC->APB1ENR |= RCC_APB1ENR_TIM7EN;
+  WAKEUP_TIMER->CR1 = TIM_CR1_OPM | TIM_CR1_URS; // One shot, stopped. UG does not raise the interrupt
+  WAKEUP_TIMER->PSC = SystemCoreClock / WAKEUP_TIMER_TICK_HZ - 1;
+  WAKEUP_TIMER->ARR = (delay_ms * WAKEUP_TIMER_TICK_HZ) / 1000 - 1;
+  WAKEUP_TIMER->CNT = 0;
+  WAKEUP_TIMER->EGR = TIM_EGR_UG; // Load the prescaler
+  WAKEUP_TIMER->SR &= ~TIM_SR_UIF;
+  WAKEUP_TIMER->DIER |= TIM_DIER_UIE;
+  NVIC_SetPriority(TIM7_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), WAKEUP_TIMER_PRIORITY, 0U));
+  NVIC_EnableIRQ(TIM7_IRQn);
+  wakeup_deadline = deadline_after(port_system_get_millis(), delay_ms);
+  WAKEUP_TIMER->CR1 |= TIM_CR1_CEN;
+  return delay_ms;
+}
+
+void port_system_wakeup_timer_stop(void)
+{
+  WAKEUP_TIMER->CR1 &= ~TIM_CR1_CEN;
+  WAKEUP_TIMER->SR &= ~TIM_SR_UIF;
+}
+
+void port_system_wakeup_timer_isr(void)
+{
+  WAKEUP_TIMER->SR &= ~TIM_SR_UIF;
+  uint32_t state = port_system_irq_save(); // The SysTick ISR preempts this one: a tick between the check and the add would be lost
+  uint32_t now = (uint32_t)msTicks;
+  if (!deadline_reached(wakeup_deadline, now))
+  {
+    msTicks += wakeup_deadline - now; // The core slept with the SysTick suspended
+  }
+  port_system_irq_restore(state);
+}
+
 //------------------------------------------------------
 // GPIO RELATED FUNCTIONS
 //------------------------------------------------------
@@ -179,6 +292,10 @@ void port_system_gpio_config(GPIO_TypeDef *p_port, uint8_t pin, uint8_t mode, ui
   {
     RCC->AHB1ENR |= RCC_AHB1ENR_GPIOCEN; /* GPIOC_CLK_ENABLE */
   }
+  else if (p_port == GPIOD)
+  {
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIODEN; /* GPIOD_CLK_ENABLE */
+  }
 
   /* Clean ( &=~ ) by displacing the base register and set the configuration ( |= ) */
   p_port->MODER &= ~(GPIO_MODER_MODER0 << (pin * 2U));
@@ -207,6 +324,10 @@ void port_system_gpio_config_exti(GPIO_TypeDef *p_port, uint8_t pin, uint32_t mo
   {
     port_selector = 2;
   }
+  else if (p_port == GPIOD)
+  {
+    port_selector = 3;
+  }
 
   uint32_t base_mask = 0x0FU;
   uint32_t displacement = (pin % 4) * 4;
@@ -292,18 +413,12 @@ bool port_system_gpio_read(GPIO_TypeDef *p_port, uint8_t pin)
 
 void port_system_gpio_write(GPIO_TypeDef *p_port, uint8_t pin, bool value)
 {
-  if (value)
-  {
-    p_port->BSRR = BIT_POS_TO_MASK(pin);
-  }
-  else
-  {
-    p_port->BSRR = BIT_POS_TO_MASK(pin) << 16;
-  }
+  uint16_t mask = BIT_POS_TO_MASK(pin);
+  p_port->BSRR = value ? GPIO_BSRR_WRITE(mask, 0) : GPIO_BSRR_WRITE(0, mask);
 }
 
 /**
- * @brief Toggle the value of a GPIO.
+ * @brief Toggle the value of a GPIO atomically: the output latch (ODR) is read and the new value is written with a single BSRR store, so the other pins of the port are never written.
  * 
  * @param p_port Port of the GPIO (CMSIS struct like)
  * @param pin Pin/line of the GPIO (index from 0 to 15)
@@ -311,9 +426,33 @@ void port_system_gpio_write(GPIO_TypeDef *p_port, uint8_t pin, bool value)
 
 void port_system_gpio_toggle(GPIO_TypeDef *p_port, uint8_t pin)
 {
-  bool leer = port_system_gpio_read(p_port, pin);
-  bool contrario = !leer;
-  port_system_gpio_write(p_port, pin, contrario);
+  port_system_gpio_toggle_pins(p_port, BIT_POS_TO_MASK(pin));
+}
+
+/**
+ * @brief Toggle several GPIOs of a port atomically, with a single BSRR store.
+ * 
+ * @param p_port Port of the GPIOs (CMSIS struct like)
+ * @param pins Mask of the pins to toggle (bit i for pin i)
+ */
+
+void port_system_gpio_toggle_pins(GPIO_TypeDef *p_port, uint16_t pins)
+{
+  uint32_t odr = p_port->ODR; // GPIO_BSRR_TOGGLE() uses it twice: a single read of the volatile register
+  p_port->BSRR = GPIO_BSRR_TOGGLE(odr, pins);
+}
+
+/**
+ * @brief Set and reset several GPIOs of a port atomically, with a single BSRR store. The other pins of the port are not changed.
+ * 
+ * @param p_port Port of the GPIOs (CMSIS struct like)
+ * @param set Mask of the pins to set to HIGH (bit i for pin i)
+ * @param reset Mask of the pins to set to LOW. A pin in both masks is set to HIGH.
+ */
+
+void port_system_gpio_write_pins(GPIO_TypeDef *p_port, uint16_t set, uint16_t reset)
+{
+  p_port->BSRR = GPIO_BSRR_WRITE(set, reset);
 }
 // ------------------------------------------------------
 // POWER RELATED FUNCTIONS
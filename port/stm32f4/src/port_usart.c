@@ -11,16 +11,81 @@
 #include <stdlib.h>
 #include "port_system.h"
 #include "port_usart.h"
+#include "usart_brr.h"
+#include "usart_isr.h"
+#include "metrics.h"
 /* HW dependent libraries */
 
 /* Global variables */
 
-port_usart_hw_t usart_arr [] = {
+port_usart_hw_t usart_arr [USARTS_NUMBER] = {
     [USART_0_ID] = {.p_usart = USART_0, .p_port_tx = USART_0_GPIO_TX, .p_port_rx = USART_0_GPIO_RX, .pin_tx = USART_0_PIN_TX, 
     .pin_rx = USART_0_PIN_RX, .alt_func_tx = USART_0_AF_TX, .alt_func_rx = USART_0_AF_RX,  
-    .i_idx = 0, .read_complete = false,  .o_idx = 0, .write_complete = false,}
+    .p_port_cts = USART_0_GPIO_CTS, .p_port_rts = USART_0_GPIO_RTS, .pin_cts = USART_0_PIN_CTS, .pin_rts = USART_0_PIN_RTS, .alt_func_cts = USART_0_AF_CTS,
+    .flow_control = false, .rts_paused = false, .overruns = 0, .rs485 = false, .rs485_destination = 0, .address_sent = false,
+    .rx = {.framing = USART_FRAMING_TEXT}, .p_tx_data = NULL, .tx_length = 0, .o_idx = 0, .write_complete = false,
+    .baudrate = USART_0_BAUDRATE, .baud_error_ppm = 0, .autobaud_edges = 0, .autobaud_first_cycle = 0, .autobaud_done = false,},
+    [USART_1_ID] = {.p_usart = USART_1, .p_port_tx = USART_1_GPIO_TX, .p_port_rx = USART_1_GPIO_RX, .pin_tx = USART_1_PIN_TX, 
+    .pin_rx = USART_1_PIN_RX, .alt_func_tx = USART_1_AF_TX, .alt_func_rx = USART_1_AF_RX,  
+    .p_port_cts = NULL, .p_port_rts = NULL, .flow_control = false, .rts_paused = false, .overruns = 0, .rs485 = false, .rs485_destination = 0, .address_sent = false,
+    .rx = {.framing = USART_FRAMING_TEXT}, .p_tx_data = NULL, .tx_length = 0, .o_idx = 0, .write_complete = false,
+    .baudrate = USART_1_BAUDRATE, .baud_error_ppm = 0, .autobaud_edges = 0, .autobaud_first_cycle = 0, .autobaud_done = false,},
+    [USART_2_ID] = {.p_usart = USART_2, .p_port_tx = USART_2_GPIO_TX, .p_port_rx = USART_2_GPIO_RX, .pin_tx = USART_2_PIN_TX, 
+    .pin_rx = USART_2_PIN_RX, .alt_func_tx = USART_2_AF_TX, .alt_func_rx = USART_2_AF_RX,  
+    .p_port_cts = USART_2_GPIO_CTS, .p_port_rts = USART_2_GPIO_RTS, .pin_cts = USART_2_PIN_CTS, .pin_rts = USART_2_PIN_RTS, .alt_func_cts = USART_2_AF_CTS,
+    .flow_control = false, .rts_paused = false, .overruns = 0, .rs485 = false, .rs485_destination = 0, .address_sent = false,
+    .rx = {.framing = USART_FRAMING_TEXT}, .p_tx_data = NULL, .tx_length = 0, .o_idx = 0, .write_complete = false,
+    .baudrate = USART_2_BAUDRATE, .baud_error_ppm = 0, .autobaud_edges = 0, .autobaud_first_cycle = 0, .autobaud_done = false,},
+    [USART_3_ID] = {.p_usart = USART_3, .p_port_tx = USART_3_GPIO_TX, .p_port_rx = USART_3_GPIO_RX, .pin_tx = USART_3_PIN_TX, 
+    .pin_rx = USART_3_PIN_RX, .alt_func_tx = USART_3_AF_TX, .alt_func_rx = USART_3_AF_RX,  
+    .p_port_cts = NULL, .p_port_rts = NULL, .flow_control = false, .rts_paused = false, .overruns = 0, .rs485 = false, .rs485_destination = 0, .address_sent = false,
+    .rx = {.framing = USART_FRAMING_TEXT}, .p_tx_data = NULL, .tx_length = 0, .o_idx = 0, .write_complete = false,
+    .baudrate = USART_3_BAUDRATE, .baud_error_ppm = 0, .autobaud_edges = 0, .autobaud_first_cycle = 0, .autobaud_done = false,},
+    [USART_4_ID] = {.p_usart = USART_4, .p_port_tx = USART_4_GPIO_TX, .p_port_rx = USART_4_GPIO_RX, .pin_tx = USART_4_PIN_TX, 
+    .pin_rx = USART_4_PIN_RX, .alt_func_tx = USART_4_AF_TX, .alt_func_rx = USART_4_AF_RX,  
+    .p_port_cts = NULL, .p_port_rts = NULL, .flow_control = false, .rts_paused = false, .overruns = 0, .rs485 = false, .rs485_destination = 0, .address_sent = false,
+    .rx = {.framing = USART_FRAMING_TEXT}, .p_tx_data = NULL, .tx_length = 0, .o_idx = 0, .write_complete = false,
+    .baudrate = USART_4_BAUDRATE, .baud_error_ppm = 0, .autobaud_edges = 0, .autobaud_first_cycle = 0, .autobaud_done = false,}
 };
 
+/**
+ * @brief Static description of each USART peripheral: registers, interrupt line and clock enable bit.
+ */
+typedef struct {
+    USART_TypeDef * p_usart; /*Peripheral registers*/
+    IRQn_Type irqn; /*Interrupt line*/
+    volatile uint32_t * p_rcc_enr; /*RCC register with the clock enable bit*/
+    uint32_t rcc_en_mask; /*Clock enable bit*/
+} port_usart_periph_t;
+
+static const port_usart_periph_t usart_periphs [USART_PERIPH_NUMBER] = {
+    [USART_PERIPH_1] = {.p_usart = USART1, .irqn = USART1_IRQn, .p_rcc_enr = &RCC->APB2ENR, .rcc_en_mask = RCC_APB2ENR_USART1EN},
+    [USART_PERIPH_2] = {.p_usart = USART2, .irqn = USART2_IRQn, .p_rcc_enr = &RCC->APB1ENR, .rcc_en_mask = RCC_APB1ENR_USART2EN},
+    [USART_PERIPH_3] = {.p_usart = USART3, .irqn = USART3_IRQn, .p_rcc_enr = &RCC->APB1ENR, .rcc_en_mask = RCC_APB1ENR_USART3EN},
+    [USART_PERIPH_UART4] = {.p_usart = UART4, .irqn = UART4_IRQn, .p_rcc_enr = &RCC->APB1ENR, .rcc_en_mask = RCC_APB1ENR_UART4EN},
+    [USART_PERIPH_UART5] = {.p_usart = UART5, .irqn = UART5_IRQn, .p_rcc_enr = &RCC->APB1ENR, .rcc_en_mask = RCC_APB1ENR_UART5EN},
+    [USART_PERIPH_6] = {.p_usart = USART6, .irqn = USART6_IRQn, .p_rcc_enr = &RCC->APB2ENR, .rcc_en_mask = RCC_APB2ENR_USART6EN},
+};
+
+/**
+ * @brief ISR dispatch table: element of usart_arr[] that uses each peripheral (see usart_isr_route()).
+ */
+static uint8_t usart_isr_table [USART_PERIPH_NUMBER];
+
+_Static_assert((USART_SR_ORE == USART_ISR_ORE) && (USART_SR_RXNE == USART_ISR_RXNE) && (USART_SR_TC == USART_ISR_TC) && (USART_SR_TXE == USART_ISR_TXE), "The flags of SR must be at the positions decoded by usart_isr_events()");
+_Static_assert((USART_CR1_RXNEIE == USART_ISR_RXNE) && (USART_CR1_TCIE == USART_ISR_TC) && (USART_CR1_TXEIE == USART_ISR_TXE), "The interrupt enables of CR1 must be at the positions of their flags");
+
+/**
+ * @brief TX ring of the console (see port_usart_console_write()). The indexes are free-running: head is only written by the producer and tail only by the TXE interrupt.
+ */
+static struct {
+    char ring[USART_CONSOLE_RING_LENGTH]; /*Bytes to send*/
+    volatile uint32_t head; /*Index where the next byte is appended*/
+    volatile uint32_t tail; /*Index of the next byte to send*/
+    volatile uint32_t dropped; /*Bytes dropped because the ring was full*/
+    bool active; /*Flag to indicate that USART_CONSOLE_ID is the console*/
+} console;
+
 /* Private functions */
 
 /**
@@ -35,8 +100,209 @@ void _reset_buffer(char *buffer, uint32_t length)
     memset(buffer, EMPTY_BUFFER_CONSTANT, length);
 }
 
+/**
+ * @brief Drive the RTS line of a USART from the occupancy of its RX ring, with hysteresis between USART_RX_RTS_LOW_WATER and USART_RX_RTS_HIGH_WATER. It is called by the producer (RX ISR) after each byte and by the consumer after each frame read.
+ * 
+ * @param p_hw Pointer to the USART HW struct
+ */
+
+static void _update_rts(port_usart_hw_t *p_hw)
+{
+    if (!p_hw->flow_control)
+    {
+        return;
+    }
+    uint32_t used = usart_rx_get_used(&p_hw->rx);
+    if (!p_hw->rts_paused && (used >= USART_RX_RTS_HIGH_WATER))
+    {
+        p_hw->rts_paused = true;
+        port_system_gpio_write(p_hw->p_port_rts, p_hw->pin_rts, HIGH); // RTS is active low
+    }
+    else if (p_hw->rts_paused && (used <= USART_RX_RTS_LOW_WATER))
+    {
+        p_hw->rts_paused = false;
+        port_system_gpio_write(p_hw->p_port_rts, p_hw->pin_rts, LOW);
+    }
+}
+
+/**
+ * @brief Get the frequency of the peripheral clock of a USART. USART1 and USART6 are connected to APB2, the rest of them to APB1.
+ * 
+ * @param p_usart Pointer to the USART peripheral
+ * @return uint32_t Frequency of the peripheral clock in Hz
+ */
+
+static uint32_t _get_pclk(USART_TypeDef *p_usart)
+{
+    if ((p_usart == USART1) || (p_usart == USART6))
+    {
+        return SystemCoreClock >> APBPrescTable[(RCC->CFGR & RCC_CFGR_PPRE2) >> RCC_CFGR_PPRE2_Pos];
+    }
+    return SystemCoreClock >> APBPrescTable[(RCC->CFGR & RCC_CFGR_PPRE1) >> RCC_CFGR_PPRE1_Pos];
+}
+
+/**
+ * @brief Get the index of a USART peripheral in the usart_periphs[] table.
+ * 
+ * @param p_usart Pointer to the USART peripheral
+ * @return uint32_t Index of the peripheral (see enum USART_PERIPH), or USART_PERIPH_NUMBER if it is unknown
+ */
+
+static uint32_t _get_periph(USART_TypeDef *p_usart)
+{
+    uint32_t periph = 0;
+    while ((periph < USART_PERIPH_NUMBER) && (usart_periphs[periph].p_usart != p_usart))
+    {
+        periph++;
+    }
+    return periph;
+}
+
 /* Public functions */
 
+/**
+ * @brief Configure the baud rate of a given USART. The BRR value and the oversampling mode are computed from the current frequency of the peripheral clock (derived from SystemCoreClock).
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param baudrate Baud rate in bits per second (up to the peripheral clock frequency divided by 8)
+ * @return true if the baud rate has been set with an error lower than USART_BRR_MAX_ERROR_PPM
+ * @return false if the baud rate cannot be achieved. The previous configuration is kept.
+ */
+
+bool port_usart_set_baudrate (uint32_t usart_id, uint32_t baudrate){
+    USART_TypeDef *p_usart = usart_arr[usart_id].p_usart;
+    usart_brr_t brr;
+    if (!usart_brr_compute(_get_pclk(p_usart), baudrate, &brr))
+    {
+        return false;
+    }
+    uint32_t enabled = p_usart->CR1 & USART_CR1_UE;
+    p_usart->CR1 &= ~USART_CR1_UE; // OVER8 and BRR must be written with the USART disabled
+    if (brr.over8)
+    {
+        p_usart->CR1 |= USART_CR1_OVER8;
+    }
+    else
+    {
+        p_usart->CR1 &= ~USART_CR1_OVER8;
+    }
+    p_usart->BRR = brr.brr;
+    p_usart->CR1 |= enabled;
+    usart_arr[usart_id].baudrate = brr.actual_baudrate;
+    usart_arr[usart_id].baud_error_ppm = brr.error_ppm;
+    return true;
+}
+
+/**
+ * @brief Get the baud rate really achieved by a given USART.
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return uint32_t Achieved baud rate in bits per second
+ */
+
+uint32_t port_usart_get_baudrate (uint32_t usart_id){
+    return usart_arr[usart_id].baudrate;
+}
+
+/**
+ * @brief Get the relative error between the achieved and the requested baud rate.
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return int32_t Error in parts per million
+ */
+
+int32_t port_usart_get_baudrate_error_ppm (uint32_t usart_id){
+    return usart_arr[usart_id].baud_error_ppm;
+}
+
+/**
+ * @brief Enable or disable the byte pacing of a given USART. On the target, each byte always takes its byte time on the line, so there is nothing to configure: the function exists for the code shared with the native platform.
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param enable Ignored
+ */
+
+void port_usart_set_byte_pacing (uint32_t usart_id, bool enable){
+}
+
+/**
+ * @brief Check if the byte pacing of a given USART is enabled. It always is on the target.
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return true
+ */
+
+bool port_usart_get_byte_pacing (uint32_t usart_id){
+    return true;
+}
+
+/**
+ * @brief Start the auto-baud detection of a given USART.
+ * 
+ * The RX pin is temporarily configured as an EXTI input on falling edges. The sender must transmit the sync char USART_AUTOBAUD_SYNC_CHAR ('U', 0x55), whose falling edges are one every two bit times. The time between the first and the last one is measured with the cycle counter and the baud rate is set to the closest standard baud rate.
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ */
+
+void port_usart_autobaud_start (uint32_t usart_id){
+    port_usart_hw_t *p_hw = &usart_arr[usart_id];
+    p_hw->autobaud_edges = 0;
+    p_hw->autobaud_done = false;
+    p_hw->p_usart->CR1 &= ~USART_CR1_RE; // Do not receive the sync char as data
+    port_system_gpio_config(p_hw->p_port_rx, p_hw->pin_rx, GPIO_MODE_IN, GPIO_PUPDR_PUP);
+    port_system_gpio_config_exti(p_hw->p_port_rx, p_hw->pin_rx, TRIGGER_FALLING_EDGE | TRIGGER_ENABLE_INTERR_REQ);
+    EXTI->PR = BIT_POS_TO_MASK(p_hw->pin_rx);
+    port_system_gpio_exti_enable(p_hw->pin_rx, PRIORITY_2, SUBPRIORITY_0);
+}
+
+/**
+ * @brief Register a falling edge of the RX line during the auto-baud detection.
+ * 
+ * This function is called from port_usart_autobaud_isr() when the EXTI line of the RX pin is pending.
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ */
+
+void port_usart_autobaud_edge (uint32_t usart_id){
+    uint32_t now = port_system_get_cycles();
+    port_usart_hw_t *p_hw = &usart_arr[usart_id];
+    if (p_hw->autobaud_done)
+    {
+        return;
+    }
+    if (p_hw->autobaud_edges == 0)
+    {
+        p_hw->autobaud_first_cycle = now;
+    }
+    p_hw->autobaud_edges++;
+    if (p_hw->autobaud_edges < USART_AUTOBAUD_SYNC_EDGES)
+    {
+        return;
+    }
+
+    /* Last falling edge of the sync char: restore the RX pin and set the measured baud rate */
+    EXTI->IMR &= ~BIT_POS_TO_MASK(p_hw->pin_rx);
+    port_system_gpio_config(p_hw->p_port_rx, p_hw->pin_rx, GPIO_MODE_ALTERNATE, GPIO_PUPDR_PUP);
+    port_system_gpio_config_alternate(p_hw->p_port_rx, p_hw->pin_rx, p_hw->alt_func_rx);
+    uint32_t measured = usart_brr_baudrate_from_cycles(SystemCoreClock, now - p_hw->autobaud_first_cycle, USART_AUTOBAUD_SYNC_BITS);
+    port_usart_set_baudrate(usart_id, usart_brr_snap_standard(measured));
+    p_hw->p_usart->CR1 |= USART_CR1_RE;
+    p_hw->autobaud_edges = 0;
+    p_hw->autobaud_done = true;
+}
+
+/**
+ * @brief Check if the auto-baud detection has finished. Once it has finished, the new baud rate can be read with port_usart_get_baudrate().
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return true 
+ * @return false 
+ */
+
+bool port_usart_autobaud_done (uint32_t usart_id){
+    return usart_arr[usart_id].autobaud_done;
+}
+
 /**
  * @brief Check if a transmission is complete.
  * 
@@ -50,7 +316,7 @@ bool port_usart_tx_done (uint32_t usart_id){
 }
 
 /**
- * @brief Check if a reception is complete.
+ * @brief Check if there is, at least, one complete frame in the RX ring.
  * 
  * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
  * @return true 
@@ -58,20 +324,50 @@ bool port_usart_tx_done (uint32_t usart_id){
  */
 
 bool port_usart_rx_done (uint32_t usart_id){
-    return usart_arr[usart_id].read_complete;
+    return usart_rx_available(&usart_arr[usart_id].rx);
 }
 
 /**
- * @brief Get the message received through the USART and store it in the buffer passed as argument.
+ * @brief Get the oldest frame received through the USART, store it in the buffer passed as argument and release it from the RX ring.
  * 
  * This function is called from the function do_get_data_rx() of the FSM to store the message received to the buffer of the FSM.
  * 
  * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
- * @param p_buffer Pointer to the buffer where the message will be stored.
+ * @param p_buffer Pointer to the buffer where the message will be stored. It must be USART_INPUT_BUFFER_LENGTH bytes long.
+ * @return uint32_t Length of the frame in bytes. 0 if there was no frame.
  */
 
-void port_usart_get_from_input_buffer (uint32_t usart_id, char *p_buffer){
-    memcpy(p_buffer, usart_arr[usart_id].input_buffer, USART_INPUT_BUFFER_LENGTH);
+uint32_t port_usart_get_from_input_buffer (uint32_t usart_id, char *p_buffer){
+    uint32_t length = usart_rx_pop(&usart_arr[usart_id].rx, p_buffer);
+    _update_rts(&usart_arr[usart_id]);
+    return length;
+}
+
+/**
+ * @brief Select the framing of the received data. The RX ring is flushed.
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param framing USART_FRAMING_TEXT or USART_FRAMING_COBS
+ */
+
+void port_usart_set_framing (uint32_t usart_id, uint8_t framing){
+    port_usart_hw_t *p_hw = &usart_arr[usart_id];
+    uint32_t rx_enabled = p_hw->p_usart->CR1 & USART_CR1_RXNEIE;
+    port_usart_disable_rx_interrupt(usart_id);
+    usart_rx_set_framing(&p_hw->rx, framing);
+    _update_rts(p_hw);
+    p_hw->p_usart->CR1 |= rx_enabled;
+}
+
+/**
+ * @brief Get the number of received frames that have been discarded because they were corrupted, too long or did not fit in the RX ring.
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return uint32_t Number of discarded frames
+ */
+
+uint32_t port_usart_get_rx_frame_errors (uint32_t usart_id){
+    return usart_arr[usart_id].rx.frame_errors;
 }
 
 /**
@@ -88,101 +384,313 @@ bool port_usart_get_txr_status (uint32_t usart_id){
 }
 
 /**
- * @brief Copy the message passed as argument to the output buffer of the USART.
+ * @brief Connect the receiver of a given USART to its own transmitter, so every byte sent is received back. It uses the half-duplex mode (HDSEL): the line is the TX pin and the RX pin is released.
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param enable true to loop back, false to go back to the full-duplex mode
+ */
+
+void port_usart_set_loopback (uint32_t usart_id, bool enable){
+    USART_TypeDef *p_usart = usart_arr[usart_id].p_usart;
+    uint32_t enabled = p_usart->CR1 & USART_CR1_UE;
+    p_usart->CR1 &= ~USART_CR1_UE; // HDSEL must be written with the USART disabled
+    if (enable)
+    {
+        p_usart->CR3 |= USART_CR3_HDSEL;
+    }
+    else
+    {
+        p_usart->CR3 &= ~USART_CR3_HDSEL;
+    }
+    p_usart->CR1 |= enabled;
+}
+
+/**
+ * @brief Enable or disable the RTS/CTS hardware flow control of a given USART.
+ * 
+ * CTS is served by the peripheral (CTSE): the transmitter does not start a byte while the peer deasserts it, so it must be connected. RTS is driven as a GPIO from the occupancy of the RX ring instead of the RXNE flag (RTSE): it is deasserted above USART_RX_RTS_HIGH_WATER bytes and asserted again once the ring is drained below USART_RX_RTS_LOW_WATER bytes, so the sender pauses instead of losing data while the main loop is busy.
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param enable true to enable the flow control, false to disable it
+ * @return true if the flow control has been configured
+ * @return false if the USART has no flow control pins
+ */
+
+bool port_usart_set_flow_control (uint32_t usart_id, bool enable){
+    port_usart_hw_t *p_hw = &usart_arr[usart_id];
+    if ((p_hw->p_port_cts == NULL) || (p_hw->p_port_rts == NULL))
+    {
+        return false;
+    }
+    USART_TypeDef *p_usart = p_hw->p_usart;
+    uint32_t enabled = p_usart->CR1 & USART_CR1_UE;
+    p_usart->CR1 &= ~USART_CR1_UE; // CTSE must be written with the USART disabled
+    if (enable)
+    {
+        port_system_gpio_config(p_hw->p_port_cts, p_hw->pin_cts, GPIO_MODE_ALTERNATE, GPIO_PUPDR_PUP);
+        port_system_gpio_config_alternate(p_hw->p_port_cts, p_hw->pin_cts, p_hw->alt_func_cts);
+        port_system_gpio_config(p_hw->p_port_rts, p_hw->pin_rts, GPIO_MODE_OUT, GPIO_PUPDR_NOPULL);
+        port_system_gpio_write(p_hw->p_port_rts, p_hw->pin_rts, LOW);
+        p_hw->rts_paused = false;
+        p_hw->flow_control = true;
+        _update_rts(p_hw); // Pause the peer at once if the ring is already above the high watermark
+        p_usart->CR3 |= USART_CR3_CTSE;
+    }
+    else
+    {
+        p_usart->CR3 &= ~USART_CR3_CTSE;
+        p_hw->flow_control = false;
+        p_hw->rts_paused = false;
+        port_system_gpio_write(p_hw->p_port_rts, p_hw->pin_rts, LOW); // Leave the peer allowed to send
+    }
+    p_usart->CR1 |= enabled;
+    return true;
+}
+
+/**
+ * @brief Get the number of received bytes lost because the previous one had not been read from DR yet (overrun error, ORE).
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return uint32_t Number of overruns
+ */
+
+uint32_t port_usart_get_overruns (uint32_t usart_id){
+    return usart_arr[usart_id].overruns;
+}
+
+/**
+ * @brief Make a given USART a node of a multi-drop RS-485 bus, or go back to the point-to-point mode.
+ * 
+ * The transceiver is half-duplex: its driver enable (DE) is driven from the RTS pin, asserted when a message is set and released from the transmission complete (TC) interrupt, once the stop bit of the last byte has left the line. Each message is preceded by the address of its destination (see port_usart_set_rs485_destination()), sent as a 9-bit word with USART_ADDRESS_MARK set. The receiver is in mute mode with wakeup by address mark (WAKE and RWU), so the frames sent to other nodes are discarded by the hardware and raise no interrupt.
+ * 
+ * @note The receiver compares the 4 LSBs of the address (ADD), so a bus has up to 16 nodes. The RTS/CTS flow control is disabled.
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param enable true to join the bus, false to go back to the point-to-point mode
+ * @param address Own address of the node on the bus
+ * @return true if the mode has been configured
+ * @return false if the USART has no RTS pin to drive DE
+ */
+
+bool port_usart_set_rs485 (uint32_t usart_id, bool enable, uint8_t address){
+    port_usart_hw_t *p_hw = &usart_arr[usart_id];
+    if (p_hw->p_port_rts == NULL)
+    {
+        return false;
+    }
+    port_usart_set_flow_control(usart_id, false);
+    USART_TypeDef *p_usart = p_hw->p_usart;
+    uint32_t enabled = p_usart->CR1 & USART_CR1_UE;
+    p_usart->CR1 &= ~USART_CR1_UE; // M and WAKE must be written with the USART disabled
+    port_system_gpio_config(p_hw->p_port_rts, p_hw->pin_rts, GPIO_MODE_OUT, GPIO_PUPDR_NOPULL);
+    port_system_gpio_write(p_hw->p_port_rts, p_hw->pin_rts, LOW); // Transceiver listening
+    if (enable)
+    {
+        p_usart->CR2 = (p_usart->CR2 & ~USART_CR2_ADD) | (address & USART_ADDRESS_MASK);
+        p_usart->CR1 |= USART_CR1_M | USART_CR1_WAKE; // 9 data bits: the 9th one is the address mark
+    }
+    else
+    {
+        p_usart->CR1 &= ~(USART_CR1_M | USART_CR1_WAKE | USART_CR1_RWU | USART_CR1_TCIE);
+    }
+    p_hw->rs485 = enable;
+    p_usart->CR1 |= enabled;
+    if (enable)
+    {
+        p_usart->CR1 |= USART_CR1_RWU; // Mute until the node is addressed
+    }
+    return true;
+}
+
+/**
+ * @brief Select the node the next messages of a given USART in RS-485 mode are sent to.
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @param address Address of the destination node
+ */
+
+void port_usart_set_rs485_destination (uint32_t usart_id, uint8_t address){
+    usart_arr[usart_id].rs485_destination = address & USART_ADDRESS_MASK;
+}
+
+/**
+ * @brief Set the message to send through the USART. The message is not copied: the ISR reads it straight from the given buffer.
  * 
  * This function is called from the function do_set_data_tx() of the FSM to set the message to send to the USART.
  * 
  * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
- * @param p_data Pointer to the message to send.
+ * @param p_data Pointer to the message to send. It must remain valid until the transmission is complete.
  * @param length Length of the message to send.
  */
 
-void port_usart_copy_to_output_buffer (uint32_t usart_id, char *p_data, uint32_t length){
-    _reset_buffer(usart_arr[usart_id].output_buffer, length);
-    memcpy(usart_arr[usart_id].output_buffer, p_data, length);
+void port_usart_set_output_buffer (uint32_t usart_id, const char *p_data, uint32_t length){
+    port_usart_hw_t *p_hw = &usart_arr[usart_id];
+    p_hw->p_tx_data = p_data;
+    p_hw->tx_length = length;
+    p_hw->o_idx = 0;
+    p_hw->write_complete = false;
+    if (p_hw->rs485)
+    {
+        p_hw->address_sent = false;
+        port_system_gpio_write(p_hw->p_port_rts, p_hw->pin_rts, HIGH); // Take the bus before the first start bit
+    }
 }
 
 /**
- * @brief Reset the input buffer of the USART.
- * 
- * This function is called from the function do_get_data_rx() to reset the input buffer of the USART after the message has been read.
+ * @brief Reset the input buffer of the USART. All the complete frames pending in the RX ring are discarded.
  * 
  * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
  */
 
 void port_usart_reset_input_buffer (uint32_t usart_id){
-    _reset_buffer(usart_arr[usart_id].input_buffer, USART_INPUT_BUFFER_LENGTH);
-    usart_arr[usart_id].read_complete = false;
+    usart_rx_flush(&usart_arr[usart_id].rx);
+    _update_rts(&usart_arr[usart_id]);
 }
 
 /**
  * @brief Reset the output buffer of the USART.
  * 
- * This function is called from the function do_set_data_tx() and do_tx_end() to reset the output buffer of the USART after the message has been sent.
+ * This function is called from the function do_tx_end() to release the output buffer of the USART after the message has been sent.
  * 
  * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
  */
 
 void port_usart_reset_output_buffer (uint32_t usart_id){
-    _reset_buffer(usart_arr[usart_id].output_buffer, USART_OUTPUT_BUFFER_LENGTH);
+    usart_arr[usart_id].p_tx_data = NULL;
+    usart_arr[usart_id].tx_length = 0;
+    usart_arr[usart_id].o_idx = 0;
     usart_arr[usart_id].write_complete = false;
 }
 
 /**
- * @brief Function to read the data from the USART Data Register and store it in the input buffer.
- * 
- * This function is called from the ISR USART3_IRQHandler() when the RXNE flag is set.
+ * @brief Shared body of the interrupt service routines of all the USARTs: serve the RXNE, TXE and TC events of a given USART.
  * 
  * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
  */
 
-void port_usart_store_data (uint32_t usart_id){
-    char char_read = USART3->DR;
-    if (char_read != END_CHAR_CONSTANT)
+void port_usart_isr (uint32_t usart_id){
+    USART_TypeDef *p_usart = usart_arr[usart_id].p_usart;
+    uint32_t events = usart_isr_events(p_usart->SR, p_usart->CR1);
+    if (events & USART_ISR_RXNE)
     {
-        if(usart_arr[usart_id].i_idx >= USART_INPUT_BUFFER_LENGTH)
+        if (events & USART_ISR_ORE)
         {
-            usart_arr[usart_id].i_idx = 0;
-            usart_arr[usart_id].input_buffer[usart_arr[usart_id].i_idx] = char_read;
-            usart_arr[usart_id].i_idx = usart_arr[usart_id].i_idx+1;
+            usart_arr[usart_id].overruns++;
+            METRICS_INC_SHARED(USART_OVERRUNS);
         }
-        else
+        port_usart_store_data(usart_id);
+    }
+    if (events & USART_ISR_TXE)
+    {
+        port_usart_write_data(usart_id);
+    }
+    if (events & USART_ISR_TC)
+    {
+        /* RS-485: the stop bit of the last byte has left the line, so the bus is released */
+        p_usart->CR1 &= ~USART_CR1_TCIE;
+        p_usart->SR = ~(uint32_t)USART_SR_TC; // The flags are rc_w0: writing 1 leaves them, so a read-modify-write could clear an RXNE set meanwhile
+        port_system_gpio_write(usart_arr[usart_id].p_port_rts, usart_arr[usart_id].pin_rts, LOW);
+        usart_arr[usart_id].write_complete = true;
+    }
+}
+
+/**
+ * @brief Serve the interrupt of a USART peripheral. The peripheral is mapped to the element of usart_arr[] that uses it, through a table filled in by port_usart_init().
+ * 
+ * This function is called from the ISRs USARTx_IRQHandler() and UARTx_IRQHandler(). Interrupts of peripherals that have not been initialized are ignored.
+ * 
+ * @param periph Peripheral that raised the interrupt (see enum USART_PERIPH)
+ */
+
+void port_usart_isr_dispatch (uint32_t periph){
+    uint32_t usart_id;
+    if (usart_isr_lookup(usart_isr_table, periph, &usart_id))
+    {
+        port_usart_isr(usart_id);
+    }
+}
+
+/**
+ * @brief Serve the EXTI interrupts of the RX pins of the USARTs that are running the auto-baud detection.
+ * 
+ * This function is called from the ISR EXTI15_10_IRQHandler(), so the auto-baud detection is available for RX pins 10 to 15.
+ */
+
+void port_usart_autobaud_isr (void){
+    for (uint32_t usart_id = 0; usart_id < USARTS_NUMBER; usart_id++)
+    {
+        uint32_t mask = BIT_POS_TO_MASK(usart_arr[usart_id].pin_rx);
+        if ((EXTI->PR & EXTI->IMR & mask) && (usart_arr[usart_id].p_usart->CR1 & USART_CR1_RE) == 0)
         {
-        usart_arr[usart_id].input_buffer[usart_arr[usart_id].i_idx] = char_read;
-        usart_arr[usart_id].i_idx = usart_arr[usart_id].i_idx+1;
+            EXTI->PR = mask;
+            port_usart_autobaud_edge(usart_id);
         }
     }
-    else
+}
+
+/**
+ * @brief Function to read the data from the USART Data Register and store it in the RX ring.
+ * 
+ * This function is called from port_usart_isr() when the RXNE flag is set. The framing of the byte is handled by usart_rx_push(). In RS-485 mode, the address word that woke the receiver up is not data: the frames for other nodes never get here.
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ */
+
+void port_usart_store_data (uint32_t usart_id){
+    uint32_t word = usart_arr[usart_id].p_usart->DR;
+    if (word & USART_ADDRESS_MARK)
     {
-        usart_arr[usart_id].read_complete = 1;
-        usart_arr[usart_id].i_idx = 0;
+        return;
     }
+    usart_rx_push(&usart_arr[usart_id].rx, (uint8_t)word);
+    _update_rts(&usart_arr[usart_id]);
 }
 
 /**
- * @brief Function to write the data from the output buffer to the USART Data Register.
+ * @brief Function to write the next byte of the output message to the USART Data Register.
  * 
- * This function is called from the ISR USART3_IRQHandler() when the TXE flag is set.
+ * This function is called from port_usart_isr() when the TXE flag is set. Once the last byte has been written, it disables the TX interrupt and flags the transmission as complete. The console sends the bytes of its TX ring instead. In RS-485 mode, the address of the destination is written first and the transmission is complete once the TC interrupt has released the bus.
  * 
  * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
  */
 
 void port_usart_write_data (uint32_t usart_id){
-    uint32_t o_idx = usart_arr[usart_id].o_idx;
-    char char_write = usart_arr[usart_id].output_buffer[o_idx];
-    if ((o_idx == USART_OUTPUT_BUFFER_LENGTH-1) | (char_write == END_CHAR_CONSTANT))
+    port_usart_hw_t *p_hw = &usart_arr[usart_id];
+    if (console.active && (usart_id == USART_CONSOLE_ID))
     {
-        USART3->DR = char_write;
-        port_usart_disable_tx_interrupt(usart_id);
-        usart_arr[usart_id].o_idx = 0;
-        usart_arr[usart_id].write_complete = 1;
+        uint32_t tail = console.tail;
+        if (tail != console.head)
+        {
+            p_hw->p_usart->DR = (uint8_t)console.ring[tail & (USART_CONSOLE_RING_LENGTH - 1)];
+            console.tail = tail + 1;
+        }
+        if (console.tail == console.head)
+        {
+            port_usart_disable_tx_interrupt(usart_id);
+        }
+        return;
     }
-    else
+    if (p_hw->rs485 && !p_hw->address_sent)
+    {
+        p_hw->p_usart->DR = USART_ADDRESS_MARK | p_hw->rs485_destination;
+        p_hw->address_sent = true;
+        return;
+    }
+    if (p_hw->o_idx < p_hw->tx_length)
     {
-        if(char_write != EMPTY_BUFFER_CONSTANT)
+        p_hw->p_usart->DR = (uint8_t)p_hw->p_tx_data[p_hw->o_idx];
+        p_hw->o_idx++;
+    }
+    if (p_hw->o_idx >= p_hw->tx_length)
+    {
+        port_usart_disable_tx_interrupt(usart_id);
+        if (p_hw->rs485)
         {
-            USART3->DR = char_write;
-            usart_arr[usart_id].o_idx++;
+            p_hw->p_usart->CR1 |= USART_CR1_TCIE; // Keep DE asserted until the last byte has left the shift register
+        }
+        else
+        {
+            p_hw->write_complete = true;
         }
     }
 }
@@ -194,17 +702,17 @@ void port_usart_write_data (uint32_t usart_id){
  */
 
 void port_usart_disable_rx_interrupt (uint32_t usart_id){
-    USART3->CR1 &= ~USART_CR1_RXNEIE;
+    usart_arr[usart_id].p_usart->CR1 &= ~USART_CR1_RXNEIE;
 }
 
 /**
- * @brief Enable USART TX interrupts.
+ * @brief Disable USART TX interrupts.
  * 
  * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
  */
 
 void port_usart_disable_tx_interrupt (uint32_t usart_id){
-    USART3->CR1 &= ~USART_CR1_TXEIE;
+    usart_arr[usart_id].p_usart->CR1 &= ~USART_CR1_TXEIE;
 }
 
 /**
@@ -214,7 +722,7 @@ void port_usart_disable_tx_interrupt (uint32_t usart_id){
  */
 
 void port_usart_enable_rx_interrupt (uint32_t usart_id){
-    USART3->CR1 |= USART_CR1_RXNEIE;
+    usart_arr[usart_id].p_usart->CR1 |= USART_CR1_RXNEIE;
 }
 
 /**
@@ -224,17 +732,16 @@ void port_usart_enable_rx_interrupt (uint32_t usart_id){
  */
 
 void port_usart_enable_tx_interrupt (uint32_t usart_id){
-        USART3->CR1 |= USART_CR1_TXEIE;
+    usart_arr[usart_id].p_usart->CR1 |= USART_CR1_TXEIE;
 }
 
 /**
- * @brief Configure the HW specifications of a given USART.
+ * @brief Configure the HW specifications of a given USART. It is called by port_usart_init() and by the console, which may take USART_CONSOLE_ID.
  * 
  * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
  */
 
-
-void port_usart_init(uint32_t usart_id)
+static void _usart_init(uint32_t usart_id)
 {
     USART_TypeDef *p_usart = usart_arr[usart_id].p_usart;
     GPIO_TypeDef *p_port_tx = usart_arr[usart_id].p_port_tx;
@@ -248,23 +755,118 @@ void port_usart_init(uint32_t usart_id)
     port_system_gpio_config(p_port_rx, pin_rx, GPIO_MODE_ALTERNATE, GPIO_PUPDR_PUP);
     port_system_gpio_config_alternate(p_port_tx, pin_tx, alt_func_tx);
     port_system_gpio_config_alternate(p_port_rx, pin_rx, alt_func_rx);
-    if (p_usart == USART3)
-    {
-        RCC->APB1ENR |= RCC_APB1ENR_USART3EN; // Enable peripheral clock
-        USART3->CR1 &= ~USART_CR1_UE; // Disable USART3 to configure the registers
-        USART3->CR1 &= ~USART_CR1_M; // Data length to 8 bits
-        USART3->CR2 &= ~USART_CR2_STOP; // Stop bit to 1
-        USART3->CR1 &= ~USART_CR1_PCE; // Parity bit to no parity
-        USART3->CR1 &= ~USART_CR1_OVER8; // Oversampling of 16
-        USART3->BRR = 0x682; // Cálculo: 16000000/(8x2x9600) y después calculamos la parte decimal
-        USART3->CR1 |= USART_CR1_TE | USART_CR1_RE; // Enable tx and rx
-        port_usart_disable_tx_interrupt(usart_id);
-        port_usart_disable_rx_interrupt(usart_id);
-        p_usart->SR &= ~USART_SR_RXNE; // Clear RXNE flag
-        NVIC_SetPriority(USART3_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 2, 0));
-        NVIC_EnableIRQ(USART3_IRQn);
-        USART3->CR1 |= USART_CR1_UE;
-    }
-    _reset_buffer(usart_arr[usart_id].input_buffer, USART_INPUT_BUFFER_LENGTH);
-    _reset_buffer(usart_arr[usart_id].output_buffer, USART_OUTPUT_BUFFER_LENGTH);
-}
\ No newline at end of file
+    uint32_t periph = _get_periph(p_usart);
+    if (periph >= USART_PERIPH_NUMBER)
+    {
+        return;
+    }
+    *usart_periphs[periph].p_rcc_enr |= usart_periphs[periph].rcc_en_mask; // Enable peripheral clock
+    p_usart->CR1 &= ~USART_CR1_UE; // Disable the USART to configure the registers
+    p_usart->CR1 &= ~USART_CR1_M; // Data length to 8 bits
+    p_usart->CR2 &= ~USART_CR2_STOP; // Stop bit to 1
+    p_usart->CR1 &= ~USART_CR1_PCE; // Parity bit to no parity
+    port_usart_set_baudrate(usart_id, usart_arr[usart_id].baudrate); // BRR and oversampling computed from SystemCoreClock
+    p_usart->CR1 |= USART_CR1_TE | USART_CR1_RE; // Enable tx and rx
+    port_usart_disable_tx_interrupt(usart_id);
+    port_usart_disable_rx_interrupt(usart_id);
+    p_usart->SR &= ~USART_SR_RXNE; // Clear RXNE flag
+    usart_isr_route(usart_isr_table, periph, usart_id);
+    NVIC_SetPriority(usart_periphs[periph].irqn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), PRIORITY_2, SUBPRIORITY_0));
+    NVIC_EnableIRQ(usart_periphs[periph].irqn);
+    p_usart->CR1 |= USART_CR1_UE;
+    _reset_buffer((char *)usart_arr[usart_id].rx.ring, USART_RX_RING_LENGTH);
+    port_usart_set_framing(usart_id, usart_arr[usart_id].rx.framing);
+    port_usart_reset_output_buffer(usart_id);
+}
+
+/**
+ * @brief Configure the HW specifications of a given USART.
+ * 
+ * If USE_STDIO_USART is defined, USART_CONSOLE_ID is reserved for printf(): its TXE interrupt sends the bytes of the console, and the first printf() configures it again. It is refused, so that it is not shared by both.
+ * 
+ * @param usart_id USART ID. This index is used to select the element of the usart_arr[] array
+ * @return true if the USART has been configured, false if it is the console
+ */
+
+bool port_usart_init(uint32_t usart_id)
+{
+#ifdef USE_STDIO_USART
+    if (usart_id == USART_CONSOLE_ID)
+    {
+        return false;
+    }
+#endif
+    _usart_init(usart_id);
+    return true;
+}
+
+/**
+ * @brief Configure the console: the USART USART_CONSOLE_ID sends the bytes of a TX ring from its TXE interrupt. It is called by the first port_usart_console_write(), so printf() needs no explicit initialization.
+ */
+
+void port_usart_console_init (void){
+    console.active = false;
+    _usart_init(USART_CONSOLE_ID);
+    console.head = 0;
+    console.tail = 0;
+    console.dropped = 0;
+    console.active = true;
+}
+
+/**
+ * @brief Append bytes to the TX ring of the console and start sending them. It never waits: the bytes that do not fit in the ring are dropped and counted.
+ * 
+ * This function is called from _write() (syscalls.c), so it is the back end of printf(). The ring is lock-free with one producer, so it must not be called from interrupts.
+ * 
+ * @param p_data Pointer to the bytes to send
+ * @param length Number of bytes to send
+ * @return uint32_t Number of bytes appended to the ring
+ */
+
+uint32_t port_usart_console_write (const char *p_data, uint32_t length){
+    if (!console.active)
+    {
+        port_usart_console_init();
+    }
+    uint32_t head = console.head;
+    uint32_t room = USART_CONSOLE_RING_LENGTH - (head - console.tail);
+    uint32_t n = (length < room) ? length : room;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        console.ring[(head + i) & (USART_CONSOLE_RING_LENGTH - 1)] = p_data[i];
+    }
+    __DMB(); // The bytes must be in the ring before the TXE interrupt sees the new head
+    console.head = head + n;
+    console.dropped += length - n;
+    if (n > 0)
+    {
+        port_usart_enable_tx_interrupt(USART_CONSOLE_ID);
+    }
+    return n;
+}
+
+/**
+ * @brief Wait until all the bytes of the TX ring of the console have left the USART.
+ * 
+ * @warning It relies on the TXE interrupt, so it must not be called with interrupts disabled.
+ */
+
+void port_usart_console_flush (void){
+    if (!console.active)
+    {
+        return;
+    }
+    while ((console.tail != console.head) || !(usart_arr[USART_CONSOLE_ID].p_usart->SR & USART_SR_TC))
+    {
+    }
+}
+
+/**
+ * @brief Get the number of bytes dropped by the console because its TX ring was full.
+ * 
+ * @return uint32_t Number of bytes dropped
+ */
+
+uint32_t port_usart_console_get_dropped (void){
+    return console.dropped;
+}
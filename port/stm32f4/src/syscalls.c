@@ -34,6 +34,7 @@
 #include <sys/times.h>
 
 #include "stm32f4xx.h"
+#include "port_usart.h"
 
 /* Variables */
 #undef errno
@@ -68,7 +69,9 @@ void _exit (int status)
 }
 
 /**
- * @brief Function able to use printf via SWO:ITM. It prints the messages on a terminal in VSCode.
+ * @brief Back end of printf. If USE_STDIO_USART is defined, the bytes are appended to the TX ring of the console USART (see port_usart_console_write()) and the caller never waits. Otherwise they are sent via SWO:ITM, to a terminal in VSCode.
+ *
+ * @note All the bytes are reported as written, even those dropped by a full console ring: newlib would retry a short write and block the caller.
  *
  * @param file
  * @param ptr
@@ -77,11 +80,15 @@ void _exit (int status)
  */
 int _write(int file, char *ptr, int len)
 {
+#ifdef USE_STDIO_USART
+    port_usart_console_write(ptr, (uint32_t)len);
+#else
     int i = 0;
     for (i = 0; i < len; i++)
     {
         ITM_SendChar((*ptr++));
     }
+#endif
     return len;
 }
 
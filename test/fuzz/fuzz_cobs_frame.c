@@ -0,0 +1,94 @@
+/**
+ * @file fuzz_cobs_frame.c
+ * @brief libFuzzer target for the incremental COBS frame decoder.
+ *
+ * The input is fed byte by byte to the decoder, as the USART ISR does. Every frame accepted by the decoder must fit in its limit and must be rebuilt by the encoder. The input is also used as a payload, that must survive an encode/decode round trip.
+ *
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+/* Other includes */
+#include "cobs_frame.h"
+
+#define FUZZ_MAX_FRAME_LENGTH 66 /*Decoded frame limit, CRC included, as used by the USART RX ring*/
+#define FUZZ_MAX_PAYLOAD_LENGTH 1024 /*Longest payload used for the round trip*/
+
+/**
+ * @brief Abort if a condition does not hold, so that libFuzzer reports the input.
+ */
+
+#define FUZZ_ASSERT(cond) do { if (!(cond)) { abort(); } } while (0)
+
+static uint8_t decoded[FUZZ_MAX_PAYLOAD_LENGTH + COBS_FRAME_CRC_LENGTH];
+static uint8_t encoded[COBS_FRAME_MAX_ENCODED_LENGTH(FUZZ_MAX_PAYLOAD_LENGTH)];
+
+/**
+ * @brief Decode a stream byte by byte. Returns the length of the last right frame, CRC excluded, or -1 if there was none.
+ */
+
+static int32_t decode_stream(const uint8_t *p_data, size_t size, uint32_t max_length)
+{
+    cobs_decoder_t decoder;
+    cobs_decoder_init(&decoder, max_length);
+    uint32_t n = 0;
+    int32_t last = -1;
+    for (size_t i = 0; i < size; i++)
+    {
+        uint8_t byte;
+        bool byte_valid;
+        cobs_frame_status_t status = cobs_decoder_push(&decoder, p_data[i], &byte, &byte_valid);
+        if (byte_valid)
+        {
+            FUZZ_ASSERT(n < max_length);
+            decoded[n++] = byte;
+        }
+        if (status == COBS_FRAME_OK)
+        {
+            FUZZ_ASSERT(n >= COBS_FRAME_CRC_LENGTH);
+            FUZZ_ASSERT(cobs_frame_crc16(decoded, n, COBS_FRAME_CRC_INIT) == 0);
+            last = (int32_t)(n - COBS_FRAME_CRC_LENGTH);
+        }
+        if (status != COBS_FRAME_NONE || p_data[i] == COBS_FRAME_DELIMITER)
+        {
+            n = 0;
+        }
+    }
+    return last;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *p_data, size_t size)
+{
+    /* Arbitrary stream: the decoder must never write past its limit and must only accept right frames */
+    int32_t length = decode_stream(p_data, size, FUZZ_MAX_FRAME_LENGTH);
+    if (length > 0)
+    {
+        /* An accepted frame is rebuilt by the encoder. Copy the payload first: the decoder reuses the buffer */
+        uint8_t payload[FUZZ_MAX_FRAME_LENGTH];
+        memcpy(payload, decoded, (size_t)length);
+        uint32_t encoded_length = cobs_frame_encode(payload, (uint32_t)length, encoded, sizeof(encoded));
+        FUZZ_ASSERT(encoded_length > 0);
+        FUZZ_ASSERT(decode_stream(encoded, encoded_length, FUZZ_MAX_FRAME_LENGTH) == length);
+        FUZZ_ASSERT(memcmp(decoded, payload, (size_t)length) == 0);
+    }
+
+    /* Round trip: the input used as payload */
+    if ((size == 0) || (size > FUZZ_MAX_PAYLOAD_LENGTH))
+    {
+        return 0;
+    }
+    uint32_t encoded_length = cobs_frame_encode(p_data, (uint32_t)size, encoded, sizeof(encoded));
+    FUZZ_ASSERT(encoded_length > 0);
+    FUZZ_ASSERT(encoded_length <= COBS_FRAME_MAX_ENCODED_LENGTH(size));
+    FUZZ_ASSERT(memchr(encoded, COBS_FRAME_DELIMITER, encoded_length - 1) == NULL);
+    FUZZ_ASSERT(encoded[encoded_length - 1] == COBS_FRAME_DELIMITER);
+    FUZZ_ASSERT(decode_stream(encoded, encoded_length, sizeof(decoded)) == (int32_t)size);
+    FUZZ_ASSERT(memcmp(decoded, p_data, size) == 0);
+    return 0;
+}
@@ -0,0 +1,130 @@
+/**
+ * @file test_button_debounce_bench.c
+ * @brief Main-loop iterations per button press with the debounce of the FSM (AFTER() transitions in the wait states) and with the timer debounce of the port (fsm_button_set_timer_debounce()).
+ *
+ * A "finger" thread presses and releases the button BENCH_PRESSES times, with BENCH_BOUNCES bounces on each edge, and wakes up the core as the EXTI interrupt does. The main loop fires the button FSM with fsm_button_fire() and sleeps with port_system_sleep() for the time fsm_button_get_next_ms() allows, as the application does. The iterations of the loop are counted from the first edge of each press until its duration is reported.
+ *
+ * With the FSM debounce the loop sleeps in the wait states until the end of the debounce, but it spins while the button is held, polling its level. With the timer debounce it sleeps until the next interrupt. On the native platform the system tick still wakes the loop up every millisecond; on the target the SysTick is suspended while sleeping, so only the edges and the timer wake it up.
+ *
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+/* Other includes */
+#include <fsm.h>
+#include "port_system.h"
+#include "port_button.h"
+#include "fsm_button.h"
+
+#define BENCH_PRESSES 10 /*Presses in each phase*/
+#define BENCH_BOUNCES 6 /*Level changes on each edge before the button settles*/
+#define BENCH_BOUNCE_US 500 /*Time between two bounces*/
+#define BENCH_HOLD_MS 300 /*Time the button is held pressed*/
+#define BENCH_GAP_MS 400 /*Time between a release and the next press*/
+
+static volatile uint32_t edge_presses; /*Presses started by the finger thread*/
+static volatile bool finger_done; /*Flag to indicate that the finger thread has finished the presses of the phase*/
+
+/**
+ * @brief Change the level of the button, bouncing, and wake up the core as the EXTI interrupt does.
+ */
+
+static void bounce_to(bool pressed)
+{
+    for (uint32_t i = 0; i < BENCH_BOUNCES; i++)
+    {
+        buttons_arr[BUTTON_0_ID].flag_pressed = (i % 2 == 0) ? pressed : !pressed;
+        port_system_wakeup();
+        usleep(BENCH_BOUNCE_US);
+    }
+    buttons_arr[BUTTON_0_ID].flag_pressed = pressed;
+    port_system_wakeup();
+}
+
+/**
+ * @brief Finger thread: press and release the button BENCH_PRESSES times.
+ */
+
+static void *finger(void *p_arg)
+{
+    for (uint32_t i = 0; i < BENCH_PRESSES; i++)
+    {
+        usleep(BENCH_GAP_MS * 1000);
+        edge_presses++;
+        bounce_to(true);
+        usleep(BENCH_HOLD_MS * 1000);
+        bounce_to(false);
+    }
+    usleep(BENCH_GAP_MS * 1000);
+    finger_done = true;
+    port_system_wakeup();
+    return NULL;
+}
+
+/**
+ * @brief Run one phase and print the iterations per press.
+ */
+
+static void run(fsm_t *p_fsm, bool timer_debounce)
+{
+    fsm_button_set_timer_debounce(p_fsm, timer_debounce);
+    fsm_button_reset_duration(p_fsm);
+    edge_presses = 0;
+    finger_done = false;
+    pthread_t thread;
+    pthread_create(&thread, NULL, finger, NULL);
+
+    uint64_t iterations = 0;
+    uint64_t total = 0;
+    uint32_t presses = 0;
+    uint32_t max = 0;
+    uint32_t min = UINT32_MAX;
+    while (!finger_done)
+    {
+        fsm_button_fire(p_fsm);
+        if (edge_presses > presses)
+        {
+            iterations++; // Only the iterations during a press are counted
+        }
+        if (fsm_button_get_duration(p_fsm) > 0)
+        {
+            fsm_button_reset_duration(p_fsm);
+            presses++;
+            total += iterations;
+            max = (iterations > max) ? (uint32_t)iterations : max;
+            min = (iterations < min) ? (uint32_t)iterations : min;
+            iterations = 0;
+        }
+        uint32_t next_ms = fsm_button_get_next_ms(p_fsm);
+        if (next_ms > 0)
+        {
+            if (next_ms != FSM_TIMED_NONE)
+            {
+                port_system_wakeup_timer_set(next_ms);
+            }
+            port_system_sleep();
+        }
+    }
+    pthread_join(thread, NULL);
+    printf("%-5s debounce | presses %2lu/%u | iterations per press avg %10lu min %10lu max %10lu\n", timer_debounce ? "timer" : "FSM",
+           (unsigned long)presses, (unsigned)BENCH_PRESSES, (unsigned long)(presses ? total / presses : 0),
+           (unsigned long)(presses ? min : 0), (unsigned long)max);
+}
+
+int main()
+{
+    port_system_init();
+    fsm_t *p_fsm = fsm_button_new(BUTTON_0_DEBOUNCE_TIME_MS, BUTTON_0_ID);
+    printf("Button debounce benchmark: %u presses of %u ms, %u bounces per edge, %u ms debounce\n", (unsigned)BENCH_PRESSES, (unsigned)BENCH_HOLD_MS,
+           (unsigned)BENCH_BOUNCES, (unsigned)BUTTON_0_DEBOUNCE_TIME_MS);
+    run(p_fsm, false);
+    run(p_fsm, true);
+    fsm_destroy(p_fsm);
+    return 0;
+}
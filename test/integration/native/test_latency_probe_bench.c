@@ -0,0 +1,173 @@
+/**
+ * @file test_latency_probe_bench.c
+ * @brief Latency from the release of the button to the toggle of the LED and to the start or stop of the player, measured with the latency probes (latency_probe.h) on the native platform.
+ *
+ * A "finger" thread presses and releases the button BENCH_PRESSES times, with BENCH_BOUNCES bounces on each edge. Each level change is timestamped and queued, and wakes up the core, as the EXTI ISR of the button does. The main loop fires the button, LED and buzzer FSMs, and each release toggles the LED and starts or stops the melody. Two loops are compared:
+ * - Idle: the loop sleeps with port_system_sleep() whenever the FSMs allow it.
+ * - Busy: the loop does BENCH_WORK_US of other work in each iteration, so an edge waits for the end of the current iteration.
+ *
+ * The latency of the player includes the wait for the end of the current note, since the player only stops between two notes. Its target is always built with USE_LATENCY_PROBE, with the instrumented FSMs compiled again (see test/integration/native/CMakeLists.txt).
+ *
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+/* Other includes */
+#include <fsm.h>
+#include "port_system.h"
+#include "port_button.h"
+#include "port_buzzer.h"
+#include "fsm_button.h"
+#include "fsm_led.h"
+#include "fsm_buzzer.h"
+#include "melodies.h"
+#include "button_edges.h"
+#include "latency_probe.h"
+
+#define BENCH_PRESSES 20 /*Presses in each phase*/
+#define BENCH_BOUNCES 6 /*Level changes on each edge before the button settles*/
+#define BENCH_BOUNCE_US 300 /*Time between two bounces*/
+#define BENCH_HOLD_MS 150 /*Time the button is held pressed*/
+#define BENCH_GAP_MS 250 /*Time between a release and the next press*/
+#define BENCH_WORK_US 2000 /*Other work done by the busy loop in each iteration*/
+
+_Static_assert(BENCH_BOUNCES % 2 == 0, "The bounces of an edge must end at the level of the edge");
+
+static volatile bool finger_done; /*Flag to indicate that the finger thread has finished the presses of the phase*/
+
+/**
+ * @brief Change the level of the button, bouncing. Each change is queued with its timestamp and wakes up the core, as the EXTI ISR does.
+ */
+
+static void bounce_to(bool pressed)
+{
+    for (uint32_t i = 0; i <= BENCH_BOUNCES; i++)
+    {
+        bool level = (i % 2 == 0) ? pressed : !pressed;
+        button_edges_push(&buttons_arr[BUTTON_0_ID].edges, level, port_system_get_millis(), port_system_get_cycles());
+        buttons_arr[BUTTON_0_ID].flag_pressed = level;
+        port_system_wakeup();
+        usleep(BENCH_BOUNCE_US);
+    }
+}
+
+/**
+ * @brief Finger thread: press and release the button BENCH_PRESSES times.
+ */
+
+static void *finger(void *p_arg)
+{
+    for (uint32_t i = 0; i < BENCH_PRESSES; i++)
+    {
+        usleep(BENCH_GAP_MS * 1000);
+        bounce_to(true);
+        usleep(BENCH_HOLD_MS * 1000);
+        bounce_to(false);
+    }
+    usleep(BENCH_GAP_MS * 1000);
+    finger_done = true;
+    port_system_wakeup();
+    return NULL;
+}
+
+/**
+ * @brief Print the histogram of a probe from its snapshot, as tools/latency_cli.py does.
+ */
+
+static void print_probe(uint32_t probe, const char *p_name)
+{
+    uint8_t snapshot[LATENCY_PROBE_SNAPSHOT_LENGTH];
+    uint32_t words[3 + LATENCY_PROBE_BUCKETS];
+    latency_probe_snapshot(probe, snapshot, sizeof(snapshot));
+    for (uint32_t i = 0; i < 3 + LATENCY_PROBE_BUCKETS; i++)
+    {
+        const uint8_t *p = &snapshot[2 + 4 * i];
+        words[i] = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+    printf("  %-6s n %3lu min %7lu us max %7lu us |", p_name, (unsigned long)words[0], (unsigned long)words[1], (unsigned long)words[2]);
+    for (uint32_t b = 0; b < LATENCY_PROBE_BUCKETS; b++)
+    {
+        if (words[3 + b] > 0)
+        {
+            printf(" %s%lu:%lu", (b < LATENCY_PROBE_BUCKETS - 1) ? "<" : ">=", 1UL << (LATENCY_PROBE_MIN_LOG2 + b - ((b < LATENCY_PROBE_BUCKETS - 1) ? 0 : 1)),
+                   (unsigned long)words[3 + b]);
+        }
+    }
+    printf("\n");
+}
+
+/**
+ * @brief Run one phase and print the histograms.
+ */
+
+static void run(fsm_t *p_fsm_button, fsm_t *p_fsm_led, fsm_t *p_fsm_buzzer, bool busy)
+{
+    latency_probe_init();
+    fsm_button_reset_duration(p_fsm_button);
+    finger_done = false;
+    pthread_t thread;
+    pthread_create(&thread, NULL, finger, NULL);
+
+    while (!finger_done)
+    {
+        fsm_button_fire(p_fsm_button);
+        if (fsm_button_get_duration(p_fsm_button) > 0)
+        {
+            fsm_buzzer_set_action(p_fsm_buzzer, (fsm_buzzer_get_action(p_fsm_buzzer) == PLAY) ? STOP : PLAY); // The LED FSM consumes the duration
+        }
+        fsm_fire(p_fsm_led);
+        fsm_fire(p_fsm_buzzer);
+        if (busy)
+        {
+            uint32_t start = port_system_get_cycles();
+            while (port_system_get_cycles() - start < BENCH_WORK_US * port_system_get_cycles_per_us())
+            {
+            }
+        }
+        else if (!fsm_buzzer_check_activity(p_fsm_buzzer))
+        {
+            uint32_t next_ms = fsm_button_get_next_ms(p_fsm_button);
+            if (next_ms > 0)
+            {
+                if (next_ms != FSM_TIMED_NONE)
+                {
+                    port_system_wakeup_timer_set(next_ms);
+                }
+                port_system_sleep();
+            }
+        }
+    }
+    pthread_join(thread, NULL);
+    fsm_buzzer_set_action(p_fsm_buzzer, STOP);
+    fsm_fire(p_fsm_buzzer);
+
+    printf("%s loop:\n", busy ? "Busy" : "Idle");
+    print_probe(LATENCY_PROBE_LED, "led");
+    print_probe(LATENCY_PROBE_BUZZER, "buzzer");
+}
+
+int main()
+{
+    port_system_init();
+    fsm_t *p_fsm_button = fsm_button_new(BUTTON_0_DEBOUNCE_TIME_MS, BUTTON_0_ID);
+    fsm_t *p_fsm_led = fsm_led_new(p_fsm_button, 0);
+    fsm_t *p_fsm_buzzer = fsm_buzzer_new(BUZZER_0_ID);
+    fsm_buzzer_set_melody(p_fsm_buzzer, &tetris_melody);
+    printf("Latency probe benchmark: %u presses of %u ms, %u bounces per edge, %u ms debounce\n", (unsigned)BENCH_PRESSES, (unsigned)BENCH_HOLD_MS,
+           (unsigned)BENCH_BOUNCES, (unsigned)BUTTON_0_DEBOUNCE_TIME_MS);
+#ifndef USE_LATENCY_PROBE
+    printf("Built without USE_LATENCY_PROBE: the histograms are empty\n");
+#endif
+    run(p_fsm_button, p_fsm_led, p_fsm_buzzer, false);
+    run(p_fsm_button, p_fsm_led, p_fsm_buzzer, true);
+    fsm_destroy(p_fsm_button);
+    fsm_destroy(p_fsm_led);
+    fsm_destroy(p_fsm_buzzer);
+    return 0;
+}
@@ -0,0 +1,89 @@
+/**
+ * @file test_led_pattern_csv.c
+ * @brief Render the LED patterns (led_pattern.h) to CSV files of duty cycle versus time, to plot them on the host.
+ *
+ * Each pattern is started with the blink FSM (fsm_blink_set_pattern()) and the duty cycle of the modelled LED (port_led_get_duty()) is sampled every CSV_RESOLUTION_MS, moving the system time with port_system_set_millis() instead of waiting. The samples are written to led_pattern_<name>.csv in the working directory and compared with led_pattern_render_csv(), so the program fails if the port does not play the tables as the model of led_pattern.c does.
+ *
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+/* Other includes */
+#include <fsm.h>
+#include "port_system.h"
+#include "port_led.h"
+#include "fsm_blink.h"
+#include "led_pattern.h"
+
+#define CSV_DURATION_MS 3000 /*Time rendered of each pattern*/
+#define CSV_RESOLUTION_MS 5 /*Time between two samples*/
+#define CSV_MAX_LENGTH (sizeof(LED_PATTERN_CSV_HEADER) + (CSV_DURATION_MS / CSV_RESOLUTION_MS) * sizeof("3000,1000\n")) /*Maximum length of a CSV*/
+#define TABLE_LENGTH 64 /*Maximum length of a table*/
+
+static char csv_played[CSV_MAX_LENGTH]; /*CSV sampled from the LED*/
+static char csv_model[CSV_MAX_LENGTH]; /*CSV rendered by led_pattern_render_csv()*/
+
+/**
+ * @brief Play a pattern with the blink FSM, sample the duty cycle of the LED and write it to a CSV file.
+ *
+ * @return true if the samples match the model of the pattern
+ */
+
+static bool render(fsm_t *p_fsm, const char *p_name, const led_pattern_t *p_pattern)
+{
+    uint32_t start = port_system_get_millis();
+    port_system_set_millis(start); // At the start of the tick, so the pattern starts at start
+    fsm_blink_set_pattern(p_fsm, p_pattern);
+    fsm_blink_fire(p_fsm);
+    uint32_t length = (uint32_t)snprintf(csv_played, sizeof(csv_played), "%s", LED_PATTERN_CSV_HEADER);
+    for (uint32_t t = 0; t < CSV_DURATION_MS; t += CSV_RESOLUTION_MS)
+    {
+        port_system_set_millis(start + t);
+        length += (uint32_t)snprintf(&csv_played[length], sizeof(csv_played) - length, "%lu,%u\n", (unsigned long)t, (unsigned)port_led_get_duty());
+    }
+
+    char file_name[64];
+    snprintf(file_name, sizeof(file_name), "led_pattern_%s.csv", p_name);
+    FILE *p_file = fopen(file_name, "w");
+    if (p_file != NULL)
+    {
+        fputs(csv_played, p_file);
+        fclose(p_file);
+    }
+
+    uint32_t model_length = led_pattern_render_csv(p_pattern, CSV_DURATION_MS, CSV_RESOLUTION_MS, csv_model, sizeof(csv_model));
+    bool ok = (model_length == length) && (strcmp(csv_model, csv_played) == 0);
+    printf("  %-10s %2lu steps of %3lu ms%s -> %s %s\n", p_name, (unsigned long)p_pattern->length, (unsigned long)p_pattern->step_ms, p_pattern->loop ? ", loop" : "", file_name,
+           ok ? "OK" : "MISMATCH");
+    return ok;
+}
+
+int main()
+{
+    static uint16_t breathe[TABLE_LENGTH];
+    static uint16_t heartbeat[TABLE_LENGTH];
+    static uint16_t blinks[TABLE_LENGTH];
+    static uint16_t level[1];
+
+    port_system_init();
+    fsm_t *p_fsm = fsm_blink_new(1000);
+    printf("LED patterns rendered every %u ms for %u ms:\n", (unsigned)CSV_RESOLUTION_MS, (unsigned)CSV_DURATION_MS);
+
+    bool ok = true;
+    led_pattern_t pattern_breathe = {breathe, led_pattern_breathe(breathe, 50), 40, true};
+    ok &= render(p_fsm, "breathe", &pattern_breathe);
+    led_pattern_t pattern_heartbeat = {heartbeat, led_pattern_heartbeat(heartbeat, 32), 30, true};
+    ok &= render(p_fsm, "heartbeat", &pattern_heartbeat);
+    led_pattern_t pattern_blinks = {blinks, led_pattern_blinks(blinks, TABLE_LENGTH, 3, 2, 2), 100, false};
+    ok &= render(p_fsm, "blinks", &pattern_blinks);
+    led_pattern_t pattern_level = {level, led_pattern_level(level, 1, 7, 10), 1, true};
+    ok &= render(p_fsm, "level", &pattern_level);
+
+    fsm_destroy(p_fsm);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,171 @@
+/**
+ * @file test_sw_timer_bench.c
+ * @brief Cost of the timer service (sw_timer.h) with BENCH_TIMERS timers running at once on the native platform.
+ *
+ * It times with port_system_get_cycles() (nanoseconds on the native platform):
+ * - Starting the timers, with random timeouts up to BENCH_MAX_MS, and stopping and restarting half of them.
+ * - Expiring them, moving the system tick with port_system_set_millis() one millisecond at a time, as the SysTick would. The same deadlines are also polled every tick, as each FSM does with its own timeout, to compare.
+ * - Expiring them again waking up only at the events of the wheel (sw_timer_get_next_ms()), as the main loop does when it sleeps until the wake-up timer fires.
+ *
+ * The program fails if a timer does not expire at its timeout.
+ *
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdio.h>
+#include <stdint.h>
+/* Other includes */
+#include "port_system.h"
+#include "sw_timer.h"
+
+#define BENCH_TIMERS 10000 /*Timers running at once*/
+#define BENCH_MAX_MS 60000 /*Longest timeout*/
+
+/**
+ * @brief Statistics of the cycles taken by each call of an operation.
+ */
+
+typedef struct
+{
+    uint64_t total; /*Sum of the cycles of all the calls*/
+    uint32_t max; /*Cycles of the slowest call*/
+    uint32_t calls; /*Calls*/
+} bench_stats_t;
+
+static sw_timer_t timers[BENCH_TIMERS]; /*Timers*/
+static uint32_t expiries[BENCH_TIMERS]; /*System tick at which each timer must expire*/
+static uint32_t late; /*Timers that have not expired at their timeout*/
+static uint32_t seed = 12345; /*State of the pseudo-random generator*/
+
+/**
+ * @brief Pseudo-random number in [1, max].
+ */
+
+static uint32_t random_ms(uint32_t max)
+{
+    seed = seed * 1103515245U + 12345U;
+    return 1 + (seed >> 8) % max;
+}
+
+/**
+ * @brief Callback of the timers: check that the timer expires at its timeout.
+ */
+
+static void on_expiry(void *p_arg)
+{
+    uint32_t i = (uint32_t)(uintptr_t)p_arg;
+    late += (port_system_get_millis() != expiries[i]) ? 1 : 0;
+}
+
+/**
+ * @brief Add the cycles of one call to the statistics.
+ */
+
+static void stats_add(bench_stats_t *p_stats, uint32_t cycles)
+{
+    p_stats->total += cycles;
+    p_stats->calls++;
+    if (cycles > p_stats->max)
+    {
+        p_stats->max = cycles;
+    }
+}
+
+/**
+ * @brief Print the average and maximum cycles of an operation.
+ */
+
+static void stats_print(const char *p_name, const bench_stats_t *p_stats)
+{
+    uint32_t avg = (p_stats->calls > 0) ? (uint32_t)(p_stats->total / p_stats->calls) : 0;
+    printf("%-26s | %8lu calls | avg %8lu ns | max %8lu ns\n", p_name, (unsigned long)p_stats->calls, (unsigned long)avg, (unsigned long)p_stats->max);
+}
+
+/**
+ * @brief Start all the timers from the system tick 0 with random timeouts, then stop and restart half of them.
+ */
+
+static void start_all(bench_stats_t *p_start, bench_stats_t *p_stop)
+{
+    port_system_set_millis(0);
+    sw_timer_init();
+    for (uint32_t i = 0; i < BENCH_TIMERS; i++)
+    {
+        sw_timer_setup(&timers[i], on_expiry, (void *)(uintptr_t)i);
+        expiries[i] = random_ms(BENCH_MAX_MS);
+        port_system_set_millis(0); // The system tick does not move while the timers are started
+        uint32_t start = port_system_get_cycles();
+        sw_timer_start(&timers[i], expiries[i], 0);
+        stats_add(p_start, port_system_get_cycles() - start);
+    }
+    for (uint32_t i = 0; i < BENCH_TIMERS; i += 2)
+    {
+        uint32_t start = port_system_get_cycles();
+        sw_timer_stop(&timers[i]);
+        stats_add(p_stop, port_system_get_cycles() - start);
+        expiries[i] = random_ms(BENCH_MAX_MS);
+        port_system_set_millis(0);
+        sw_timer_start(&timers[i], expiries[i], 0);
+    }
+}
+
+int main()
+{
+    port_system_init();
+    bench_stats_t start = {0};
+    bench_stats_t stop = {0};
+    bench_stats_t tick = {0};
+    bench_stats_t poll = {0};
+    bench_stats_t wakeup = {0};
+
+    /* Expire the timers at every tick, and poll the same deadlines */
+    start_all(&start, &stop);
+    uint32_t expired = 0;
+    uint32_t polled = 0;
+    for (uint32_t ms = 1; ms <= BENCH_MAX_MS; ms++)
+    {
+        port_system_set_millis(ms);
+        uint32_t t0 = port_system_get_cycles();
+        expired += sw_timer_process();
+        uint32_t t1 = port_system_get_cycles();
+        for (uint32_t i = 0; i < BENCH_TIMERS; i++)
+        {
+            polled += deadline_reached(expiries[i], ms) && !deadline_reached(expiries[i], ms - 1) ? 1 : 0;
+        }
+        stats_add(&tick, t1 - t0);
+        stats_add(&poll, port_system_get_cycles() - t1);
+    }
+    uint32_t hw_updates = sw_timer_get_hw_updates();
+
+    /* Expire the timers waking up only at the events of the wheel */
+    bench_stats_t ignored = {0};
+    start_all(&ignored, &ignored);
+    uint32_t expired_sleeping = 0;
+    uint32_t now = 0;
+    port_system_set_millis(now);
+    uint32_t next;
+    while ((next = sw_timer_get_next_ms()) != SW_TIMER_NONE)
+    {
+        now += next;
+        port_system_set_millis(now);
+        uint32_t t0 = port_system_get_cycles();
+        expired_sleeping += sw_timer_process();
+        stats_add(&wakeup, port_system_get_cycles() - t0);
+    }
+
+    printf("timer wheel benchmark: %u timers, timeouts up to %u ms, %u levels of %u slots\n", (unsigned)BENCH_TIMERS, (unsigned)BENCH_MAX_MS, (unsigned)SW_TIMER_LEVELS, (unsigned)SW_TIMER_SLOTS);
+    stats_print("start", &start);
+    stats_print("stop", &stop);
+    stats_print("process, every tick", &tick);
+    stats_print("poll deadlines, every tick", &poll);
+    stats_print("process, at wheel events", &wakeup);
+    printf("expired %lu (polled %lu) per tick, %lu sleeping; %lu wake-ups for %lu timers; wake-up timer programmed %lu times\n", (unsigned long)expired, (unsigned long)polled,
+           (unsigned long)expired_sleeping, (unsigned long)wakeup.calls, (unsigned long)BENCH_TIMERS, (unsigned long)hw_updates);
+    printf("expire cost per timer: %lu ns\n", (unsigned long)(tick.total / (expired > 0 ? expired : 1)));
+    bool ok = (late == 0) && (expired == BENCH_TIMERS) && (expired_sleeping == BENCH_TIMERS) && (polled == BENCH_TIMERS);
+    printf("%s\n", ok ? "OK" : "FAIL: timers not expired at their timeout");
+    return ok ? 0 : 1;
+}
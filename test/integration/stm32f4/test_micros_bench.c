@@ -0,0 +1,101 @@
+/**
+ * @file test_micros_bench.c
+ * @brief Cost of reading the time bases of port_system.h: the microsecond count of TIM5 (port_system_get_micros()), the cycle count of DWT (port_system_get_cycles()) and the 64-bit millisecond count (port_system_get_millis64()).
+ *
+ * Each read is timed with port_system_get_cycles() (DWT) and the cycles of an empty measure are subtracted. A read of TIM5 crosses the APB1 bridge, so it is a few cycles slower than DWT, which is on the private peripheral bus, but it does not wrap for 71.6 minutes; the 64-bit millisecond count masks the interrupts to read both halves.
+ *
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdio.h>
+#include <stdint.h>
+/* Other includes */
+#include "port_system.h"
+
+#define BENCH_CALLS 1000 /*Reads of each time base*/
+
+/**
+ * @brief Statistics of the cycles taken by each read of a time base.
+ */
+
+typedef struct
+{
+    uint64_t total; /*Sum of the cycles of all the reads*/
+    uint32_t max; /*Cycles of the slowest read*/
+} bench_stats_t;
+
+static volatile uint64_t sink; /*Value read, so the reads are not optimized out*/
+
+/**
+ * @brief Add the cycles of one read to the statistics, without the cycles of an empty measure.
+ */
+
+static void stats_add(bench_stats_t *p_stats, uint32_t cycles, uint32_t overhead)
+{
+    cycles = (cycles > overhead) ? cycles - overhead : 0;
+    p_stats->total += cycles;
+    if (cycles > p_stats->max)
+    {
+        p_stats->max = cycles;
+    }
+}
+
+/**
+ * @brief Print the average and maximum cycles of a read.
+ */
+
+static void stats_print(const char *p_name, const bench_stats_t *p_stats)
+{
+    printf("%-20s | avg %4lu cycles | max %4lu cycles\n", p_name, (unsigned long)(p_stats->total / BENCH_CALLS), (unsigned long)p_stats->max);
+}
+
+int main()
+{
+    port_system_init();
+    bench_stats_t micros = {0};
+    bench_stats_t cycles = {0};
+    bench_stats_t millis64 = {0};
+
+    uint32_t overhead = UINT32_MAX;
+    for (uint32_t i = 0; i < BENCH_CALLS; i++)
+    {
+        uint32_t start = port_system_get_cycles();
+        uint32_t empty = port_system_get_cycles() - start;
+        overhead = (empty < overhead) ? empty : overhead;
+    }
+
+    for (uint32_t i = 0; i < BENCH_CALLS; i++)
+    {
+        uint32_t start = port_system_get_cycles();
+        sink = port_system_get_micros();
+        stats_add(&micros, port_system_get_cycles() - start, overhead);
+    }
+
+    for (uint32_t i = 0; i < BENCH_CALLS; i++)
+    {
+        uint32_t start = port_system_get_cycles();
+        sink = port_system_get_cycles();
+        stats_add(&cycles, port_system_get_cycles() - start, overhead);
+    }
+
+    for (uint32_t i = 0; i < BENCH_CALLS; i++)
+    {
+        uint32_t start = port_system_get_cycles();
+        sink = port_system_get_millis64();
+        stats_add(&millis64, port_system_get_cycles() - start, overhead);
+    }
+
+    uint32_t start_us = port_system_get_micros();
+    port_system_delay_us(100);
+    uint32_t delay = port_system_get_micros() - start_us;
+
+    printf("time base benchmark: %u reads each, %lu cycles of measure removed\n", (unsigned)BENCH_CALLS, (unsigned long)overhead);
+    stats_print("get_micros (TIM5)", &micros);
+    stats_print("get_cycles (DWT)", &cycles);
+    stats_print("get_millis64", &millis64);
+    printf("delay_us(100) took %lu us\n", (unsigned long)delay);
+    return 0;
+}
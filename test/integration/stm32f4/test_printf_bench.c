@@ -0,0 +1,134 @@
+/**
+ * @file test_printf_bench.c
+ * @brief Cost of printing a typical log line through the console USART (USART_CONSOLE_ID, the ST-LINK virtual COM port).
+ *
+ * It times with port_system_get_cycles() (DWT):
+ * - The formatting alone (snprintf()), which is the floor of any printf() back end.
+ * - A blocking write of the same bytes polling the TXE flag, as a printf() retargeted without a buffer would do.
+ * - The formatting plus port_usart_console_write(), which is what printf() costs when USE_STDIO_USART is defined.
+ *
+ * The results are printed with printf() after a port_usart_console_flush(), so they go to the console or to SWO:ITM depending on USE_STDIO_USART.
+ *
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdio.h>
+#include <stdint.h>
+/* Other includes */
+#include "port_system.h"
+#include "port_usart.h"
+
+#define BENCH_CALLS 100 /*Lines printed by each method*/
+#define BENCH_BAUDRATE 115200 /*Baud rate of the console*/
+
+/**
+ * @brief Statistics of the cycles taken by each call of a method.
+ */
+
+typedef struct
+{
+    uint64_t total; /*Sum of the cycles of all the calls*/
+    uint32_t max; /*Cycles of the slowest call*/
+} bench_stats_t;
+
+static char line[USART_CONSOLE_RING_LENGTH]; /*Line being formatted*/
+
+/**
+ * @brief Format a typical log line: a timestamp, a tag and a couple of values.
+ */
+
+static int format_line(uint32_t i)
+{
+    return snprintf(line, sizeof(line), "[%8lu] usart: frame %lu len %u\n", (unsigned long)port_system_get_millis(), (unsigned long)i, (unsigned)(i % 64));
+}
+
+/**
+ * @brief Send the bytes of the line polling the TXE flag, without interrupts.
+ */
+
+static void write_blocking(int length)
+{
+    USART_TypeDef *p_usart = usart_arr[USART_CONSOLE_ID].p_usart;
+    for (int i = 0; i < length; i++)
+    {
+        while (!(p_usart->SR & USART_SR_TXE))
+        {
+        }
+        p_usart->DR = (uint8_t)line[i];
+    }
+    while (!(p_usart->SR & USART_SR_TC))
+    {
+    }
+}
+
+/**
+ * @brief Add the cycles of one call to the statistics.
+ */
+
+static void stats_add(bench_stats_t *p_stats, uint32_t cycles)
+{
+    p_stats->total += cycles;
+    if (cycles > p_stats->max)
+    {
+        p_stats->max = cycles;
+    }
+}
+
+/**
+ * @brief Print the average and maximum cycles and microseconds of a method.
+ */
+
+static void stats_print(const char *p_name, const bench_stats_t *p_stats)
+{
+    uint32_t avg = (uint32_t)(p_stats->total / BENCH_CALLS);
+    printf("%-22s | avg %8lu cycles (%6lu us) | max %8lu cycles (%6lu us)\n", p_name,
+           (unsigned long)avg, (unsigned long)(avg / port_system_get_cycles_per_us()),
+           (unsigned long)p_stats->max, (unsigned long)(p_stats->max / port_system_get_cycles_per_us()));
+}
+
+int main()
+{
+    port_system_init();
+    port_usart_console_init();
+    port_usart_set_baudrate(USART_CONSOLE_ID, BENCH_BAUDRATE);
+    bench_stats_t format = {0};
+    bench_stats_t blocking = {0};
+    bench_stats_t buffered = {0};
+
+    for (uint32_t i = 0; i < BENCH_CALLS; i++)
+    {
+        uint32_t start = port_system_get_cycles();
+        format_line(i);
+        stats_add(&format, port_system_get_cycles() - start);
+    }
+
+    for (uint32_t i = 0; i < BENCH_CALLS; i++)
+    {
+        uint32_t start = port_system_get_cycles();
+        write_blocking(format_line(i));
+        stats_add(&blocking, port_system_get_cycles() - start);
+    }
+
+    uint32_t dropped = port_usart_console_get_dropped();
+    for (uint32_t i = 0; i < BENCH_CALLS; i++)
+    {
+        uint32_t start = port_system_get_cycles();
+        port_usart_console_write(line, (uint32_t)format_line(i));
+        stats_add(&buffered, port_system_get_cycles() - start);
+    }
+    dropped = port_usart_console_get_dropped() - dropped;
+    uint32_t start = port_system_get_cycles();
+    port_usart_console_flush();
+    uint32_t flush = port_system_get_cycles() - start;
+
+    printf("printf benchmark: %u lines per method, %lu bps, ring of %u bytes\n", (unsigned)BENCH_CALLS, (unsigned long)port_usart_get_baudrate(USART_CONSOLE_ID), (unsigned)USART_CONSOLE_RING_LENGTH);
+    stats_print("snprintf only", &format);
+    stats_print("snprintf + blocking", &blocking);
+    stats_print("snprintf + console", &buffered);
+    printf("console: %lu bytes dropped, flush took %lu us\n", (unsigned long)dropped, (unsigned long)(flush / port_system_get_cycles_per_us()));
+    port_usart_console_flush();
+    return 0;
+}
@@ -0,0 +1,251 @@
+/**
+ * @file test_button_scan_bench.c
+ * @brief Cost of debouncing 1, 8 and 32 noisy buttons per system tick: EXTI interrupt per edge (port_button_isr()) against a periodic scan with the vertical counter (port_button_scan()).
+ *
+ * Every button is pressed once every BENCH_PERIOD_MS and held BENCH_HOLD_MS, and each edge bounces BENCH_BOUNCES times, BENCH_BOUNCE_US apart. The levels are generated for each tick and the work that each path would do in that tick is timed with port_system_get_cycles():
+ * - EXTI: one interrupt per level change. Each one reads the pending lines, finds the button in the lookup table and queues the timestamped edge, as port_button_isr() does. The debounce is still to be done by the FSM.
+ * - Scan: once every BUTTON_SCAN_PERIOD_MS, one button_scan_update() for all the buttons, and one queued edge per debounced change, as port_button_scan() does. It gives the debounced presses, which are checked.
+ *
+ * The cost of the interrupt entry and exit is not included: on the target it adds about 25 cycles to each EXTI interrupt, so the figures favour the EXTI path. The lines are modelled as bits of a 32-bit mask: on the target they spread over several GPIO ports, with one button_scan_update() per port.
+ *
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+/* Other includes */
+#include "port_system.h"
+#include "port_button.h"
+#include "button_edges.h"
+#include "button_scan.h"
+
+#define BENCH_MAX_BUTTONS 32 /*Largest number of buttons benchmarked*/
+#define BENCH_TICKS 10000 /*System ticks (ms) simulated for each number of buttons*/
+#define BENCH_PERIOD_MS 500 /*Time between two presses of the same button*/
+#define BENCH_HOLD_MS 200 /*Time the buttons are held pressed*/
+#define BENCH_BOUNCES 15 /*Level changes on each edge before the button settles. Odd, so the level ends up changed*/
+#define BENCH_BOUNCE_US 250 /*Time between two bounces*/
+#define BENCH_SKEW_MS 7 /*Delay between the presses of two consecutive buttons*/
+
+_Static_assert(BENCH_BOUNCES % 2 == 1, "The bounces of an edge must leave the level changed");
+_Static_assert(BENCH_SKEW_MS * (BENCH_MAX_BUTTONS - 1) < BENCH_PERIOD_MS - BENCH_HOLD_MS, "All the buttons must start released");
+
+/**
+ * @brief Button of the benchmark.
+ */
+typedef struct {
+    bool pressed; /*State of the button*/
+    button_edges_t edges; /*Queue of timestamped edges*/
+} bench_button_t;
+
+static bench_button_t bench_buttons[BENCH_MAX_BUTTONS]; /*Buttons*/
+static uint8_t bench_lut[BENCH_MAX_BUTTONS]; /*Button of each line*/
+static button_scan_t bench_scan; /*Debouncer of the scan path*/
+static uint32_t bench_countdown; /*Ticks until the next sample of the scan path*/
+static uint32_t bench_presses; /*Presses debounced by the scan path*/
+static uint32_t bench_overhead; /*Cycles taken by port_system_get_cycles() itself*/
+
+/**
+ * @brief Time since the last press of a button.
+ *
+ * @param button Index of the button
+ * @param tick System tick
+ * @return uint32_t Time since the last press in ms
+ */
+
+static uint32_t bench_phase(uint32_t button, uint32_t tick)
+{
+    return (tick + BENCH_PERIOD_MS - button * BENCH_SKEW_MS) % BENCH_PERIOD_MS; // The presses of different buttons are not aligned
+}
+
+/**
+ * @brief Level changes of a button in a tick, and its level at the end of the tick.
+ *
+ * @param button Index of the button
+ * @param tick System tick
+ * @param p_level Pointer where the level at the end of the tick is written
+ * @return uint32_t Level changes during the tick
+ */
+
+static uint32_t bench_changes(uint32_t button, uint32_t tick, bool *p_level)
+{
+    uint32_t t = bench_phase(button, tick);
+    uint32_t since_edge = (t >= BENCH_HOLD_MS) ? t - BENCH_HOLD_MS : t;
+    bool settled = (t < BENCH_HOLD_MS);
+    uint32_t changes = 0;
+    uint32_t done = 0; // Bounces of the edge until the end of this tick
+    for (uint32_t k = 0; k < BENCH_BOUNCES; k++)
+    {
+        uint32_t k_ms = (k * BENCH_BOUNCE_US) / 1000;
+        changes += (k_ms == since_edge) ? 1 : 0;
+        done += (k_ms <= since_edge) ? 1 : 0;
+    }
+    *p_level = (done % 2 == 0) ? !settled : settled;
+    return changes;
+}
+
+/**
+ * @brief Model of port_button_isr() for one EXTI interrupt.
+ *
+ * @param pending Pending lines
+ * @param levels Level of all the lines
+ */
+
+static void bench_exti_isr(uint32_t pending, uint32_t levels)
+{
+    uint32_t cycles = port_system_get_cycles();
+    uint32_t millis = port_system_get_millis();
+    while (pending)
+    {
+        uint32_t line = __builtin_ctz(pending);
+        pending &= pending - 1;
+        bench_button_t *p_button = &bench_buttons[bench_lut[line]];
+        p_button->pressed = (levels >> line) & 1;
+        button_edges_push(&p_button->edges, p_button->pressed, millis, cycles);
+    }
+}
+
+/**
+ * @brief Model of port_button_scan() for one tick.
+ *
+ * @param levels Level of all the lines
+ */
+
+static void bench_scan_tick(uint32_t levels)
+{
+    if (bench_countdown-- > 0)
+    {
+        return;
+    }
+    bench_countdown = BUTTON_SCAN_PERIOD_MS - 1;
+    uint32_t toggle = button_scan_update(&bench_scan, levels);
+    if (toggle == 0)
+    {
+        return;
+    }
+    uint32_t cycles = port_system_get_cycles();
+    uint32_t millis = port_system_get_millis();
+    while (toggle)
+    {
+        uint32_t line = __builtin_ctz(toggle);
+        toggle &= toggle - 1;
+        bench_button_t *p_button = &bench_buttons[bench_lut[line]];
+        p_button->pressed = (bench_scan.state >> line) & 1;
+        button_edges_push(&p_button->edges, p_button->pressed, millis, cycles);
+        bench_presses += p_button->pressed ? 1 : 0;
+    }
+}
+
+/**
+ * @brief Measure the cycles taken by port_system_get_cycles() itself, to be discounted from each measurement.
+ */
+
+static void bench_calibrate(void)
+{
+    bench_overhead = UINT32_MAX;
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        uint32_t start = port_system_get_cycles();
+        uint32_t cycles = port_system_get_cycles() - start;
+        bench_overhead = (cycles < bench_overhead) ? cycles : bench_overhead;
+    }
+}
+
+/**
+ * @brief Cycles elapsed since start, without the cost of the measurement.
+ */
+
+static uint32_t bench_elapsed(uint32_t start)
+{
+    uint32_t cycles = port_system_get_cycles() - start;
+    return (cycles > bench_overhead) ? cycles - bench_overhead : 0;
+}
+
+/**
+ * @brief Empty the edge queues, as the button FSMs would.
+ */
+
+static void bench_drain(uint32_t n)
+{
+    button_edge_t edge;
+    for (uint32_t b = 0; b < n; b++)
+    {
+        while (button_edges_pop(&bench_buttons[b].edges, &edge))
+        {
+        }
+    }
+}
+
+/**
+ * @brief Run both paths for n buttons and print the results.
+ */
+
+static void run(uint32_t n)
+{
+    memset(bench_buttons, 0, sizeof(bench_buttons));
+    for (uint32_t b = 0; b < BENCH_MAX_BUTTONS; b++)
+    {
+        bench_lut[b] = b;
+    }
+    memset(&bench_scan, 0, sizeof(bench_scan));
+    bench_countdown = 0;
+    bench_presses = 0;
+
+    uint64_t exti_total = 0;
+    uint64_t scan_total = 0;
+    uint32_t exti_max = 0;
+    uint32_t scan_max = 0;
+    uint32_t interrupts = 0;
+    uint32_t expected = 0;
+    for (uint32_t tick = 0; tick < BENCH_TICKS; tick++)
+    {
+        /* Levels at the end of the tick and the interrupts of the EXTI path during it */
+        uint32_t levels = 0;
+        uint32_t exti_tick = 0;
+        for (uint32_t b = 0; b < n; b++)
+        {
+            bool level;
+            uint32_t changes = bench_changes(b, tick, &level);
+            levels |= level ? (1U << b) : 0;
+            expected += (bench_phase(b, tick) == 0) ? 1 : 0;
+            for (uint32_t c = 0; c < changes; c++)
+            {
+                uint32_t start = port_system_get_cycles();
+                bench_exti_isr(1U << b, levels);
+                exti_tick += bench_elapsed(start);
+                interrupts++;
+            }
+        }
+
+        uint32_t start = port_system_get_cycles();
+        bench_scan_tick(levels);
+        uint32_t scan_tick = bench_elapsed(start);
+
+        exti_total += exti_tick;
+        scan_total += scan_tick;
+        exti_max = (exti_tick > exti_max) ? exti_tick : exti_max;
+        scan_max = (scan_tick > scan_max) ? scan_tick : scan_max;
+        bench_drain(n);
+    }
+
+    printf("%2u buttons | EXTI %6lu irq/s cycles/tick avg %6lu max %6lu | scan cycles/tick avg %6lu max %6lu | presses %lu/%lu\n", (unsigned)n,
+           (unsigned long)((uint64_t)interrupts * 1000 / BENCH_TICKS), (unsigned long)(exti_total / BENCH_TICKS), (unsigned long)exti_max,
+           (unsigned long)(scan_total / BENCH_TICKS), (unsigned long)scan_max, (unsigned long)bench_presses, (unsigned long)expected);
+}
+
+int main()
+{
+    port_system_init();
+    bench_calibrate();
+    printf("Button scan benchmark: %u ms simulated, a press every %u ms, %u bounces per edge %u us apart, scan every %u ms (%u cycles per us)\n",
+           (unsigned)BENCH_TICKS, (unsigned)BENCH_PERIOD_MS, (unsigned)BENCH_BOUNCES, (unsigned)BENCH_BOUNCE_US, (unsigned)BUTTON_SCAN_PERIOD_MS,
+           (unsigned)port_system_get_cycles_per_us());
+    run(1);
+    run(8);
+    run(32);
+    return 0;
+}
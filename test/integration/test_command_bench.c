@@ -0,0 +1,69 @@
+/**
+ * @file test_command_bench.c
+ * @brief Benchmark of the command interpreter: commands executed per second.
+ *
+ * Frames with one and with several commands are interpreted in a loop. No USART is attached, so the replies are built and batched but not sent. It is intended to run on the native platform.
+ *
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+/* Other includes */
+#include "port_system.h"
+#include "port_buzzer.h"
+#include "fsm_buzzer.h"
+#include "fsm_command.h"
+
+#define BENCH_DURATION_MS 1000 /*Duration of each measurement*/
+
+/**
+ * @brief Interpret the same frame for BENCH_DURATION_MS and print the commands per second.
+ */
+
+static void bench(fsm_t *p_fsm_command, const char *name, const char *p_frame)
+{
+    uint32_t length = strlen(p_frame);
+    uint32_t commands = 0;
+    uint32_t frames = 0;
+    uint32_t start = port_system_get_millis();
+    uint32_t elapsed;
+    do
+    {
+        for (uint32_t i = 0; i < 100; i++)
+        {
+            commands += fsm_command_execute(p_fsm_command, p_frame, length);
+        }
+        frames += 100;
+        elapsed = port_system_get_millis() - start;
+    } while (elapsed < BENCH_DURATION_MS);
+
+    printf("%-8s %7lu frames/s %8lu commands/s\n", name, (unsigned long)(1000ull * frames / elapsed), (unsigned long)(1000ull * commands / elapsed));
+}
+
+int main()
+{
+    port_system_init();
+    fsm_t *p_fsm_buzzer = fsm_buzzer_new(BUZZER_0_ID);
+    fsm_t *p_fsm_command = fsm_command_new(NULL, p_fsm_buzzer);
+
+    printf("Command interpreter benchmark\n");
+    bench(p_fsm_command, "single", "play");
+    bench(p_fsm_command, "arg", "speed 1.25");
+    bench(p_fsm_command, "status", "status");
+    bench(p_fsm_command, "batch", "melody tetris;speed 1.5;play;pause;status;stop");
+    bench(p_fsm_command, "unknown", "foo;bar;baz");
+
+    fsm_command_stats_t stats;
+    fsm_command_get_stats(p_fsm_command, &stats);
+    printf("Totals: %lu frames, %lu commands, %lu errors\n", (unsigned long)stats.frames, (unsigned long)stats.commands, (unsigned long)stats.errors);
+
+    fsm_destroy(p_fsm_command);
+    fsm_destroy(p_fsm_buzzer);
+    return 0;
+}
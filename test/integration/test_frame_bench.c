@@ -0,0 +1,151 @@
+/**
+ * @file test_frame_bench.c
+ * @brief Benchmark of the COBS framing against the text framing (END_CHAR_CONSTANT terminator).
+ *
+ * For several payload lengths it prints the bytes added on the link by each framing and the CPU cycles per payload byte spent to build a frame and to parse it byte by byte (as port_usart_store_data() does in the ISR).
+ * The text framing can only carry payloads without END_CHAR_CONSTANT and EMPTY_BUFFER_CONSTANT, so its payloads are printable chars.
+ *
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+/* Other includes */
+#include "port_system.h"
+#include "port_usart.h"
+#include "cobs_frame.h"
+
+#define BENCH_ITERATIONS 200 /*Number of frames built and parsed for each payload length*/
+#define BENCH_MAX_PAYLOAD 64 /*Longest payload measured*/
+
+static uint8_t payload[BENCH_MAX_PAYLOAD];
+static uint8_t frame[COBS_FRAME_MAX_ENCODED_LENGTH(BENCH_MAX_PAYLOAD)];
+static uint8_t rx_buffer[BENCH_MAX_PAYLOAD + COBS_FRAME_CRC_LENGTH];
+static volatile uint32_t sink; /*Keeps the compiler from removing the measured loops*/
+
+/**
+ * @brief Build a text frame: the payload followed by the end char.
+ */
+
+static uint32_t text_encode(const uint8_t *p_payload, uint32_t length, uint8_t *p_out)
+{
+    memcpy(p_out, p_payload, length);
+    p_out[length] = END_CHAR_CONSTANT;
+    return length + 1;
+}
+
+/**
+ * @brief Parse a text frame byte by byte, as the ISR does.
+ */
+
+static uint32_t text_decode(const uint8_t *p_frame, uint32_t length, uint8_t *p_out)
+{
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < length; i++)
+    {
+        if (p_frame[i] == END_CHAR_CONSTANT)
+        {
+            return n;
+        }
+        p_out[n++] = p_frame[i];
+    }
+    return 0;
+}
+
+/**
+ * @brief Parse a COBS frame byte by byte, as the ISR does.
+ */
+
+static uint32_t cobs_decode(const uint8_t *p_frame, uint32_t length, uint8_t *p_out)
+{
+    cobs_decoder_t decoder;
+    cobs_decoder_init(&decoder, sizeof(rx_buffer));
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < length; i++)
+    {
+        uint8_t decoded;
+        bool decoded_valid;
+        cobs_frame_status_t status = cobs_decoder_push(&decoder, p_frame[i], &decoded, &decoded_valid);
+        if (decoded_valid)
+        {
+            p_out[n++] = decoded;
+        }
+        if (status == COBS_FRAME_OK)
+        {
+            return n - COBS_FRAME_CRC_LENGTH;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Measure one framing for one payload length and print the results.
+ */
+
+static void bench(const char *name, uint32_t length, uint32_t (*encode)(const uint8_t *, uint32_t, uint8_t *), uint32_t (*decode)(const uint8_t *, uint32_t, uint8_t *))
+{
+    uint32_t frame_length = 0;
+    uint32_t start = port_system_get_cycles();
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        frame_length = encode(payload, length, frame);
+    }
+    uint32_t encode_cycles = port_system_get_cycles() - start;
+
+    start = port_system_get_cycles();
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        sink = decode(frame, frame_length, rx_buffer);
+    }
+    uint32_t decode_cycles = port_system_get_cycles() - start;
+
+    if ((sink != length) || (memcmp(rx_buffer, payload, length) != 0))
+    {
+        printf("%s: ERROR decoding a payload of %u bytes\n", name, (unsigned)length);
+        return;
+    }
+    uint32_t bytes = BENCH_ITERATIONS * length;
+    printf("%-5s payload %3u B | frame %3u B | overhead %2u B (%3u %%) | encode %3u.%02u cyc/B | decode %3u.%02u cyc/B\n",
+           name, (unsigned)length, (unsigned)frame_length, (unsigned)(frame_length - length), (unsigned)(100 * (frame_length - length) / length),
+           (unsigned)(encode_cycles / bytes), (unsigned)((100 * (encode_cycles % bytes)) / bytes),
+           (unsigned)(decode_cycles / bytes), (unsigned)((100 * (decode_cycles % bytes)) / bytes));
+}
+
+/**
+ * @brief Adapter of cobs_frame_encode() with the signature of the benchmark.
+ */
+
+static uint32_t cobs_encode(const uint8_t *p_payload, uint32_t length, uint8_t *p_out)
+{
+    return cobs_frame_encode(p_payload, length, p_out, sizeof(frame));
+}
+
+int main()
+{
+    port_system_init();
+    const uint32_t lengths[] = {4, 8, 16, 32, BENCH_MAX_PAYLOAD};
+
+    printf("Frame benchmark: %u frames per measurement\n", (unsigned)BENCH_ITERATIONS);
+    for (uint32_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++)
+    {
+        for (uint32_t i = 0; i < lengths[l]; i++)
+        {
+            payload[i] = 'a' + (i % 26); // Printable, so that the text framing can carry it too
+        }
+        bench("text", lengths[l], text_encode, text_decode);
+        bench("cobs", lengths[l], cobs_encode, cobs_decode);
+
+        for (uint32_t i = 0; i < lengths[l]; i++)
+        {
+            payload[i] = (uint8_t)(i * 37); // Binary, including zeros: only the COBS framing can carry it
+        }
+        bench("cobs*", lengths[l], cobs_encode, cobs_decode);
+    }
+    printf("cobs*: binary payload with zeros\n");
+    return 0;
+}
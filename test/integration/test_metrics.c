@@ -0,0 +1,66 @@
+/**
+ * @file test_metrics.c
+ * @brief Field telemetry: the button, USART, buzzer and command interpreter FSMs run instrumented with the metrics registry, and the command `metrics` received through the USART returns a snapshot of it.
+ *
+ * Each press of the button starts or stops the melody. Build it with -DUSE_METRICS=true and poll the snapshots from the host with:
+ *
+ *     tools/metrics_cli.py --port <serial port or pseudo-terminal of USART_0_ID>
+ *
+ * Without USE_METRICS the program still runs, but the command `metrics` replies `metrics err`.
+ *
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdio.h>
+#include <stdint.h>
+/* Other includes */
+#include <fsm.h>
+#include "port_system.h"
+#include "port_button.h"
+#include "port_usart.h"
+#include "port_buzzer.h"
+#include "fsm_button.h"
+#include "fsm_usart.h"
+#include "fsm_buzzer.h"
+#include "fsm_command.h"
+#include "melodies.h"
+#include "metrics.h"
+
+int main()
+{
+    port_system_init();
+    metrics_init();
+    fsm_t *p_fsm_button = fsm_button_new(BUTTON_0_DEBOUNCE_TIME_MS, BUTTON_0_ID);
+    fsm_t *p_fsm_usart = fsm_usart_new(USART_0_ID);
+    fsm_t *p_fsm_buzzer = fsm_buzzer_new(BUZZER_0_ID);
+    fsm_t *p_fsm_command = fsm_command_new(p_fsm_usart, p_fsm_buzzer);
+    fsm_buzzer_set_melody(p_fsm_buzzer, &tetris_melody);
+    fsm_usart_enable_rx_interrupt(p_fsm_usart);
+
+    while (1)
+    {
+        METRICS_FSM_FIRE_WITH(p_fsm_button, BUTTON, fsm_button_fire);
+        METRICS_FSM_FIRE(p_fsm_usart, USART);
+        METRICS_FSM_FIRE(p_fsm_command, COMMAND);
+        METRICS_FSM_FIRE(p_fsm_buzzer, BUZZER);
+
+        if (fsm_button_get_duration(p_fsm_button) > 0)
+        {
+            fsm_buzzer_set_action(p_fsm_buzzer, (fsm_buzzer_get_action(p_fsm_buzzer) == PLAY) ? STOP : PLAY);
+            fsm_button_reset_duration(p_fsm_button);
+        }
+        uint32_t next_ms = (fsm_usart_check_activity(p_fsm_usart) || fsm_buzzer_check_activity(p_fsm_buzzer)) ? 0 : fsm_button_get_next_ms(p_fsm_button);
+        if (next_ms > 0)
+        {
+            if (next_ms != FSM_TIMED_NONE)
+            {
+                port_system_wakeup_timer_set(next_ms); // End of the debounce of the button
+            }
+            METRICS_SLEEP();
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,189 @@
+/**
+ * @file test_rs485_bus.c
+ * @brief Simulation of a multi-drop RS-485 bus: one host polls RS485_UNITS units and each unit replies. It measures the bus throughput and the RX interrupt load of each node.
+ *
+ * Every node has its own RX ring (usart_rx_t) and every word on the bus reaches all the receivers but the sender's, as on a half-duplex bus. Each message is preceded by the address of its destination (a word with USART_ADDRESS_MARK set). Two receivers are compared:
+ * - Hardware: mute mode with wakeup by address mark (port_usart_set_rs485()). The words for other nodes raise no interrupt (modelled by usart_rx_wakeup()).
+ * - Software: every word raises an interrupt and the ISR filters the address itself.
+ *
+ * The bus time is computed from the baud rate (RS485_WORD_BITS bit times per word) plus a turnaround time per message, so the throughput does not depend on the platform. The cycles spent by the ISR of each node are measured with port_system_get_cycles() and given per second of bus time, so on the target they are the share of SystemCoreClock taken by the bus.
+ *
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+/* Other includes */
+#include "port_system.h"
+#include "usart_rx.h"
+
+#define RS485_UNITS 15 /*Units on the bus, with addresses 1 to RS485_UNITS. The host has address 0*/
+#define RS485_HOST_ADDRESS 0 /*Address of the host*/
+#define RS485_BAUDRATE 115200 /*Baud rate of the bus*/
+#define RS485_WORD_BITS 11 /*Bit times per word: start bit, 9 data bits (address mark) and stop bit*/
+#define RS485_TURNAROUND_US 100 /*Idle time between two messages: DE switching and processing of the request*/
+#define RS485_ROUNDS 100 /*Polling rounds: each one sends one request to every unit*/
+#define RS485_REQUEST "play 3\n" /*Request sent by the host to each unit*/
+#define RS485_REPLY "play ok\n" /*Reply sent by each unit to the host*/
+
+_Static_assert(RS485_UNITS <= USART_ADDRESS_MASK, "The receivers compare 4 address bits: up to 16 nodes per bus");
+
+/**
+ * @brief Node of the bus.
+ */
+typedef struct {
+    uint8_t address; /*Own address*/
+    bool muted; /*Mute flag of the receiver (RWU)*/
+    usart_rx_t rx; /*RX ring*/
+    uint32_t interrupts; /*RX interrupts served*/
+    uint64_t cycles; /*Cycles spent in the RX ISR*/
+} rs485_node_t;
+
+static rs485_node_t nodes[RS485_UNITS + 1]; /*Host (index 0) and units*/
+static char frame[USART_INPUT_BUFFER_LENGTH]; /*Frame read from a ring*/
+static uint64_t bus_bits; /*Bit times elapsed on the bus, turnarounds included*/
+static uint32_t bus_words; /*Words sent on the bus*/
+static uint32_t payload_bytes; /*Payload bytes delivered*/
+static uint32_t lost_frames; /*Requests and replies that did not arrive*/
+
+/**
+ * @brief RX interrupt of a node for a word of the bus.
+ *
+ * @param p_node Pointer to the node
+ * @param word Word on the bus
+ * @param hw_filter true if the receiver filters the addresses in hardware (mute mode)
+ */
+
+static void node_receive(rs485_node_t *p_node, uint16_t word, bool hw_filter)
+{
+    if (hw_filter && !usart_rx_wakeup(&p_node->muted, p_node->address, word) && p_node->muted)
+    {
+        return; // Discarded by the receiver: no interrupt
+    }
+    uint32_t start = port_system_get_cycles();
+    p_node->interrupts++;
+    bool data = hw_filter ? !(word & USART_ADDRESS_MARK) : usart_rx_wakeup(&p_node->muted, p_node->address, word);
+    if (data)
+    {
+        usart_rx_push(&p_node->rx, (uint8_t)word);
+    }
+    p_node->cycles += port_system_get_cycles() - start;
+}
+
+/**
+ * @brief Send a message on the bus, preceded by the address of its destination.
+ *
+ * @param src Index of the sender
+ * @param dst Address of the destination
+ * @param p_msg Message
+ * @param hw_filter true if the receivers filter the addresses in hardware
+ */
+
+static void bus_send(uint32_t src, uint8_t dst, const char *p_msg, bool hw_filter)
+{
+    uint32_t length = strlen(p_msg);
+    for (uint32_t i = 0; i <= length; i++)
+    {
+        uint16_t word = (i == 0) ? (USART_ADDRESS_MARK | dst) : (uint8_t)p_msg[i - 1];
+        for (uint32_t n = 0; n <= RS485_UNITS; n++)
+        {
+            if (n != src)
+            {
+                node_receive(&nodes[n], word, hw_filter);
+            }
+        }
+    }
+    bus_words += length + 1;
+    bus_bits += (uint64_t)(length + 1) * RS485_WORD_BITS + (uint64_t)RS485_TURNAROUND_US * RS485_BAUDRATE / 1000000;
+}
+
+/**
+ * @brief Take the frame received by a node and check it.
+ *
+ * @param p_node Pointer to the node
+ * @param p_msg Message expected, with its END_CHAR_CONSTANT
+ */
+
+static void node_check(rs485_node_t *p_node, const char *p_msg)
+{
+    uint32_t length = usart_rx_pop(&p_node->rx, frame);
+    if ((length == strlen(p_msg) - 1) && (memcmp(frame, p_msg, length) == 0))
+    {
+        payload_bytes += length + 1;
+    }
+    else
+    {
+        lost_frames++;
+    }
+}
+
+/**
+ * @brief Run the polling rounds and print the results.
+ *
+ * @param hw_filter true if the receivers filter the addresses in hardware
+ */
+
+static void run(bool hw_filter)
+{
+    memset(nodes, 0, sizeof(nodes));
+    for (uint32_t n = 0; n <= RS485_UNITS; n++)
+    {
+        nodes[n].address = n;
+        nodes[n].muted = true;
+        usart_rx_set_framing(&nodes[n].rx, USART_FRAMING_TEXT);
+    }
+    bus_bits = 0;
+    bus_words = 0;
+    payload_bytes = 0;
+    lost_frames = 0;
+
+    for (uint32_t round = 0; round < RS485_ROUNDS; round++)
+    {
+        for (uint32_t unit = 1; unit <= RS485_UNITS; unit++)
+        {
+            bus_send(RS485_HOST_ADDRESS, unit, RS485_REQUEST, hw_filter);
+            node_check(&nodes[unit], RS485_REQUEST);
+            bus_send(unit, RS485_HOST_ADDRESS, RS485_REPLY, hw_filter);
+            node_check(&nodes[RS485_HOST_ADDRESS], RS485_REPLY);
+        }
+    }
+    /* No unit can have received a frame for another one */
+    for (uint32_t n = 0; n <= RS485_UNITS; n++)
+    {
+        lost_frames += usart_rx_available(&nodes[n].rx) ? 1 : 0;
+    }
+
+    uint64_t bus_us = (bus_bits * 1000000) / RS485_BAUDRATE;
+    uint32_t max_irq = 0;
+    uint64_t sum_irq = 0;
+    uint64_t max_cycles = 0;
+    uint64_t sum_cycles = 0;
+    for (uint32_t n = 1; n <= RS485_UNITS; n++)
+    {
+        max_irq = nodes[n].interrupts > max_irq ? nodes[n].interrupts : max_irq;
+        max_cycles = nodes[n].cycles > max_cycles ? nodes[n].cycles : max_cycles;
+        sum_irq += nodes[n].interrupts;
+        sum_cycles += nodes[n].cycles;
+    }
+    printf("%-8s | bus %6lu B/s payload %6lu B/s | unit irq/s avg %6lu max %6lu | unit isr cycles/s avg %8lu max %8lu | host irq/s %6lu | lost %lu\n",
+           hw_filter ? "hardware" : "software",
+           (unsigned long)((uint64_t)bus_words * 1000000 / bus_us), (unsigned long)((uint64_t)payload_bytes * 1000000 / bus_us),
+           (unsigned long)(sum_irq * 1000000 / RS485_UNITS / bus_us), (unsigned long)((uint64_t)max_irq * 1000000 / bus_us),
+           (unsigned long)(sum_cycles * 1000000 / RS485_UNITS / bus_us), (unsigned long)(max_cycles * 1000000 / bus_us),
+           (unsigned long)((uint64_t)nodes[RS485_HOST_ADDRESS].interrupts * 1000000 / bus_us), (unsigned long)lost_frames);
+}
+
+int main()
+{
+    port_system_init();
+    printf("RS-485 bus simulation: host and %u units, %u bps, %u polling rounds, %u us turnaround\n", (unsigned)RS485_UNITS, (unsigned)RS485_BAUDRATE,
+           (unsigned)RS485_ROUNDS, (unsigned)RS485_TURNAROUND_US);
+    run(false);
+    run(true);
+    return 0;
+}
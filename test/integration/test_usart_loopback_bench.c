@@ -0,0 +1,332 @@
+/**
+ * @file test_usart_loopback_bench.c
+ * @brief USART loopback benchmark: throughput and round-trip latency of frames sent with fsm_usart_set_out_data() and received back through the RX path.
+ *
+ * For each frame size it runs two phases:
+ * - Latency: one frame in flight at a time. The round trip is timed with port_system_get_cycles() (DWT on the target) from the moment the frame is queued until the FSM returns it, and the p50, p99 and p999 are printed.
+ * - Throughput: frames are pipelined, up to the TX queue length and as many as fit in the RX ring, and the sustained bytes/s and frames/s are printed.
+ *
+ * By default the USART is looped back internally with port_usart_set_loopback(): half-duplex mode on the target, a simulated jumper on the native platform. Set BENCH_EXTERNAL_LOOPBACK to 1 to use a TX-RX jumper instead (PB10-PC11 on the target) or, on the native platform, a host process that echoes the pseudo-terminal.
+ *
+ * Set BENCH_FLOW_CONTROL to 1 to enable the RTS/CTS flow control (port_usart_set_flow_control()); with an external loopback on the target, RTS must also be jumpered to CTS (PB14-PB13). Set BENCH_RING_WINDOW to 0 and BENCH_SLOW_LOOP_US to a few hundreds to emulate a main loop that cannot keep up: without flow control the RX ring overflows and frames are lost, with it the sender pauses instead. The overruns (ORE) and the frames lost are printed for each frame size.
+ *
+ * On the native platform the bytes are paced at BENCH_BAUDRATE (port_usart_set_byte_pacing()), so the figures can be compared with the target. Set BENCH_BYTE_PACING to 0 to measure the host-bound path instead: the line utilisation is then not printed.
+ *
+ * The frame sizes are swept by default. Build with -DBENCH_FRAME_SIZE=<bytes>, or give the sizes on the command line (e.g. `test_usart_loopback_bench 24 48`), to run other ones.
+ *
+ * These figures are the baseline for any change in the USART buffers (e.g., DMA).
+ *
+ * @author Sistemas Digitales II
+ * @date 18/10/2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+/* Other includes */
+#include <fsm.h>
+#include "port_system.h"
+#include "port_usart.h"
+#include "fsm_usart.h"
+
+#define BENCH_USART_ID USART_0_ID /*USART under test*/
+#define BENCH_BAUDRATE 115200 /*Baud rate of the USART under test*/
+#define BENCH_FRAMES 1000 /*Frames sent in each phase for each frame size*/
+#define BENCH_TIMEOUT_MS 500 /*Time without receiving any frame before a phase is aborted*/
+#define BENCH_EXTERNAL_LOOPBACK 0 /*1 to use a TX-RX jumper (or a host echo of the pseudo-terminal) instead of the internal loopback*/
+#define BENCH_FLOW_CONTROL 0 /*1 to enable the RTS/CTS flow control of the USART under test*/
+#define BENCH_RING_WINDOW 1 /*1 to keep in flight only the frames that fit in the RX ring. 0 to pipeline up to the TX queue length*/
+#define BENCH_SLOW_LOOP_US 0 /*Busy time added to each iteration of the throughput loop, to emulate a slow main loop*/
+#define BENCH_BYTE_PACING 1 /*1 to pace the bytes at the baud rate on the native platform (they always are on the target). 0 for host-bound figures*/
+#ifndef BENCH_FRAME_SIZE
+#define BENCH_FRAME_SIZE 0 /*Frame size in bytes, END_CHAR_CONSTANT included. 0 to sweep the default sizes*/
+#endif
+#define BENCH_FRAME_MIN_SIZE 9 /*Sequence number and END_CHAR_CONSTANT*/
+#define BENCH_MAX_SIZES 8 /*Maximum number of frame sizes of a run*/
+
+_Static_assert((BENCH_FRAME_SIZE == 0) || ((BENCH_FRAME_SIZE >= BENCH_FRAME_MIN_SIZE) && (BENCH_FRAME_SIZE <= USART_INPUT_BUFFER_LENGTH)), "BENCH_FRAME_SIZE must be 0 or a frame size from BENCH_FRAME_MIN_SIZE to USART_INPUT_BUFFER_LENGTH");
+
+static uint32_t latencies[BENCH_FRAMES]; /*Round-trip latency of each frame, in cycles*/
+static char tx_frame[USART_INPUT_BUFFER_LENGTH]; /*Frame being queued*/
+static char rx_frame[USART_INPUT_BUFFER_LENGTH]; /*Frame received*/
+
+/**
+ * @brief Build a text frame of the given size, END_CHAR_CONSTANT included. It starts with the sequence number, so lost or reordered frames are detected.
+ */
+
+static uint32_t build_frame(uint32_t seq, uint32_t size)
+{
+    snprintf(tx_frame, sizeof(tx_frame), "%08lx", (unsigned long)seq);
+    for (uint32_t i = 8; i < size - 1; i++)
+    {
+        tx_frame[i] = 'a' + ((seq + i) % 26);
+    }
+    tx_frame[size - 1] = END_CHAR_CONSTANT;
+    return size;
+}
+
+/**
+ * @brief Check that the frame received is the frame built for the given sequence number (without the END_CHAR_CONSTANT).
+ */
+
+static bool check_frame(fsm_t *p_usart, uint32_t seq, uint32_t size)
+{
+    build_frame(seq, size);
+    return (fsm_usart_get_in_length(p_usart) == size - 1) && (memcmp(rx_frame, tx_frame, size - 1) == 0);
+}
+
+/**
+ * @brief Busy-wait for some microseconds.
+ */
+
+static void busy_wait_us(uint32_t us)
+{
+    uint32_t start = port_system_get_cycles();
+    while (port_system_get_cycles() - start < us * port_system_get_cycles_per_us())
+    {
+    }
+}
+
+/**
+ * @brief Get the sequence number of the frame received (its first 8 hex chars).
+ */
+
+static uint32_t parse_seq(void)
+{
+    uint32_t seq = 0;
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        char c = rx_frame[i];
+        seq = (seq << 4) | (uint32_t)((c >= 'a') ? (c - 'a' + 10) : (c - '0'));
+    }
+    return seq;
+}
+
+/**
+ * @brief Fire the USART FSM and take the received frame, if any.
+ */
+
+static bool poll_frame(fsm_t *p_usart)
+{
+    fsm_fire(p_usart);
+    if (!fsm_usart_check_data_received(p_usart))
+    {
+        return false;
+    }
+    fsm_usart_get_in_data(p_usart, rx_frame);
+    return true;
+}
+
+/**
+ * @brief Compare two latencies for qsort().
+ */
+
+static int compare_latency(const void *p_a, const void *p_b)
+{
+    uint32_t a = *(const uint32_t *)p_a;
+    uint32_t b = *(const uint32_t *)p_b;
+    return (a > b) - (a < b);
+}
+
+/**
+ * @brief Get a percentile of the sorted latencies, in tenths of microsecond.
+ */
+
+static uint32_t percentile_us10(uint32_t n, uint32_t per_mille)
+{
+    uint32_t idx = (n * per_mille) / 1000;
+    if (idx >= n)
+    {
+        idx = n - 1;
+    }
+    return (uint32_t)((10ull * latencies[idx]) / port_system_get_cycles_per_us());
+}
+
+/**
+ * @brief Latency phase: one frame in flight at a time.
+ *
+ * @return uint32_t Number of frames received back correctly
+ */
+
+static uint32_t bench_latency(fsm_t *p_usart, uint32_t size, uint32_t *p_errors)
+{
+    uint32_t n = 0;
+    for (uint32_t seq = 0; seq < BENCH_FRAMES; seq++)
+    {
+        build_frame(seq, size);
+        uint32_t start = port_system_get_cycles();
+        fsm_usart_set_out_data(p_usart, tx_frame, size);
+        uint32_t start_ms = port_system_get_millis();
+        bool received = false;
+        while (!received && (port_system_get_millis() - start_ms < BENCH_TIMEOUT_MS))
+        {
+            received = poll_frame(p_usart);
+        }
+        uint32_t cycles = port_system_get_cycles() - start;
+        if (!received)
+        {
+            (*p_errors)++;
+            break;
+        }
+        if (check_frame(p_usart, seq, size))
+        {
+            latencies[n++] = cycles;
+        }
+        else
+        {
+            (*p_errors)++;
+        }
+        fsm_usart_reset_input_data(p_usart);
+    }
+    return n;
+}
+
+/**
+ * @brief Throughput phase: frames pipelined up to the TX queue length and, if BENCH_RING_WINDOW is set, as many as fit in the RX ring.
+ *
+ * @return uint64_t Cycles elapsed until the last frame was received
+ */
+
+static uint64_t bench_throughput(fsm_t *p_usart, uint32_t size, uint32_t *p_received, uint32_t *p_errors)
+{
+    uint32_t window = BENCH_RING_WINDOW ? USART_RX_RING_LENGTH / (size + 1) : USART_TX_QUEUE_LENGTH;
+    if (window > USART_TX_QUEUE_LENGTH)
+    {
+        window = USART_TX_QUEUE_LENGTH;
+    }
+    uint32_t sent = 0;
+    uint32_t expected = 0;
+    uint32_t received = 0;
+    uint64_t elapsed = 0;
+    uint32_t last = port_system_get_cycles();
+    uint32_t last_rx_ms = port_system_get_millis();
+    while ((expected < BENCH_FRAMES) && (port_system_get_millis() - last_rx_ms < BENCH_TIMEOUT_MS))
+    {
+        if ((sent < BENCH_FRAMES) && (sent - expected < window))
+        {
+            build_frame(sent, size);
+            sent += fsm_usart_set_out_data(p_usart, tx_frame, size) ? 1 : 0;
+        }
+        busy_wait_us(BENCH_SLOW_LOOP_US);
+        if (poll_frame(p_usart))
+        {
+            uint32_t seq = parse_seq();
+            if ((seq >= expected) && (seq < sent) && check_frame(p_usart, seq, size))
+            {
+                *p_errors += seq - expected; // Frames lost before this one
+                expected = seq + 1;
+                received++;
+            }
+            else
+            {
+                (*p_errors)++;
+            }
+            last_rx_ms = port_system_get_millis();
+            fsm_usart_reset_input_data(p_usart);
+        }
+        uint32_t now = port_system_get_cycles();
+        elapsed += now - last; // Accumulated, so it does not wrap around with the 32-bit counter
+        last = now;
+    }
+    *p_errors += BENCH_FRAMES - expected;
+    *p_received = received;
+    return elapsed;
+}
+
+/**
+ * @brief Get the frame sizes of the run: the ones given on the command line, BENCH_FRAME_SIZE or the default sweep.
+ *
+ * @return uint32_t Number of frame sizes
+ */
+
+static uint32_t get_sizes(int argc, char *argv[], uint32_t *p_sizes)
+{
+    static const uint32_t default_sizes[] = {10, 16, 32, USART_INPUT_BUFFER_LENGTH};
+    uint32_t n = 0;
+    for (int i = 1; (i < argc) && (n < BENCH_MAX_SIZES); i++)
+    {
+        uint32_t size = (uint32_t)strtoul(argv[i], NULL, 0);
+        if ((size < BENCH_FRAME_MIN_SIZE) || (size > USART_INPUT_BUFFER_LENGTH))
+        {
+            printf("Frame size %s ignored: it must be from %u to %u bytes\n", argv[i], (unsigned)BENCH_FRAME_MIN_SIZE, (unsigned)USART_INPUT_BUFFER_LENGTH);
+            continue;
+        }
+        p_sizes[n++] = size;
+    }
+    if ((n > 0) || (argc > 1))
+    {
+        return n;
+    }
+    if (BENCH_FRAME_SIZE != 0)
+    {
+        p_sizes[0] = BENCH_FRAME_SIZE;
+        return 1;
+    }
+    memcpy(p_sizes, default_sizes, sizeof(default_sizes));
+    return sizeof(default_sizes) / sizeof(default_sizes[0]);
+}
+
+int main(int argc, char *argv[])
+{
+    port_system_init();
+    fsm_t *p_usart = fsm_usart_new(BENCH_USART_ID);
+    port_usart_set_baudrate(BENCH_USART_ID, BENCH_BAUDRATE);
+    port_usart_set_byte_pacing(BENCH_USART_ID, BENCH_BYTE_PACING);
+    bool paced = port_usart_get_byte_pacing(BENCH_USART_ID);
+#if !BENCH_EXTERNAL_LOOPBACK
+    port_usart_set_loopback(BENCH_USART_ID, true);
+#endif
+#if BENCH_FLOW_CONTROL
+    if (!port_usart_set_flow_control(BENCH_USART_ID, true))
+    {
+        printf("ERROR: the USART under test has no RTS/CTS pins\n");
+    }
+#endif
+    fsm_usart_enable_rx_interrupt(p_usart);
+    uint32_t sizes[BENCH_MAX_SIZES];
+    uint32_t n_sizes = get_sizes(argc, argv, sizes);
+
+    printf("USART loopback benchmark: %u frames per phase, %lu bps, %s loopback, flow control %s\n", (unsigned)BENCH_FRAMES, (unsigned long)port_usart_get_baudrate(BENCH_USART_ID), BENCH_EXTERNAL_LOOPBACK ? "external" : "internal", BENCH_FLOW_CONTROL ? "on" : "off");
+    if (!paced)
+    {
+        printf("Byte pacing off: the figures are bound by the host, not by the baud rate\n");
+    }
+    for (uint32_t s = 0; s < n_sizes; s++)
+    {
+        uint32_t size = sizes[s];
+        uint32_t errors = 0;
+        uint32_t frame_errors = fsm_usart_get_rx_frame_errors(p_usart);
+        uint32_t overruns = port_usart_get_overruns(BENCH_USART_ID);
+
+        uint32_t n = bench_latency(p_usart, size, &errors);
+        qsort(latencies, n, sizeof(latencies[0]), compare_latency);
+
+        uint32_t received;
+        uint64_t elapsed = bench_throughput(p_usart, size, &received, &errors);
+        uint64_t elapsed_us = elapsed / port_system_get_cycles_per_us();
+        if ((n == 0) || (elapsed_us == 0))
+        {
+            printf("size %3u B | ERROR: no frame received back\n", (unsigned)size);
+            continue;
+        }
+        uint32_t bytes_per_s = (uint32_t)((1000000ull * received * size) / elapsed_us);
+        uint32_t p50 = percentile_us10(n, 500);
+        uint32_t p99 = percentile_us10(n, 990);
+        uint32_t p999 = percentile_us10(n, 999);
+        errors += fsm_usart_get_rx_frame_errors(p_usart) - frame_errors;
+        char line[16] = "";
+        if (paced)
+        {
+            snprintf(line, sizeof(line), "line %3u %% | ", (unsigned)((10ull * 100 * bytes_per_s) / port_usart_get_baudrate(BENCH_USART_ID)));
+        }
+        printf("size %3u B | %8lu B/s | %7lu frames/s | %srtt p50 %7lu.%lu us p99 %7lu.%lu us p999 %7lu.%lu us | errors %u ore %lu\n",
+               (unsigned)size, (unsigned long)bytes_per_s, (unsigned long)((1000000ull * received) / elapsed_us), line,
+               (unsigned long)(p50 / 10), (unsigned long)(p50 % 10), (unsigned long)(p99 / 10), (unsigned long)(p99 % 10),
+               (unsigned long)(p999 / 10), (unsigned long)(p999 % 10), (unsigned)errors,
+               (unsigned long)(port_usart_get_overruns(BENCH_USART_ID) - overruns));
+    }
+    return 0;
+}
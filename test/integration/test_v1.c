@@ -18,11 +18,11 @@ int main(void)
     while (1)
     {
         // In every iteration, we fire the FSM and retrieve the duration of the button press
-        fsm_fire(p_fsm_button);
+        fsm_button_fire(p_fsm_button);
         uint32_t duration = fsm_button_get_duration(p_fsm_button);
         if (duration > 0)
         {
-            printf("Button %d pressed for %ld ms", BUTTON_0_ID, duration);
+            printf("Button %d pressed for %lu ms", BUTTON_0_ID, (unsigned long)duration);
             // If the button is pressed for more than CHANGE_MODE_BUTTON_TIME, we toggle the LED
             if (duration >= CHANGE_MODE_BUTTON_TIME) {
                 printf(" (long press detected)\n");
@@ -33,6 +33,16 @@ int main(void)
             // We always reset the duration after reading it
             fsm_button_reset_duration(p_fsm_button);
         }
+        // Sleep until the end of the debounce, or until the next interrupt if nothing is due
+        uint32_t next_ms = fsm_button_get_next_ms(p_fsm_button);
+        if (next_ms > 0)
+        {
+            if (next_ms != FSM_TIMED_NONE)
+            {
+                port_system_wakeup_timer_set(next_ms);
+            }
+            port_system_sleep();
+        }
     }
 
     // We should never reach this point
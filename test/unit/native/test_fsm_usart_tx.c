@@ -0,0 +1,198 @@
+#include <unity.h>
+#include <string.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include "fsm_usart.h"
+#include "port_usart.h"
+#include "port_system.h"
+
+#define TEST_USART_ID USART_0_ID /*USART under test. Its bytes are read from the slave side of its pseudo-terminal*/
+#define TEST_TIMEOUT_MS 1000 /*Maximum time to send the queue or to read the bytes back*/
+
+static fsm_t *p_fsm;
+static int fd_host = -1; /*Slave side of the pseudo-terminal, opened as the host would*/
+static void *cb_args[USART_TX_QUEUE_LENGTH * 2]; /*Arguments of the completion callbacks, in call order*/
+static uint32_t cb_calls;
+static uint32_t cb_sent[USART_TX_QUEUE_LENGTH * 2]; /*Messages sent when each callback was called*/
+
+/**
+ * @brief Read the bytes the USART has written to the pseudo-terminal, until the given length or the timeout.
+ */
+
+static uint32_t _host_read(char *p_buffer, uint32_t length)
+{
+    uint32_t n = 0;
+    uint32_t start = port_system_get_millis();
+    while ((n < length) && (port_system_get_millis() - start < TEST_TIMEOUT_MS))
+    {
+        struct pollfd pfd = {.fd = fd_host, .events = POLLIN};
+        if (poll(&pfd, 1, 10) > 0)
+        {
+            ssize_t r = read(fd_host, p_buffer + n, length - n);
+            n += (r > 0) ? (uint32_t)r : 0;
+        }
+    }
+    return n;
+}
+
+/**
+ * @brief Fire the FSM until the given number of messages has been sent since the last reset of the statistics.
+ */
+
+static void _send_until(uint32_t messages_sent)
+{
+    fsm_usart_tx_stats_t stats;
+    uint32_t start = port_system_get_millis();
+    do
+    {
+        fsm_fire(p_fsm);
+        fsm_usart_get_tx_stats(p_fsm, &stats);
+    } while ((stats.messages_sent < messages_sent) && (port_system_get_millis() - start < TEST_TIMEOUT_MS));
+}
+
+static void _record_cb(fsm_t *p_this, void *p_arg)
+{
+    fsm_usart_tx_stats_t stats;
+    fsm_usart_get_tx_stats(p_this, &stats);
+    cb_sent[cb_calls] = stats.messages_sent;
+    cb_args[cb_calls++] = p_arg;
+}
+
+void setUp(void)
+{
+    p_fsm = fsm_usart_new(TEST_USART_ID);
+    if (fd_host < 0)
+    {
+        fd_host = open(port_usart_get_pty_name(TEST_USART_ID), O_RDWR | O_NOCTTY | O_NONBLOCK);
+    }
+    char discard[64];
+    while (read(fd_host, discard, sizeof(discard)) > 0) // Bytes of a previous test
+    {
+    }
+    cb_calls = 0;
+}
+
+void tearDown(void)
+{
+    fsm_destroy(p_fsm);
+}
+
+void test_queue_full(void)
+{
+    fsm_usart_tx_stats_t stats;
+    char msg[] = "m0";
+    for (uint32_t i = 0; i < USART_TX_QUEUE_LENGTH; i++)
+    {
+        msg[1] = '0' + i;
+        UNITY_TEST_ASSERT(fsm_usart_set_out_data(p_fsm, msg, 2), __LINE__, "ERROR: a message has been rejected before the queue was full");
+    }
+    UNITY_TEST_ASSERT(!fsm_usart_set_out_data(p_fsm, "full", 4), __LINE__, "ERROR: a copied message has been accepted with the queue full");
+    UNITY_TEST_ASSERT(!fsm_usart_set_out_data_ref(p_fsm, "full", 4, _record_cb, NULL), __LINE__, "ERROR: a caller-owned message has been accepted with the queue full");
+    fsm_usart_get_tx_stats(p_fsm, &stats);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(USART_TX_QUEUE_LENGTH, stats.messages_queued, __LINE__, "ERROR: the messages queued are wrong");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(2, stats.messages_dropped, __LINE__, "ERROR: the messages rejected have not been counted as dropped");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(USART_TX_QUEUE_LENGTH * 2, stats.bytes_copied, __LINE__, "ERROR: the bytes of the rejected messages have been counted");
+
+    /* Once a message has been sent, there is room for one more */
+    _send_until(1);
+    UNITY_TEST_ASSERT(fsm_usart_set_out_data(p_fsm, "m4", 2), __LINE__, "ERROR: a message has been rejected once a slot was free");
+    UNITY_TEST_ASSERT(!fsm_usart_set_out_data(p_fsm, "m5", 2), __LINE__, "ERROR: a message has been accepted with the queue full again");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, cb_calls, __LINE__, "ERROR: the callback of a rejected message has been called");
+}
+
+void test_ring_wrap(void)
+{
+    char msg[] = "m0";
+    for (uint32_t i = 0; i < USART_TX_QUEUE_LENGTH; i++)
+    {
+        msg[1] = '0' + i;
+        fsm_usart_set_out_data(p_fsm, msg, 2);
+    }
+    _send_until(2);
+
+    /* The next messages take the slots of the first ones */
+    for (uint32_t i = USART_TX_QUEUE_LENGTH; i < USART_TX_QUEUE_LENGTH + 2; i++)
+    {
+        msg[1] = '0' + i;
+        UNITY_TEST_ASSERT(fsm_usart_set_out_data(p_fsm, msg, 2), __LINE__, "ERROR: a message has been rejected after the ring wrapped");
+    }
+    _send_until(USART_TX_QUEUE_LENGTH + 2);
+
+    char expected[] = "m0m1m2m3m4m5";
+    char received[sizeof(expected)] = {0};
+    UNITY_TEST_ASSERT_EQUAL_UINT32(strlen(expected), _host_read(received, strlen(expected)), __LINE__, "ERROR: not all the bytes have been sent");
+    UNITY_TEST_ASSERT_EQUAL_STRING(expected, received, __LINE__, "ERROR: the messages have not been sent in order across the wrap of the ring");
+}
+
+void test_caller_owned(void)
+{
+    static char buffers[3][8] = {"first-", "second-", "third-"};
+    fsm_usart_tx_stats_t stats;
+    fsm_usart_set_out_data(p_fsm, "copy-", 5);
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        UNITY_TEST_ASSERT(fsm_usart_set_out_data_ref(p_fsm, buffers[i], strlen(buffers[i]), _record_cb, buffers[i]), __LINE__, "ERROR: a caller-owned message has been rejected");
+    }
+    fsm_usart_get_tx_stats(p_fsm, &stats);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, stats.last_bytes_copied, __LINE__, "ERROR: a caller-owned message has been copied");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(5, stats.bytes_copied, __LINE__, "ERROR: the bytes of the caller-owned messages have been counted as copied");
+
+    /* The bytes are read from the buffer of the caller when the message is sent, not when it is queued */
+    buffers[2][0] = 'T';
+    _send_until(4);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(3, cb_calls, __LINE__, "ERROR: not all the completion callbacks have been called");
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        UNITY_TEST_ASSERT_EQUAL_PTR(buffers[i], cb_args[i], __LINE__, "ERROR: the completion callbacks have not been called in the order of the queue");
+        UNITY_TEST_ASSERT_EQUAL_UINT32(i + 2, cb_sent[i], __LINE__, "ERROR: a completion callback has been called before its message was counted as sent");
+    }
+    char expected[] = "copy-first-second-Third-";
+    char received[sizeof(expected)] = {0};
+    _host_read(received, strlen(expected));
+    UNITY_TEST_ASSERT_EQUAL_STRING(expected, received, __LINE__, "ERROR: the caller-owned messages have not been sent from their buffers");
+}
+
+void test_stats(void)
+{
+    fsm_usart_tx_stats_t stats;
+    fsm_usart_set_out_data(p_fsm, "12345", 5);
+    fsm_usart_set_out_data(p_fsm, "123", 3);
+    fsm_usart_set_out_data_ref(p_fsm, "1234567", 7, NULL, NULL);
+    fsm_usart_get_tx_stats(p_fsm, &stats);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(8, stats.bytes_copied, __LINE__, "ERROR: the bytes copied are wrong");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, stats.last_bytes_copied, __LINE__, "ERROR: the bytes copied for the last message are wrong");
+    UNITY_TEST_ASSERT_EQUAL_UINT8(3, stats.depth, __LINE__, "ERROR: the depth of the queue is wrong");
+    UNITY_TEST_ASSERT_EQUAL_UINT8(3, stats.max_depth, __LINE__, "ERROR: the maximum depth of the queue is wrong");
+
+    _send_until(2);
+    fsm_usart_set_out_data(p_fsm, "12", 2);
+    fsm_usart_get_tx_stats(p_fsm, &stats);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(10, stats.bytes_copied, __LINE__, "ERROR: the bytes copied have not been accumulated");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(2, stats.last_bytes_copied, __LINE__, "ERROR: the bytes copied for the last message are wrong");
+    UNITY_TEST_ASSERT_EQUAL_UINT8(2, stats.depth, __LINE__, "ERROR: the depth of the queue has not followed the messages sent");
+    UNITY_TEST_ASSERT_EQUAL_UINT8(3, stats.max_depth, __LINE__, "ERROR: the maximum depth of the queue has not been kept");
+
+    _send_until(4);
+    fsm_usart_get_tx_stats(p_fsm, &stats);
+    UNITY_TEST_ASSERT_EQUAL_UINT8(0, stats.depth, __LINE__, "ERROR: the queue is not empty once all the messages have been sent");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(4, stats.messages_sent, __LINE__, "ERROR: the messages sent are wrong");
+
+    fsm_usart_reset_tx_stats(p_fsm);
+    fsm_usart_get_tx_stats(p_fsm, &stats);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, stats.bytes_copied, __LINE__, "ERROR: the bytes copied have not been reset");
+    UNITY_TEST_ASSERT_EQUAL_UINT8(0, stats.max_depth, __LINE__, "ERROR: the maximum depth of the queue has not been reset");
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+
+    RUN_TEST(test_queue_full);
+    RUN_TEST(test_ring_wrap);
+    RUN_TEST(test_caller_owned);
+    RUN_TEST(test_stats);
+
+    exit(UNITY_END());
+}
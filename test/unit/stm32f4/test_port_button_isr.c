@@ -0,0 +1,42 @@
+#include <unity.h>
+#include "port_button.h"
+#include "port_system.h"
+#include "stm32f4xx.h"
+
+void setUp(void)
+{
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOCEN;
+}
+
+void tearDown(void)
+{
+    RCC->AHB1ENR &= ~RCC_AHB1ENR_GPIOCEN;
+}
+
+void test_isr_dispatch(void)
+{
+    button_edge_t edge;
+    port_button_init(BUTTON_0_ID);
+    while (port_button_get_edge(BUTTON_0_ID, &edge))
+    {
+    }
+    buttons_arr[BUTTON_0_ID].flag_pressed = true;
+
+    // Raise the EXTI line of the button by software: the button is released (the pin is HIGH)
+    EXTI->SWIER = BIT_POS_TO_MASK(BUTTON_0_PIN);
+    port_system_delay_ms(1);
+
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, EXTI->PR & BIT_POS_TO_MASK(BUTTON_0_PIN), __LINE__, "ERROR: The EXTI line of the button has not been cleared by the ISR");
+    UNITY_TEST_ASSERT(!buttons_arr[BUTTON_0_ID].flag_pressed, __LINE__, "ERROR: The ISR has not updated the state of the button of the EXTI line");
+    UNITY_TEST_ASSERT(port_button_get_edge(BUTTON_0_ID, &edge), __LINE__, "ERROR: The ISR has not queued the edge of the button");
+    UNITY_TEST_ASSERT(!edge.pressed, __LINE__, "ERROR: The edge queued by the ISR has not the level of the button");
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+
+    RUN_TEST(test_isr_dispatch);
+    exit(UNITY_END());
+}
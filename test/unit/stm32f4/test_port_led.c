@@ -0,0 +1,135 @@
+#include <unity.h>
+#include "port_led.h"
+#include "port_system.h"
+#include "stm32f4xx.h"
+
+#define LD2_PIN 5 /*LD2 pin number*/
+
+void setUp(void)
+{
+    port_led_gpio_setup();
+}
+
+void tearDown(void)
+{
+    port_led_blink_stop();
+    port_led_pattern_stop();
+}
+
+void test_toggle_regs(void)
+{
+    uint32_t prev_odr = GPIOA->ODR;
+    port_led_toggle();
+    UNITY_TEST_ASSERT_EQUAL_UINT32(prev_odr ^ (1U << LD2_PIN), GPIOA->ODR, __LINE__, "ERROR: the toggle has not changed only the LD2 bit of ODR");
+    port_led_toggle();
+    UNITY_TEST_ASSERT_EQUAL_UINT32(prev_odr, GPIOA->ODR, __LINE__, "ERROR: two toggles do not restore ODR");
+}
+
+void test_batch_write_regs(void)
+{
+    const uint16_t others = (1U << 8) | (1U << 9);
+    uint32_t prev_odr = GPIOA->ODR;
+    port_system_gpio_write_pins(GPIOA, 1U << LD2_PIN, others);
+    UNITY_TEST_ASSERT_EQUAL_UINT32((prev_odr & ~others) | (1U << LD2_PIN), GPIOA->ODR, __LINE__, "ERROR: the batch write has not set and reset the pins requested");
+    port_system_gpio_toggle_pins(GPIOA, (1U << LD2_PIN) | others);
+    UNITY_TEST_ASSERT_EQUAL_UINT32((prev_odr & ~(1U << LD2_PIN)) | others, GPIOA->ODR, __LINE__, "ERROR: the batch toggle has not toggled the pins requested");
+    port_system_gpio_write_pins(GPIOA, prev_odr & others, ~prev_odr & others);
+}
+
+void test_hw_blink_regs(void)
+{
+    uint32_t prev_gpio_mode = GPIOA->MODER;
+
+    UNITY_TEST_ASSERT(port_led_blink_start(1000), __LINE__, "ERROR: LD2 cannot blink by hardware");
+
+    // PA5 as alternate function 3 (TIM8_CH1N)
+    UNITY_TEST_ASSERT_EQUAL_UINT32(GPIO_MODE_ALTERNATE, (GPIOA->MODER >> (LD2_PIN * 2)) & 0x3, __LINE__, "ERROR: LD2 pin is not configured as alternate function");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(3, (GPIOA->AFR[0] >> (LD2_PIN * 4)) & 0xF, __LINE__, "ERROR: LD2 pin is not routed to TIM8_CH1N (AF3)");
+    uint32_t mask = ~(0x3 << (LD2_PIN * 2));
+    UNITY_TEST_ASSERT_EQUAL_UINT32(prev_gpio_mode & mask, GPIOA->MODER & mask, __LINE__, "ERROR: GPIO MODE has been modified for other pins than LD2");
+
+    // TIM8 channel 1 in output compare toggle mode, on the complementary output
+    UNITY_TEST_ASSERT(RCC->APB2ENR & RCC_APB2ENR_TIM8EN, __LINE__, "ERROR: TIM8 clock is not enabled");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0x3, (TIM8->CCMR1 & TIM_CCMR1_OC1M) >> TIM_CCMR1_OC1M_Pos, __LINE__, "ERROR: TIM8 channel 1 is not in toggle mode");
+    UNITY_TEST_ASSERT(TIM8->CCER & TIM_CCER_CC1NE, __LINE__, "ERROR: TIM8_CH1N output is not enabled");
+    UNITY_TEST_ASSERT(TIM8->BDTR & TIM_BDTR_MOE, __LINE__, "ERROR: TIM8 main output is not enabled");
+    UNITY_TEST_ASSERT(TIM8->CR1 & TIM_CR1_CEN, __LINE__, "ERROR: TIM8 is not running");
+
+    // One toggle every half period
+    uint64_t clocks = (uint64_t)(TIM8->PSC + 1) * (TIM8->ARR + 1);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(SystemCoreClock / 2, (uint32_t)clocks, __LINE__, "ERROR: TIM8 does not toggle LD2 every half period");
+    UNITY_TEST_ASSERT(TIM8->ARR <= 0xFFFF, __LINE__, "ERROR: TIM8 ARR overflows");
+}
+
+void test_hw_blink_stop(void)
+{
+    port_led_blink_start(1000);
+    port_led_blink_stop();
+    UNITY_TEST_ASSERT_EQUAL_UINT32(GPIO_MODE_OUT, (GPIOA->MODER >> (LD2_PIN * 2)) & 0x3, __LINE__, "ERROR: LD2 pin is not configured as output after stopping the blink");
+    UNITY_TEST_ASSERT(!(TIM8->CR1 & TIM_CR1_CEN), __LINE__, "ERROR: TIM8 is still running after stopping the blink");
+}
+
+void test_hw_blink_period_too_short(void)
+{
+    UNITY_TEST_ASSERT(!port_led_blink_start(LD2_HW_BLINK_MIN_PERIOD_MS - 1), __LINE__, "ERROR: LD2 blinks by hardware at a period too short");
+}
+
+void test_pattern_regs(void)
+{
+    static uint16_t breath[32];
+    led_pattern_breathe(breath, 32);
+    led_pattern_t pattern = {breath, 32, 20, true};
+    UNITY_TEST_ASSERT(port_led_pattern_start(&pattern), __LINE__, "ERROR: LD2 cannot play a pattern by hardware");
+
+    // TIM8 channel 1 in PWM mode 1 without preload, a step of 20 PWM periods and DMA requests on update
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0x6, (TIM8->CCMR1 & TIM_CCMR1_OC1M) >> TIM_CCMR1_OC1M_Pos, __LINE__, "ERROR: TIM8 channel 1 is not in PWM mode 1");
+    UNITY_TEST_ASSERT(!(TIM8->CCMR1 & TIM_CCMR1_OC1PE), __LINE__, "ERROR: TIM8 CCR1 preload is enabled");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(LED_PATTERN_DUTY_MAX - 1, TIM8->ARR, __LINE__, "ERROR: the PWM does not have LED_PATTERN_DUTY_MAX levels");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(SystemCoreClock / LED_PATTERN_PWM_HZ, (TIM8->PSC + 1) * (TIM8->ARR + 1), __LINE__, "ERROR: the PWM frequency is not LED_PATTERN_PWM_HZ");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(19, TIM8->RCR, __LINE__, "ERROR: TIM8 repetition counter does not count the PWM periods of a step");
+    UNITY_TEST_ASSERT(TIM8->DIER & TIM_DIER_UDE, __LINE__, "ERROR: TIM8 update DMA request is not enabled");
+    UNITY_TEST_ASSERT(TIM8->CCER & TIM_CCER_CC1NE, __LINE__, "ERROR: TIM8_CH1N output is not enabled");
+    UNITY_TEST_ASSERT(TIM8->CR1 & TIM_CR1_CEN, __LINE__, "ERROR: TIM8 is not running");
+
+    // DMA2 Stream 1, channel 7 (TIM8_UP): half words from the table to CCR1, circular
+    UNITY_TEST_ASSERT(RCC->AHB1ENR & RCC_AHB1ENR_DMA2EN, __LINE__, "ERROR: DMA2 clock is not enabled");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(7, (DMA2_Stream1->CR & DMA_SxCR_CHSEL) >> DMA_SxCR_CHSEL_Pos, __LINE__, "ERROR: DMA2 Stream 1 is not on channel 7");
+    UNITY_TEST_ASSERT(DMA2_Stream1->CR & DMA_SxCR_CIRC, __LINE__, "ERROR: the DMA of a looping pattern is not circular");
+    UNITY_TEST_ASSERT(DMA2_Stream1->CR & DMA_SxCR_EN, __LINE__, "ERROR: DMA2 Stream 1 is not enabled");
+    UNITY_TEST_ASSERT_EQUAL_UINT32((uint32_t)(uintptr_t)&TIM8->CCR1, DMA2_Stream1->PAR, __LINE__, "ERROR: the DMA does not write to TIM8_CCR1");
+    UNITY_TEST_ASSERT(port_led_pattern_is_running(), __LINE__, "ERROR: the pattern is not running");
+
+    // The duty cycle follows the table
+    port_system_delay_ms(5 * 20 + 10);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(breath[5], port_led_get_duty(), __LINE__, "ERROR: the DMA has not copied the table to TIM8_CCR1");
+}
+
+void test_pattern_stop(void)
+{
+    static uint16_t blinks[4];
+    led_pattern_t pattern = {blinks, led_pattern_blinks(blinks, 4, 2, 1, 1), 10, false};
+    port_led_pattern_start(&pattern);
+    UNITY_TEST_ASSERT(!(DMA2_Stream1->CR & DMA_SxCR_CIRC), __LINE__, "ERROR: the DMA of a pattern played once is circular");
+    port_system_delay_ms(5 * 10);
+    UNITY_TEST_ASSERT(!port_led_pattern_is_running(), __LINE__, "ERROR: the pattern played once is still running");
+    port_led_pattern_stop();
+    UNITY_TEST_ASSERT_EQUAL_UINT32(GPIO_MODE_OUT, (GPIOA->MODER >> (LD2_PIN * 2)) & 0x3, __LINE__, "ERROR: LD2 pin is not configured as output after stopping the pattern");
+    UNITY_TEST_ASSERT(!(TIM8->DIER & TIM_DIER_UDE), __LINE__, "ERROR: TIM8 still requests DMA transfers after stopping the pattern");
+    UNITY_TEST_ASSERT(!port_led_get(), __LINE__, "ERROR: LD2 is not off after stopping the pattern");
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+
+    RUN_TEST(test_toggle_regs);
+    RUN_TEST(test_batch_write_regs);
+    RUN_TEST(test_hw_blink_regs);
+    RUN_TEST(test_hw_blink_stop);
+    RUN_TEST(test_hw_blink_period_too_short);
+    RUN_TEST(test_pattern_regs);
+    RUN_TEST(test_pattern_stop);
+
+    exit(UNITY_END());
+}
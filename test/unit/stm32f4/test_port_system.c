@@ -0,0 +1,71 @@
+#include <unity.h>
+#include "port_system.h"
+#include "stm32f4xx.h"
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_micros_timer_regs(void)
+{
+    UNITY_TEST_ASSERT(RCC->APB1ENR & RCC_APB1ENR_TIM5EN, __LINE__, "ERROR: TIM5 clock is not enabled");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(SystemCoreClock / 1000000 - 1, TIM5->PSC, __LINE__, "ERROR: TIM5 does not count at 1 MHz");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFF, TIM5->ARR, __LINE__, "ERROR: TIM5 does not count the whole 32 bits");
+    UNITY_TEST_ASSERT(TIM5->CR1 & TIM_CR1_CEN, __LINE__, "ERROR: TIM5 is not running");
+    UNITY_TEST_ASSERT(!(TIM5->DIER & TIM_DIER_UIE), __LINE__, "ERROR: TIM5 interrupts are enabled");
+}
+
+void test_micros_follow_cycles(void)
+{
+    uint32_t start_us = port_system_get_micros();
+    uint32_t start_cycles = port_system_get_cycles();
+    port_system_delay_ms(10);
+    uint32_t elapsed_us = port_system_get_micros() - start_us;
+    uint32_t elapsed_cycles = port_system_get_cycles() - start_cycles;
+    UNITY_TEST_ASSERT_UINT32_WITHIN(5, elapsed_cycles / port_system_get_cycles_per_us(), elapsed_us, __LINE__, "ERROR: TIM5 does not count the microseconds of the core clock");
+}
+
+void test_wakeup_timer_regs(void)
+{
+    UNITY_TEST_ASSERT_EQUAL_UINT32(100, port_system_wakeup_timer_set(100), __LINE__, "ERROR: the wake-up timer has not been programmed for the delay requested");
+    UNITY_TEST_ASSERT(RCC->APB1ENR & RCC_APB1ENR_TIM7EN, __LINE__, "ERROR: TIM7 clock is not enabled");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(SystemCoreClock / WAKEUP_TIMER_TICK_HZ - 1, TIM7->PSC, __LINE__, "ERROR: TIM7 does not count at WAKEUP_TIMER_TICK_HZ");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(100 * WAKEUP_TIMER_TICK_HZ / 1000 - 1, TIM7->ARR, __LINE__, "ERROR: TIM7 does not expire after the delay");
+    UNITY_TEST_ASSERT(TIM7->CR1 & TIM_CR1_OPM, __LINE__, "ERROR: TIM7 is not one-shot");
+    UNITY_TEST_ASSERT(TIM7->DIER & TIM_DIER_UIE, __LINE__, "ERROR: TIM7 update interrupt is not enabled");
+    UNITY_TEST_ASSERT(TIM7->CR1 & TIM_CR1_CEN, __LINE__, "ERROR: TIM7 is not running");
+    port_system_wakeup_timer_stop();
+    UNITY_TEST_ASSERT(!(TIM7->CR1 & TIM_CR1_CEN), __LINE__, "ERROR: TIM7 is running after it has been stopped");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(WAKEUP_TIMER_MAX_MS, port_system_wakeup_timer_set(10 * WAKEUP_TIMER_MAX_MS), __LINE__, "ERROR: a delay too long has not been cut");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0xFFFF, TIM7->ARR, __LINE__, "ERROR: TIM7 does not count a whole turn for the longest delay");
+    port_system_wakeup_timer_stop();
+}
+
+void test_wakeup_timer_catch_up(void)
+{
+    uint32_t start = port_system_get_millis();
+    port_system_wakeup_timer_set(20);
+    port_system_systick_suspend(); // As port_system_sleep() does: the system tick stops
+    while (TIM7->CR1 & TIM_CR1_CEN)
+    {
+    }
+    port_system_systick_resume();
+    UNITY_TEST_ASSERT_UINT32_WITHIN(1, 20, port_system_get_millis() - start, __LINE__, "ERROR: the system tick has not been moved to the expiry of the wake-up timer");
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+
+    RUN_TEST(test_micros_timer_regs);
+    RUN_TEST(test_micros_follow_cycles);
+    RUN_TEST(test_wakeup_timer_regs);
+    RUN_TEST(test_wakeup_timer_catch_up);
+
+    exit(UNITY_END());
+}
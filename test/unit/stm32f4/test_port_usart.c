@@ -0,0 +1,139 @@
+#include <unity.h>
+#include <string.h>
+#include "port_usart.h"
+#include "port_system.h"
+#include "usart_brr.h"
+#include "stm32f4xx.h"
+
+#define TEST_TIMEOUT_MS 100 /*Maximum time to wait for a transmission*/
+
+void setUp(void)
+{
+    port_usart_init(USART_0_ID);
+    port_usart_init(USART_1_ID);
+}
+
+void tearDown(void)
+{
+    port_usart_disable_rx_interrupt(USART_0_ID);
+    port_usart_disable_tx_interrupt(USART_0_ID);
+    port_usart_disable_rx_interrupt(USART_1_ID);
+    port_usart_disable_tx_interrupt(USART_1_ID);
+}
+
+void test_identifiers(void)
+{
+    UNITY_TEST_ASSERT_EQUAL_INT(0, USART_0_ID, __LINE__, "ERROR: USART_0_ID must be 0");
+    UNITY_TEST_ASSERT_EQUAL_INT(1, USART_1_ID, __LINE__, "ERROR: USART_1_ID must be 1");
+    UNITY_TEST_ASSERT_EQUAL_INT(USART3, usart_arr[USART_0_ID].p_usart, __LINE__, "ERROR: USART_0 must use USART3");
+    UNITY_TEST_ASSERT_EQUAL_INT(USART2, usart_arr[USART_1_ID].p_usart, __LINE__, "ERROR: USART_1 must use USART2");
+    for (uint32_t i = 0; i < USARTS_NUMBER; i++)
+    {
+        for (uint32_t j = i + 1; j < USARTS_NUMBER; j++)
+        {
+            UNITY_TEST_ASSERT(usart_arr[i].p_usart != usart_arr[j].p_usart, __LINE__, "ERROR: Two USART IDs use the same peripheral");
+        }
+    }
+}
+
+void _test_regs(uint32_t usart_id, uint32_t pclk_hz)
+{
+    USART_TypeDef *p_usart = usart_arr[usart_id].p_usart;
+    usart_brr_t brr;
+    usart_brr_compute(pclk_hz, port_usart_get_baudrate(usart_id), &brr);
+
+    UNITY_TEST_ASSERT(p_usart->CR1 & USART_CR1_UE, __LINE__, "ERROR: USART is not enabled");
+    UNITY_TEST_ASSERT(p_usart->CR1 & USART_CR1_TE, __LINE__, "ERROR: USART transmitter is not enabled");
+    UNITY_TEST_ASSERT(p_usart->CR1 & USART_CR1_RE, __LINE__, "ERROR: USART receiver is not enabled");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, p_usart->CR1 & (USART_CR1_M | USART_CR1_PCE), __LINE__, "ERROR: USART must use 8 data bits and no parity");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, p_usart->CR2 & USART_CR2_STOP, __LINE__, "ERROR: USART must use 1 stop bit");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(brr.brr, p_usart->BRR, __LINE__, "ERROR: USART BRR does not match the peripheral clock");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, p_usart->CR1 & (USART_CR1_RXNEIE | USART_CR1_TXEIE), __LINE__, "ERROR: USART interrupts must be disabled after the initialization");
+}
+
+void test_regs(void)
+{
+    uint32_t pclk1 = SystemCoreClock >> APBPrescTable[(RCC->CFGR & RCC_CFGR_PPRE1) >> RCC_CFGR_PPRE1_Pos];
+    UNITY_TEST_ASSERT(RCC->APB1ENR & RCC_APB1ENR_USART3EN, __LINE__, "ERROR: USART3 clock is not enabled");
+    UNITY_TEST_ASSERT(RCC->APB1ENR & RCC_APB1ENR_USART2EN, __LINE__, "ERROR: USART2 clock is not enabled");
+    _test_regs(USART_0_ID, pclk1);
+    _test_regs(USART_1_ID, pclk1);
+}
+
+void test_interrupts_per_instance(void)
+{
+    port_usart_enable_rx_interrupt(USART_0_ID);
+    UNITY_TEST_ASSERT(USART3->CR1 & USART_CR1_RXNEIE, __LINE__, "ERROR: RX interrupt of USART_0 is not enabled");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, USART2->CR1 & USART_CR1_RXNEIE, __LINE__, "ERROR: RX interrupt of USART_1 has been enabled by USART_0");
+
+    port_usart_enable_rx_interrupt(USART_1_ID);
+    port_usart_disable_rx_interrupt(USART_0_ID);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, USART3->CR1 & USART_CR1_RXNEIE, __LINE__, "ERROR: RX interrupt of USART_0 is not disabled");
+    UNITY_TEST_ASSERT(USART2->CR1 & USART_CR1_RXNEIE, __LINE__, "ERROR: RX interrupt of USART_1 has been disabled by USART_0");
+
+    UNITY_TEST_ASSERT(NVIC_GetEnableIRQ(USART3_IRQn), __LINE__, "ERROR: USART3 IRQ is not enabled in the NVIC");
+    UNITY_TEST_ASSERT(NVIC_GetEnableIRQ(USART2_IRQn), __LINE__, "ERROR: USART2 IRQ is not enabled in the NVIC");
+}
+
+void test_parallel_tx(void)
+{
+    const char msg_0[] = "telemetry";
+    const char msg_1[] = "ctl";
+    port_usart_set_output_buffer(USART_0_ID, msg_0, strlen(msg_0));
+    port_usart_set_output_buffer(USART_1_ID, msg_1, strlen(msg_1));
+    port_usart_enable_tx_interrupt(USART_0_ID);
+    port_usart_enable_tx_interrupt(USART_1_ID);
+
+    uint32_t start = port_system_get_millis();
+    while (!(port_usart_tx_done(USART_0_ID) && port_usart_tx_done(USART_1_ID)) && (port_system_get_millis() - start < TEST_TIMEOUT_MS))
+    {
+    }
+    UNITY_TEST_ASSERT(port_usart_tx_done(USART_0_ID), __LINE__, "ERROR: USART_0 has not finished its transmission");
+    UNITY_TEST_ASSERT(port_usart_tx_done(USART_1_ID), __LINE__, "ERROR: USART_1 has not finished its transmission");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(strlen(msg_0), usart_arr[USART_0_ID].o_idx, __LINE__, "ERROR: USART_0 has not sent all its bytes");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(strlen(msg_1), usart_arr[USART_1_ID].o_idx, __LINE__, "ERROR: USART_1 has not sent all its bytes");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, USART3->CR1 & USART_CR1_TXEIE, __LINE__, "ERROR: TX interrupt of USART_0 must be disabled at the end of the transmission");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, USART2->CR1 & USART_CR1_TXEIE, __LINE__, "ERROR: TX interrupt of USART_1 must be disabled at the end of the transmission");
+    port_usart_reset_output_buffer(USART_0_ID);
+    port_usart_reset_output_buffer(USART_1_ID);
+}
+
+void test_rx_dispatch(void)
+{
+    // In half-duplex mode the receiver is internally connected to the transmitter, so USART_1 receives its own message
+    char buffer[USART_INPUT_BUFFER_LENGTH] = {0};
+    const char msg[] = "echo\n";
+    port_usart_set_loopback(USART_1_ID, true);
+    UNITY_TEST_ASSERT(USART2->CR3 & USART_CR3_HDSEL, __LINE__, "ERROR: USART_1 is not in half-duplex mode");
+    port_usart_reset_input_buffer(USART_1_ID);
+    port_usart_enable_rx_interrupt(USART_1_ID);
+    port_usart_set_output_buffer(USART_1_ID, msg, strlen(msg));
+    port_usart_enable_tx_interrupt(USART_1_ID);
+
+    uint32_t start = port_system_get_millis();
+    while (!port_usart_rx_done(USART_1_ID) && (port_system_get_millis() - start < TEST_TIMEOUT_MS))
+    {
+    }
+    UNITY_TEST_ASSERT(port_usart_rx_done(USART_1_ID), __LINE__, "ERROR: USART_1 has not received its own frame");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(4, port_usart_get_from_input_buffer(USART_1_ID, buffer), __LINE__, "ERROR: Wrong length of the received frame");
+    UNITY_TEST_ASSERT_EQUAL_STRING("echo", buffer, __LINE__, "ERROR: Wrong content of the received frame");
+    UNITY_TEST_ASSERT(!port_usart_rx_done(USART_0_ID), __LINE__, "ERROR: USART_0 has received a frame of USART_1");
+
+    port_usart_set_loopback(USART_1_ID, false);
+    UNITY_TEST_ASSERT(!(USART2->CR3 & USART_CR3_HDSEL), __LINE__, "ERROR: USART_1 is still in half-duplex mode");
+    UNITY_TEST_ASSERT(USART2->CR1 & USART_CR1_UE, __LINE__, "ERROR: USART_1 has not been enabled again");
+    port_usart_reset_output_buffer(USART_1_ID);
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+
+    RUN_TEST(test_identifiers);
+    RUN_TEST(test_regs);
+    RUN_TEST(test_interrupts_per_instance);
+    RUN_TEST(test_parallel_tx);
+    RUN_TEST(test_rx_dispatch);
+    exit(UNITY_END());
+}
@@ -0,0 +1,129 @@
+#include <string.h>
+#include <unity.h>
+#include "binlog.h"
+#include "port_system.h"
+
+#define PAYLOAD_LENGTH 512 /*Large enough for any test below*/
+
+static uint8_t payload[PAYLOAD_LENGTH];
+
+void setUp(void)
+{
+    binlog_init();
+}
+
+void tearDown(void)
+{
+}
+
+/**
+ * @brief Get the word at a byte offset of the payload (little endian).
+ */
+
+static uint32_t get_word(uint32_t offset)
+{
+    return (uint32_t)payload[offset] | ((uint32_t)payload[offset + 1] << 8) | ((uint32_t)payload[offset + 2] << 16) | ((uint32_t)payload[offset + 3] << 24);
+}
+
+void test_records(void)
+{
+    BINLOG("boot");
+    BINLOG("button %u pressed for %u ms", 3, 250);
+    BINLOG("level %d", -7);
+
+    uint32_t length = binlog_read(payload, sizeof(payload));
+    UNITY_TEST_ASSERT_EQUAL_UINT32(BINLOG_FRAME_HEADER_LENGTH + 4 * (2 + 4 + 3), length, __LINE__, "ERROR: wrong length of the payload");
+    UNITY_TEST_ASSERT_EQUAL_UINT8(BINLOG_FRAME_TYPE, payload[0], __LINE__, "ERROR: wrong frame type");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(port_system_get_cycles_per_us(), payload[1] | (payload[2] << 8), __LINE__, "ERROR: wrong cycles per microsecond");
+
+    // The host tool finds each format string at the offset given by its ID
+    uint32_t offset = BINLOG_FRAME_HEADER_LENGTH;
+    uint32_t word = get_word(offset);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, word >> BINLOG_ID_BITS, __LINE__, "ERROR: wrong number of arguments");
+    UNITY_TEST_ASSERT_EQUAL_STRING("boot", binlog_get_format(word & BINLOG_ID_DROPPED), __LINE__, "ERROR: wrong format string");
+    uint32_t timestamp = get_word(offset + 4);
+
+    offset += 4 * 2;
+    word = get_word(offset);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(2, word >> BINLOG_ID_BITS, __LINE__, "ERROR: wrong number of arguments");
+    UNITY_TEST_ASSERT_EQUAL_STRING("button %u pressed for %u ms", binlog_get_format(word & BINLOG_ID_DROPPED), __LINE__, "ERROR: wrong format string");
+    UNITY_TEST_ASSERT((int32_t)(get_word(offset + 4) - timestamp) >= 0, __LINE__, "ERROR: timestamps must not go backwards");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(3, get_word(offset + 8), __LINE__, "ERROR: wrong first argument");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(250, get_word(offset + 12), __LINE__, "ERROR: wrong second argument");
+
+    offset += 4 * 4;
+    word = get_word(offset);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, word >> BINLOG_ID_BITS, __LINE__, "ERROR: wrong number of arguments");
+    UNITY_TEST_ASSERT_EQUAL_INT32(-7, (int32_t)get_word(offset + 8), __LINE__, "ERROR: wrong signed argument");
+
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, binlog_read(payload, sizeof(payload)), __LINE__, "ERROR: the records must be released once read");
+}
+
+void test_partial_read(void)
+{
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        BINLOG("sample %u", i);
+    }
+    // Room for 4 whole records of 3 words: the fifth one must not be split
+    uint32_t size = BINLOG_FRAME_HEADER_LENGTH + 4 * 3 * 4 + 8;
+    uint32_t next = 0;
+    uint32_t length;
+    while ((length = binlog_read(payload, size)) > 0)
+    {
+        UNITY_TEST_ASSERT_EQUAL_UINT32(0, (length - BINLOG_FRAME_HEADER_LENGTH) % (4 * 3), __LINE__, "ERROR: records must not be split");
+        for (uint32_t offset = BINLOG_FRAME_HEADER_LENGTH; offset < length; offset += 4 * 3)
+        {
+            UNITY_TEST_ASSERT_EQUAL_UINT32(next++, get_word(offset + 8), __LINE__, "ERROR: records lost or reordered");
+        }
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT32(10, next, __LINE__, "ERROR: wrong number of records read");
+}
+
+void test_overflow(void)
+{
+    // Records of 3 words: the ring is full after BINLOG_RING_WORDS / 3 of them
+    uint32_t fit = BINLOG_RING_WORDS / 3;
+    for (uint32_t i = 0; i < fit + 5; i++)
+    {
+        BINLOG("sample %u", i);
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT32(5, binlog_get_dropped(), __LINE__, "ERROR: wrong number of dropped records");
+
+    // The first record read reports the drops, then the oldest records follow
+    uint32_t length = binlog_read(payload, sizeof(payload));
+    UNITY_TEST_ASSERT(length > 0, __LINE__, "ERROR: no records read");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(BINLOG_ID_DROPPED | (1UL << BINLOG_ID_BITS), get_word(BINLOG_FRAME_HEADER_LENGTH), __LINE__, "ERROR: drops not reported");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(5, get_word(BINLOG_FRAME_HEADER_LENGTH + 8), __LINE__, "ERROR: wrong number of drops reported");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, get_word(BINLOG_FRAME_HEADER_LENGTH + 4 * 3 + 8), __LINE__, "ERROR: the oldest records must be kept");
+
+    // Drain the ring, then wrap around the end of it several times
+    while (binlog_read(payload, sizeof(payload)) > 0)
+    {
+    }
+    for (uint32_t i = 0; i < 3 * fit; i++)
+    {
+        BINLOG("sample %u", i);
+        if (i % 7 == 6)
+        {
+            length = binlog_read(payload, sizeof(payload));
+            for (uint32_t offset = BINLOG_FRAME_HEADER_LENGTH; offset < length; offset += 4 * 3)
+            {
+                UNITY_TEST_ASSERT_EQUAL_UINT32(i - 6 + (offset - BINLOG_FRAME_HEADER_LENGTH) / (4 * 3), get_word(offset + 8), __LINE__, "ERROR: records lost or reordered after wrapping around");
+            }
+        }
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT32(5, binlog_get_dropped(), __LINE__, "ERROR: no record must be dropped while the ring is drained");
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+
+    RUN_TEST(test_records);
+    RUN_TEST(test_partial_read);
+    RUN_TEST(test_overflow);
+
+    exit(UNITY_END());
+}
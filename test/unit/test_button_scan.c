@@ -0,0 +1,76 @@
+#include <string.h>
+#include <unity.h>
+#include "button_scan.h"
+#include "port_system.h"
+
+static button_scan_t scan;
+
+void setUp(void)
+{
+    memset(&scan, 0, sizeof(scan));
+}
+
+void tearDown(void)
+{
+}
+
+void test_change_accepted_after_samples(void)
+{
+    for (uint32_t i = 1; i < BUTTON_SCAN_SAMPLES; i++)
+    {
+        UNITY_TEST_ASSERT_EQUAL_UINT32(0, button_scan_update(&scan, 0x1), __LINE__, "ERROR: a change has been accepted before BUTTON_SCAN_SAMPLES samples");
+        UNITY_TEST_ASSERT_EQUAL_UINT32(0x1, button_scan_busy(&scan), __LINE__, "ERROR: the line being debounced is not busy");
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0x1, button_scan_update(&scan, 0x1), __LINE__, "ERROR: the change has not been accepted after BUTTON_SCAN_SAMPLES samples");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0x1, scan.state, __LINE__, "ERROR: the debounced state has not changed");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, button_scan_busy(&scan), __LINE__, "ERROR: the counter is still running after the change");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, button_scan_update(&scan, 0x1), __LINE__, "ERROR: a stable line has changed again");
+}
+
+void test_bounces_rejected(void)
+{
+    // A bounce shorter than BUTTON_SCAN_SAMPLES samples resets the counter
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        for (uint32_t j = 1; j < BUTTON_SCAN_SAMPLES; j++)
+        {
+            UNITY_TEST_ASSERT_EQUAL_UINT32(0, button_scan_update(&scan, 0x1), __LINE__, "ERROR: a bounce has changed the debounced state");
+        }
+        UNITY_TEST_ASSERT_EQUAL_UINT32(0, button_scan_update(&scan, 0x0), __LINE__, "ERROR: a sample equal to the state has changed it");
+        UNITY_TEST_ASSERT_EQUAL_UINT32(0, button_scan_busy(&scan), __LINE__, "ERROR: the counter has not been reset by a sample equal to the state");
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, scan.state, __LINE__, "ERROR: the bounces have reached the debounced state");
+}
+
+void test_lines_independent(void)
+{
+    // Line 0 is pressed now, line 31 two samples later; line 5 bounces
+    uint32_t samples[] = {0x00000001, 0x00000021, 0x80000001, 0x80000021, 0x80000001, 0x80000001};
+    uint32_t expected[] = {0, 0, 0, 0x00000001, 0, 0x80000000};
+    for (uint32_t i = 0; i < sizeof(samples) / sizeof(samples[0]); i++)
+    {
+        UNITY_TEST_ASSERT_EQUAL_UINT32(expected[i], button_scan_update(&scan, samples[i]), __LINE__, "ERROR: the lines are not debounced independently");
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0x80000001, scan.state, __LINE__, "ERROR: wrong debounced state");
+}
+
+void test_set(void)
+{
+    button_scan_update(&scan, 0x3);
+    button_scan_set(&scan, 0x1, 0x1);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0x1, scan.state, __LINE__, "ERROR: the state of the line has not been set");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0x2, button_scan_busy(&scan), __LINE__, "ERROR: the counters of the other lines have been modified");
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+
+    RUN_TEST(test_change_accepted_after_samples);
+    RUN_TEST(test_bounces_rejected);
+    RUN_TEST(test_lines_independent);
+    RUN_TEST(test_set);
+
+    exit(UNITY_END());
+}
@@ -0,0 +1,161 @@
+#include <unity.h>
+#include "fsm_blink.h"
+#include "port_led.h"
+#include "port_system.h"
+
+#define PERIOD_MS 100 /*Blinking period of the tests*/
+
+static fsm_t *p_fsm;
+
+void setUp(void)
+{
+    p_fsm = fsm_blink_new(PERIOD_MS);
+}
+
+void tearDown(void)
+{
+    fsm_destroy(p_fsm);
+}
+
+/**
+ * @brief Fire the FSM every millisecond for ms milliseconds and count the changes of the LED.
+ */
+
+uint32_t _run_ms(uint32_t ms)
+{
+    uint32_t changes = 0;
+    bool on = port_led_get();
+    uint32_t start = port_system_get_millis();
+    while (port_system_get_millis() - start < ms) // Bounded by the system time, so the overshoot of the delays does not add up
+    {
+        if (fsm_blink_check_activity(p_fsm))
+        {
+            fsm_fire(p_fsm);
+        }
+        port_system_delay_ms(1);
+        changes += (port_led_get() != on) ? 1 : 0;
+        on = port_led_get();
+    }
+    return changes;
+}
+
+void test_hardware_blink(void)
+{
+    UNITY_TEST_ASSERT(((fsm_blink_t *)p_fsm)->hw_blink, __LINE__, "ERROR: the LED is not blinked by the hardware");
+    UNITY_TEST_ASSERT(!fsm_blink_check_activity(p_fsm), __LINE__, "ERROR: the FSM is active while the hardware blinks the LED");
+    uint32_t changes = _run_ms(5 * PERIOD_MS / 2 + PERIOD_MS / 4);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(5, changes, __LINE__, "ERROR: the LED has not toggled every half period without firing the FSM");
+}
+
+void test_set_period(void)
+{
+    fsm_blink_set_period(p_fsm, 2 * PERIOD_MS);
+    UNITY_TEST_ASSERT(fsm_blink_check_activity(p_fsm), __LINE__, "ERROR: the FSM is not active with a new period pending");
+    fsm_fire(p_fsm);
+    UNITY_TEST_ASSERT(!fsm_blink_check_activity(p_fsm), __LINE__, "ERROR: the FSM is still active after applying the new period");
+    uint32_t changes = _run_ms(2 * PERIOD_MS + PERIOD_MS / 2);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(2, changes, __LINE__, "ERROR: the LED has not toggled every half of the new period");
+}
+
+void test_software_fallback(void)
+{
+    /* The hardware cannot blink at this period: the FSM toggles the LED at each fire */
+    fsm_blink_set_period(p_fsm, LD2_HW_BLINK_MIN_PERIOD_MS - 1);
+    fsm_fire(p_fsm);
+    UNITY_TEST_ASSERT(!((fsm_blink_t *)p_fsm)->hw_blink, __LINE__, "ERROR: the hardware blinks the LED at a period it does not support");
+    UNITY_TEST_ASSERT(fsm_blink_check_activity(p_fsm), __LINE__, "ERROR: the FSM is not active while it toggles the LED");
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        bool on = port_led_get();
+        port_system_delay_ms(1);
+        fsm_fire(p_fsm);
+        UNITY_TEST_ASSERT(port_led_get() != on, __LINE__, "ERROR: the FSM has not toggled the LED by software");
+    }
+
+    fsm_blink_set_period(p_fsm, PERIOD_MS);
+    fsm_fire(p_fsm);
+    UNITY_TEST_ASSERT(((fsm_blink_t *)p_fsm)->hw_blink, __LINE__, "ERROR: the hardware does not blink the LED again at a supported period");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(5, _run_ms(5 * PERIOD_MS / 2 + PERIOD_MS / 4), __LINE__, "ERROR: the LED has not toggled every half period");
+}
+
+void test_pattern(void)
+{
+    static uint16_t breath[20];
+    led_pattern_breathe(breath, 20);
+    led_pattern_t pattern = {breath, 20, 10, true};
+    fsm_blink_set_pattern(p_fsm, &pattern);
+    UNITY_TEST_ASSERT(fsm_blink_check_activity(p_fsm), __LINE__, "ERROR: the FSM is not active with a new pattern pending");
+    fsm_fire(p_fsm);
+    UNITY_TEST_ASSERT(!fsm_blink_check_activity(p_fsm), __LINE__, "ERROR: the FSM is active while the hardware plays the pattern");
+    uint32_t start = port_system_get_millis();
+    for (uint32_t i = 0; i < 2 * 20 * 2; i++)
+    {
+        uint32_t t = port_system_get_millis() - start;
+        uint16_t duty = port_led_get_duty();
+        if (port_system_get_millis() - start == t) // Not at the edge of a step
+        {
+            UNITY_TEST_ASSERT_EQUAL_UINT32(breath[(t / 10) % 20], duty, __LINE__, "ERROR: the duty cycle of the LED does not follow the pattern");
+        }
+        port_system_delay_ms(5);
+    }
+
+    /* A new period is kept until the pattern stops */
+    fsm_blink_set_period(p_fsm, 2 * PERIOD_MS);
+    fsm_fire(p_fsm);
+    UNITY_TEST_ASSERT(port_led_pattern_is_running(), __LINE__, "ERROR: a new period has stopped the pattern");
+    fsm_blink_set_pattern(p_fsm, NULL);
+    fsm_fire(p_fsm);
+    UNITY_TEST_ASSERT(!port_led_pattern_is_running(), __LINE__, "ERROR: the pattern is still running");
+    UNITY_TEST_ASSERT(((fsm_blink_t *)p_fsm)->hw_blink, __LINE__, "ERROR: the hardware does not blink the LED again after the pattern");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(2, _run_ms(2 * PERIOD_MS + PERIOD_MS / 2), __LINE__, "ERROR: the LED has not toggled every half of the new period");
+}
+
+void test_pattern_once(void)
+{
+    static uint16_t blinks[6];
+    led_pattern_t pattern = {blinks, led_pattern_blinks(blinks, 6, 3, 1, 1), 20, false};
+    fsm_blink_set_pattern(p_fsm, &pattern);
+    fsm_fire(p_fsm);
+    uint32_t changes = _run_ms(200);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(5, changes, __LINE__, "ERROR: the LED has not blinked 3 times");
+    UNITY_TEST_ASSERT(!port_led_pattern_is_running(), __LINE__, "ERROR: the pattern does not stop after its last step");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, port_led_get_duty(), __LINE__, "ERROR: the LED does not keep the last step of the pattern");
+}
+
+void test_next_ms(void)
+{
+    UNITY_TEST_ASSERT_EQUAL_UINT32(FSM_TIMED_NONE, fsm_blink_get_next_ms(p_fsm), __LINE__, "ERROR: the FSM has a deadline while the hardware blinks the LED");
+    fsm_blink_set_period(p_fsm, PERIOD_MS);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, fsm_blink_get_next_ms(p_fsm), __LINE__, "ERROR: the FSM can sleep with a new period pending");
+    fsm_blink_fire(p_fsm);
+    port_led_blink_stop(); // Blink by software, to run check_timeout() of the FSM
+    ((fsm_blink_t *)p_fsm)->hw_blink = false;
+
+    /* The software toggle is due every half period: the main loop sleeps until then */
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        bool on = port_led_get();
+        uint32_t next_ms = fsm_blink_get_next_ms(p_fsm);
+        UNITY_TEST_ASSERT(next_ms <= PERIOD_MS / 2, __LINE__, "ERROR: the time to the next toggle is longer than half the period");
+        fsm_blink_fire(p_fsm);
+        UNITY_TEST_ASSERT((next_ms <= 1) || (port_led_get() == on), __LINE__, "ERROR: the LED has toggled before the time given by the FSM");
+        port_system_delay_ms(next_ms);
+        fsm_blink_fire(p_fsm);
+        UNITY_TEST_ASSERT(port_led_get() != on, __LINE__, "ERROR: the LED has not toggled at the time given by the FSM");
+    }
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+
+    RUN_TEST(test_hardware_blink);
+    RUN_TEST(test_set_period);
+    RUN_TEST(test_software_fallback);
+    RUN_TEST(test_pattern);
+    RUN_TEST(test_pattern_once);
+    RUN_TEST(test_next_ms);
+
+    exit(UNITY_END());
+}
@@ -0,0 +1,149 @@
+#include <unity.h>
+#include "fsm_button.h"
+#include "port_system.h"
+#include "port_button.h"
+#include "button_edges.h"
+
+#define BOUNCE_US 300 /*Time between two bounces of an edge*/
+#define STALL_MS 100 /*Time the main loop is stalled after each edge before firing the FSM*/
+
+static fsm_t *p_fsm;
+static uint32_t base_millis; /*System tick at the origin of the injected timestamps*/
+static uint32_t base_cycles; /*Cycle counter at the origin of the injected timestamps*/
+
+void setUp(void)
+{
+    p_fsm = fsm_button_new(BUTTON_0_DEBOUNCE_TIME_MS, BUTTON_0_ID);
+    port_system_gpio_exti_disable(BUTTON_0_PIN); // Disable EXTI to avoid unwanted interrupts
+    base_cycles = port_system_get_cycles();
+    base_millis = port_system_get_millis();
+}
+
+void tearDown(void)
+{
+    fsm_destroy(p_fsm);
+}
+
+/**
+ * @brief Inject an edge that happened us microseconds after the origin, with three bounces, as the ISR of the port would queue it, and set the level of the button.
+ */
+
+void _inject_edge(bool pressed, uint32_t us)
+{
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        uint32_t t = us + i * BOUNCE_US;
+        button_edges_push(&buttons_arr[BUTTON_0_ID].edges, (i % 2 == 0) ? pressed : !pressed, base_millis + t / 1000, base_cycles + t * port_system_get_cycles_per_us());
+    }
+    buttons_arr[BUTTON_0_ID].flag_pressed = pressed;
+}
+
+/**
+ * @brief Stall the main loop until ms milliseconds after the origin.
+ */
+
+void _stall_until(uint32_t ms)
+{
+    while (port_system_get_millis() - base_millis < ms)
+    {
+        port_system_delay_ms(1);
+    }
+}
+
+void test_duration_with_stalled_loop(void)
+{
+    const uint32_t press_us = 1500;
+    const uint32_t release_us = 512345;
+
+    _inject_edge(true, press_us);
+    _stall_until(press_us / 1000 + STALL_MS);
+    fsm_fire(p_fsm);
+    UNITY_TEST_ASSERT_EQUAL_INT(BUTTON_PRESSED_WAIT, fsm_get_state(p_fsm), __LINE__, "The FSM did not change to BUTTON_PRESSED_WAIT after pressing the button");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(base_millis + press_us / 1000, ((fsm_button_t *)p_fsm)->tick_pressed, __LINE__, "The tick of the press is not the tick of its first edge");
+    _stall_until(press_us / 1000 + BUTTON_0_DEBOUNCE_TIME_MS + 1);
+    fsm_fire(p_fsm);
+    UNITY_TEST_ASSERT_EQUAL_INT(BUTTON_PRESSED, fsm_get_state(p_fsm), __LINE__, "The FSM did not change to BUTTON_PRESSED after the debounce time");
+
+    _inject_edge(false, release_us);
+    _stall_until(release_us / 1000 + STALL_MS);
+    fsm_fire(p_fsm);
+    UNITY_TEST_ASSERT_EQUAL_INT(BUTTON_RELEASED_WAIT, fsm_get_state(p_fsm), __LINE__, "The FSM did not change to BUTTON_RELEASED_WAIT after releasing the button");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(release_us - press_us, fsm_button_get_duration_us(p_fsm), __LINE__, "The duration in us is not the time between the first edges of the press and the release");
+    UNITY_TEST_ASSERT_EQUAL_UINT32((release_us - press_us) / 1000, fsm_button_get_duration(p_fsm), __LINE__, "The duration in ms does not match the duration in us");
+
+    /* The bounces of the release must not be taken as the next press */
+    _stall_until(release_us / 1000 + BUTTON_0_DEBOUNCE_TIME_MS + 1);
+    fsm_fire(p_fsm);
+    UNITY_TEST_ASSERT_EQUAL_INT(BUTTON_RELEASED, fsm_get_state(p_fsm), __LINE__, "The FSM did not change to BUTTON_RELEASED after the debounce time");
+    const uint32_t next_us = release_us + 400000;
+    _inject_edge(true, next_us);
+    _stall_until(next_us / 1000 + STALL_MS);
+    fsm_fire(p_fsm);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(base_millis + next_us / 1000, ((fsm_button_t *)p_fsm)->tick_pressed, __LINE__, "A bounce of the release was taken as the next press");
+}
+
+void test_duration_longer_than_cycle_counter(void)
+{
+    /* Longer than the period of the cycle counter: the duration falls back to the system tick */
+    const uint32_t press_ms = 100000;
+    button_edges_push(&buttons_arr[BUTTON_0_ID].edges, true, base_millis, base_cycles);
+    buttons_arr[BUTTON_0_ID].flag_pressed = true;
+    fsm_fire(p_fsm);
+    _stall_until(BUTTON_0_DEBOUNCE_TIME_MS + 1);
+    fsm_fire(p_fsm);
+    UNITY_TEST_ASSERT_EQUAL_INT(BUTTON_PRESSED, fsm_get_state(p_fsm), __LINE__, "The FSM did not change to BUTTON_PRESSED after the debounce time");
+    button_edges_push(&buttons_arr[BUTTON_0_ID].edges, false, base_millis + press_ms, base_cycles); // The cycle counter has wrapped around several times
+    buttons_arr[BUTTON_0_ID].flag_pressed = false;
+    fsm_fire(p_fsm);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(press_ms * 1000, fsm_button_get_duration_us(p_fsm), __LINE__, "The duration of a long press is not computed from the system tick");
+}
+
+void test_edge_queue_overflow(void)
+{
+    button_edges_t *p_edges = &buttons_arr[BUTTON_0_ID].edges;
+    button_edge_t edge;
+    for (uint32_t i = 0; i < BUTTON_EDGES_LENGTH + 8; i++)
+    {
+        button_edges_push(p_edges, i % 2 == 0, i, i);
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT32(8, p_edges->dropped, __LINE__, "The edges that do not fit in the queue are not counted as dropped");
+    for (uint32_t i = 0; i < BUTTON_EDGES_LENGTH; i++)
+    {
+        UNITY_TEST_ASSERT(port_button_get_edge(BUTTON_0_ID, &edge), __LINE__, "An edge queued is missing");
+        UNITY_TEST_ASSERT_EQUAL_UINT32(i, edge.millis, __LINE__, "The edges are not taken in order");
+    }
+    UNITY_TEST_ASSERT(!port_button_get_edge(BUTTON_0_ID, &edge), __LINE__, "The queue is not empty after taking all the edges");
+}
+
+void test_timer_debounce_press_and_release_in_one_fire(void)
+{
+    /* The timer ISR debounces a press and its release before the main loop fires the FSM */
+    const uint32_t press_us = 1000;
+    const uint32_t release_us = 101000;
+    fsm_button_set_timer_debounce(p_fsm, true);
+    button_edges_push(&buttons_arr[BUTTON_0_ID].edges, true, base_millis + press_us / 1000, base_cycles + press_us * port_system_get_cycles_per_us());
+    button_edges_push(&buttons_arr[BUTTON_0_ID].edges, false, base_millis + release_us / 1000, base_cycles + release_us * port_system_get_cycles_per_us());
+    UNITY_TEST_ASSERT(fsm_button_check_activity(p_fsm), __LINE__, "The FSM is inactive with debounced edges queued");
+    fsm_fire(p_fsm);
+    UNITY_TEST_ASSERT_EQUAL_INT(BUTTON_PRESSED, fsm_get_state(p_fsm), __LINE__, "The press debounced before the release has been lost");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(base_millis + press_us / 1000, ((fsm_button_t *)p_fsm)->tick_pressed, __LINE__, "The tick of the press is not the tick of its edge");
+    UNITY_TEST_ASSERT(fsm_button_check_activity(p_fsm), __LINE__, "The FSM is inactive with the release queued: it would wait for the next interrupt");
+    fsm_fire(p_fsm);
+    UNITY_TEST_ASSERT_EQUAL_INT(BUTTON_RELEASED, fsm_get_state(p_fsm), __LINE__, "The release debounced in the same fire has been lost");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(release_us - press_us, fsm_button_get_duration_us(p_fsm), __LINE__, "The duration is not the time between the debounced edges");
+    UNITY_TEST_ASSERT(!fsm_button_check_activity(p_fsm), __LINE__, "The FSM is active with no edge queued");
+    fsm_button_set_timer_debounce(p_fsm, false);
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+
+    RUN_TEST(test_duration_with_stalled_loop);
+    RUN_TEST(test_duration_longer_than_cycle_counter);
+    RUN_TEST(test_edge_queue_overflow);
+    RUN_TEST(test_timer_debounce_press_and_release_in_one_fire);
+
+    exit(UNITY_END());
+}
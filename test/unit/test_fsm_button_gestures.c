@@ -0,0 +1,155 @@
+#include <unity.h>
+#include "fsm_button.h"
+#include "port_system.h"
+#include "port_button.h"
+
+#define DOUBLE_CLICK_MS 300 /*Double click time of the tests*/
+#define LONG_PRESS_MS 500 /*Long press time of the tests*/
+#define REPEAT_MS 100 /*Auto-repeat period of the tests*/
+#define PRESS_MS (BUTTON_0_DEBOUNCE_TIME_MS + 50) /*Short press of the tests: the release is only seen after the debounce time*/
+
+static fsm_t *p_fsm;
+static uint32_t events[16]; /*Events received by the subscriber, in order*/
+static uint32_t events_number; /*Events received by the subscriber*/
+
+void setUp(void)
+{
+    p_fsm = fsm_button_new(BUTTON_0_DEBOUNCE_TIME_MS, BUTTON_0_ID);
+    port_system_gpio_exti_disable(BUTTON_0_PIN); // Disable EXTI to avoid unwanted interrupts
+    events_number = 0;
+}
+
+void tearDown(void)
+{
+    fsm_destroy(p_fsm);
+}
+
+/**
+ * @brief Subscriber that records the events received.
+ */
+
+void _record(fsm_t *p_this, uint32_t event, void *p_arg)
+{
+    UNITY_TEST_ASSERT_EQUAL_PTR(p_fsm, p_this, __LINE__, "The callback did not receive the FSM of the button");
+    UNITY_TEST_ASSERT_EQUAL_PTR(&events_number, p_arg, __LINE__, "The callback did not receive its argument");
+    if (events_number < sizeof(events) / sizeof(events[0]))
+    {
+        events[events_number] = event;
+    }
+    events_number++;
+}
+
+/**
+ * @brief Fire the FSM every millisecond for ms milliseconds.
+ */
+
+void _run_ms(uint32_t ms)
+{
+    uint32_t start = port_system_get_millis();
+    while (port_system_get_millis() - start < ms) // Bounded by the system time, so the overshoot of the delays does not add up
+    {
+        fsm_fire(p_fsm);
+        port_system_delay_ms(1);
+    }
+    fsm_fire(p_fsm);
+}
+
+/**
+ * @brief Set the level of the button and run the FSM for ms milliseconds.
+ */
+
+void _hold(bool pressed, uint32_t ms)
+{
+    buttons_arr[BUTTON_0_ID].flag_pressed = pressed;
+    _run_ms(ms);
+}
+
+/**
+ * @brief Count the events of a type received.
+ */
+
+uint32_t _count(uint32_t event)
+{
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < events_number; i++)
+    {
+        count += (events[i] == event) ? 1 : 0;
+    }
+    return count;
+}
+
+void test_click(void)
+{
+    UNITY_TEST_ASSERT(fsm_button_subscribe(p_fsm, BUTTON_EVENT_CLICK | BUTTON_EVENT_DOUBLE_CLICK | BUTTON_EVENT_LONG_PRESS | BUTTON_EVENT_REPEAT, _record, &events_number), __LINE__, "The subscription failed");
+    fsm_button_set_gestures(p_fsm, DOUBLE_CLICK_MS, LONG_PRESS_MS, REPEAT_MS);
+
+    _hold(true, PRESS_MS);
+    _hold(false, DOUBLE_CLICK_MS / 2);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, events_number, __LINE__, "A click was notified before the double click time");
+    UNITY_TEST_ASSERT(fsm_button_check_activity(p_fsm), __LINE__, "The FSM is not active while a click is pending");
+    _hold(false, DOUBLE_CLICK_MS);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, events_number, __LINE__, "A short press was not notified once");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(BUTTON_EVENT_CLICK, events[0], __LINE__, "A short press was not notified as a click");
+    UNITY_TEST_ASSERT(!fsm_button_check_activity(p_fsm), __LINE__, "The FSM is active after notifying the click");
+}
+
+void test_double_click(void)
+{
+    fsm_button_subscribe(p_fsm, BUTTON_EVENT_CLICK | BUTTON_EVENT_DOUBLE_CLICK | BUTTON_EVENT_LONG_PRESS, _record, &events_number);
+    fsm_button_set_gestures(p_fsm, DOUBLE_CLICK_MS, LONG_PRESS_MS, REPEAT_MS);
+
+    _hold(true, PRESS_MS);
+    _hold(false, 200);
+    _hold(true, PRESS_MS);
+    _hold(false, DOUBLE_CLICK_MS + 50);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, events_number, __LINE__, "A double click was not notified once");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(BUTTON_EVENT_DOUBLE_CLICK, events[0], __LINE__, "Two presses within the double click time were not notified as a double click");
+
+    /* Two presses further apart than the double click time are two clicks */
+    events_number = 0;
+    _hold(true, PRESS_MS);
+    _hold(false, DOUBLE_CLICK_MS + 50);
+    _hold(true, PRESS_MS);
+    _hold(false, DOUBLE_CLICK_MS + 50);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(2, _count(BUTTON_EVENT_CLICK), __LINE__, "Two presses further apart than the double click time were not notified as two clicks");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(2, events_number, __LINE__, "Unexpected events after two separate clicks");
+}
+
+void test_long_press_with_repeat(void)
+{
+    fsm_button_subscribe(p_fsm, BUTTON_EVENT_CLICK | BUTTON_EVENT_DOUBLE_CLICK | BUTTON_EVENT_LONG_PRESS | BUTTON_EVENT_REPEAT, _record, &events_number);
+    fsm_button_set_gestures(p_fsm, DOUBLE_CLICK_MS, LONG_PRESS_MS, REPEAT_MS);
+
+    _hold(true, LONG_PRESS_MS - 50);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, events_number, __LINE__, "A long press was notified before the long press time");
+    UNITY_TEST_ASSERT(fsm_button_check_activity(p_fsm), __LINE__, "The FSM is not active while the long press is due");
+    _hold(true, 250 + REPEAT_MS / 2); // 750 ms held
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, _count(BUTTON_EVENT_LONG_PRESS), __LINE__, "The long press was not notified once while held");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(BUTTON_EVENT_LONG_PRESS, events[0], __LINE__, "The long press is not the first event");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(2, _count(BUTTON_EVENT_REPEAT), __LINE__, "The auto-repeat was not notified every repeat period");
+    _hold(false, DOUBLE_CLICK_MS + 50);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, _count(BUTTON_EVENT_CLICK), __LINE__, "A long press was also notified as a click");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(3, events_number, __LINE__, "Unexpected events after a long press");
+}
+
+void test_subscribers_full(void)
+{
+    for (uint32_t i = 0; i < FSM_BUTTON_SUBSCRIBERS; i++)
+    {
+        UNITY_TEST_ASSERT(fsm_button_subscribe(p_fsm, BUTTON_EVENT_CLICK, _record, &events_number), __LINE__, "A subscription failed with room left");
+    }
+    UNITY_TEST_ASSERT(!fsm_button_subscribe(p_fsm, BUTTON_EVENT_CLICK, _record, &events_number), __LINE__, "A subscription did not fail with no room left");
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+
+    RUN_TEST(test_click);
+    RUN_TEST(test_double_click);
+    RUN_TEST(test_long_press_with_repeat);
+    RUN_TEST(test_subscribers_full);
+
+    exit(UNITY_END());
+}
@@ -0,0 +1,52 @@
+#include <unity.h>
+#include "fsm_button.h"
+#include "port_system.h"
+#include "port_button.h"
+
+static fsm_t *p_fsm;
+
+void setUp(void)
+{
+    p_fsm = fsm_button_new(BUTTON_0_DEBOUNCE_TIME_MS, BUTTON_0_ID);
+    port_system_gpio_exti_disable(BUTTON_0_PIN); // Disable EXTI to avoid unwanted interrupts
+}
+
+void tearDown(void)
+{
+    buttons_arr[BUTTON_0_ID].flag_pressed = false;
+    fsm_destroy(p_fsm);
+}
+
+void test_next_ms(void)
+{
+    UNITY_TEST_ASSERT_EQUAL_UINT32(FSM_TIMED_NONE, fsm_button_get_next_ms(p_fsm), __LINE__, "The FSM released does not wait for an interrupt");
+
+    buttons_arr[BUTTON_0_ID].flag_pressed = true;
+    fsm_button_fire(p_fsm);
+    port_system_delay_ms(10);
+    fsm_button_fire(p_fsm);
+    UNITY_TEST_ASSERT_EQUAL_INT(BUTTON_PRESSED_WAIT, fsm_get_state(p_fsm), __LINE__, "The FSM did not wait for the debounce time after pressing the button");
+    uint32_t next_ms = fsm_button_get_next_ms(p_fsm);
+    UNITY_TEST_ASSERT((next_ms > 0) && (next_ms <= BUTTON_0_DEBOUNCE_TIME_MS - 10), __LINE__, "The time to sleep is not the time left to the end of the debounce");
+
+    port_system_delay_ms(next_ms);
+    fsm_button_fire(p_fsm);
+    UNITY_TEST_ASSERT_EQUAL_INT(BUTTON_PRESSED, fsm_get_state(p_fsm), __LINE__, "The FSM did not change to BUTTON_PRESSED after sleeping until the end of the debounce");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, fsm_button_get_next_ms(p_fsm), __LINE__, "The FSM pressed does not poll the level of the button");
+
+    buttons_arr[BUTTON_0_ID].flag_pressed = false;
+    fsm_button_fire(p_fsm);
+    port_system_delay_ms(fsm_button_get_next_ms(p_fsm));
+    fsm_button_fire(p_fsm);
+    UNITY_TEST_ASSERT_EQUAL_INT(BUTTON_RELEASED, fsm_get_state(p_fsm), __LINE__, "The FSM did not change to BUTTON_RELEASED after sleeping until the end of the debounce");
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+
+    RUN_TEST(test_next_ms);
+
+    exit(UNITY_END());
+}
@@ -0,0 +1,105 @@
+#include <string.h>
+#include <unity.h>
+#include "fsm_command.h"
+#include "fsm_buzzer.h"
+#include "port_buzzer.h"
+#include "port_system.h"
+
+#define KEYWORD_MAX_LENGTH 16 /*Longer than any keyword, with room for a char more*/
+
+/**
+ * @brief Keywords of the command table, written independently of its COMMAND_ENTRY() lines.
+ */
+static const char *const keywords[] = {"play", "pause", "stop", "speed", "melody", "status", "metrics", "latency"};
+
+static fsm_t *p_fsm_buzzer;
+static fsm_t *p_fsm_command;
+
+void setUp(void)
+{
+    p_fsm_buzzer = fsm_buzzer_new(BUZZER_0_ID);
+    p_fsm_command = fsm_command_new(NULL, p_fsm_buzzer);
+}
+
+void tearDown(void)
+{
+    fsm_destroy(p_fsm_command);
+    fsm_destroy(p_fsm_buzzer);
+}
+
+/**
+ * @brief Execute a frame with a single command and check if its keyword has been found in the table. Without a USART, the reply line is left in the reply buffer: an unknown keyword is replied with "? <keyword>", a known one with "<keyword> <result>".
+ */
+
+static bool _is_command(const char *p_keyword)
+{
+    uint32_t length = strlen(p_keyword);
+    fsm_command_execute(p_fsm_command, p_keyword, length);
+    const char *p_reply = ((fsm_command_t *)p_fsm_command)->reply;
+    return (memcmp(p_reply, p_keyword, length) == 0) && (p_reply[length] == ' ');
+}
+
+void test_every_keyword(void)
+{
+    for (uint32_t i = 0; i < sizeof(keywords) / sizeof(keywords[0]); i++)
+    {
+        UNITY_TEST_ASSERT(_is_command(keywords[i]), __LINE__, "ERROR: a keyword of the command table is not found: check its first and last chars in COMMAND_ENTRY()");
+    }
+}
+
+void test_near_misses(void)
+{
+    for (uint32_t i = 0; i < sizeof(keywords) / sizeof(keywords[0]); i++)
+    {
+        char miss[KEYWORD_MAX_LENGTH];
+        uint32_t length = strlen(keywords[i]);
+
+        /* Same length, first and last chars: the same slot of the table */
+        strcpy(miss, keywords[i]);
+        miss[1] = (miss[1] == 'x') ? 'y' : 'x';
+        UNITY_TEST_ASSERT(!_is_command(miss), __LINE__, "ERROR: a keyword with the same hash has been accepted");
+
+        strcpy(miss, keywords[i]);
+        miss[0]++;
+        UNITY_TEST_ASSERT(!_is_command(miss), __LINE__, "ERROR: a keyword with another first char has been accepted");
+
+        strcpy(miss, keywords[i]);
+        miss[length - 1]++;
+        UNITY_TEST_ASSERT(!_is_command(miss), __LINE__, "ERROR: a keyword with another last char has been accepted");
+
+        strcpy(miss, keywords[i]);
+        miss[0] -= 'a' - 'A';
+        UNITY_TEST_ASSERT(!_is_command(miss), __LINE__, "ERROR: a keyword in upper case has been accepted");
+
+        strcpy(miss, keywords[i]);
+        miss[length - 1] = '\0';
+        UNITY_TEST_ASSERT(!_is_command(miss), __LINE__, "ERROR: a truncated keyword has been accepted");
+
+        strcpy(miss, keywords[i]);
+        miss[length] = miss[length - 1];
+        miss[length + 1] = '\0';
+        UNITY_TEST_ASSERT(!_is_command(miss), __LINE__, "ERROR: a keyword with a char more has been accepted");
+    }
+    UNITY_TEST_ASSERT(!_is_command("x"), __LINE__, "ERROR: a one-char keyword has been accepted");
+}
+
+void test_stats(void)
+{
+    fsm_command_stats_t stats;
+    fsm_command_execute(p_fsm_command, "play;plby;stop", 14);
+    fsm_command_get_stats(p_fsm_command, &stats);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(2, stats.commands, __LINE__, "ERROR: the commands of the frame have not been executed");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, stats.errors, __LINE__, "ERROR: the unknown command has not been counted as an error");
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+
+    RUN_TEST(test_every_keyword);
+    RUN_TEST(test_near_misses);
+    RUN_TEST(test_stats);
+
+    exit(UNITY_END());
+}
@@ -0,0 +1,206 @@
+#include <unity.h>
+#include "port_system.h"
+#include "fsm_timed.h"
+
+#define TIMEOUT_WAIT 0 /*Index of the timeout of the WAIT state*/
+#define TIMEOUT_TICK 1 /*Index of the period of the TICK state*/
+#define WAIT_MS 50 /*Time in WAIT*/
+#define TICK_MS 20 /*Period of the transition of TICK to itself*/
+
+enum
+{
+    WAIT = 0, /*Only an AFTER() transition*/
+    TICK, /*An AFTER() transition to itself and an input function*/
+};
+
+typedef struct
+{
+    fsm_timed_t timed; /*FSM with timed transitions*/
+    bool leave; /*Input of the transition from TICK to WAIT*/
+    uint32_t checks; /*Calls to the input function*/
+    uint32_t ticks; /*Transitions from TICK to itself*/
+    uint32_t backdate_ms; /*Time the entry in TICK is recorded before the transition*/
+} test_fsm_t;
+
+static test_fsm_t fsm;
+
+static bool check_leave(fsm_t *p_fsm)
+{
+    test_fsm_t *p_test = (test_fsm_t *)p_fsm;
+    p_test->checks++;
+    return p_test->leave;
+}
+
+static void do_tick(fsm_t *p_fsm)
+{
+    ((test_fsm_t *)p_fsm)->ticks++;
+}
+
+static void do_enter_tick(fsm_t *p_fsm)
+{
+    test_fsm_t *p_test = (test_fsm_t *)p_fsm;
+    if (p_test->backdate_ms > 0)
+    {
+        fsm_timed_enter(&p_test->timed, port_system_get_millis() - p_test->backdate_ms);
+    }
+}
+
+static fsm_trans_t fsm_tt[] = {
+    {WAIT, AFTER(TIMEOUT_WAIT), TICK, do_enter_tick},
+    {TICK, check_leave, WAIT, NULL},
+    {TICK, AFTER(TIMEOUT_TICK), TICK, do_tick},
+    {-1, NULL, -1, NULL},
+};
+
+void setUp(void)
+{
+    port_system_set_millis(1000);
+    fsm.leave = false;
+    fsm.checks = 0;
+    fsm.ticks = 0;
+    fsm.backdate_ms = 0;
+    fsm_timed_init(&fsm.timed, fsm_tt);
+    fsm_timed_set_timeout(&fsm.timed, TIMEOUT_WAIT, WAIT_MS);
+    fsm_timed_set_timeout(&fsm.timed, TIMEOUT_TICK, TICK_MS);
+}
+
+void tearDown(void)
+{
+    port_system_set_millis(0);
+}
+
+/**
+ * @brief Set the system tick and fire the FSM with fsm_fire(), as the FSMs that do not know about the timed transitions are fired.
+ */
+
+static int _fire_at(uint32_t ms)
+{
+    port_system_set_millis(ms);
+    return fsm_fire(&fsm.timed.f);
+}
+
+/**
+ * @brief Set the system tick and fire the FSM with fsm_timed_fire().
+ */
+
+static int _timed_fire_at(uint32_t ms)
+{
+    port_system_set_millis(ms);
+    return fsm_timed_fire(&fsm.timed);
+}
+
+void test_after(void)
+{
+    _fire_at(1000 + WAIT_MS - 1);
+    UNITY_TEST_ASSERT_EQUAL_INT(WAIT, fsm_get_state(&fsm.timed.f), __LINE__, "ERROR: the AFTER() transition has fired before its timeout");
+    _fire_at(1000 + WAIT_MS);
+    UNITY_TEST_ASSERT_EQUAL_INT(TICK, fsm_get_state(&fsm.timed.f), __LINE__, "ERROR: the AFTER() transition has not fired at its timeout");
+
+    /* The transition to the same state restarts the time in the state, from the tick it fires at */
+    uint32_t entered = 1000 + WAIT_MS;
+    for (uint32_t ms = entered + 1; ms <= entered + 10 * TICK_MS; ms++)
+    {
+        _fire_at(ms);
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT32(10, fsm.ticks, __LINE__, "ERROR: the AFTER() transition to the same state has not fired every timeout");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(10 * TICK_MS, fsm.checks, __LINE__, "ERROR: the input function has not been checked at every fire");
+
+    fsm.leave = true;
+    _fire_at(entered + 10 * TICK_MS + 1);
+    UNITY_TEST_ASSERT_EQUAL_INT(WAIT, fsm_get_state(&fsm.timed.f), __LINE__, "ERROR: the input function has not fired its transition");
+    _fire_at(entered + 10 * TICK_MS + 2 + WAIT_MS - 1); // With fsm_fire(), the entry in WAIT is only seen at this check
+    UNITY_TEST_ASSERT_EQUAL_INT(WAIT, fsm_get_state(&fsm.timed.f), __LINE__, "ERROR: the time in the state has not restarted with the new state");
+}
+
+void test_timed_fire(void)
+{
+    UNITY_TEST_ASSERT(fsm.timed.timed_only, __LINE__, "ERROR: a state with AFTER() transitions only is not taken as timed");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(WAIT_MS, fsm_timed_get_next_ms(&fsm.timed), __LINE__, "ERROR: the deadline is not the timeout of the state");
+    UNITY_TEST_ASSERT_EQUAL_INT(0, _timed_fire_at(1000 + WAIT_MS - 1), __LINE__, "ERROR: a transition has fired before the deadline");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, fsm_timed_get_next_ms(&fsm.timed), __LINE__, "ERROR: the time to the deadline is wrong");
+    UNITY_TEST_ASSERT_EQUAL_INT(1, _timed_fire_at(1000 + WAIT_MS), __LINE__, "ERROR: the AFTER() transition has not fired at the deadline");
+
+    /* In TICK the input function is checked at every fire */
+    UNITY_TEST_ASSERT(!fsm.timed.timed_only, __LINE__, "ERROR: a state with an input function is taken as timed only");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(TICK_MS, fsm_timed_get_next_ms(&fsm.timed), __LINE__, "ERROR: the deadline has not been computed at the entry in the state");
+    _timed_fire_at(1000 + WAIT_MS + 1);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, fsm.checks, __LINE__, "ERROR: the input function has not been checked");
+
+    /* A transition fired by an input function enters the state at the fire */
+    fsm.leave = true;
+    _timed_fire_at(1000 + WAIT_MS + 2);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(WAIT_MS, fsm_timed_get_next_ms(&fsm.timed), __LINE__, "ERROR: the state has not been entered at the fire");
+}
+
+void test_enter(void)
+{
+    fsm.backdate_ms = 5;
+    _fire_at(1000 + WAIT_MS);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(TICK_MS - 5, fsm_timed_get_next_ms(&fsm.timed), __LINE__, "ERROR: the entry recorded by the output function has not been taken");
+    _fire_at(1000 + WAIT_MS + TICK_MS - 6);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, fsm.ticks, __LINE__, "ERROR: the AFTER() transition has fired before its timeout from the entry recorded");
+    _fire_at(1000 + WAIT_MS + TICK_MS - 5);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, fsm.ticks, __LINE__, "ERROR: the AFTER() transition has not fired at its timeout from the entry recorded");
+}
+
+void test_set_timeout(void)
+{
+    _fire_at(1010);
+    fsm_timed_set_timeout(&fsm.timed, TIMEOUT_WAIT, 100);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(90, fsm_timed_get_next_ms(&fsm.timed), __LINE__, "ERROR: the deadline has not been computed again from the entry in the state");
+    _fire_at(1099);
+    UNITY_TEST_ASSERT_EQUAL_INT(WAIT, fsm_get_state(&fsm.timed.f), __LINE__, "ERROR: the AFTER() transition has fired before its new timeout");
+    _fire_at(1100);
+    UNITY_TEST_ASSERT_EQUAL_INT(TICK, fsm_get_state(&fsm.timed.f), __LINE__, "ERROR: the AFTER() transition has not fired at its new timeout");
+}
+
+void test_across_wrap(void)
+{
+    port_system_set_millis(UINT32_MAX - 10);
+    fsm_timed_init(&fsm.timed, fsm_tt);
+    fsm_timed_set_timeout(&fsm.timed, TIMEOUT_WAIT, WAIT_MS);
+    UNITY_TEST_ASSERT_EQUAL_INT(0, _timed_fire_at(WAIT_MS - 12), __LINE__, "ERROR: the AFTER() transition has fired before its timeout across the wrap");
+    UNITY_TEST_ASSERT_EQUAL_INT(1, _timed_fire_at(WAIT_MS - 11), __LINE__, "ERROR: the AFTER() transition has not fired at its timeout across the wrap");
+}
+
+void test_next_ms_all(void)
+{
+    static test_fsm_t other;
+    static fsm_trans_t other_tt[] = {
+        {TICK, check_leave, WAIT, NULL},
+        {-1, NULL, -1, NULL},
+    };
+    other.leave = false;
+    fsm_timed_init(&other.timed, other_tt);
+    fsm_timed_t *fsms[] = {&fsm.timed, &other.timed};
+    UNITY_TEST_ASSERT_EQUAL_UINT32(FSM_TIMED_NONE, fsm_timed_get_next_ms(&other.timed), __LINE__, "ERROR: a state with no AFTER() transition has a deadline");
+    port_system_set_millis(1020);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(WAIT_MS - 20, fsm_timed_get_next_ms_all(fsms, 2), __LINE__, "ERROR: the first deadline of the FSMs is wrong");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(FSM_TIMED_NONE, fsm_timed_get_next_ms_all(&fsms[1], 1), __LINE__, "ERROR: FSMs with no AFTER() transition have a deadline");
+}
+
+void test_remaining_ms(void)
+{
+    port_system_set_millis(1005);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(WAIT_MS - 5, fsm_timed_get_remaining_ms(&fsm.timed, TIMEOUT_WAIT), __LINE__, "ERROR: the time left to a timeout is not counted from the entry in the state");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(TICK_MS - 5, fsm_timed_get_remaining_ms(&fsm.timed, TIMEOUT_TICK), __LINE__, "ERROR: the time left to a timeout of another state is wrong");
+    port_system_set_millis(1000 + TICK_MS + 1);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, fsm_timed_get_remaining_ms(&fsm.timed, TIMEOUT_TICK), __LINE__, "ERROR: a timeout already reached has time left");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(FSM_TIMED_NONE, fsm_timed_get_remaining_ms(&fsm.timed, FSM_TIMED_TIMEOUTS), __LINE__, "ERROR: an invalid timeout has time left");
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+
+    RUN_TEST(test_after);
+    RUN_TEST(test_timed_fire);
+    RUN_TEST(test_enter);
+    RUN_TEST(test_set_timeout);
+    RUN_TEST(test_across_wrap);
+    RUN_TEST(test_next_ms_all);
+    RUN_TEST(test_remaining_ms);
+
+    exit(UNITY_END());
+}
@@ -0,0 +1,97 @@
+#include <unity.h>
+#include "gpio_bsrr.h"
+#include "port_system.h"
+
+/**
+ * @brief Model of the output registers of a GPIO port.
+ */
+typedef struct {
+    uint32_t odr; /*Output data register*/
+    uint32_t stores; /*Stores done to the registers*/
+} gpio_model_t;
+
+static gpio_model_t port;
+
+void setUp(void)
+{
+    port.odr = 0;
+    port.stores = 0;
+}
+
+void tearDown(void)
+{
+}
+
+/**
+ * @brief Store to BSRR: the reset half is applied first, so the set half wins if a pin is in both.
+ */
+
+void _bsrr_store(gpio_model_t *p_port, uint32_t bsrr)
+{
+    p_port->odr &= ~(bsrr >> GPIO_BSRR_RESET_POS);
+    p_port->odr |= bsrr & 0xFFFF;
+    p_port->stores++;
+}
+
+/**
+ * @brief Store to ODR.
+ */
+
+void _odr_store(gpio_model_t *p_port, uint32_t odr)
+{
+    p_port->odr = odr & 0xFFFF;
+    p_port->stores++;
+}
+
+void test_write(void)
+{
+    port.odr = 0x00F0;
+    _bsrr_store(&port, GPIO_BSRR_WRITE(0x0003, 0x0030));
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0x00C3, port.odr, __LINE__, "ERROR: the pins have not been set and reset as requested");
+    _bsrr_store(&port, GPIO_BSRR_WRITE(0x0100, 0x0100));
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0x01C3, port.odr, __LINE__, "ERROR: a pin in both masks has not been set");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0x0000FFFF, GPIO_BSRR_WRITE(0xFFFFFFFF, 0), __LINE__, "ERROR: the set mask overflows into the reset half");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(2, port.stores, __LINE__, "ERROR: each batch write must be a single store");
+}
+
+void test_toggle(void)
+{
+    port.odr = 0xA5A5;
+    _bsrr_store(&port, GPIO_BSRR_TOGGLE(port.odr, 0x00FF));
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0xA55A, port.odr, __LINE__, "ERROR: the pins have not been toggled");
+    _bsrr_store(&port, GPIO_BSRR_TOGGLE(port.odr, 0x00FF));
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0xA5A5, port.odr, __LINE__, "ERROR: two toggles do not restore the pins");
+    _bsrr_store(&port, GPIO_BSRR_TOGGLE(port.odr, 0));
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0xA5A5, port.odr, __LINE__, "ERROR: an empty toggle has changed the port");
+}
+
+void test_isr_between_read_and_store(void)
+{
+    const uint32_t led = 1U << 5;
+    const uint32_t isr_pin = 1U << 6;
+
+    /* Single BSRR store: the change of the ISR survives */
+    uint32_t bsrr = GPIO_BSRR_TOGGLE(port.odr, led);
+    _bsrr_store(&port, GPIO_BSRR_WRITE(isr_pin, 0)); // Preempted by an ISR that sets another pin of the port
+    _bsrr_store(&port, bsrr);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(led | isr_pin, port.odr, __LINE__, "ERROR: the toggle has undone the change of the ISR");
+
+    /* Read-modify-write of ODR: the change of the ISR is lost */
+    setUp();
+    uint32_t odr = port.odr ^ led;
+    _bsrr_store(&port, GPIO_BSRR_WRITE(isr_pin, 0));
+    _odr_store(&port, odr);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(led, port.odr, __LINE__, "ERROR: the model does not show the race of the read-modify-write");
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+
+    RUN_TEST(test_write);
+    RUN_TEST(test_toggle);
+    RUN_TEST(test_isr_between_read_and_store);
+
+    exit(UNITY_END());
+}
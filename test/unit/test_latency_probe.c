@@ -0,0 +1,112 @@
+#include <string.h>
+#include <unity.h>
+#include "latency_probe.h"
+#include "port_system.h"
+
+static uint8_t snapshot[LATENCY_PROBE_SNAPSHOT_LENGTH];
+
+void setUp(void)
+{
+    latency_probe_init();
+}
+
+void tearDown(void)
+{
+}
+
+/**
+ * @brief Read a little-endian word of the snapshot.
+ */
+
+uint32_t _word(uint32_t offset)
+{
+    return snapshot[offset] | (snapshot[offset + 1] << 8) | (snapshot[offset + 2] << 16) | ((uint32_t)snapshot[offset + 3] << 24);
+}
+
+/**
+ * @brief Read a bucket of the snapshot.
+ */
+
+uint32_t _bucket(uint32_t bucket)
+{
+    return _word(2 + 4 * (3 + bucket));
+}
+
+void test_log_buckets(void)
+{
+    const uint32_t min = 1U << LATENCY_PROBE_MIN_LOG2;
+    latency_probe_observe(LATENCY_PROBE_LED, 0);
+    latency_probe_observe(LATENCY_PROBE_LED, min - 1);
+    latency_probe_observe(LATENCY_PROBE_LED, min);
+    latency_probe_observe(LATENCY_PROBE_LED, 2 * min - 1);
+    latency_probe_observe(LATENCY_PROBE_LED, 2 * min);
+    latency_probe_observe(LATENCY_PROBE_LED, UINT32_MAX);
+
+    UNITY_TEST_ASSERT_EQUAL_UINT32(LATENCY_PROBE_SNAPSHOT_LENGTH, latency_probe_snapshot(LATENCY_PROBE_LED, snapshot, sizeof(snapshot)), __LINE__, "ERROR: the snapshot has not the expected length");
+    UNITY_TEST_ASSERT_EQUAL_UINT8(LATENCY_PROBE_FRAME_TYPE, snapshot[0], __LINE__, "ERROR: the snapshot does not start with its frame type");
+    UNITY_TEST_ASSERT_EQUAL_UINT8(LATENCY_PROBE_LED, snapshot[1], __LINE__, "ERROR: the snapshot is not of the probe requested");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(6, _word(2), __LINE__, "ERROR: the number of latencies is wrong");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, _word(6), __LINE__, "ERROR: the minimum latency is wrong");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, _word(10), __LINE__, "ERROR: the maximum latency is wrong");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(2, _bucket(0), __LINE__, "ERROR: the latencies lower than the first bound are not in the first bucket");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(2, _bucket(1), __LINE__, "ERROR: the latencies of the second octave are not in the second bucket");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, _bucket(2), __LINE__, "ERROR: the latencies of the third octave are not in the third bucket");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, _bucket(LATENCY_PROBE_BUCKETS - 1), __LINE__, "ERROR: the greatest latencies are not in the last bucket");
+
+    latency_probe_snapshot(LATENCY_PROBE_BUZZER, snapshot, sizeof(snapshot));
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, _word(2), __LINE__, "ERROR: the latencies of a probe have been recorded in another one");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, _word(6), __LINE__, "ERROR: the minimum latency of an empty probe is not 0");
+}
+
+void test_edge_to_action(void)
+{
+    const uint32_t delay_ms = 5;
+    latency_probe_action(LATENCY_PROBE_LED); // Not armed: nothing is recorded
+    latency_probe_edge(port_system_get_millis(), port_system_get_cycles());
+    port_system_delay_ms(delay_ms);
+    latency_probe_action(LATENCY_PROBE_LED);
+    latency_probe_action(LATENCY_PROBE_LED); // Disarmed by the previous action: nothing is recorded
+
+    latency_probe_snapshot(LATENCY_PROBE_LED, snapshot, sizeof(snapshot));
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, _word(2), __LINE__, "ERROR: the probe has not recorded exactly the action that followed the edge");
+    UNITY_TEST_ASSERT(_word(6) >= delay_ms * 1000, __LINE__, "ERROR: the latency is shorter than the time between the edge and the action");
+    UNITY_TEST_ASSERT(_word(6) < LATENCY_PROBE_WINDOW_MS * 1000, __LINE__, "ERROR: the latency is longer than the window of the probe");
+
+    /* The other probes stay armed by the same edge until their own action */
+    latency_probe_action(LATENCY_PROBE_BUZZER);
+    latency_probe_snapshot(LATENCY_PROBE_BUZZER, snapshot, sizeof(snapshot));
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, _word(2), __LINE__, "ERROR: an edge did not arm all the probes");
+}
+
+void test_stale_edge(void)
+{
+    /* An edge older than the window does not cause the action */
+    latency_probe_edge(port_system_get_millis() - LATENCY_PROBE_WINDOW_MS - 1, port_system_get_cycles());
+    latency_probe_action(LATENCY_PROBE_LED);
+    latency_probe_snapshot(LATENCY_PROBE_LED, snapshot, sizeof(snapshot));
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, _word(2), __LINE__, "ERROR: an action has been recorded for a stale edge");
+}
+
+void test_lookup(void)
+{
+    UNITY_TEST_ASSERT_EQUAL_INT32(LATENCY_PROBE_LED, latency_probe_lookup("led", 3), __LINE__, "ERROR: a probe is not found by its name");
+    UNITY_TEST_ASSERT_EQUAL_INT32(LATENCY_PROBE_BUZZER, latency_probe_lookup("Buzzer", 6), __LINE__, "ERROR: the names of the probes are case sensitive");
+    UNITY_TEST_ASSERT_EQUAL_INT32(LATENCY_PROBE_BUZZER, latency_probe_lookup("1", 1), __LINE__, "ERROR: a probe is not found by its index");
+    UNITY_TEST_ASSERT_EQUAL_INT32(-1, latency_probe_lookup("le", 2), __LINE__, "ERROR: a prefix of a name has been taken as the name");
+    UNITY_TEST_ASSERT_EQUAL_INT32(-1, latency_probe_lookup("9", 1), __LINE__, "ERROR: an index out of range has been accepted");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, latency_probe_snapshot(LATENCY_PROBES_NUMBER, snapshot, sizeof(snapshot)), __LINE__, "ERROR: a snapshot of a probe out of range has been written");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, latency_probe_snapshot(LATENCY_PROBE_LED, snapshot, sizeof(snapshot) - 1), __LINE__, "ERROR: a snapshot has been written in a buffer too small");
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+
+    RUN_TEST(test_log_buckets);
+    RUN_TEST(test_edge_to_action);
+    RUN_TEST(test_stale_edge);
+    RUN_TEST(test_lookup);
+
+    exit(UNITY_END());
+}
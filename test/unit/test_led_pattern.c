@@ -0,0 +1,124 @@
+#include <unity.h>
+#include <string.h>
+#include "led_pattern.h"
+#include "port_system.h"
+
+#define TABLE_LENGTH 32 /*Length of the tables of the tests*/
+
+static uint16_t table[TABLE_LENGTH];
+
+void setUp(void)
+{
+    memset(table, 0xFF, sizeof(table));
+}
+
+void tearDown(void)
+{
+}
+
+void test_gamma(void)
+{
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, led_pattern_gamma(0), __LINE__, "ERROR: zero brightness is not off");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(LED_PATTERN_DUTY_MAX, led_pattern_gamma(LED_PATTERN_DUTY_MAX), __LINE__, "ERROR: full brightness is not fully on");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(LED_PATTERN_DUTY_MAX / 4, led_pattern_gamma(LED_PATTERN_DUTY_MAX / 2), __LINE__, "ERROR: half brightness is not a quarter of the duty cycle");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(LED_PATTERN_DUTY_MAX, led_pattern_gamma(2 * LED_PATTERN_DUTY_MAX), __LINE__, "ERROR: the brightness is not saturated");
+}
+
+void test_breathe(void)
+{
+    UNITY_TEST_ASSERT_EQUAL_UINT32(TABLE_LENGTH, led_pattern_breathe(table, TABLE_LENGTH), __LINE__, "ERROR: the breath has not filled the table");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, table[0], __LINE__, "ERROR: the breath does not start off");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(LED_PATTERN_DUTY_MAX, table[TABLE_LENGTH / 2], __LINE__, "ERROR: the breath does not reach full brightness at the middle");
+    for (uint32_t i = 1; i < TABLE_LENGTH; i++)
+    {
+        UNITY_TEST_ASSERT_EQUAL_UINT32(table[i], table[TABLE_LENGTH - i], __LINE__, "ERROR: the breath is not symmetric");
+        if (i <= TABLE_LENGTH / 2)
+        {
+            UNITY_TEST_ASSERT(table[i] > table[i - 1], __LINE__, "ERROR: the breath does not rise until the middle");
+        }
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, led_pattern_breathe(table, 1), __LINE__, "ERROR: a breath has been filled in a table too short");
+}
+
+void test_heartbeat(void)
+{
+    UNITY_TEST_ASSERT_EQUAL_UINT32(TABLE_LENGTH, led_pattern_heartbeat(table, TABLE_LENGTH), __LINE__, "ERROR: the heartbeat has not filled the table");
+    uint32_t beats = 0;
+    for (uint32_t i = 0; i < TABLE_LENGTH; i++)
+    {
+        UNITY_TEST_ASSERT(table[i] <= LED_PATTERN_DUTY_MAX, __LINE__, "ERROR: a duty cycle of the heartbeat is out of range");
+        beats += ((i == 0) || (table[i] > table[i - 1])) ? 1 : 0;
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT32(2, beats, __LINE__, "ERROR: the heartbeat does not have two beats");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, table[TABLE_LENGTH - 1], __LINE__, "ERROR: the heartbeat does not end with a rest");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, led_pattern_heartbeat(table, LED_PATTERN_HEARTBEAT_MIN_LENGTH - 1), __LINE__, "ERROR: a heartbeat has been filled in a table too short");
+}
+
+void test_blinks(void)
+{
+    UNITY_TEST_ASSERT_EQUAL_UINT32(15, led_pattern_blinks(table, TABLE_LENGTH, 3, 2, 3), __LINE__, "ERROR: the blinks have not filled the steps expected");
+    uint32_t blinks = 0;
+    for (uint32_t i = 0; i < 15; i++)
+    {
+        blinks += ((table[i] == LED_PATTERN_DUTY_MAX) && ((i == 0) || (table[i - 1] == 0))) ? 1 : 0;
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT32(3, blinks, __LINE__, "ERROR: the table does not have 3 blinks");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, table[14], __LINE__, "ERROR: the blinks do not end with the LED off");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0xFFFF, table[15], __LINE__, "ERROR: the blinks have written past their steps");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, led_pattern_blinks(table, TABLE_LENGTH, 7, 2, 3), __LINE__, "ERROR: blinks have been filled in a table too short");
+}
+
+void test_level(void)
+{
+    led_pattern_level(table, 1, 5, 10);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(led_pattern_gamma(LED_PATTERN_DUTY_MAX / 2), table[0], __LINE__, "ERROR: the level is not shown at its brightness");
+    led_pattern_level(table, 1, 20, 10);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(LED_PATTERN_DUTY_MAX, table[0], __LINE__, "ERROR: the level is not saturated");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0xFFFF, table[1], __LINE__, "ERROR: the level has written past the table");
+}
+
+void test_sample(void)
+{
+    led_pattern_blinks(table, TABLE_LENGTH, 2, 1, 1);
+    led_pattern_t pattern = {table, 4, 10, true};
+    UNITY_TEST_ASSERT(led_pattern_is_valid(&pattern), __LINE__, "ERROR: the pattern is not valid");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(LED_PATTERN_DUTY_MAX, led_pattern_sample(&pattern, 9), __LINE__, "ERROR: the first step does not last step_ms");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, led_pattern_sample(&pattern, 10), __LINE__, "ERROR: the second step does not start after step_ms");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(LED_PATTERN_DUTY_MAX, led_pattern_sample(&pattern, 40), __LINE__, "ERROR: the looping pattern does not start again");
+    pattern.loop = false;
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, led_pattern_sample(&pattern, 40), __LINE__, "ERROR: the pattern does not keep its last step");
+
+    pattern.step_ms = LED_PATTERN_MAX_STEP_MS + 1;
+    UNITY_TEST_ASSERT(!led_pattern_is_valid(&pattern), __LINE__, "ERROR: a pattern with a step too long is valid");
+    pattern.step_ms = 10;
+    pattern.length = 0;
+    UNITY_TEST_ASSERT(!led_pattern_is_valid(&pattern), __LINE__, "ERROR: an empty pattern is valid");
+}
+
+void test_render_csv(void)
+{
+    char csv[128];
+    led_pattern_blinks(table, TABLE_LENGTH, 1, 1, 1);
+    led_pattern_t pattern = {table, 2, 10, true};
+    const char *p_expected = LED_PATTERN_CSV_HEADER "0,1000\n5,1000\n10,0\n15,0\n20,1000\n25,1000\n";
+    uint32_t length = led_pattern_render_csv(&pattern, 30, 5, csv, sizeof(csv));
+    UNITY_TEST_ASSERT_EQUAL_UINT32(strlen(p_expected), length, __LINE__, "ERROR: the length of the CSV is not the expected one");
+    UNITY_TEST_ASSERT_EQUAL_STRING(p_expected, csv, __LINE__, "ERROR: the CSV is not the expected one");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, led_pattern_render_csv(&pattern, 30, 5, csv, length), __LINE__, "ERROR: the CSV has been rendered in a buffer too small");
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+
+    RUN_TEST(test_gamma);
+    RUN_TEST(test_breathe);
+    RUN_TEST(test_heartbeat);
+    RUN_TEST(test_blinks);
+    RUN_TEST(test_level);
+    RUN_TEST(test_sample);
+    RUN_TEST(test_render_csv);
+
+    exit(UNITY_END());
+}
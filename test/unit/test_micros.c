@@ -0,0 +1,74 @@
+#include <unity.h>
+#include "deadline.h"
+#include "port_system.h"
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_micros_follow_millis(void)
+{
+    uint32_t start_us = port_system_get_micros();
+    uint32_t start_ms = port_system_get_millis();
+    port_system_delay_ms(20);
+    uint32_t elapsed_us = port_system_get_micros() - start_us;
+    uint32_t elapsed_ms = port_system_get_millis() - start_ms;
+    UNITY_TEST_ASSERT_UINT32_WITHIN(1000, elapsed_ms * 1000, elapsed_us, __LINE__, "ERROR: the microsecond count does not follow the millisecond count");
+}
+
+void test_micros_monotonic(void)
+{
+    uint32_t last = port_system_get_micros();
+    uint32_t changes = 0;
+    for (uint32_t i = 0; i < 100000 && changes < 100; i++)
+    {
+        uint32_t now = port_system_get_micros();
+        UNITY_TEST_ASSERT((int32_t)(now - last) >= 0, __LINE__, "ERROR: the microsecond count has gone backwards");
+        changes += (now != last) ? 1 : 0;
+        last = now;
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT32(100, changes, __LINE__, "ERROR: the microsecond count does not run");
+}
+
+void test_delay_us(void)
+{
+    const uint32_t delays_us[] = {10, 100, 500, 2500};
+    for (uint32_t i = 0; i < sizeof(delays_us) / sizeof(delays_us[0]); i++)
+    {
+        uint32_t shortest = UINT32_MAX;
+        for (uint32_t j = 0; j < 5; j++) // The shortest of several delays, since the native platform may be preempted by the host
+        {
+            uint32_t start = port_system_get_micros();
+            port_system_delay_us(delays_us[i]);
+            uint32_t elapsed = port_system_get_micros() - start;
+            UNITY_TEST_ASSERT(elapsed >= delays_us[i], __LINE__, "ERROR: the delay has been shorter than requested");
+            shortest = (elapsed < shortest) ? elapsed : shortest;
+        }
+        UNITY_TEST_ASSERT(shortest < delays_us[i] + 1000, __LINE__, "ERROR: the delay has been much longer than requested");
+    }
+}
+
+void test_micros_deadline(void)
+{
+    deadline_t deadline = deadline_after(port_system_get_micros(), 300);
+    UNITY_TEST_ASSERT(!deadline_reached(deadline, port_system_get_micros()), __LINE__, "ERROR: a deadline in microseconds has been reached at once");
+    port_system_delay_us(300);
+    UNITY_TEST_ASSERT(deadline_reached(deadline, port_system_get_micros()), __LINE__, "ERROR: a deadline in microseconds has not been reached after the delay");
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+
+    RUN_TEST(test_micros_follow_millis);
+    RUN_TEST(test_micros_monotonic);
+    RUN_TEST(test_delay_us);
+    RUN_TEST(test_micros_deadline);
+
+    exit(UNITY_END());
+}
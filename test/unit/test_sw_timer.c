@@ -0,0 +1,235 @@
+#include <unity.h>
+#include "port_system.h"
+#include "sw_timer.h"
+
+#define RANDOM_TIMERS 500 /*Timers of the random test*/
+#define RANDOM_MAX_MS 40000 /*Longest timeout of the random test*/
+
+static uint32_t fired; /*Times the counting callback has been called*/
+static uint32_t fired_at; /*System tick of the last call of the counting callback*/
+
+void setUp(void)
+{
+    fired = 0;
+    fired_at = 0;
+    sw_timer_init();
+}
+
+void tearDown(void)
+{
+    port_system_set_millis(0);
+}
+
+/**
+ * @brief Callback that counts its calls and records the system tick of the last one.
+ */
+
+static void _count(void *p_arg)
+{
+    fired++;
+    fired_at = port_system_get_millis();
+}
+
+/**
+ * @brief Set the system tick and process the wheel.
+ */
+
+static uint32_t _process_at(uint32_t ms)
+{
+    port_system_set_millis(ms);
+    return sw_timer_process();
+}
+
+/**
+ * @brief Check that a one-shot timer started at the tick start expires exactly timeout_ms later, moving the system tick straight to it.
+ */
+
+static void _check_expiry(uint32_t start, uint32_t timeout_ms)
+{
+    sw_timer_t timer;
+    sw_timer_setup(&timer, _count, NULL);
+    port_system_set_millis(start);
+    sw_timer_init();
+    fired = 0;
+    UNITY_TEST_ASSERT(sw_timer_start(&timer, timeout_ms, 0), __LINE__, "ERROR: the timer has not started");
+    _process_at(start + timeout_ms / 2);
+    _process_at(start + timeout_ms - 1);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, fired, __LINE__, "ERROR: the timer has expired before its timeout");
+    UNITY_TEST_ASSERT(sw_timer_is_running(&timer), __LINE__, "ERROR: the timer is not running before its timeout");
+    _process_at(start + timeout_ms);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, fired, __LINE__, "ERROR: the timer has not expired at its timeout");
+    UNITY_TEST_ASSERT(!sw_timer_is_running(&timer), __LINE__, "ERROR: a one-shot timer is running after it has expired");
+}
+
+void test_one_shot(void)
+{
+    const uint32_t timeouts_ms[] = {1, 31, 32, 33, 1000, 1024, 33000, 1048576, 5000000, SW_TIMER_MAX_MS};
+    for (uint32_t i = 0; i < sizeof(timeouts_ms) / sizeof(timeouts_ms[0]); i++)
+    {
+        _check_expiry(1000, timeouts_ms[i]);
+        _check_expiry(12345, timeouts_ms[i]);
+    }
+    sw_timer_t timer;
+    sw_timer_setup(&timer, _count, NULL);
+    UNITY_TEST_ASSERT(!sw_timer_start(&timer, SW_TIMER_MAX_MS + 1, 0), __LINE__, "ERROR: a timer with a timeout too long has started");
+}
+
+void test_zero_timeout(void)
+{
+    sw_timer_t timer;
+    sw_timer_setup(&timer, _count, NULL);
+    _process_at(500);
+    sw_timer_start(&timer, 0, 0);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, _process_at(500), __LINE__, "ERROR: a timer has expired at the tick processed already");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, _process_at(501), __LINE__, "ERROR: a timer of timeout 0 has not expired at the next tick");
+}
+
+void test_periodic(void)
+{
+    sw_timer_t timer;
+    sw_timer_setup(&timer, _count, NULL);
+    port_system_set_millis(0);
+    sw_timer_init();
+    sw_timer_start(&timer, 10, 25);
+    for (uint32_t ms = 1; ms <= 1010; ms++)
+    {
+        uint32_t before = fired;
+        _process_at(ms);
+        bool due = (ms >= 10) && ((ms - 10) % 25 == 0);
+        UNITY_TEST_ASSERT_EQUAL_UINT32(before + (due ? 1 : 0), fired, __LINE__, "ERROR: the periodic timer has not expired every period");
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT32(41, fired, __LINE__, "ERROR: the periodic timer has not expired the times expected");
+
+    UNITY_TEST_ASSERT_EQUAL_UINT32(4, _process_at(1110), __LINE__, "ERROR: the expiries missed by a late call have not been run");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1110, fired_at, __LINE__, "ERROR: the callbacks have not been called by the late call");
+    sw_timer_stop(&timer);
+    UNITY_TEST_ASSERT(!sw_timer_is_running(&timer), __LINE__, "ERROR: the timer is running after it has been stopped");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, _process_at(2000), __LINE__, "ERROR: a stopped timer has expired");
+}
+
+void test_stop_restart(void)
+{
+    sw_timer_t timers[3];
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        sw_timer_setup(&timers[i], _count, NULL);
+        sw_timer_start(&timers[i], 100, 0); // The three in the same slot
+    }
+    sw_timer_stop(&timers[1]); // Middle of the slot
+    sw_timer_stop(&timers[1]); // Already stopped
+    sw_timer_start(&timers[2], 300, 0); // Restart: moved to another slot
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, _process_at(100), __LINE__, "ERROR: the timers stopped or restarted have expired");
+    UNITY_TEST_ASSERT(sw_timer_is_running(&timers[2]), __LINE__, "ERROR: the restarted timer is not running");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, _process_at(299), __LINE__, "ERROR: the restarted timer has expired at its first timeout");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, _process_at(300), __LINE__, "ERROR: the restarted timer has not expired at its new timeout");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(SW_TIMER_NONE, sw_timer_get_next_ms(), __LINE__, "ERROR: there is an event in an empty wheel");
+}
+
+void test_across_wrap(void)
+{
+    port_system_set_millis(UINT32_MAX - 50);
+    sw_timer_init();
+    sw_timer_t timer;
+    sw_timer_setup(&timer, _count, NULL);
+    sw_timer_start(&timer, 100, 2000);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, _process_at(UINT32_MAX), __LINE__, "ERROR: the timer has expired before the wrap");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, _process_at(48), __LINE__, "ERROR: the timer has expired before its timeout across the wrap");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, _process_at(49), __LINE__, "ERROR: the timer has not expired at its timeout across the wrap");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, _process_at(2049), __LINE__, "ERROR: the periodic timer has not expired after the wrap");
+}
+
+void test_next_event(void)
+{
+    sw_timer_t timers[3];
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        sw_timer_setup(&timers[i], _count, NULL);
+    }
+    port_system_set_millis(0);
+    sw_timer_init();
+    sw_timer_start(&timers[0], 20, 0);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(20, sw_timer_get_next_ms(), __LINE__, "ERROR: the next event is not the expiry of the timer");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, sw_timer_get_hw_updates(), __LINE__, "ERROR: the wake-up timer has not been programmed");
+    sw_timer_start(&timers[1], 5000, 0);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, sw_timer_get_hw_updates(), __LINE__, "ERROR: the wake-up timer has been programmed for a later timer");
+    sw_timer_start(&timers[2], 7, 0);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(2, sw_timer_get_hw_updates(), __LINE__, "ERROR: the wake-up timer has not been programmed for a nearer timer");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(7, sw_timer_get_next_ms(), __LINE__, "ERROR: the next event is not the nearest expiry");
+
+    _process_at(7);
+    _process_at(20);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(2, fired, __LINE__, "ERROR: the timers have not expired");
+    uint32_t next = sw_timer_get_next_ms();
+    UNITY_TEST_ASSERT(next > 0 && next <= 5000 - 20, __LINE__, "ERROR: the next event is after the expiry of the last timer");
+    uint32_t wakeups = 0;
+    while (fired < 3 && wakeups < 20)
+    {
+        _process_at(port_system_get_millis() + sw_timer_get_next_ms()); // Sleep until the next event
+        wakeups++;
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT32(5000, fired_at, __LINE__, "ERROR: the timer has not expired at its timeout waking up at the events of the wheel");
+    UNITY_TEST_ASSERT(wakeups <= SW_TIMER_LEVELS, __LINE__, "ERROR: the wheel has needed a wake-up per slot to reach the timer");
+}
+
+void test_flag(void)
+{
+    volatile bool flag = false;
+    sw_timer_t timer;
+    sw_timer_setup(&timer, sw_timer_set_flag, (void *)&flag);
+    sw_timer_start(&timer, 50, 0);
+    _process_at(port_system_get_millis() + 49);
+    UNITY_TEST_ASSERT(!flag, __LINE__, "ERROR: the flag has been raised before the timeout");
+    _process_at(port_system_get_millis() + 1);
+    UNITY_TEST_ASSERT(flag, __LINE__, "ERROR: the flag has not been raised at the timeout");
+}
+
+void test_random(void)
+{
+    static sw_timer_t timers[RANDOM_TIMERS];
+    static uint32_t expiries[RANDOM_TIMERS];
+    uint32_t seed = 12345;
+    port_system_set_millis(1000);
+    sw_timer_init();
+    for (uint32_t i = 0; i < RANDOM_TIMERS; i++)
+    {
+        seed = seed * 1103515245U + 12345U;
+        uint32_t timeout_ms = (seed >> 8) % RANDOM_MAX_MS;
+        sw_timer_setup(&timers[i], _count, NULL);
+        sw_timer_start(&timers[i], timeout_ms, 0);
+        expiries[i] = 1000 + ((timeout_ms == 0) ? 1 : timeout_ms);
+    }
+    uint32_t ms = 1000;
+    uint32_t expired = 0;
+    while (ms < 1000 + RANDOM_MAX_MS + 1)
+    {
+        seed = seed * 1103515245U + 12345U;
+        uint32_t prev = ms;
+        ms += 1 + (seed >> 8) % 97; // Random steps, across slots and turns of the levels
+        uint32_t before = fired;
+        expired += _process_at(ms);
+        uint32_t expected = 0;
+        for (uint32_t i = 0; i < RANDOM_TIMERS; i++)
+        {
+            expected += (expiries[i] > prev && expiries[i] <= ms) ? 1 : 0;
+        }
+        UNITY_TEST_ASSERT_EQUAL_UINT32(expected, fired - before, __LINE__, "ERROR: the timers expired in a step are not the ones due");
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT32(RANDOM_TIMERS, expired, __LINE__, "ERROR: not all the timers have expired");
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+
+    RUN_TEST(test_one_shot);
+    RUN_TEST(test_zero_timeout);
+    RUN_TEST(test_periodic);
+    RUN_TEST(test_stop_restart);
+    RUN_TEST(test_across_wrap);
+    RUN_TEST(test_next_event);
+    RUN_TEST(test_flag);
+    RUN_TEST(test_random);
+
+    exit(UNITY_END());
+}
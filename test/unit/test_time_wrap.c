@@ -0,0 +1,151 @@
+#include <unity.h>
+#include "deadline.h"
+#include "fsm_blink.h"
+#include "fsm_button.h"
+#include "fsm_buzzer.h"
+#include "melodies.h"
+#include "port_button.h"
+#include "port_buzzer.h"
+#include "port_led.h"
+#include "port_system.h"
+
+#define WRAP_MS (1ULL << 32) /*System tick at which the 32-bit count wraps*/
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+    port_system_set_millis(0);
+}
+
+/**
+ * @brief Fire an FSM every millisecond for ms milliseconds.
+ */
+
+void _run_ms(fsm_t *p_fsm, uint32_t ms)
+{
+    uint32_t start = port_system_get_millis();
+    while (port_system_get_millis() - start < ms)
+    {
+        fsm_fire(p_fsm);
+        port_system_delay_ms(1);
+    }
+    fsm_fire(p_fsm);
+}
+
+void test_deadline(void)
+{
+    deadline_t deadline = deadline_after(UINT32_MAX - 10, 20);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(9, deadline, __LINE__, "ERROR: the deadline has not wrapped");
+    UNITY_TEST_ASSERT(!deadline_reached(deadline, UINT32_MAX - 5), __LINE__, "ERROR: a deadline after the wrap has been reached before it");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(15, deadline_remaining(deadline, UINT32_MAX - 5), __LINE__, "ERROR: the time left across the wrap is wrong");
+    UNITY_TEST_ASSERT(!deadline_reached(deadline, 8), __LINE__, "ERROR: the deadline has been reached before it");
+    UNITY_TEST_ASSERT(deadline_reached(deadline, 9), __LINE__, "ERROR: the deadline has not been reached at it");
+    UNITY_TEST_ASSERT(!deadline_passed(deadline, 9), __LINE__, "ERROR: the deadline has passed at it");
+    UNITY_TEST_ASSERT(deadline_passed(deadline, 10), __LINE__, "ERROR: the deadline has not passed after it");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, deadline_remaining(deadline, 10), __LINE__, "ERROR: there is time left after the deadline");
+
+    deadline = UINT32_MAX - 1;
+    UNITY_TEST_ASSERT(deadline_reached(deadline, 3), __LINE__, "ERROR: a deadline before the wrap is not reached after it");
+    UNITY_TEST_ASSERT(deadline_elapsed(UINT32_MAX - 1, 5, 3), __LINE__, "ERROR: the time elapsed across the wrap is wrong");
+    UNITY_TEST_ASSERT(!deadline_elapsed(UINT32_MAX - 1, 6, 3), __LINE__, "ERROR: the time elapsed across the wrap is wrong");
+}
+
+void test_millis64(void)
+{
+    port_system_set_millis(UINT32_MAX - 20);
+    port_system_delay_ms(40);
+    uint64_t millis64 = port_system_get_millis64();
+    uint32_t millis = port_system_get_millis();
+    UNITY_TEST_ASSERT(millis64 >= WRAP_MS + 19, __LINE__, "ERROR: the 64-bit count has wrapped or the delay has not waited across the wrap");
+    UNITY_TEST_ASSERT(millis64 < WRAP_MS + 40, __LINE__, "ERROR: the delay across the wrap has waited too long");
+    UNITY_TEST_ASSERT_EQUAL_UINT32((uint32_t)millis64, millis, __LINE__, "ERROR: the 32-bit count is not the lower half of the 64-bit one");
+
+    port_system_set_millis64(3 * WRAP_MS + 5);
+    UNITY_TEST_ASSERT((port_system_get_millis64() >> 32) == 3, __LINE__, "ERROR: the upper half of the 64-bit count has not been set");
+    UNITY_TEST_ASSERT(port_system_get_millis() < 10, __LINE__, "ERROR: the lower half of the 64-bit count has not been set");
+}
+
+void test_delay_until_across_wrap(void)
+{
+    port_system_set_millis(UINT32_MAX - 10);
+    uint32_t t = port_system_get_millis();
+    uint64_t start = port_system_get_millis64();
+    port_system_delay_until_ms(&t, 30);
+    UNITY_TEST_ASSERT_UINT32_WITHIN(2, 30, (uint32_t)(port_system_get_millis64() - start), __LINE__, "ERROR: the delay until a time after the wrap has not waited the right time");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(port_system_get_millis(), t, __LINE__, "ERROR: the time reference has not been updated");
+}
+
+void test_fsm_button_across_wrap(void)
+{
+    port_system_set_millis(UINT32_MAX - BUTTON_0_DEBOUNCE_TIME_MS / 2);
+    fsm_t *p_fsm = fsm_button_new(BUTTON_0_DEBOUNCE_TIME_MS, BUTTON_0_ID);
+    port_system_gpio_exti_disable(BUTTON_0_PIN); // Disable EXTI to avoid unwanted interrupts
+
+    /* The debounce time of the press ends after the wrap */
+    buttons_arr[BUTTON_0_ID].flag_pressed = true;
+    fsm_fire(p_fsm);
+    _run_ms(p_fsm, BUTTON_0_DEBOUNCE_TIME_MS - 20);
+    UNITY_TEST_ASSERT(port_system_get_millis() < BUTTON_0_DEBOUNCE_TIME_MS, __LINE__, "ERROR: the test has not crossed the wrap");
+    UNITY_TEST_ASSERT_EQUAL_INT(BUTTON_PRESSED_WAIT, p_fsm->current_state, __LINE__, "ERROR: the debounce time has ended before it across the wrap");
+    _run_ms(p_fsm, 100);
+    UNITY_TEST_ASSERT_EQUAL_INT(BUTTON_PRESSED, p_fsm->current_state, __LINE__, "ERROR: the debounce time has not ended across the wrap");
+
+    buttons_arr[BUTTON_0_ID].flag_pressed = false;
+    _run_ms(p_fsm, BUTTON_0_DEBOUNCE_TIME_MS + 20);
+    UNITY_TEST_ASSERT_EQUAL_INT(BUTTON_RELEASED, p_fsm->current_state, __LINE__, "ERROR: the button has not been released");
+    UNITY_TEST_ASSERT_UINT32_WITHIN(10, 2 * BUTTON_0_DEBOUNCE_TIME_MS - 20 + 100 - BUTTON_0_DEBOUNCE_TIME_MS, fsm_button_get_duration(p_fsm), __LINE__, "ERROR: the duration of a press across the wrap is wrong");
+    fsm_destroy(p_fsm);
+}
+
+void test_fsm_blink_across_wrap(void)
+{
+    port_system_set_millis(UINT32_MAX - 120);
+    fsm_t *p_fsm = fsm_blink_new(100);
+    port_led_blink_stop(); // Blink by software, to run check_timeout() of the FSM
+    ((fsm_blink_t *)p_fsm)->hw_blink = false;
+
+    uint32_t changes = 0;
+    bool on = port_led_get();
+    uint32_t start = port_system_get_millis();
+    while (port_system_get_millis() - start < 275)
+    {
+        fsm_fire(p_fsm);
+        port_system_delay_ms(1);
+        changes += (port_led_get() != on) ? 1 : 0;
+        on = port_led_get();
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT32(5, changes, __LINE__, "ERROR: the LED has not toggled every half period across the wrap");
+    fsm_destroy(p_fsm);
+}
+
+void test_fsm_buzzer_across_wrap(void)
+{
+    port_system_set_millis(UINT32_MAX - 120);
+    fsm_t *p_fsm = fsm_buzzer_new(BUZZER_0_ID);
+    fsm_buzzer_set_melody(p_fsm, &scale_melody);
+    fsm_buzzer_set_speed(p_fsm, 5.0); // Notes of 50 ms
+    fsm_buzzer_set_action(p_fsm, PLAY);
+    _run_ms(p_fsm, 275);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(6, ((fsm_buzzer_t *)p_fsm)->note_index, __LINE__, "ERROR: the player has not started a note every note duration across the wrap"); // Index of the next note
+    fsm_buzzer_set_action(p_fsm, STOP);
+    fsm_fire(p_fsm);
+    fsm_destroy(p_fsm);
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+
+    RUN_TEST(test_deadline);
+    RUN_TEST(test_millis64);
+    RUN_TEST(test_delay_until_across_wrap);
+    RUN_TEST(test_fsm_button_across_wrap);
+    RUN_TEST(test_fsm_blink_across_wrap);
+    RUN_TEST(test_fsm_buzzer_across_wrap);
+
+    exit(UNITY_END());
+}
@@ -0,0 +1,142 @@
+#include <unity.h>
+#include "usart_brr.h"
+#include "port_system.h"
+
+/**
+ * @brief Reference values of the baud rate register, from the tables "Error calculation for programmed baud rates" of the reference manual (RM0390, USART fractional baud rate generation). The error is the one listed in the tables, in hundredths of percent.
+ */
+typedef struct {
+    uint32_t pclk_hz; /*Frequency of the peripheral clock*/
+    uint32_t baudrate; /*Requested baud rate*/
+    uint16_t brr; /*Programmed value: mantissa and fraction of USARTDIV*/
+    bool over8; /*Oversampling by 8*/
+    int32_t error_cpct; /*Error of the achieved baud rate, in hundredths of percent*/
+} brr_reference_t;
+
+static const brr_reference_t references[] = {
+    {8000000, 1200, 0x1A0B, false, 0}, // USARTDIV 416.6875
+    {8000000, 9600, 0x341, false, 4}, // 52.0625
+    {8000000, 19200, 0x1A1, false, -8}, // 26.0625
+    {8000000, 57600, 0x8B, false, -8}, // 8.6875
+    {8000000, 115200, 0x45, false, 64}, // 4.3125
+    {8000000, 230400, 0x23, false, -79}, // 2.1875
+    {8000000, 460800, 0x11, false, 212}, // 1.0625
+    {8000000, 921600, 0x11, true, -355}, // 1.125
+    {8000000, 1000000, 0x10, true, 0}, // 1
+    {16000000, 1200, 0x3415, false, 0}, // 833.3125
+    {16000000, 9600, 0x683, false, -2}, // 104.1875
+    {16000000, 19200, 0x341, false, 4}, // 52.0625
+    {16000000, 57600, 0x116, false, -8}, // 17.375
+    {16000000, 115200, 0x8B, false, -8}, // 8.6875
+    {16000000, 230400, 0x45, false, 64}, // 4.3125
+    {16000000, 460800, 0x23, false, -79}, // 2.1875
+    {16000000, 921600, 0x11, false, 212}, // 1.0625
+    {42000000, 1200, 0x88B8, false, 0}, // 2187.5
+    {42000000, 9600, 0x1117, false, 0}, // 273.4375
+    {42000000, 19200, 0x88C, false, -2}, // 136.75
+    {42000000, 57600, 0x2D9, false, 2}, // 45.5625
+    {42000000, 115200, 0x16D, false, -11}, // 22.8125
+    {42000000, 230400, 0xB6, false, 16}, // 11.375
+    {42000000, 460800, 0x5B, false, 16}, // 5.6875
+    {42000000, 921600, 0x2E, false, -93}, // 2.875
+    {84000000, 9600, 0x222E, false, 0}, // 546.875
+    {84000000, 19200, 0x1117, false, 0}, // 273.4375
+    {84000000, 57600, 0x5B2, false, 2}, // 91.125
+    {84000000, 115200, 0x2D9, false, 2}, // 45.5625
+    {84000000, 230400, 0x16D, false, -11}, // 22.8125
+    {84000000, 460800, 0xB6, false, 16}, // 11.375
+    {84000000, 921600, 0x5B, false, 16}, // 5.6875
+};
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_known_values(void)
+{
+    usart_brr_t brr;
+
+    // 16 MHz / 9600 bps = 1666.67 -> 1667 (0x683), oversampling by 16
+    UNITY_TEST_ASSERT(usart_brr_compute(16000000, 9600, &brr), __LINE__, "ERROR: 9600 bps at 16 MHz must be achievable");
+    UNITY_TEST_ASSERT_EQUAL_UINT16(0x683, brr.brr, __LINE__, "ERROR: wrong BRR for 9600 bps at 16 MHz");
+    UNITY_TEST_ASSERT(!brr.over8, __LINE__, "ERROR: 9600 bps at 16 MHz must use oversampling by 16");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(9598, brr.actual_baudrate, __LINE__, "ERROR: wrong achieved baud rate for 9600 bps at 16 MHz");
+
+    // 84 MHz / 115200 bps = 729.17 -> 729 (0x2D9)
+    UNITY_TEST_ASSERT(usart_brr_compute(84000000, 115200, &brr), __LINE__, "ERROR: 115200 bps at 84 MHz must be achievable");
+    UNITY_TEST_ASSERT_EQUAL_UINT16(0x2D9, brr.brr, __LINE__, "ERROR: wrong BRR for 115200 bps at 84 MHz");
+
+    // 16 MHz / 1 Mbps = 16: the lowest divider with oversampling by 16
+    UNITY_TEST_ASSERT(usart_brr_compute(16000000, 1000000, &brr), __LINE__, "ERROR: 1 Mbps at 16 MHz must be achievable");
+    UNITY_TEST_ASSERT(!brr.over8, __LINE__, "ERROR: 1 Mbps at 16 MHz must use oversampling by 16");
+    UNITY_TEST_ASSERT_EQUAL_UINT16(0x10, brr.brr, __LINE__, "ERROR: wrong BRR for 1 Mbps at 16 MHz");
+
+    // 8 MHz / 1 Mbps = 8: only possible with oversampling by 8 (mantissa 1, fraction 0)
+    UNITY_TEST_ASSERT(usart_brr_compute(8000000, 1000000, &brr), __LINE__, "ERROR: 1 Mbps at 8 MHz must be achievable");
+    UNITY_TEST_ASSERT(brr.over8, __LINE__, "ERROR: 1 Mbps at 8 MHz must use oversampling by 8");
+    UNITY_TEST_ASSERT_EQUAL_UINT16(0x10, brr.brr, __LINE__, "ERROR: wrong BRR for 1 Mbps at 8 MHz");
+    UNITY_TEST_ASSERT_EQUAL_INT32(0, brr.error_ppm, __LINE__, "ERROR: 1 Mbps at 8 MHz must be exact");
+
+    // 8 MHz / 921600 bps = 8.68 -> 9: oversampling by 8, fraction 1
+    UNITY_TEST_ASSERT(usart_brr_compute(8000000, 921600, &brr) == false, __LINE__, "ERROR: 921600 bps at 8 MHz has a 3.5 % error and must be rejected");
+    UNITY_TEST_ASSERT(brr.over8, __LINE__, "ERROR: 921600 bps at 8 MHz must use oversampling by 8");
+    UNITY_TEST_ASSERT_EQUAL_UINT16(0x11, brr.brr, __LINE__, "ERROR: wrong BRR for 921600 bps at 8 MHz");
+}
+
+void test_out_of_range(void)
+{
+    usart_brr_t brr;
+    UNITY_TEST_ASSERT(!usart_brr_compute(90000000, 1200, &brr), __LINE__, "ERROR: 1200 bps at 90 MHz does not fit in BRR");
+    UNITY_TEST_ASSERT(!usart_brr_compute(16000000, 4000000, &brr), __LINE__, "ERROR: 4 Mbps at 16 MHz is above the maximum baud rate");
+    UNITY_TEST_ASSERT(!usart_brr_compute(16000000, 0, &brr), __LINE__, "ERROR: a baud rate of 0 must be rejected");
+}
+
+void test_reference_table(void)
+{
+    for (uint32_t i = 0; i < sizeof(references) / sizeof(references[0]); i++)
+    {
+        const brr_reference_t *p_ref = &references[i];
+        usart_brr_t brr;
+        bool ok = usart_brr_compute(p_ref->pclk_hz, p_ref->baudrate, &brr);
+        UNITY_TEST_ASSERT_EQUAL_UINT16(p_ref->brr, brr.brr, __LINE__, "ERROR: BRR is not the value of the reference manual");
+        UNITY_TEST_ASSERT(brr.over8 == p_ref->over8, __LINE__, "ERROR: the oversampling is not the one of the reference manual");
+        UNITY_TEST_ASSERT_INT32_WITHIN(50, p_ref->error_cpct * 100, brr.error_ppm, __LINE__, "ERROR: the baud rate error is not the one of the reference manual");
+        UNITY_TEST_ASSERT(ok == (abs(p_ref->error_cpct) <= USART_BRR_MAX_ERROR_PPM / 100), __LINE__, "ERROR: wrong acceptance of the baud rate error");
+    }
+
+    // 84 MHz / 1200 bps: USARTDIV 4375 does not fit in the 12-bit mantissa
+    usart_brr_t brr;
+    UNITY_TEST_ASSERT(!usart_brr_compute(84000000, 1200, &brr), __LINE__, "ERROR: a divider out of range must be rejected");
+}
+
+void test_autobaud_measurement(void)
+{
+    // 8 bit times of the sync char at 115200 bps measured with a 16 MHz counter: 1111.1 cycles
+    uint32_t measured = usart_brr_baudrate_from_cycles(16000000, 1111, 8);
+    UNITY_TEST_ASSERT_UINT32_WITHIN(100, 115200, measured, __LINE__, "ERROR: wrong measured baud rate");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(115200, usart_brr_snap_standard(measured), __LINE__, "ERROR: measured baud rate not snapped to 115200");
+
+    // A 3 % slower measurement still snaps to the right standard baud rate
+    UNITY_TEST_ASSERT_EQUAL_UINT32(9600, usart_brr_snap_standard(9312), __LINE__, "ERROR: measured baud rate not snapped to 9600");
+
+    // Far away from any standard baud rate: keep the measurement
+    UNITY_TEST_ASSERT_EQUAL_UINT32(75000, usart_brr_snap_standard(75000), __LINE__, "ERROR: non-standard baud rate must be kept");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, usart_brr_baudrate_from_cycles(16000000, 0, 8), __LINE__, "ERROR: an empty measurement must be rejected");
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+
+    RUN_TEST(test_known_values);
+    RUN_TEST(test_out_of_range);
+    RUN_TEST(test_reference_table);
+    RUN_TEST(test_autobaud_measurement);
+
+    exit(UNITY_END());
+}
@@ -0,0 +1,214 @@
+#include <unity.h>
+#include <string.h>
+#include "usart_isr.h"
+#include "port_system.h"
+
+#define MODEL_PERIPHS 6 /*Peripherals of the dispatch table, as USART1 to USART6*/
+#define MODEL_USARTS 2 /*USART IDs in use*/
+#define MODEL_PERIPH_0 2 /*Peripheral of the first USART ID (USART3)*/
+#define MODEL_PERIPH_1 1 /*Peripheral of the second USART ID (USART2)*/
+
+/**
+ * @brief Model of the registers of a USART peripheral served by the ISR, in the order of USART_TypeDef.
+ */
+typedef struct {
+    uint32_t SR; /*Status register*/
+    uint32_t DR; /*Data register*/
+    uint32_t BRR; /*Baud rate register*/
+    uint32_t CR1; /*Control register 1*/
+} usart_model_t;
+
+/**
+ * @brief Element of the USART array of the port: the registers of its peripheral and what its ISR has done.
+ */
+typedef struct {
+    usart_model_t *p_usart; /*Peripheral registers*/
+    uint32_t received; /*Bytes read from DR*/
+    uint32_t last_byte; /*Last byte read from DR*/
+    uint32_t written; /*Bytes written to DR*/
+    uint32_t overruns; /*Overruns counted*/
+    uint32_t completions; /*Transmission complete events served*/
+} usart_hw_model_t;
+
+static usart_model_t periphs[MODEL_PERIPHS];
+static usart_hw_model_t usarts[MODEL_USARTS];
+static uint8_t isr_table[MODEL_PERIPHS];
+
+void setUp(void)
+{
+    memset(periphs, 0, sizeof(periphs));
+    memset(usarts, 0, sizeof(usarts));
+    memset(isr_table, 0, sizeof(isr_table));
+    usarts[0].p_usart = &periphs[MODEL_PERIPH_0];
+    usarts[1].p_usart = &periphs[MODEL_PERIPH_1];
+    usart_isr_route(isr_table, MODEL_PERIPH_0, 0);
+    usart_isr_route(isr_table, MODEL_PERIPH_1, 1);
+}
+
+void tearDown(void)
+{
+}
+
+/**
+ * @brief Byte received by a peripheral: RXNE is set. If the previous byte has not been read, ORE is set instead and the new byte is lost.
+ */
+
+static void _receive(usart_model_t *p_usart, uint8_t byte)
+{
+    if (p_usart->SR & USART_ISR_RXNE)
+    {
+        p_usart->SR |= USART_ISR_ORE;
+        return;
+    }
+    p_usart->DR = byte;
+    p_usart->SR |= USART_ISR_RXNE;
+}
+
+/**
+ * @brief Body of the ISR of a USART ID, as port_usart_isr(): a read of DR clears RXNE and ORE, and a write clears TXE and TC.
+ */
+
+static void _isr(uint32_t usart_id)
+{
+    usart_hw_model_t *p_hw = &usarts[usart_id];
+    uint32_t events = usart_isr_events(p_hw->p_usart->SR, p_hw->p_usart->CR1);
+    if (events & USART_ISR_RXNE)
+    {
+        p_hw->overruns += (events & USART_ISR_ORE) ? 1 : 0;
+        p_hw->last_byte = p_hw->p_usart->DR;
+        p_hw->p_usart->SR &= ~(USART_ISR_RXNE | USART_ISR_ORE);
+        p_hw->received++;
+    }
+    if (events & USART_ISR_TXE)
+    {
+        p_hw->p_usart->DR = 'x';
+        p_hw->p_usart->SR &= ~(USART_ISR_TXE | USART_ISR_TC);
+        p_hw->written++;
+    }
+    if (events & USART_ISR_TC)
+    {
+        p_hw->p_usart->CR1 &= ~USART_ISR_TC;
+        p_hw->completions++;
+    }
+}
+
+/**
+ * @brief Interrupt of a peripheral, as port_usart_isr_dispatch().
+ */
+
+static void _isr_dispatch(uint32_t periph)
+{
+    uint32_t usart_id;
+    if (usart_isr_lookup(isr_table, periph, &usart_id))
+    {
+        _isr(usart_id);
+    }
+}
+
+void test_route(void)
+{
+    uint32_t usart_id = MODEL_USARTS;
+    UNITY_TEST_ASSERT(usart_isr_lookup(isr_table, MODEL_PERIPH_0, &usart_id), __LINE__, "ERROR: the peripheral of the first USART is not routed");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, usart_id, __LINE__, "ERROR: the peripheral of the first USART is routed to another USART ID");
+    UNITY_TEST_ASSERT(usart_isr_lookup(isr_table, MODEL_PERIPH_1, &usart_id), __LINE__, "ERROR: the peripheral of the second USART is not routed");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, usart_id, __LINE__, "ERROR: the peripheral of the second USART is routed to another USART ID");
+    for (uint32_t periph = 0; periph < MODEL_PERIPHS; periph++)
+    {
+        if ((periph != MODEL_PERIPH_0) && (periph != MODEL_PERIPH_1))
+        {
+            UNITY_TEST_ASSERT(!usart_isr_lookup(isr_table, periph, &usart_id), __LINE__, "ERROR: a peripheral that is not used is routed");
+        }
+    }
+}
+
+void test_dispatch_rx(void)
+{
+    usarts[0].p_usart->CR1 = USART_ISR_RXNE;
+    usarts[1].p_usart->CR1 = USART_ISR_RXNE;
+    _receive(usarts[1].p_usart, 'b');
+    _isr_dispatch(MODEL_PERIPH_1);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, usarts[0].received, __LINE__, "ERROR: the interrupt of the second USART has been served by the first one");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, usarts[1].received, __LINE__, "ERROR: the byte of the second USART has not been received");
+    UNITY_TEST_ASSERT_EQUAL_UINT32('b', usarts[1].last_byte, __LINE__, "ERROR: the byte has not been read from the peripheral of the second USART");
+
+    _receive(usarts[0].p_usart, 'a');
+    _isr_dispatch(MODEL_PERIPH_0);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, usarts[0].received, __LINE__, "ERROR: the byte of the first USART has not been received");
+    UNITY_TEST_ASSERT_EQUAL_UINT32('a', usarts[0].last_byte, __LINE__, "ERROR: the byte has not been read from the peripheral of the first USART");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, usarts[1].received, __LINE__, "ERROR: the interrupt of the first USART has been served by the second one");
+}
+
+void test_dispatch_unused(void)
+{
+    usarts[0].p_usart->CR1 = USART_ISR_RXNE;
+    _receive(usarts[0].p_usart, 'a');
+    _isr_dispatch(0);
+    _isr_dispatch(MODEL_PERIPHS - 1);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, usarts[0].received + usarts[1].received, __LINE__, "ERROR: the interrupt of a peripheral that is not used has been served");
+}
+
+void test_enables(void)
+{
+    /* Flags set but not enabled are left for the main loop (e.g., TXE with the TX interrupt disabled) */
+    usarts[0].p_usart->SR = USART_ISR_TXE | USART_ISR_TC;
+    usarts[0].p_usart->CR1 = USART_ISR_RXNE;
+    _receive(usarts[0].p_usart, 'a');
+    _isr_dispatch(MODEL_PERIPH_0);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, usarts[0].received, __LINE__, "ERROR: the enabled RX event has not been served");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, usarts[0].written, __LINE__, "ERROR: a TXE flag with its interrupt disabled has been served");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, usarts[0].completions, __LINE__, "ERROR: a TC flag with its interrupt disabled has been served");
+
+    /* Enabled RXNE interrupt with no byte received: nothing to read */
+    usarts[0].p_usart->CR1 = USART_ISR_RXNE | USART_ISR_TXE;
+    _isr_dispatch(MODEL_PERIPH_0);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, usarts[0].received, __LINE__, "ERROR: DR has been read with RXNE cleared");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, usarts[0].written, __LINE__, "ERROR: the enabled TX event has not been served");
+
+    /* The events of another peripheral do not enable anything */
+    usarts[1].p_usart->SR = USART_ISR_TXE;
+    _isr_dispatch(MODEL_PERIPH_1);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, usarts[1].written, __LINE__, "ERROR: the enables of the first USART have been used for the second one");
+}
+
+void test_overrun(void)
+{
+    usarts[0].p_usart->CR1 = USART_ISR_RXNE;
+    usarts[1].p_usart->CR1 = USART_ISR_RXNE;
+    _receive(usarts[0].p_usart, 'a');
+    _receive(usarts[0].p_usart, 'b'); // Before the ISR has read 'a'
+    _receive(usarts[1].p_usart, 'c');
+    _isr_dispatch(MODEL_PERIPH_0);
+    _isr_dispatch(MODEL_PERIPH_1);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, usarts[0].overruns, __LINE__, "ERROR: the overrun of the first USART has not been counted");
+    UNITY_TEST_ASSERT_EQUAL_UINT32('a', usarts[0].last_byte, __LINE__, "ERROR: the byte before the overrun has not been received");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, usarts[1].overruns, __LINE__, "ERROR: the overrun of the first USART has been counted for the second one");
+
+    /* ORE without RXNE enabled is not served: the byte that follows reports it */
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, usart_isr_events(USART_ISR_ORE | USART_ISR_RXNE, 0), __LINE__, "ERROR: an overrun has been reported with the RX interrupt disabled");
+}
+
+void test_transmission_complete(void)
+{
+    usarts[1].p_usart->CR1 = USART_ISR_TC;
+    usarts[1].p_usart->SR = USART_ISR_TC | USART_ISR_TXE;
+    _isr_dispatch(MODEL_PERIPH_1);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, usarts[1].completions, __LINE__, "ERROR: the TC event has not been served");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, usarts[1].written, __LINE__, "ERROR: a TXE flag with its interrupt disabled has been served with TC");
+    _isr_dispatch(MODEL_PERIPH_1);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, usarts[1].completions, __LINE__, "ERROR: the TC event has been served with its interrupt disabled");
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+
+    RUN_TEST(test_route);
+    RUN_TEST(test_dispatch_rx);
+    RUN_TEST(test_dispatch_unused);
+    RUN_TEST(test_enables);
+    RUN_TEST(test_overrun);
+    RUN_TEST(test_transmission_complete);
+
+    exit(UNITY_END());
+}
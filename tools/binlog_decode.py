@@ -0,0 +1,186 @@
+#!/usr/bin/env python3
+"""Decode the deferred binary log (common/src/binlog.c) streamed by the MCU.
+
+The format strings are read from the section binlog_fmt of the ELF of the
+firmware: the ID of a record is the offset of its format string in that
+section. The records arrive as COBS-encoded, CRC-checked frames (see
+common/src/cobs_frame.c) whose payload starts with BINLOG_FRAME_TYPE.
+
+Usage:
+    binlog_decode.py firmware.elf [--port /dev/ttyACM0 --baud 115200]
+    binlog_decode.py firmware.elf --file capture.bin
+
+Only the Python standard library is needed. pyserial is used to configure
+the baud rate of a serial port if it is installed; pseudo-terminals (the
+native platform) and captures are read as plain files.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+SECTION = "binlog_fmt"
+FRAME_TYPE = ord("L")
+FRAME_HEADER_LENGTH = 3
+ID_BITS = 24
+ID_DROPPED = (1 << ID_BITS) - 1
+CRC_INIT = 0xFFFF
+CONVERSION = re.compile(r"%([-+ #0]*\d*(?:\.\d+)?)(hh|h|ll|l|z|j|t)?([diouxXcps%])")
+
+
+def read_formats(elf_path):
+    """Return {offset: format string} for the section binlog_fmt of an ELF."""
+    with open(elf_path, "rb") as f:
+        elf = f.read()
+    if elf[:4] != b"\x7fELF":
+        sys.exit(f"{elf_path}: not an ELF file")
+    is64 = elf[4] == 2
+    endian = "<" if elf[5] == 1 else ">"
+    if is64:
+        shoff, = struct.unpack_from(endian + "Q", elf, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from(endian + "HHH", elf, 0x3A)
+        header = endian + "IIQQQQIIQQ"
+    else:
+        shoff, = struct.unpack_from(endian + "I", elf, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from(endian + "HHH", elf, 0x2E)
+        header = endian + "IIIIIIIIII"
+    sections = [struct.unpack_from(header, elf, shoff + i * shentsize) for i in range(shnum)]
+    names = sections[shstrndx]
+    for sec in sections:
+        name_off = names[4] + sec[0]
+        name = elf[name_off:elf.index(b"\0", name_off)].decode()
+        if name == SECTION:
+            data = elf[sec[4]:sec[4] + sec[5]]
+            break
+    else:
+        sys.exit(f"{elf_path}: no section {SECTION} (no BINLOG() call sites?)")
+
+    formats = {}
+    offset = 0
+    while offset < len(data):
+        end = data.index(b"\0", offset)
+        if end > offset:
+            formats[offset] = data[offset:end].decode(errors="replace")
+        offset = end + 1
+    return formats
+
+
+def crc16(data, crc=CRC_INIT):
+    """CRC-16/CCITT-FALSE, as cobs_frame_crc16()."""
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(frame):
+    """Decode a COBS frame without its delimiter and check its CRC. Return the payload or None."""
+    out = bytearray()
+    i = 0
+    while i < len(frame):
+        code = frame[i]
+        if code == 0 or i + code > len(frame):
+            return None
+        out += frame[i + 1:i + code]
+        i += code
+        if code != 0xFF and i < len(frame):
+            out.append(0)
+    if len(out) < 2 or crc16(out[:-2]) != (out[-2] << 8 | out[-1]):
+        return None
+    return bytes(out[:-2])
+
+
+def format_record(fmt, args):
+    """Apply a printf format to 32-bit integer arguments."""
+    args = list(args)
+
+    def convert(match):
+        flags, _, conv = match.groups()
+        if conv == "%":
+            return "%"
+        value = args.pop(0) if args else 0
+        if conv in "di":
+            value = value - (1 << 32) if value & 0x80000000 else value
+            conv = "d"
+        elif conv == "u":
+            conv = "d"
+        elif conv == "p":
+            return "0x%08x" % value
+        elif conv == "s":
+            return "<str@0x%08x>" % value
+        elif conv == "c":
+            value = chr(value & 0xFF)
+        return ("%" + flags + conv) % value
+
+    return CONVERSION.sub(convert, fmt)
+
+
+def decode_payload(payload, formats):
+    """Yield (time in us, text) for each record of a frame payload."""
+    cycles_per_us = payload[1] | (payload[2] << 8) or 1
+    offset = FRAME_HEADER_LENGTH
+    while offset + 8 <= len(payload):
+        word, timestamp = struct.unpack_from("<II", payload, offset)
+        fmt_id, nargs = word & ID_DROPPED, word >> ID_BITS
+        args = struct.unpack_from("<%dI" % nargs, payload, offset + 8)
+        offset += 8 + 4 * nargs
+        if fmt_id == ID_DROPPED:
+            text = "*** %u records dropped ***" % args[0]
+        elif fmt_id in formats:
+            text = format_record(formats[fmt_id], args)
+        else:
+            text = "<unknown format 0x%06x> %s" % (fmt_id, " ".join("0x%08x" % a for a in args))
+        yield timestamp / cycles_per_us, text
+
+
+def open_input(args):
+    if args.file:
+        return open(args.file, "rb")
+    if args.port:
+        try:
+            import serial
+            return serial.Serial(args.port, args.baud)
+        except ImportError:
+            return open(args.port, "rb", buffering=0)
+    return sys.stdin.buffer
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("elf", help="ELF of the firmware, with the section " + SECTION)
+    parser.add_argument("--port", help="serial port or pseudo-terminal to read")
+    parser.add_argument("--baud", type=int, default=115200, help="baud rate of the serial port")
+    parser.add_argument("--file", help="capture of the raw bytes to decode")
+    args = parser.parse_args()
+
+    formats = read_formats(args.elf)
+    stream = open_input(args)
+    frame = bytearray()
+    errors = 0
+    while True:
+        chunk = stream.read(1)
+        if not chunk:
+            break
+        if chunk[0] != 0:
+            frame += chunk
+            continue
+        if not frame:
+            continue
+        payload = cobs_decode(bytes(frame))
+        frame.clear()
+        if payload is None:
+            errors += 1
+            continue
+        if payload[0] != FRAME_TYPE or len(payload) < FRAME_HEADER_LENGTH:
+            continue
+        for time_us, text in decode_payload(payload, formats):
+            print("%12.1f us  %s" % (time_us, text), flush=True)
+    if errors:
+        print("%d corrupted frames" % errors, file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+"""Read the latency probes of the MCU (common/src/latency_probe.c) and print their histograms.
+
+It sends the command `latency <probe>` through the USART link of the command
+interpreter (common/src/fsm_command.c) for every probe and decodes the
+snapshots, COBS-encoded, CRC-checked binary frames. The names and the order of
+the probes and the buckets of the histograms are read from
+common/include/latency_probe.h.
+
+Usage:
+    latency_cli.py --port /dev/ttyACM0 [--baud 115200]
+
+The firmware must be built with -DUSE_LATENCY_PROBE=true. The link is opened as
+in metrics_cli.py.
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+import time
+
+from binlog_decode import cobs_decode
+from metrics_cli import Link
+
+HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "common", "include", "latency_probe.h")
+FRAME_TYPE = ord("H")
+REPLY = re.compile(rb"^(?:latency (?:ok|err)\n)+")
+
+
+def read_probes(header_path):
+    """Return the names of the probes and the number of buckets and the upper bound (log2) of the first one."""
+    with open(header_path) as f:
+        text = f.read()
+    body = re.search(r"#define LATENCY_PROBES\(X\)(.*?)\n\n", text, re.S).group(1)
+    buckets = int(re.search(r"#define LATENCY_PROBE_BUCKETS (\d+)", text).group(1))
+    min_log2 = int(re.search(r"#define LATENCY_PROBE_MIN_LOG2 (\d+)", text).group(1))
+    return re.findall(r"X\((\w+)\)", body), buckets, min_log2
+
+
+def poll(link, probe, timeout):
+    """Send the command for a probe and return the payload of its snapshot, or None."""
+    link.write(b"latency %d\n" % probe)
+    data = bytearray()
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        data += link.read(deadline - time.monotonic())
+        while b"\0" in data:
+            chunk, _, data = bytes(data).partition(b"\0")
+            data = bytearray(data)
+            payload = cobs_decode(REPLY.sub(b"", chunk))
+            if payload and payload[0] == FRAME_TYPE and payload[1] == probe:
+                return payload
+        if data.startswith(b"latency err\n"):
+            sys.exit("the firmware replied `latency err`: was it built with -DUSE_LATENCY_PROBE=true?")
+    return None
+
+
+def percentile(counts, bounds, fraction):
+    """Upper bound of the bucket that holds the given fraction of the latencies."""
+    total = sum(counts)
+    seen = 0
+    for count, bound in zip(counts, bounds):
+        seen += count
+        if seen >= fraction * total:
+            return bound
+    return bounds[-1]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--port", required=True, help="serial port or pseudo-terminal of the command interpreter")
+    parser.add_argument("--baud", type=int, default=115200, help="baud rate of the serial port")
+    parser.add_argument("--timeout", type=float, default=1.0, help="seconds to wait for each snapshot")
+    parser.add_argument("--header", default=HEADER, help="latency_probe.h of the firmware")
+    args = parser.parse_args()
+
+    names, buckets, min_log2 = read_probes(args.header)
+    bounds = ["<%u" % (1 << (min_log2 + b)) if b < buckets - 1 else ">=%u" % (1 << (min_log2 + b - 1)) for b in range(buckets)]
+    link = Link(args.port, args.baud)
+    for probe, name in enumerate(names):
+        payload = poll(link, probe, args.timeout)
+        if payload is None or len(payload) != 2 + 4 * (3 + buckets):
+            print("%-8s no snapshot received" % name.lower(), file=sys.stderr)
+            continue
+        count, min_us, max_us, *counts = struct.unpack_from("<%dI" % (3 + buckets), payload, 2)
+        if count == 0:
+            print("%-8s no latencies recorded" % name.lower())
+            continue
+        print("%-8s n %u min %u us max %u us p50 %s us p99 %s us" % (name.lower(), count, min_us, max_us,
+                                                                    percentile(counts, bounds, 0.5), percentile(counts, bounds, 0.99)))
+        print("         " + " ".join("%s:%u" % (bound, n) for bound, n in zip(bounds, counts) if n))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""Poll the metrics registry of the MCU (common/src/metrics.c) and print deltas.
+
+It sends the command `metrics` through the USART link of the command
+interpreter (common/src/fsm_command.c) and decodes the snapshot, a
+COBS-encoded, CRC-checked binary frame. The names and the order of the
+metrics are read from the tables of common/include/metrics.h, so the
+tool follows any change of the registry.
+
+Usage:
+    metrics_cli.py --port /dev/ttyACM0 [--baud 115200] [--interval 1.0]
+
+Only the Python standard library is needed. pyserial is used to configure
+the baud rate of a serial port if it is installed; pseudo-terminals (the
+native platform) are opened as plain files.
+"""
+
+import argparse
+import os
+import re
+import select
+import struct
+import sys
+import time
+
+from binlog_decode import cobs_decode
+
+HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "common", "include", "metrics.h")
+FRAME_TYPE = ord("M")
+REPLY = re.compile(rb"^(?:metrics (?:ok|err)\n)+")
+
+
+def read_registry(header_path):
+    """Return the names of the counters, gauges and histograms and the number of buckets of the histograms."""
+    with open(header_path) as f:
+        text = f.read()
+
+    def table(name):
+        body = re.search(r"#define %s\(X\)(.*?)\n\n" % name, text, re.S).group(1)
+        return re.findall(r"X\((\w+)\)", body)
+
+    buckets = int(re.search(r"#define METRICS_HISTOGRAM_BUCKETS (\d+)", text).group(1))
+    min_log2 = int(re.search(r"#define METRICS_HISTOGRAM_MIN_LOG2 (\d+)", text).group(1))
+    return table("METRICS_COUNTERS"), table("METRICS_GAUGES"), table("METRICS_HISTOGRAMS"), buckets, min_log2
+
+
+class Link:
+    """Serial port or pseudo-terminal with a read timeout."""
+
+    def __init__(self, port, baud):
+        try:
+            import serial
+            self.serial = serial.Serial(port, baud, timeout=0.1)
+            self.fd = None
+        except ImportError:
+            self.serial = None
+            self.fd = os.open(port, os.O_RDWR | os.O_NOCTTY)
+
+    def write(self, data):
+        if self.serial:
+            self.serial.write(data)
+        else:
+            os.write(self.fd, data)
+
+    def read(self, timeout):
+        if self.serial:
+            return self.serial.read(256)
+        ready, _, _ = select.select([self.fd], [], [], timeout)
+        return os.read(self.fd, 256) if ready else b""
+
+
+def poll(link, timeout):
+    """Send the command and return the payload of the snapshot, or None."""
+    link.write(b"metrics\n")
+    data = bytearray()
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        data += link.read(deadline - time.monotonic())
+        while b"\0" in data:
+            chunk, _, data = bytes(data).partition(b"\0")
+            data = bytearray(data)
+            payload = cobs_decode(REPLY.sub(b"", chunk))
+            if payload and payload[0] == FRAME_TYPE:
+                return payload
+        if data.startswith(b"metrics err\n"):
+            sys.exit("the firmware replied `metrics err`: was it built with -DUSE_METRICS=true?")
+    return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--port", required=True, help="serial port or pseudo-terminal of the command interpreter")
+    parser.add_argument("--baud", type=int, default=115200, help="baud rate of the serial port")
+    parser.add_argument("--interval", type=float, default=1.0, help="seconds between snapshots")
+    parser.add_argument("--count", type=int, default=0, help="number of snapshots (0: forever)")
+    parser.add_argument("--header", default=HEADER, help="metrics.h of the firmware")
+    args = parser.parse_args()
+
+    counters, gauges, histograms, buckets, min_log2 = read_registry(args.header)
+    words = 1 + len(counters) + len(gauges) + len(histograms) * buckets
+    link = Link(args.port, args.baud)
+    previous = None
+    n = 0
+    while args.count == 0 or n < args.count:
+        payload = poll(link, max(args.interval, 0.5))
+        if payload is None or len(payload) != 1 + 4 * words:
+            print("no snapshot received", file=sys.stderr)
+            time.sleep(args.interval)
+            continue
+        values = struct.unpack_from("<%dI" % words, payload, 1)
+        now_ms, values = values[0], values[1:]
+        if previous is not None:
+            dt = ((now_ms - previous[0]) & 0xFFFFFFFF) / 1000.0 or 1e-3
+            print("--- %.3f s (+%.3f s)" % (now_ms / 1000.0, dt))
+            for i, name in enumerate(counters):
+                delta = (values[i] - previous[1][i]) & 0xFFFFFFFF
+                print("  %-22s %10u  %+9u  %10.1f/s" % (name.lower(), values[i], delta, delta / dt))
+            for i, name in enumerate(gauges):
+                value = values[len(counters) + i]
+                text = "%.1f %%" % (value / 10.0) if name.endswith("_PERMILLE") else str(value)
+                print("  %-22s %10s" % (name.lower(), text))
+            base = len(counters) + len(gauges)
+            for h, name in enumerate(histograms):
+                cells = []
+                for b in range(buckets):
+                    i = base + h * buckets + b
+                    delta = (values[i] - previous[1][i]) & 0xFFFFFFFF
+                    bound = "<%u" % (1 << (min_log2 + b)) if b < buckets - 1 else ">=%u" % (1 << (min_log2 + b - 1))
+                    cells.append("%s:%u" % (bound, delta))
+                print("  %-22s %s" % (name.lower(), " ".join(cells)))
+            sys.stdout.flush()
+        previous = (now_ms, values)
+        n += 1
+        time.sleep(args.interval)
+
+
+if __name__ == "__main__":
+    main()